@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+
+#include <AH/Hardware/ExtendedInputOutput/ExtendedIOElement.hpp>
+
+#include <memory>
+#include <vector>
+
+USING_AH_NAMESPACE;
+
+/// Extended IO element that doesn't do any IO, to measure the overhead of
+/// looking up the element of a pin.
+class DummyExtIOElement : public ExtendedIOElement {
+  public:
+    DummyExtIOElement(pin_t length) : ExtendedIOElement(length) {}
+
+    void pinModeBuffered(pin_t, PinMode_t) override {}
+    void digitalWriteBuffered(pin_t, PinStatus_t) override {}
+    int digitalReadBuffered(pin_t pin) override { return pin & 1; }
+    void analogWriteBuffered(pin_t, analog_t) override {}
+    analog_t analogReadBuffered(pin_t pin) override { return pin; }
+    void begin() override {}
+    void updateBufferedOutputs() override {}
+    void updateBufferedInputs() override {}
+};
+
+/// Create the given number of 8-pin elements (e.g. shift registers), and
+/// return a list of all of their pins.
+static std::vector<pin_t>
+makeElements(size_t count,
+             std::vector<std::unique_ptr<DummyExtIOElement>> &elements) {
+    std::vector<pin_t> pins;
+    for (size_t i = 0; i < count; ++i) {
+        elements.emplace_back(new DummyExtIOElement(8));
+        for (pin_t p = 0; p < 8; ++p)
+            pins.push_back(elements.back()->pin(p));
+    }
+    return pins;
+}
+
+/// The original implementation of ExtIO::getIOElementOfPin, for comparison.
+static ExtendedIOElement *linearSearch(pin_t pin) {
+    for (auto &el : ExtendedIOElement::getAll())
+        if (pin < el.getStart())
+            break;
+        else if (pin >= el.getStart() && pin < el.getEnd())
+            return &el;
+    return nullptr;
+}
+
+static void BM_ExtIO_digitalReadBuffered_linear(benchmark::State &state) {
+    std::vector<std::unique_ptr<DummyExtIOElement>> elements;
+    auto pins = makeElements(state.range(0), elements);
+    size_t i = 0;
+    for (auto _ : state) {
+        ExtendedIOElement *el = linearSearch(pins[i]);
+        benchmark::DoNotOptimize(
+            el->digitalReadBuffered(pins[i] - el->getStart()));
+        if (++i == pins.size())
+            i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ExtIO_digitalReadBuffered_linear)->Arg(1)->Arg(18)->Arg(64);
+
+static void BM_ExtIO_digitalReadBuffered_table(benchmark::State &state) {
+    std::vector<std::unique_ptr<DummyExtIOElement>> elements;
+    auto pins = makeElements(state.range(0), elements);
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ExtIO::digitalReadBuffered(pins[i]));
+        if (++i == pins.size())
+            i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ExtIO_digitalReadBuffered_table)->Arg(1)->Arg(18)->Arg(64);
+
+/// Calling the element directly, without looking it up, as a lower bound.
+static void BM_ExtIO_digitalReadBuffered_direct(benchmark::State &state) {
+    std::vector<std::unique_ptr<DummyExtIOElement>> elements;
+    makeElements(state.range(0), elements);
+    size_t i = 0;
+    pin_t p = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(elements[i]->digitalReadBuffered(p));
+        if (++p == 8) {
+            p = 0;
+            if (++i == elements.size())
+                i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ExtIO_digitalReadBuffered_direct)->Arg(1)->Arg(18)->Arg(64);
@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+
+#include <AH/Containers/Updatable.hpp>
+#include <AH/Hardware/ExtendedInputOutput/ExtendedIOElement.hpp>
+#include <AH/Hardware/FilteredAnalog.hpp>
+#include <AH/Hardware/FilteredAnalogArray.hpp>
+
+#include <memory>
+#include <vector>
+
+USING_AH_NAMESPACE;
+
+/// Extended IO element with noisy analog inputs, without any actual IO, so
+/// only the cost of filtering is measured. Like a buffered multiplexer, the
+/// analog inputs are sampled in updateBufferedInputs, and analogRead simply
+/// returns the buffered sample.
+class NoisyAnalogExtIOElement : public ExtendedIOElement {
+  public:
+    NoisyAnalogExtIOElement(pin_t length)
+        : ExtendedIOElement(length), samples(length) {
+        updateBufferedInputs();
+    }
+
+    void pinModeBuffered(pin_t, PinMode_t) override {}
+    void digitalWriteBuffered(pin_t, PinStatus_t) override {}
+    int digitalReadBuffered(pin_t) override { return 0; }
+    void analogWriteBuffered(pin_t, analog_t) override {}
+    analog_t analogRead(pin_t pin) override { return samples[pin]; }
+    analog_t analogReadBuffered(pin_t pin) override { return samples[pin]; }
+    void begin() override {}
+    void updateBufferedOutputs() override {}
+    void updateBufferedInputs() override {
+        // Cheap pseudo-random noise of a few LSB around a fixed value per pin.
+        for (pin_t pin = 0; pin < samples.size(); ++pin) {
+            noise = noise * 1103515245u + 12345u;
+            samples[pin] = (pin * 16 + (noise >> 30)) & 0x3FF;
+        }
+    }
+
+  private:
+    std::vector<analog_t> samples;
+    uint32_t noise = 1;
+};
+
+constexpr uint8_t NumPots = 64;
+
+/// Stands in for sending the new values over MIDI.
+static unsigned sink = 0;
+
+/// One potentiometer per object, updated through the linked list of
+/// Updatable%s, like MIDIFilteredAnalog.
+class SeparatePotentiometer : public Updatable<> {
+  public:
+    SeparatePotentiometer(pin_t pin) : analog(pin) {}
+    void begin() override {}
+    void update() override {
+        if (analog.update())
+            sink += analog.getValue();
+    }
+
+  private:
+    FilteredAnalog<10> analog;
+};
+
+static void BM_FilteredAnalog_separate(benchmark::State &state) {
+    NoisyAnalogExtIOElement el(NumPots);
+    std::vector<std::unique_ptr<SeparatePotentiometer>> pots;
+    for (pin_t p = 0; p < NumPots; ++p)
+        pots.emplace_back(new SeparatePotentiometer(el.pin(p)));
+    for (auto _ : state) {
+        el.updateBufferedInputs();
+        Updatable<>::updateAll();
+    }
+    benchmark::DoNotOptimize(sink);
+    state.SetItemsProcessed(state.iterations() * NumPots);
+}
+BENCHMARK(BM_FilteredAnalog_separate);
+
+static void BM_FilteredAnalog_array(benchmark::State &state) {
+    NoisyAnalogExtIOElement el(NumPots);
+    PinList<NumPots> pins;
+    for (pin_t p = 0; p < NumPots; ++p)
+        pins[p] = el.pin(p);
+    FilteredAnalogArray<NumPots, 10> analogs = pins;
+    for (auto _ : state) {
+        el.updateBufferedInputs();
+        if (analogs.update())
+            analogs.forEachChanged(
+                [&](uint8_t i) { sink += analogs.getValue(i); });
+    }
+    benchmark::DoNotOptimize(sink);
+    state.SetItemsProcessed(state.iterations() * NumPots);
+}
+BENCHMARK(BM_FilteredAnalog_array);
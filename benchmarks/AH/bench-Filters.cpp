@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include <AH/Filters/EMA.hpp>
+#include <AH/Filters/Hysteresis.hpp>
+#include <AH/Settings/SettingsWrapper.hpp>
+
+#include <random>
+#include <vector>
+
+USING_AH_NAMESPACE;
+
+/// 10-bit samples of a slow ramp with a few LSB of noise, shifted left by the
+/// filter shift factor, like FilteredAnalog does.
+static std::vector<uint16_t> makeSamples() {
+    std::vector<uint16_t> samples;
+    std::mt19937 rng(1);
+    for (unsigned i = 0; i < 4096; ++i) {
+        int sample = int(i / 4 % 1024) + int(rng() % 9) - 4;
+        sample = sample < 0 ? 0 : sample > 1023 ? 1023 : sample;
+        samples.push_back(sample << ANALOG_FILTER_SHIFT_FACTOR);
+    }
+    return samples;
+}
+
+using AnalogEMA =
+    EMA<ANALOG_FILTER_SHIFT_FACTOR, ANALOG_FILTER_TYPE, ANALOG_FILTER_TYPE>;
+// Reduce the 12-bit filtered values to 7-bit MIDI values.
+using AnalogHysteresis = Hysteresis<10 + ANALOG_FILTER_SHIFT_FACTOR - 7,
+                                    uint16_t, uint8_t>;
+
+static void BM_EMA(benchmark::State &state) {
+    auto samples = makeSamples();
+    AnalogEMA filter;
+    for (auto _ : state)
+        for (uint16_t sample : samples)
+            benchmark::DoNotOptimize(filter(sample));
+    state.SetItemsProcessed(state.iterations() * samples.size());
+}
+BENCHMARK(BM_EMA);
+
+static void BM_Hysteresis(benchmark::State &state) {
+    auto samples = makeSamples();
+    AnalogHysteresis hysteresis;
+    for (auto _ : state)
+        for (uint16_t sample : samples)
+            benchmark::DoNotOptimize(hysteresis.update(sample));
+    state.SetItemsProcessed(state.iterations() * samples.size());
+}
+BENCHMARK(BM_Hysteresis);
+
+static void BM_EMA_Hysteresis(benchmark::State &state) {
+    auto samples = makeSamples();
+    AnalogEMA filter;
+    AnalogHysteresis hysteresis;
+    for (auto _ : state)
+        for (uint16_t sample : samples)
+            benchmark::DoNotOptimize(hysteresis.update(filter(sample)));
+    state.SetItemsProcessed(state.iterations() * samples.size());
+}
+BENCHMARK(BM_EMA_Hysteresis);
@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+
+#include <Control_Surface/Control_Surface_Class.hpp>
+#include <Display/NoteBitmapDisplay.hpp>
+#include <MockPagedDisplay.hpp>
+
+#include <memory>
+#include <vector>
+
+USING_CS_NAMESPACE;
+
+/// Grid of 8×4 note indicators of 16×16 pixels, filling the entire display.
+struct NoteGrid {
+    constexpr static uint8_t NumNotes = 32;
+
+    NoteGrid() {
+        for (uint8_t i = 0; i < NumNotes; ++i) {
+            notes.emplace_back(new NoteValue{{i, CHANNEL_1}});
+            PixelLocation loc = {int16_t(i % 8 * 16), int16_t(i / 8 * 16)};
+            elements.emplace_back(
+                new NoteBitmapDisplay{display, *notes.back(), XBM::mute_14B,
+                                      loc, 1});
+        }
+    }
+
+    /// Turn the given note on or off.
+    void toggle(uint8_t note) {
+        uint8_t velocity = notes[note]->getValue() ? 0x00 : 0x7F;
+        notes[note]->updateWith(
+            {MIDIMessageType::NOTE_ON, CHANNEL_1, note, velocity, 0});
+    }
+
+    MockPagedDisplay display;
+    std::vector<std::unique_ptr<NoteValue>> notes;
+    std::vector<std::unique_ptr<NoteBitmapDisplay>> elements;
+};
+
+/// Toggle the number of notes given by the first argument, then update the
+/// displays, for every frame.
+static void BM_DisplayElements_frame(benchmark::State &state) {
+    NoteGrid grid;
+    Control_Surface.updateDisplays(); // Initial frame isn't measured
+    grid.display.bytesTransferred = 0;
+    const uint8_t changes = state.range(0);
+    uint8_t note = 0;
+    for (auto _ : state) {
+        for (uint8_t i = 0; i < changes; ++i) {
+            grid.toggle(note);
+            note = (note + 1) % NoteGrid::NumNotes;
+        }
+        Control_Surface.updateDisplays();
+    }
+    benchmark::DoNotOptimize(grid.display.buffer);
+    state.counters["bytes_transferred/frame"] = benchmark::Counter(
+        grid.display.bytesTransferred, benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * changes);
+}
+BENCHMARK(BM_DisplayElements_frame)->Arg(0)->Arg(1)->Arg(8)->Arg(32);
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/// Mixes of MIDI messages that are used as workloads for the benchmarks.
+/// They are generated deterministically, so the results can be compared
+/// between runs.
+enum class MIDIMix : int {
+    Notes,         ///< Note On and Note Off messages on all channels.
+    ControlChange, ///< Control Change messages in bursts per channel.
+    RealTime,      ///< Timing clock messages with some Note messages.
+    SysEx,         ///< Long System Exclusive messages.
+    Mixed,         ///< A random mix of all of the above.
+};
+constexpr int NumMIDIMixes = 5;
+
+inline const char *getName(MIDIMix mix) {
+    switch (mix) {
+        case MIDIMix::Notes: return "Notes";
+        case MIDIMix::ControlChange: return "ControlChange";
+        case MIDIMix::RealTime: return "RealTime";
+        case MIDIMix::SysEx: return "SysEx";
+        case MIDIMix::Mixed: return "Mixed";
+        default: return "<invalid>";
+    }
+}
+
+/// Run the benchmark for all mixes, passing the mix as the first argument.
+inline void allMIDIMixes(benchmark::internal::Benchmark *b) {
+    for (int mix = 0; mix < NumMIDIMixes; ++mix)
+        b->Arg(mix);
+}
+
+/// A single MIDI message, all bytes including the status byte.
+using MIDIMessageBytes = std::vector<uint8_t>;
+
+inline MIDIMessageBytes makeSysEx(size_t length, uint8_t seed) {
+    MIDIMessageBytes sysex = {0xF0};
+    for (size_t i = 0; i < length; ++i)
+        sysex.push_back((seed + i) & 0x7F);
+    sysex.push_back(0xF7);
+    return sysex;
+}
+
+/// Generate the messages of the given mix.
+inline std::vector<MIDIMessageBytes> makeMIDIMessages(MIDIMix mix) {
+    std::vector<MIDIMessageBytes> msgs;
+    std::mt19937 rng(1);
+    auto rand7 = [&] { return uint8_t(rng() & 0x7F); };
+    switch (mix) {
+        case MIDIMix::Notes:
+            for (unsigned i = 0; i < 256; ++i) {
+                uint8_t ch = i % 16, note = rand7();
+                msgs.push_back({uint8_t(0x90 | ch), note, rand7()});
+                msgs.push_back({uint8_t(0x80 | ch), note, 0x40});
+            }
+            break;
+        case MIDIMix::ControlChange:
+            for (uint8_t ch = 0; ch < 8; ++ch)
+                for (uint8_t cc = 0; cc < 64; ++cc)
+                    msgs.push_back({uint8_t(0xB0 | ch), cc, rand7()});
+            break;
+        case MIDIMix::RealTime:
+            msgs.push_back({0xFA}); // Start
+            for (unsigned i = 0; i < 384; ++i) {
+                msgs.push_back({0xF8}); // Timing Clock
+                if (i % 6 == 0)
+                    msgs.push_back({0x99, uint8_t(36 + i % 12), 0x7F});
+            }
+            msgs.push_back({0xFC}); // Stop
+            break;
+        case MIDIMix::SysEx:
+            for (uint8_t i = 0; i < 8; ++i)
+                msgs.push_back(makeSysEx(120, i));
+            break;
+        case MIDIMix::Mixed:
+            for (unsigned i = 0; i < 512; ++i) {
+                unsigned r = rng() % 100;
+                uint8_t ch = rng() % 16;
+                if (r < 40)
+                    msgs.push_back({uint8_t(0xB0 | ch), rand7(), rand7()});
+                else if (r < 70)
+                    msgs.push_back({uint8_t(0x90 | ch), rand7(), rand7()});
+                else if (r < 85)
+                    msgs.push_back({0xF8});
+                else if (r < 95)
+                    msgs.push_back({uint8_t(0xE0 | ch), rand7(), rand7()});
+                else
+                    msgs.push_back(makeSysEx(16 + rng() % 48, rand7()));
+            }
+            break;
+        default: break;
+    }
+    return msgs;
+}
+
+/// Encode the messages as a serial MIDI byte stream, optionally using running
+/// status.
+inline std::vector<uint8_t>
+toSerialMIDI(const std::vector<MIDIMessageBytes> &msgs,
+             bool runningStatus = true) {
+    std::vector<uint8_t> data;
+    uint8_t status = 0;
+    for (auto &msg : msgs) {
+        uint8_t header = msg[0];
+        bool realtime = header >= 0xF8;
+        bool skipStatus = runningStatus && header == status && !realtime;
+        data.insert(data.end(), msg.begin() + skipStatus, msg.end());
+        if (header < 0xF0)
+            status = header;
+        else if (!realtime)
+            status = 0; // System Common messages cancel running status
+    }
+    return data;
+}
+
+/// Encode the messages as 4-byte USB MIDI event packets on cable 0.
+inline std::vector<uint8_t>
+toUSBMIDI(const std::vector<MIDIMessageBytes> &msgs) {
+    std::vector<uint8_t> data;
+    for (auto &msg : msgs) {
+        uint8_t header = msg[0];
+        if (header < 0xF0) { // Channel message: CIN = message type
+            data.push_back(header >> 4);
+            data.push_back(header);
+            data.push_back(msg[1]);
+            data.push_back(msg.size() > 2 ? msg[2] : 0);
+        } else if (header != 0xF0) { // Single-byte real-time message
+            data.insert(data.end(), {0x0F, header, 0, 0});
+        } else { // SysEx: CIN 0x4 (start/continue), 0x5-0x7 (end)
+            size_t i = 0;
+            while (msg.size() - i > 3) {
+                data.insert(data.end(), {0x04, msg[i], msg[i + 1], msg[i + 2]});
+                i += 3;
+            }
+            uint8_t remaining = msg.size() - i;
+            data.push_back(0x04 + remaining);
+            for (uint8_t j = 0; j < 3; ++j)
+                data.push_back(j < remaining ? msg[i + j] : 0);
+        }
+    }
+    return data;
+}
@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+
+#include <MIDI_Inputs/NoteCCRange.hpp>
+
+#include <memory>
+#include <vector>
+
+USING_CS_NAMESPACE;
+
+/// Create the given number of elements with consecutive addresses, and a
+/// matching list of messages of the given type that addresses each of them
+/// once.
+template <class Element>
+static std::vector<ChannelMessageMatcher>
+makeElements(size_t count, std::vector<std::unique_ptr<Element>> &elements,
+             MIDIMessageType type) {
+    std::vector<ChannelMessageMatcher> messages;
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t address = i % 128;
+        Channel channel = Channel::createChannel(1 + (i / 128) % 16);
+        uint8_t CN = i / 128 / 16;
+        elements.emplace_back(new Element({address, channel, Cable(CN)}));
+        messages.push_back({type, channel, address, uint8_t(i % 128), CN});
+    }
+    return messages;
+}
+
+template <class Registry>
+static void updateAll(benchmark::State &state,
+                      const std::vector<ChannelMessageMatcher> &messages) {
+    size_t i = 0;
+    for (auto _ : state) {
+        Registry::updateAllWith(messages[i]);
+        if (++i == messages.size())
+            i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_MIDIInputElementCC_linear(benchmark::State &state) {
+    std::vector<std::unique_ptr<CCValue>> elements;
+    auto messages = makeElements(state.range(0), elements,
+                                 MIDIMessageType::CONTROL_CHANGE);
+    updateAll<MIDIInputElementCC>(state, messages);
+}
+BENCHMARK(BM_MIDIInputElementCC_linear)->Arg(16)->Arg(128)->Arg(1024);
+
+static void BM_MIDIInputElementCC_indexed(benchmark::State &state) {
+    std::unique_ptr<MIDIInputElementCC::DispatchIndex<2048>> index{
+        new MIDIInputElementCC::DispatchIndex<2048>};
+    std::vector<std::unique_ptr<CCValue>> elements;
+    auto messages = makeElements(state.range(0), elements,
+                                 MIDIMessageType::CONTROL_CHANGE);
+    updateAll<MIDIInputElementCC>(state, messages);
+}
+BENCHMARK(BM_MIDIInputElementCC_indexed)->Arg(16)->Arg(128)->Arg(1024);
+
+static void BM_MIDIInputElementNote_linear(benchmark::State &state) {
+    std::vector<std::unique_ptr<NoteValue>> elements;
+    auto messages =
+        makeElements(state.range(0), elements, MIDIMessageType::NOTE_ON);
+    updateAll<MIDIInputElementNote>(state, messages);
+}
+BENCHMARK(BM_MIDIInputElementNote_linear)->Arg(16)->Arg(128)->Arg(1024);
+
+static void BM_MIDIInputElementNote_indexed(benchmark::State &state) {
+    std::unique_ptr<MIDIInputElementNote::DispatchIndex<2048>> index{
+        new MIDIInputElementNote::DispatchIndex<2048>};
+    std::vector<std::unique_ptr<NoteValue>> elements;
+    auto messages =
+        makeElements(state.range(0), elements, MIDIMessageType::NOTE_ON);
+    updateAll<MIDIInputElementNote>(state, messages);
+}
+BENCHMARK(BM_MIDIInputElementNote_indexed)->Arg(16)->Arg(128)->Arg(1024);
@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+
+#include <MIDI_Inputs/MIDITempoTracker.hpp>
+
+#include <random>
+#include <vector>
+
+USING_CS_NAMESPACE;
+
+/// The timestamps of a 128 BPM clock with up to 2 ms of jitter.
+static std::vector<unsigned long> makeClockTimes() {
+    std::vector<unsigned long> times;
+    std::mt19937 rng(1);
+    for (unsigned i = 0; i < 24 * 64; ++i)
+        times.push_back(i * 19531ul + rng() % 2000);
+    return times;
+}
+
+static void BM_MIDITempoTracker_clock(benchmark::State &state) {
+    auto times = makeClockTimes();
+    const RealTimeMessage clock = MIDIMessageType::TIMING_CLOCK;
+    MIDITempoTracker tracker;
+    tracker.update(MIDIMessageType::START, 0);
+    for (auto _ : state) {
+        for (unsigned long time : times)
+            tracker.update(clock, time);
+        benchmark::DoNotOptimize(tracker.getTickInterval());
+    }
+    state.SetItemsProcessed(state.iterations() * times.size());
+}
+BENCHMARK(BM_MIDITempoTracker_clock);
+
+static void BM_MIDITempoTracker_beatPhase(benchmark::State &state) {
+    auto times = makeClockTimes();
+    MIDITempoTracker tracker;
+    tracker.update(MIDIMessageType::START, 0);
+    for (unsigned long time : times)
+        tracker.update(MIDIMessageType::TIMING_CLOCK, time);
+    unsigned long now = times.back();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(tracker.getBeatPhase(now++ % 30000));
+}
+BENCHMARK(BM_MIDITempoTracker_beatPhase);
@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+
+#include <MIDI_Interfaces/MIDI_Pipes.hpp>
+
+USING_CS_NAMESPACE;
+
+/// Sink+source that counts the number of messages it receives.
+struct CountingMIDI_SinkSource : TrueMIDI_SinkSource {
+    void sinkMIDIfromPipe(ChannelMessage) override { ++count; }
+    void sinkMIDIfromPipe(SysExMessage) override { ++count; }
+    void sinkMIDIfromPipe(RealTimeMessage) override { ++count; }
+    unsigned long count = 0;
+};
+
+/// Full mesh of N interfaces: every interface sends to all other interfaces.
+template <uint8_t N>
+struct FullMesh {
+    FullMesh() {
+        for (uint8_t i = 0; i < N; ++i)
+            for (uint8_t j = i + 1; j < N; ++j)
+                interfaces[i] | pipes | interfaces[j];
+    }
+
+    /// Every interface sends a single message.
+    void send(uint8_t note) {
+        for (auto &interface : interfaces) {
+            ChannelMessage msg{0x90, note, 0x7F, 0};
+            if (interface.canWrite(msg.CN))
+                interface.sourceMIDItoPipe(msg);
+        }
+    }
+
+    unsigned long getCount() const {
+        unsigned long count = 0;
+        for (auto &interface : interfaces)
+            count += interface.count;
+        return count;
+    }
+
+    constexpr static uint8_t NumPipes = N * (N - 1) / 2;
+    CountingMIDI_SinkSource interfaces[N];
+    BidirectionalMIDI_PipeFactory<NumPipes> pipes;
+};
+
+template <uint8_t N>
+static void runMesh(benchmark::State &state, FullMesh<N> &mesh) {
+    uint8_t note = 0;
+    unsigned long initialCount = mesh.getCount();
+    for (auto _ : state)
+        mesh.send(note++ & 0x7F);
+    // One item is one message delivered to a sink
+    unsigned long delivered = state.iterations() * N * (N - 1);
+    if (mesh.getCount() - initialCount != delivered)
+        state.SkipWithError("Not every message was delivered");
+    state.SetItemsProcessed(delivered);
+}
+
+template <uint8_t N>
+static void BM_MIDI_Pipes_fullMesh_linked(benchmark::State &state) {
+    FullMesh<N> mesh;
+    runMesh(state, mesh);
+}
+BENCHMARK_TEMPLATE(BM_MIDI_Pipes_fullMesh_linked, 2);
+BENCHMARK_TEMPLATE(BM_MIDI_Pipes_fullMesh_linked, 4);
+BENCHMARK_TEMPLATE(BM_MIDI_Pipes_fullMesh_linked, 8);
+
+template <uint8_t N>
+static void BM_MIDI_Pipes_fullMesh_frozen(benchmark::State &state) {
+    FullMesh<N> mesh;
+    MIDI_RoutingTable<N, 2 * FullMesh<N>::NumPipes> routes;
+    for (auto &interface : mesh.interfaces)
+        if (!routes.freeze(interface))
+            state.SkipWithError("Failed to freeze the routing table");
+    runMesh(state, mesh);
+}
+BENCHMARK_TEMPLATE(BM_MIDI_Pipes_fullMesh_frozen, 2);
+BENCHMARK_TEMPLATE(BM_MIDI_Pipes_fullMesh_frozen, 4);
+BENCHMARK_TEMPLATE(BM_MIDI_Pipes_fullMesh_frozen, 8);
@@ -0,0 +1,34 @@
+#include <benchmark/benchmark.h>
+
+#include <MIDI_Interfaces/USBMIDI_Interface.hpp>
+
+#include <MIDIStreams.hpp>
+
+using ::testing::Invoke;
+using ::testing::NiceMock;
+
+USING_CS_NAMESPACE;
+
+/// Reads all messages of the mix through USBMIDI_Interface::read. The host
+/// has all packets available at once, and has no more packets after that.
+static void BM_USBMIDI_Interface_read(benchmark::State &state) {
+    auto mix = MIDIMix(state.range(0));
+    state.SetLabel(getName(mix));
+    using Packet_t = USBMIDI_Interface::MIDIUSBPacket_t;
+    auto data = toUSBMIDI(makeMIDIMessages(mix));
+    std::vector<Packet_t> packets(data.size() / 4);
+    for (size_t i = 0; i < packets.size(); ++i)
+        std::copy_n(data.data() + 4 * i, 4, packets[i].data);
+    size_t index = 0;
+    NiceMock<USBMIDI_Interface> midi;
+    ON_CALL(midi, readUSBPacket()).WillByDefault(Invoke([&] {
+        return index < packets.size() ? packets[index++] : Packet_t{};
+    }));
+    for (auto _ : state) {
+        index = 0;
+        while (midi.read() != MIDIReadEvent::NO_MESSAGE)
+            benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_USBMIDI_Interface_read)->Apply(allMIDIMixes);
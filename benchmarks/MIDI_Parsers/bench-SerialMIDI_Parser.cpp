@@ -0,0 +1,90 @@
+#include <benchmark/benchmark.h>
+
+#include <MIDI_Interfaces/SerialMIDI_Interface.hpp>
+#include <MIDI_Parsers/SerialMIDI_Parser.hpp>
+
+#include <MIDIStreams.hpp>
+
+#include <vector>
+
+USING_CS_NAMESPACE;
+
+/// A Stream that endlessly repeats the given data.
+class RepeatingStream : public Stream {
+  public:
+    RepeatingStream(const std::vector<uint8_t> &data) : data(data) {}
+
+    size_t write(uint8_t) override { return 1; }
+    int peek() override { return data[index]; }
+    int read() override {
+        int c = data[index];
+        if (++index == data.size())
+            index = 0;
+        return c;
+    }
+    int available() override { return data.size() - index; }
+
+  private:
+    const std::vector<uint8_t> &data;
+    size_t index = 0;
+};
+
+/// Serial MIDI data of the mix given by the first argument of the benchmark.
+static std::vector<uint8_t> makeMIDIStream(benchmark::State &state) {
+    auto mix = MIDIMix(state.range(0));
+    state.SetLabel(getName(mix));
+    return toSerialMIDI(makeMIDIMessages(mix));
+}
+
+static void BM_SerialMIDI_Parser_bytewise(benchmark::State &state) {
+    auto data = makeMIDIStream(state);
+    SerialMIDI_Parser parser;
+    for (auto _ : state)
+        for (uint8_t b : data)
+            benchmark::DoNotOptimize(parser.parse(b));
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_SerialMIDI_Parser_bytewise)->Apply(allMIDIMixes);
+
+static void BM_SerialMIDI_Parser_buffer(benchmark::State &state) {
+    auto data = makeMIDIStream(state);
+    SerialMIDI_Parser parser;
+    for (auto _ : state) {
+        size_t i = 0, consumed;
+        while (i < data.size()) {
+            benchmark::DoNotOptimize(
+                parser.parse(data.data() + i, data.size() - i, consumed));
+            i += consumed;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_SerialMIDI_Parser_buffer)->Apply(allMIDIMixes);
+
+/// The way StreamMIDI_Interface used to read: one Stream call per byte.
+static void BM_Stream_read_bytewise(benchmark::State &state) {
+    auto data = makeMIDIStream(state);
+    RepeatingStream stream = data;
+    SerialMIDI_Parser parser;
+    for (auto _ : state)
+        for (size_t i = 0; i < data.size(); ++i)
+            if (stream.available() > 0)
+                benchmark::DoNotOptimize(parser.parse(stream.read()));
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_Stream_read_bytewise)->Apply(allMIDIMixes);
+
+static void BM_StreamMIDI_Interface_read(benchmark::State &state) {
+    auto data = makeMIDIStream(state);
+    size_t messages = 0;
+    SerialMIDI_Parser parser;
+    for (uint8_t b : data)
+        messages += parser.parse(b) != MIDIReadEvent::NO_MESSAGE;
+    RepeatingStream stream = data;
+    StreamMIDI_Interface midi = stream;
+    for (auto _ : state)
+        for (size_t i = 0; i < messages; ++i)
+            benchmark::DoNotOptimize(midi.read());
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_StreamMIDI_Interface_read)->Apply(allMIDIMixes);
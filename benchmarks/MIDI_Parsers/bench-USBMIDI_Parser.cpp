@@ -0,0 +1,19 @@
+#include <benchmark/benchmark.h>
+
+#include <MIDI_Parsers/USBMIDI_Parser.hpp>
+
+#include <MIDIStreams.hpp>
+
+USING_CS_NAMESPACE;
+
+static void BM_USBMIDI_Parser(benchmark::State &state) {
+    auto mix = MIDIMix(state.range(0));
+    state.SetLabel(getName(mix));
+    auto data = toUSBMIDI(makeMIDIMessages(mix));
+    USBMIDI_Parser parser;
+    for (auto _ : state)
+        for (size_t i = 0; i < data.size(); i += 4)
+            benchmark::DoNotOptimize(parser.parse(data.data() + i));
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_USBMIDI_Parser)->Apply(allMIDIMixes);
@@ -0,0 +1,13 @@
+#include <Arduino.h>
+#include <benchmark/benchmark.h>
+
+int main(int argc, char **argv) {
+    ::benchmark::Initialize(&argc, argv);
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    ::benchmark::AddCustomContext("library_version", LIBRARY_VERSION);
+    ArduinoMock::begin();
+    ::benchmark::RunSpecifiedBenchmarks();
+    ArduinoMock::end();
+    return 0;
+}
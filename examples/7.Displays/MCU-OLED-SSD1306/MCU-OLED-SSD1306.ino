@@ -91,10 +91,13 @@ Adafruit_SSD1306 ssd1306Display = {
 
 // Implement the display interface, specifically, the begin and drawBackground
 // methods.
-class MySSD1306_DisplayInterface : public SSD1306_DisplayInterface {
+// The SPI version of the display interface only transfers the pages of the
+// display that changed.
+class MySSD1306_DisplayInterface : public SSD1306_SPI_DisplayInterface {
  public:
   MySSD1306_DisplayInterface(Adafruit_SSD1306 &display)
-    : SSD1306_DisplayInterface(display) {}
+    : SSD1306_SPI_DisplayInterface(display, SPI, OLED_DC, OLED_CS,
+                                   {SPI_Frequency, MSBFIRST, SPI_MODE0}) {}
 
   void begin() override {
     // Initialize the Adafruit_SSD1306 display
@@ -102,7 +105,7 @@ class MySSD1306_DisplayInterface : public SSD1306_DisplayInterface {
       FATAL_ERROR(F("SSD1306 allocation failed."), 0x1306);
 
     // If you override the begin method, remember to call the super class method
-    SSD1306_DisplayInterface::begin();
+    SSD1306_SPI_DisplayInterface::begin();
   }
 
   void drawBackground() override { disp.drawLine(1, 8, 126, 8, WHITE); }
@@ -0,0 +1,19 @@
+#include "SPI.h"
+#include <ArduinoMock.hpp>
+
+void SPIClass::begin() { ArduinoMock::getSPI().begin(); }
+void SPIClass::end() { ArduinoMock::getSPI().end(); }
+
+void SPIClass::beginTransaction(SPISettings settings) {
+    ArduinoMock::getSPI().beginTransaction(settings);
+}
+void SPIClass::endTransaction() { ArduinoMock::getSPI().endTransaction(); }
+
+uint8_t SPIClass::transfer(uint8_t data) {
+    return ArduinoMock::getSPI().transfer(data);
+}
+void SPIClass::transfer(void *buf, size_t count) {
+    ArduinoMock::getSPI().transfer(buf, count);
+}
+
+SPIClass SPI;
@@ -1 +1,51 @@
-// TODO
\ No newline at end of file
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <gmock-wrapper.h>
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+class SPISettings {
+  public:
+    SPISettings(unsigned long clock, uint8_t bitOrder, uint8_t dataMode)
+        : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+    SPISettings() : SPISettings(4000000, 1 /* MSBFIRST */, SPI_MODE0) {}
+
+    bool operator==(const SPISettings &o) const {
+        return clock == o.clock && bitOrder == o.bitOrder &&
+               dataMode == o.dataMode;
+    }
+
+    unsigned long clock;
+    uint8_t bitOrder;
+    uint8_t dataMode;
+};
+
+class SPIHelper {
+  public:
+    MOCK_METHOD(void, begin, ());
+    MOCK_METHOD(void, end, ());
+    MOCK_METHOD(void, beginTransaction, (SPISettings));
+    MOCK_METHOD(void, endTransaction, ());
+    MOCK_METHOD(uint8_t, transfer, (uint8_t));
+    MOCK_METHOD(void, transfer, (void *, size_t));
+
+    virtual ~SPIHelper() = default;
+};
+
+class SPIClass {
+  public:
+    void begin();
+    void end();
+    void beginTransaction(SPISettings settings);
+    void endTransaction();
+    uint8_t transfer(uint8_t data);
+    void transfer(void *buf, size_t count);
+};
+
+extern SPIClass SPI;
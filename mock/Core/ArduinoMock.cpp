@@ -21,4 +21,8 @@ void ArduinoMock::end() {
 
 SerialHelper &ArduinoMock::getSerial() {
     return getInstance().serial;
-}
\ No newline at end of file
+}
+
+SPIHelper &ArduinoMock::getSPI() {
+    return getInstance().spi;
+}
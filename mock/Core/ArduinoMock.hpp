@@ -1,6 +1,7 @@
 #pragma once
 
 #include "HardwareSerial.h"
+#include <SPI.h>
 
 class ArduinoMock {
   protected:
@@ -8,6 +9,7 @@ class ArduinoMock {
 
   private:
     SerialHelper serial;
+    SPIHelper spi;
     static testing::StrictMock<ArduinoMock> *instance;
 
   public:
@@ -15,6 +17,7 @@ class ArduinoMock {
     static void begin();
     static void end();
     static SerialHelper &getSerial();
+    static SPIHelper &getSPI();
 
     MOCK_METHOD(void, pinMode, (uint8_t, uint8_t));
     MOCK_METHOD(void, digitalWrite, (uint8_t, uint8_t));
@@ -0,0 +1,123 @@
+#include "Adafruit_GFX.h"
+
+#include <utility>
+
+// Simplified versions of the generic Adafruit_GFX drawing functions.
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h)
+    : WIDTH(w), HEIGHT(h), _width(w), _height(h), cursor_x(0), cursor_y(0),
+      textcolor(0xFFFF), textbgcolor(0xFFFF), textsize(1), rotation(0),
+      wrap(true), _cp437(false), gfxFont(NULL) {}
+
+void Adafruit_GFX::startWrite() {}
+void Adafruit_GFX::endWrite() {}
+
+void Adafruit_GFX::writePixel(int16_t x, int16_t y, uint16_t color) {
+    drawPixel(x, y, color);
+}
+void Adafruit_GFX::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                                 uint16_t color) {
+    fillRect(x, y, w, h, color);
+}
+void Adafruit_GFX::writeFastVLine(int16_t x, int16_t y, int16_t h,
+                                  uint16_t color) {
+    drawFastVLine(x, y, h, color);
+}
+void Adafruit_GFX::writeFastHLine(int16_t x, int16_t y, int16_t w,
+                                  uint16_t color) {
+    drawFastHLine(x, y, w, color);
+}
+void Adafruit_GFX::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                             uint16_t color) {
+    drawLine(x0, y0, x1, y1, color);
+}
+
+void Adafruit_GFX::setRotation(uint8_t r) {
+    rotation = r & 3;
+    _width = rotation & 1 ? HEIGHT : WIDTH;
+    _height = rotation & 1 ? WIDTH : HEIGHT;
+}
+void Adafruit_GFX::invertDisplay(boolean) {}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                 uint16_t color) {
+    for (int16_t i = 0; i < h; ++i)
+        drawPixel(x, y + i, color);
+}
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                 uint16_t color) {
+    for (int16_t i = 0; i < w; ++i)
+        drawPixel(x + i, y, color);
+}
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color) {
+    for (int16_t i = 0; i < w; ++i)
+        drawFastVLine(x + i, y, h, color);
+}
+void Adafruit_GFX::fillScreen(uint16_t color) {
+    fillRect(0, 0, _width, _height, color);
+}
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                            uint16_t color) {
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep) {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if (x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    int16_t dx = x1 - x0, dy = abs(y1 - y0);
+    int16_t err = dx / 2, ystep = y0 < y1 ? 1 : -1;
+    for (; x0 <= x1; ++x0) {
+        steep ? drawPixel(y0, x0, color) : drawPixel(x0, y0, color);
+        if ((err -= dy) < 0) {
+            y0 += ystep;
+            err += dx;
+        }
+    }
+}
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::drawXBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+                               int16_t w, int16_t h, uint16_t color) {
+    int16_t byteWidth = (w + 7) / 8;
+    for (int16_t j = 0; j < h; ++j)
+        for (int16_t i = 0; i < w; ++i)
+            if (bitmap[j * byteWidth + i / 8] & (1 << (i % 8)))
+                drawPixel(x + i, y + j, color);
+}
+
+void Adafruit_GFX::setCursor(int16_t x, int16_t y) {
+    cursor_x = x;
+    cursor_y = y;
+}
+void Adafruit_GFX::setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+void Adafruit_GFX::setTextColor(uint16_t c, uint16_t bg) {
+    textcolor = c;
+    textbgcolor = bg;
+}
+void Adafruit_GFX::setTextSize(uint8_t s) { textsize = s > 0 ? s : 1; }
+
+size_t Adafruit_GFX::write(uint8_t c) {
+    if (c == '\n') {
+        cursor_x = 0;
+        cursor_y += textsize * 8;
+    } else if (c != '\r') {
+        cursor_x += textsize * 6;
+    }
+    return 1;
+}
+
+int16_t Adafruit_GFX::width() const { return _width; }
+int16_t Adafruit_GFX::height() const { return _height; }
+uint8_t Adafruit_GFX::getRotation() const { return rotation; }
+int16_t Adafruit_GFX::getCursorX() const { return cursor_x; }
+int16_t Adafruit_GFX::getCursorY() const { return cursor_y; }
@@ -0,0 +1,65 @@
+#include "Adafruit_SSD1306.h"
+
+#include <algorithm>
+#include <utility>
+
+// Frame buffer only: commands are recorded, nothing is sent to a display.
+
+Adafruit_SSD1306::Adafruit_SSD1306(int8_t SID, int8_t SCLK, int8_t DC,
+                                   int8_t RST, int8_t CS)
+    : Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT), buffer(),
+      sid(SID), sclk(SCLK), dc(DC), rst(RST), cs(CS), hwSPI(false) {}
+Adafruit_SSD1306::Adafruit_SSD1306(int8_t DC, int8_t RST, int8_t CS)
+    : Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT), buffer(), sid(-1),
+      sclk(-1), dc(DC), rst(RST), cs(CS), hwSPI(true) {}
+Adafruit_SSD1306::Adafruit_SSD1306(int8_t RST)
+    : Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT), buffer(), sid(-1),
+      sclk(-1), dc(-1), rst(RST), cs(-1), hwSPI(false) {}
+
+void Adafruit_SSD1306::begin(uint8_t switchvcc, uint8_t i2caddr, bool) {
+    _vccstate = switchvcc;
+    _i2caddr = i2caddr;
+}
+void Adafruit_SSD1306::ssd1306_command(uint8_t c) { commands.push_back(c); }
+
+void Adafruit_SSD1306::clearDisplay() {
+    std::fill(std::begin(buffer), std::end(buffer), 0);
+}
+void Adafruit_SSD1306::display() { ++displays; }
+uint8_t *Adafruit_SSD1306::getBuffer() { return buffer; }
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || x >= width() || y < 0 || y >= height())
+        return;
+    switch (getRotation()) {
+        case 1:
+            std::swap(x, y);
+            x = WIDTH - x - 1;
+            break;
+        case 2:
+            x = WIDTH - x - 1;
+            y = HEIGHT - y - 1;
+            break;
+        case 3:
+            std::swap(x, y);
+            y = HEIGHT - y - 1;
+            break;
+        default: break;
+    }
+    uint8_t &byte = buffer[x + (y / 8) * WIDTH];
+    uint8_t mask = 1 << (y & 7);
+    switch (color) {
+        case WHITE: byte |= mask; break;
+        case BLACK: byte &= ~mask; break;
+        case INVERSE: byte ^= mask; break;
+        default: break;
+    }
+}
+void Adafruit_SSD1306::drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                     uint16_t color) {
+    Adafruit_GFX::drawFastVLine(x, y, h, color);
+}
+void Adafruit_SSD1306::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                     uint16_t color) {
+    Adafruit_GFX::drawFastHLine(x, y, w, color);
+}
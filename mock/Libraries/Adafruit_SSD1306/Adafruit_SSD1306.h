@@ -44,6 +44,8 @@ typedef uint32_t PortMask;
 // #include <SPI.h>
 #include <Adafruit_GFX.h>
 
+#include <vector>
+
 #define BLACK 0
 #define WHITE 1
 #define INVERSE 2
@@ -154,6 +156,7 @@ class Adafruit_SSD1306 : public Adafruit_GFX {
     void clearDisplay(void);
     // void invertDisplay(uint8_t i);
     void display();
+    uint8_t *getBuffer(void);
 
     // void startscrollright(uint8_t start, uint8_t stop);
     // void startscrollleft(uint8_t start, uint8_t stop);
@@ -171,7 +174,14 @@ class Adafruit_SSD1306 : public Adafruit_GFX {
     void drawFastHLine(int16_t x, int16_t y, int16_t w,
                        uint16_t color) override;
 
+    /// Mock only: all bytes passed to ssd1306_command.
+    std::vector<uint8_t> commands;
+    /// Mock only: the number of calls to display.
+    unsigned displays = 0;
+
   private:
+    uint8_t buffer[SSD1306_LCDWIDTH * ((SSD1306_LCDHEIGHT + 7) / 8)];
+
     int8_t _i2caddr, _vccstate, sid, sclk, dc, rst, cs;
     void fastSPIwrite(uint8_t c);
 
@@ -0,0 +1,119 @@
+/* ✔ */
+
+#pragma once
+
+#include <AH/Settings/Warnings.hpp>
+
+AH_DIAGNOSTIC_WERROR() // Enable errors on warnings
+
+#include <AH/Settings/NamespaceSettings.hpp>
+#include <atomic>
+#include <stddef.h>
+
+BEGIN_AH_NAMESPACE
+
+/// @addtogroup AH_Containers
+/// @{
+
+/**
+ * @brief   Bounded, lock-free queue for passing data from one thread (the
+ *          producer) to another (the consumer).
+ *
+ * Only one thread may call the producer functions (@ref push,
+ * @ref spaceLeft), and only one thread may call the consumer functions
+ * (@ref pop, @ref size). Neither of them ever blocks or waits for the other
+ * thread, which makes it suitable for passing data from interrupt handlers or
+ * callbacks of e.g. the Bluetooth stack to the main loop.
+ *
+ * @note    Requires `<atomic>`, which is not available on AVR.
+ *
+ * @tparam  T
+ *          The type of the elements.
+ * @tparam  N
+ *          The maximum number of elements in the queue, must be a power of
+ *          two.
+ */
+template <class T, size_t N>
+class SPSCQueue {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "N should be a power of two");
+
+  public:
+    /// @name   Producer
+    /// @{
+
+    /// Get the number of elements that can be pushed. The actual number may
+    /// be higher if the consumer pops elements concurrently.
+    size_t spaceLeft() const {
+        size_t w = writeIndex.load(std::memory_order_relaxed);
+        size_t r = readIndex.load(std::memory_order_acquire);
+        return N - (w - r);
+    }
+
+    /// Add an element to the queue. Returns false if the queue is full.
+    bool push(const T &element) { return push(&element, 1); }
+
+    /**
+     * @brief   Add multiple elements to the queue.
+     *
+     * Either all elements are added, or none of them are, if there's not
+     * enough space.
+     *
+     * @retval  true
+     *          All elements were added.
+     * @retval  false
+     *          Not enough space left, nothing was added.
+     */
+    bool push(const T *elements, size_t count) {
+        size_t w = writeIndex.load(std::memory_order_relaxed);
+        size_t r = readIndex.load(std::memory_order_acquire);
+        if (count > N - (w - r))
+            return false;
+        for (size_t i = 0; i < count; ++i)
+            buffer[(w + i) & (N - 1)] = elements[i];
+        writeIndex.store(w + count, std::memory_order_release);
+        return true;
+    }
+
+    /// @}
+
+    /// @name   Consumer
+    /// @{
+
+    /// Get the number of elements in the queue. The actual number may be
+    /// higher if the producer pushes elements concurrently.
+    size_t size() const {
+        size_t r = readIndex.load(std::memory_order_relaxed);
+        size_t w = writeIndex.load(std::memory_order_acquire);
+        return w - r;
+    }
+
+    /// Remove the oldest element from the queue. Returns false if the queue
+    /// is empty.
+    bool pop(T &element) {
+        size_t r = readIndex.load(std::memory_order_relaxed);
+        size_t w = writeIndex.load(std::memory_order_acquire);
+        if (r == w)
+            return false;
+        element = buffer[r & (N - 1)];
+        readIndex.store(r + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @}
+
+    /// Get the maximum number of elements in the queue.
+    constexpr static size_t capacity() { return N; }
+
+  private:
+    T buffer[N];
+    // Free-running indices: they are only reduced modulo N when accessing the
+    // buffer, so a full queue can be distinguished from an empty one.
+    std::atomic<size_t> writeIndex{0};
+    std::atomic<size_t> readIndex{0};
+};
+
+/// @}
+
+END_AH_NAMESPACE
+
+AH_DIAGNOSTIC_POP()
@@ -95,6 +95,14 @@ class UpdatableCRTP : public DoublyLinkable<Derived> {
         applyToAll(LockGuard(mutex), method, std::forward<Args>(args)...);
     }
 
+    /// Call the given function with each enabled instance as its argument.
+    template <class Function>
+    static void forEach(Function &&function) {
+        LockGuard lock(mutex);
+        for (auto &el : updatables)
+            function(el);
+    }
+
     /// @}
 
   public:
@@ -1,4 +1,5 @@
 #include "Button.hpp"
+#include <AH/Timing/LatencyProbe.hpp>
 
 AH_DIAGNOSTIC_WERROR() // Enable errors on warnings
 
@@ -26,6 +27,8 @@ Button::State Button::update() {
     } else {
         debouncedState = static_cast<State>((prevState << 1) | prevState);
     }
+    if (debouncedState == Falling || debouncedState == Rising)
+        AH_PROFILE_INPUT();
     if (input != prevInput) { // Button is pressed, released or bounces
         prevBounceTime = now;
         prevInput = input;
@@ -6,12 +6,25 @@
 AH_DIAGNOSTIC_WERROR() // Enable errors on warnings
 
 #include <AH/Hardware/Hardware-Types.hpp>
+#include <AH/Settings/SettingsWrapper.hpp>
 
 BEGIN_AH_NAMESPACE
 
 /**
  * @brief   A class that reads the states of a button matrix.
  *
+ * Every button is debounced individually: when a button changes state, the
+ * change is reported immediately, and further changes of that button are
+ * ignored for approximately @ref BUTTON_DEBOUNCE_TIME milliseconds (between 1
+ * and 1.5 times the debounce time). Other buttons are not affected, so fast
+ * successive presses of different buttons are never lost.
+ *
+ * The debounce state is kept in 2-bit counters per button, stored as two bit
+ * planes, so all counters can be decremented eight at a time.
+ *
+ * If the column pins belong to an ExtendedIOElement, its inputs are read only
+ * once per row, instead of once per button.
+ *
  * @tparam  nb_rows
  *          The number of rows in the button matrix.
  * @tparam  nb_cols
@@ -74,13 +87,31 @@ class ButtonMatrix {
      */
     virtual void onButtonChanged(uint8_t row, uint8_t col, bool state) = 0;
 
-    static inline uint8_t positionToBits(uint8_t col, uint8_t row);
-    static inline uint8_t bitsToIndex(uint8_t bits);
-    static inline uint8_t bitsToBitmask(uint8_t bits);
+    static inline uint16_t positionToBits(uint8_t col, uint8_t row);
+    static inline uint16_t bitsToIndex(uint16_t bits);
+    static inline uint8_t bitsToBitmask(uint16_t bits);
     void setPrevState(uint8_t col, uint8_t row, bool state);
 
-    unsigned long prevRefresh = 0;
-    uint8_t prevStates[(nb_cols * nb_rows + 7) / 8];
+    /// Check whether the given button is still being debounced.
+    bool isDebouncing(uint16_t bits) const;
+    /// Start debouncing the given button (set its counter to 3).
+    void startDebouncing(uint16_t bits);
+    /// Decrement the debounce counters of all buttons that are non-zero.
+    void decrementDebounceCounters();
+    /// Refresh the buffered inputs of all ExtendedIOElement%s that the column
+    /// pins belong to.
+    void updateBufferedColumnInputs();
+
+    /// The time between two decrements of the debounce counters.
+    constexpr static unsigned long debounceTick =
+        BUTTON_DEBOUNCE_TIME >= 2 ? BUTTON_DEBOUNCE_TIME / 2 : 1;
+    constexpr static uint16_t nb_bytes = (nb_cols * nb_rows + 7) / 8;
+
+    unsigned long prevTick = 0;
+    uint8_t prevStates[nb_bytes];
+    /// Low and high bits of the debounce counters of all buttons.
+    uint8_t debounceLo[nb_bytes] = {};
+    uint8_t debounceHi[nb_bytes] = {};
 
     const PinList<nb_rows> rowPins;
     const PinList<nb_cols> colPins;
@@ -1,4 +1,5 @@
 #include "ButtonMatrix.hpp"
+#include <AH/Hardware/ExtendedInputOutput/ExtendedIOElement.hpp>
 #include <AH/Hardware/ExtendedInputOutput/ExtendedInputOutput.hpp>
 #include <string.h>
 
@@ -16,27 +17,54 @@ ButtonMatrix<nb_rows, nb_cols>::ButtonMatrix(const PinList<nb_rows> &rowPins,
 template <uint8_t nb_rows, uint8_t nb_cols>
 void ButtonMatrix<nb_rows, nb_cols>::update() {
     unsigned long now = millis();
-    // only update 25 ms after previous change (crude software debounce).
-    // Edit this in Settings/Settings.hpp
-    if (now - prevRefresh < BUTTON_DEBOUNCE_TIME)
-        return;
+    // Decrement the debounce counters once per tick. After three ticks, all
+    // counters are zero, so there's no need to catch up any further.
+    uint8_t ticks = 0;
+    while (now - prevTick >= debounceTick && ticks < 3) {
+        prevTick += debounceTick;
+        ++ticks;
+    }
+    if (now - prevTick >= debounceTick)
+        prevTick = now;
+    while (ticks-- > 0)
+        decrementDebounceCounters();
 
     for (size_t row = 0; row < nb_rows; row++) { // scan through all rows
         pinMode(rowPins[row], OUTPUT);           // make the current row Lo-Z 0V
+        updateBufferedColumnInputs();
         for (size_t col = 0; col < nb_cols; col++) { // scan through all columns
-            bool state = digitalRead(colPins[col]);  // read the state
-            if (state != getPrevState(col, row)) {
-                // if the state changed since last time
-                // execute the handler
-                onButtonChanged(row, col, state);
-                setPrevState(col, row, state); // remember the state
-                prevRefresh = now;
-            }
+            bool state = digitalReadBuffered(colPins[col]); // read the state
+            if (state == getPrevState(col, row))
+                continue;
+            // Ignore changes of buttons that changed state less than the
+            // debounce time ago (bounces). Edit this in Settings/Settings.hpp
+            uint16_t bits = positionToBits(col, row);
+            if (isDebouncing(bits))
+                continue;
+            // if the state changed since last time, execute the handler
+            onButtonChanged(row, col, state);
+            setPrevState(col, row, state); // remember the state
+            startDebouncing(bits);
         }
         pinMode(rowPins[row], INPUT); // make the current row Hi-Z again
     }
 }
 
+template <uint8_t nb_rows, uint8_t nb_cols>
+void ButtonMatrix<nb_rows, nb_cols>::updateBufferedColumnInputs() {
+    // Read all inputs of an ExtIO element at once, instead of one transaction
+    // per button. Consecutive column pins usually belong to the same element.
+    ExtendedIOElement *prevElement = nullptr;
+    for (const pin_t &colPin : colPins) {
+        if (colPin == NO_PIN || colPin < NUM_DIGITAL_PINS + NUM_ANALOG_INPUTS)
+            continue;
+        ExtendedIOElement &element = getIOElementOfPin(colPin);
+        if (&element != prevElement)
+            element.updateBufferedInputs();
+        prevElement = &element;
+    }
+}
+
 template <uint8_t nb_rows, uint8_t nb_cols>
 void ButtonMatrix<nb_rows, nb_cols>::begin() {
     // make all columns input pins and enable
@@ -49,36 +77,61 @@ void ButtonMatrix<nb_rows, nb_cols>::begin() {
 }
 
 template <uint8_t nb_rows, uint8_t nb_cols>
-inline uint8_t ButtonMatrix<nb_rows, nb_cols>::positionToBits(uint8_t col,
-                                                              uint8_t row) {
+inline uint16_t ButtonMatrix<nb_rows, nb_cols>::positionToBits(uint8_t col,
+                                                               uint8_t row) {
     // map from a 2D array of bits to a flat array of bits
-    return col * nb_rows + row;
+    return uint16_t(col) * nb_rows + row;
 }
 
 template <uint8_t nb_rows, uint8_t nb_cols>
-inline uint8_t ButtonMatrix<nb_rows, nb_cols>::bitsToIndex(uint8_t bits) {
+inline uint16_t ButtonMatrix<nb_rows, nb_cols>::bitsToIndex(uint16_t bits) {
     return bits >> 3; // bits / 8
 }
 
 template <uint8_t nb_rows, uint8_t nb_cols>
-inline uint8_t ButtonMatrix<nb_rows, nb_cols>::bitsToBitmask(uint8_t bits) {
+inline uint8_t ButtonMatrix<nb_rows, nb_cols>::bitsToBitmask(uint16_t bits) {
     return 1 << (bits & 7); // bits % 8
 }
 
 template <uint8_t nb_rows, uint8_t nb_cols>
 bool ButtonMatrix<nb_rows, nb_cols>::getPrevState(uint8_t col, uint8_t row) {
-    uint8_t bits = positionToBits(col, row);
+    uint16_t bits = positionToBits(col, row);
     return !!(prevStates[bitsToIndex(bits)] & bitsToBitmask(bits));
 }
 
 template <uint8_t nb_rows, uint8_t nb_cols>
 void ButtonMatrix<nb_rows, nb_cols>::setPrevState(uint8_t col, uint8_t row,
                                                   bool state) {
-    uint8_t bits = positionToBits(col, row);
+    uint16_t bits = positionToBits(col, row);
     if (state)
         prevStates[bitsToIndex(bits)] |= bitsToBitmask(bits);
     else
         prevStates[bitsToIndex(bits)] &= ~bitsToBitmask(bits);
 }
 
-END_AH_NAMESPACE
\ No newline at end of file
+template <uint8_t nb_rows, uint8_t nb_cols>
+bool ButtonMatrix<nb_rows, nb_cols>::isDebouncing(uint16_t bits) const {
+    uint8_t mask = bitsToBitmask(bits);
+    uint16_t index = bitsToIndex(bits);
+    return (debounceLo[index] | debounceHi[index]) & mask;
+}
+
+template <uint8_t nb_rows, uint8_t nb_cols>
+void ButtonMatrix<nb_rows, nb_cols>::startDebouncing(uint16_t bits) {
+    debounceLo[bitsToIndex(bits)] |= bitsToBitmask(bits);
+    debounceHi[bitsToIndex(bits)] |= bitsToBitmask(bits);
+}
+
+template <uint8_t nb_rows, uint8_t nb_cols>
+void ButtonMatrix<nb_rows, nb_cols>::decrementDebounceCounters() {
+    // Subtract one from eight 2-bit counters at once (vertical counters),
+    // counters that are already zero stay zero:
+    //   11 → 10 → 01 → 00 → 00
+    for (uint16_t i = 0; i < nb_bytes; ++i) {
+        uint8_t nonzero = debounceLo[i] | debounceHi[i];
+        debounceHi[i] &= debounceLo[i];
+        debounceLo[i] ^= nonzero;
+    }
+}
+
+END_AH_NAMESPACE
@@ -1,3 +1,7 @@
-#ifdef TEST_COMPILE_ALL_HEADERS_SEPARATELY
 #include "AnalogMultiplex.hpp"
-#endif
\ No newline at end of file
+
+BEGIN_AH_NAMESPACE
+
+const void *detail::AnalogMultiplexAddressLines::owner = nullptr;
+
+END_AH_NAMESPACE
@@ -12,6 +12,14 @@ AH_DIAGNOSTIC_WERROR() // Enable errors on warnings
 
 BEGIN_AH_NAMESPACE
 
+namespace detail {
+/// Keeps track of which multiplexer last wrote to its address lines, because
+/// multiplexers of any size can share the same address lines.
+struct AnalogMultiplexAddressLines {
+    static const void *owner;
+};
+} // namespace detail
+
 /**
  * @brief   A class for reading multiplexed analog inputs.
  *          Supports 74HC4067, 74HC4051, etc.
@@ -19,12 +27,43 @@ BEGIN_AH_NAMESPACE
  * You can use many multiplexers on the same address lines if each of the 
  * multiplexers has a different enable line.
  * 
+ * ### Buffered scanning
+ * 
+ * By default, every call to @ref analogRead selects the address of the pin,
+ * and then reads it. If @p Buffered is true, the multiplexer is scanned in 
+ * the background instead: @ref updateBufferedInputs reads a number of channels
+ * (all of them by default, see @ref setChannelsPerUpdate) into a buffer, and
+ * @ref analogRead and @ref analogReadBuffered simply return the last sample
+ * of the given pin, without doing any IO. This means that e.g. FilteredAnalog
+ * reads from the buffer as well.
+ * 
+ * The channels are scanned in Gray code order, so only a single address line
+ * has to be changed between two channels. The address of the next channel is
+ * selected at the end of each update, so the multiplexer output settles during
+ * the rest of the loop, and the reading that is normally discarded to give the
+ * output time to settle can be skipped for the first channel of the next
+ * update (if there is no enable pin). Within an update, every other channel
+ * is read right after its address was selected, so its first reading is still
+ * discarded. Reading a single channel per update (see
+ * @ref setChannelsPerUpdate) therefore needs only a single conversion.
+ * 
+ * All channels are read once by @ref begin, so the buffer contains valid
+ * samples before any FilteredAnalog is initialized.
+ * 
+ * @note    The buffer is updated by
+ *          @ref ExtendedIOElement::updateAllBufferedInputs, which is called
+ *          by `Control_Surface.loop()`. If you don't use Control Surface, you
+ *          have to call it yourself.
+ * @note    Digital reads are never buffered.
+ * 
  * @tparam  N 
  *          The number of address lines.
+ * @tparam  Buffered
+ *          Scan all channels into a buffer in @ref updateBufferedInputs.
  * 
  * @ingroup AH_ExtIO
  */
-template <uint8_t N>
+template <uint8_t N, bool Buffered = false>
 class AnalogMultiplex : public StaticSizeExtendedIOElement<1 << N> {
   public:
     /**
@@ -46,6 +85,12 @@ class AnalogMultiplex : public StaticSizeExtendedIOElement<1 << N> {
         : analogPin(analogPin), addressPins(addressPins), enablePin(enablePin) {
     }
 
+    /// Destructor.
+    ~AnalogMultiplex() {
+        if (detail::AnalogMultiplexAddressLines::owner == this)
+            detail::AnalogMultiplexAddressLines::owner = nullptr;
+    }
+
     /**
      * @brief   Set the pin mode of the analog input pin.  
      *          This allows you to enable the internal pull-up resistor, for
@@ -97,6 +142,9 @@ class AnalogMultiplex : public StaticSizeExtendedIOElement<1 << N> {
     /**
      * @brief   Read the analog value of the given input.
      * 
+     * If @p Buffered is true, this returns the last sample of the given input
+     * in the buffer.
+     * 
      * @param   pin
      *          The multiplexer's pin number to read from.
      */
@@ -123,6 +171,8 @@ class AnalogMultiplex : public StaticSizeExtendedIOElement<1 << N> {
     /**
      * @brief   Initialize the multiplexer: set the pin mode of the address pins
      *          and the enable pin to output mode.
+     * 
+     * If @p Buffered is true, all channels are read into the buffer.
      */
     void begin() override;
 
@@ -133,16 +183,41 @@ class AnalogMultiplex : public StaticSizeExtendedIOElement<1 << N> {
     void updateBufferedOutputs() override {} // LCOV_EXCL_LINE
 
     /**
-     * @brief   No periodic updating of the state is necessary, all actions are 
-     *          carried out when the user calls analogRead or digitalRead.
+     * @brief   If @p Buffered is true, read the next channels into the buffer.
+     *          Otherwise, no periodic updating of the state is necessary, all
+     *          actions are carried out when the user calls analogRead or
+     *          digitalRead.
      */
-    void updateBufferedInputs() override {} // LCOV_EXCL_LINE
+    void updateBufferedInputs() override;
+
+    /**
+     * @brief   Set the number of channels that are read into the buffer by
+     *          each call to @ref updateBufferedInputs.
+     * 
+     * Reading fewer channels per update spreads the scan over multiple loops,
+     * which decreases the worst-case loop time. The default is to read all
+     * channels. The number of channels is clamped to [1, 2<sup>N</sup>].
+     */
+    void setChannelsPerUpdate(uint16_t channels) {
+        static_assert(Buffered, "Only buffered multiplexers are scanned");
+        channelsPerUpdate = channels < 1        ? 1
+                            : channels > 1 << N ? 1 << N
+                                                : channels;
+    }
 
   private:
     const pin_t analogPin;
     const Array<pin_t, N> addressPins;
     const pin_t enablePin;
 
+    /// The last sample of each channel, if buffered.
+    analog_t samples[Buffered ? 1 << N : 1] = {};
+    /// The position in the Gray code sequence of the channel to read next.
+    uint8_t scanIndex = 0;
+    /// The address that was last written to the address lines.
+    uint8_t currentAddress = 0;
+    uint16_t channelsPerUpdate = 1 << N;
+
     /**
      * @brief   Write the pin number/address to the address pins of the 
      *          multiplexer.
@@ -152,6 +227,27 @@ class AnalogMultiplex : public StaticSizeExtendedIOElement<1 << N> {
      */
     void setMuxAddress(uint8_t address);
 
+    /**
+     * @brief   Write the pin number/address to the address pins of the 
+     *          multiplexer, only changing the address lines that differ from
+     *          the current address.
+     * 
+     * @param   address
+     *          The address to select.
+     * @return  True if the address was already selected before, so the
+     *          output of the multiplexer has settled.
+     */
+    bool selectMuxAddress(uint8_t address);
+
+    /**
+     * @brief   Read the given number of channels into the buffer, continuing
+     *          the scan where the previous call left off.
+     */
+    void scanChannels(uint16_t count);
+
+    /// Get the address of the n-th channel in the scan order.
+    static uint8_t grayCode(uint8_t n) { return n ^ (n >> 1); }
+
     /**
      * @brief   Select the correct address and enable the multiplexer.
      * 
@@ -186,33 +282,51 @@ using CD74HC4067 = AnalogMultiplex<4>;
  */
 using CD74HC4051 = AnalogMultiplex<3>;
 
+/**
+ * @brief   An alias for AnalogMultiplex<4, true> to use with CD74HC4067 analog
+ *          multiplexers that are scanned into a buffer.
+ * 
+ * @ingroup AH_ExtIO
+ */
+using BufferedCD74HC4067 = AnalogMultiplex<4, true>;
+
+/**
+ * @brief   An alias for AnalogMultiplex<3, true> to use with CD74HC4051 analog
+ *          multiplexers that are scanned into a buffer.
+ * 
+ * @ingroup AH_ExtIO
+ */
+using BufferedCD74HC4051 = AnalogMultiplex<3, true>;
+
 // -------------------------------------------------------------------------- //
 
-template <uint8_t N>
-void AnalogMultiplex<N>::pinMode(pin_t, PinMode_t mode) {
+template <uint8_t N, bool Buffered>
+void AnalogMultiplex<N, Buffered>::pinMode(pin_t, PinMode_t mode) {
     ExtIO::pinMode(analogPin, mode);
 }
 
-template <uint8_t N>
-void AnalogMultiplex<N>::pinModeBuffered(pin_t, PinMode_t mode) {
-    AnalogMultiplex<N>::pinMode(analogPin, mode);
+template <uint8_t N, bool Buffered>
+void AnalogMultiplex<N, Buffered>::pinModeBuffered(pin_t, PinMode_t mode) {
+    AnalogMultiplex<N, Buffered>::pinMode(analogPin, mode);
 }
 
-template <uint8_t N>
-int AnalogMultiplex<N>::digitalRead(pin_t pin) {
+template <uint8_t N, bool Buffered>
+int AnalogMultiplex<N, Buffered>::digitalRead(pin_t pin) {
     prepareReading(pin);
     int result = ExtIO::digitalRead(analogPin);
     afterReading();
     return result;
 }
 
-template <uint8_t N>
-int AnalogMultiplex<N>::digitalReadBuffered(pin_t pin) {
-    return AnalogMultiplex<N>::digitalRead(pin);
+template <uint8_t N, bool Buffered>
+int AnalogMultiplex<N, Buffered>::digitalReadBuffered(pin_t pin) {
+    return AnalogMultiplex<N, Buffered>::digitalRead(pin);
 }
 
-template <uint8_t N>
-analog_t AnalogMultiplex<N>::analogRead(pin_t pin) {
+template <uint8_t N, bool Buffered>
+analog_t AnalogMultiplex<N, Buffered>::analogRead(pin_t pin) {
+    if (Buffered)
+        return samples[pin];
     prepareReading(pin);
     ExtIO::analogRead(analogPin); // Discard first reading
     analog_t result = ExtIO::analogRead(analogPin);
@@ -220,42 +334,103 @@ analog_t AnalogMultiplex<N>::analogRead(pin_t pin) {
     return result;
 }
 
-template <uint8_t N>
-analog_t AnalogMultiplex<N>::analogReadBuffered(pin_t pin) {
-    return AnalogMultiplex<N>::analogRead(pin);
+template <uint8_t N, bool Buffered>
+analog_t AnalogMultiplex<N, Buffered>::analogReadBuffered(pin_t pin) {
+    return AnalogMultiplex<N, Buffered>::analogRead(pin);
 }
 
-template <uint8_t N>
-void AnalogMultiplex<N>::begin() {
+template <uint8_t N, bool Buffered>
+void AnalogMultiplex<N, Buffered>::begin() {
     for (const pin_t &addressPin : addressPins)
         ExtIO::pinMode(addressPin, OUTPUT);
     if (enablePin != NO_PIN) {
         ExtIO::pinMode(enablePin, OUTPUT);
         ExtIO::digitalWrite(enablePin, MUX_DISABLED);
     }
+    // Fill the buffer, so the first buffered readings are valid.
+    if (Buffered)
+        scanChannels(1 << N);
 }
 
-template <uint8_t N>
-void AnalogMultiplex<N>::setMuxAddress(uint8_t address) {
+template <uint8_t N, bool Buffered>
+void AnalogMultiplex<N, Buffered>::updateBufferedInputs() {
+    if (Buffered)
+        scanChannels(channelsPerUpdate);
+}
+
+template <uint8_t N, bool Buffered>
+void AnalogMultiplex<N, Buffered>::scanChannels(uint16_t count) {
+    constexpr uint8_t mask = (1 << N) - 1;
+    uint8_t address = grayCode(scanIndex);
+    // The first reading can only be used without discarding one if the
+    // address was selected at the end of the previous update, and the
+    // multiplexer was enabled all along.
+    bool settled = selectMuxAddress(address) && enablePin == NO_PIN;
+    if (enablePin != NO_PIN)
+        ExtIO::digitalWrite(enablePin, MUX_ENABLED);
+    for (uint16_t i = 0; i < count; ++i) {
+        if (!settled)
+            ExtIO::analogRead(analogPin); // Discard first reading
+        samples[address] = ExtIO::analogRead(analogPin);
+        scanIndex = (scanIndex + 1) & mask;
+        address = grayCode(scanIndex);
+        // The output of the multiplexer has to settle after every address
+        // change. For the next channel of this update, there's nothing to
+        // overlap that time with, so its first reading is discarded. The
+        // address selected after the last channel settles during the rest
+        // of the loop.
+        settled = selectMuxAddress(address);
+    }
+    afterReading();
+}
+
+template <uint8_t N, bool Buffered>
+void AnalogMultiplex<N, Buffered>::setMuxAddress(uint8_t address) {
     uint8_t mask = 1;
     for (const pin_t &addressPin : addressPins) {
         ExtIO::digitalWrite(addressPin, (address & mask) != 0 ? HIGH : LOW);
         mask <<= 1;
     }
+    currentAddress = address;
+    detail::AnalogMultiplexAddressLines::owner = this;
+#if !defined(__AVR__) && defined(ARDUINO)
+    delayMicroseconds(5);
+#endif
+}
+
+template <uint8_t N, bool Buffered>
+bool AnalogMultiplex<N, Buffered>::selectMuxAddress(uint8_t address) {
+    // If another multiplexer changed the address lines, the current address
+    // is unknown, so all lines have to be written.
+    if (detail::AnalogMultiplexAddressLines::owner != this) {
+        setMuxAddress(address);
+        return false;
+    }
+    uint8_t changed = address ^ currentAddress;
+    if (changed == 0)
+        return true;
+    uint8_t mask = 1;
+    for (const pin_t &addressPin : addressPins) {
+        if (changed & mask)
+            ExtIO::digitalWrite(addressPin, (address & mask) != 0 ? HIGH : LOW);
+        mask <<= 1;
+    }
+    currentAddress = address;
 #if !defined(__AVR__) && defined(ARDUINO)
     delayMicroseconds(5);
 #endif
+    return false;
 }
 
-template <uint8_t N>
-void AnalogMultiplex<N>::prepareReading(uint8_t address) {
+template <uint8_t N, bool Buffered>
+void AnalogMultiplex<N, Buffered>::prepareReading(uint8_t address) {
     setMuxAddress(address);
     if (enablePin != NO_PIN)
         ExtIO::digitalWrite(enablePin, MUX_ENABLED);
 }
 
-template <uint8_t N>
-void AnalogMultiplex<N>::afterReading() {
+template <uint8_t N, bool Buffered>
+void AnalogMultiplex<N, Buffered>::afterReading() {
     if (enablePin != NO_PIN)
         ExtIO::digitalWrite(enablePin, MUX_DISABLED);
 }
@@ -15,6 +15,28 @@ ExtendedIOElement::ExtendedIOElement(pin_t length)
                       "recommended."),
                     0x00FF);
     offset = end;
+    // Pin numbers are handed out in increasing order, so appending keeps the
+    // list sorted.
+    if (lastByPin)
+        lastByPin->nextByPin = this;
+    else
+        firstByPin = this;
+    lastByPin = this;
+    lookupTableValid = false;
+}
+
+ExtendedIOElement::~ExtendedIOElement() {
+    ExtendedIOElement *prev = nullptr;
+    for (ExtendedIOElement *el = firstByPin; el; el = el->nextByPin) {
+        if (el == this) {
+            (prev ? prev->nextByPin : firstByPin) = nextByPin;
+            if (lastByPin == this)
+                lastByPin = prev;
+            break;
+        }
+        prev = el;
+    }
+    lookupTableValid = false;
 }
 
 void ExtendedIOElement::beginAll() {
@@ -56,7 +78,43 @@ DoublyLinkedList<ExtendedIOElement> &ExtendedIOElement::getAll() {
     return updatables;
 }
 
+ExtendedIOElement *ExtendedIOElement::getElementOfPin(pin_t pin) {
+    if (!lookupTableValid)
+        updateLookupTable();
+    if (pin < lookupTableStart)
+        return nullptr;
+    // Unsigned, so the division compiles to a shift, even with -Os.
+    pin_t block = unsigned(pin - lookupTableStart) / lookupBlockSize;
+    ExtendedIOElement *el = lookupTable[block < lookupTableSize
+                                            ? block
+                                            : lookupTableSize - 1];
+    // Usually, the first element is the right one, unless multiple elements
+    // share a block, or if the pin is beyond the end of the table.
+    while (el && pin >= el->end)
+        el = el->nextByPin;
+    return el && pin >= el->start ? el : nullptr;
+}
+
+void ExtendedIOElement::updateLookupTable() {
+    // The table starts at the first element that still exists, so pin numbers
+    // of destroyed elements don't waste any space.
+    ExtendedIOElement *el = firstByPin;
+    lookupTableStart = el ? el->start : offset;
+    for (pin_t block = 0; block < lookupTableSize; ++block) {
+        pin_t blockStart = lookupTableStart + block * lookupBlockSize;
+        while (el && el->end <= blockStart)
+            el = el->nextByPin;
+        lookupTable[block] = el;
+    }
+    lookupTableValid = true;
+}
+
 pin_t ExtendedIOElement::offset = NUM_DIGITAL_PINS + NUM_ANALOG_INPUTS;
+ExtendedIOElement *ExtendedIOElement::firstByPin = nullptr;
+ExtendedIOElement *ExtendedIOElement::lastByPin = nullptr;
+ExtendedIOElement *ExtendedIOElement::lookupTable[lookupTableSize] = {};
+pin_t ExtendedIOElement::lookupTableStart = 0;
+bool ExtendedIOElement::lookupTableValid = false;
 
 END_AH_NAMESPACE
 
@@ -47,18 +47,17 @@ BEGIN_AH_NAMESPACE
  * translated to `mux1.digitalRead(7)`.
  *
  * The number of extended IO elements is limited only by the size of
- * `pin_t`. However, looking up the extended IO element for a given
- * extended IO pin number uses linear search, so that might add
- * some noticable overhead for large pin numbers.  
+ * `pin_t`. The extended IO element of a given extended IO pin number is looked
+ * up using a table with one entry per 8 pins, so extended IO pins can be
+ * accessed in constant time, regardless of the number of elements. Only the
+ * first @ref EXTIO_LOOKUP_TABLE_PINS extended IO pins are in the table, pins
+ * beyond that use linear search.
  * 
  * The design here is a compromise: saving a pointer to each extended IO element
- * to find it directly would be much faster than having to search all elements
- * each time. On the other hand, it would require each `pin_t` variable to be
- * at least one byte larger. Since almost all other classes in this library 
- * store pin variables, the memory penalty would be too large, especially on AVR
- * microcontrollers.  
- * Another reason to do it this way, is that this approach is still fast enough
- * to make sure it is not noticable to human users.
+ * in each `pin_t` variable would be faster still, but it would require each
+ * `pin_t` variable to be at least one byte larger. Since almost all other
+ * classes in this library store pin variables, the memory penalty would be too
+ * large, especially on AVR microcontrollers.  
  */
 class ExtendedIOElement : public UpdatableCRTP<ExtendedIOElement> {
   protected:
@@ -71,6 +70,9 @@ class ExtendedIOElement : public UpdatableCRTP<ExtendedIOElement> {
     ExtendedIOElement(pin_t length);
 
   public:
+    /// Destructor: the pins of this element can no longer be used.
+    virtual ~ExtendedIOElement();
+
     /** 
      * @brief   Set the mode of a given pin.
      * 
@@ -255,11 +257,39 @@ class ExtendedIOElement : public UpdatableCRTP<ExtendedIOElement> {
      */
     static DoublyLinkedList<ExtendedIOElement> &getAll();
 
+    /**
+     * @brief   Find the extended IO element that the given extended IO pin
+     *          number belongs to, in constant time.
+     *
+     * Unlike @ref getAll, this includes elements that are disabled.
+     *
+     * @return  A pointer to the element, or `nullptr` if no element has the
+     *          given pin.
+     */
+    static ExtendedIOElement *getElementOfPin(pin_t pin);
+
   private:
+    /// Rebuild the lookup table for @ref getElementOfPin.
+    static void updateLookupTable();
+
     const pin_t length;
     const pin_t start;
     const pin_t end;
     static pin_t offset;
+
+    /// All elements, sorted by pin number (i.e. in order of construction).
+    ExtendedIOElement *nextByPin = nullptr;
+    static ExtendedIOElement *firstByPin;
+    static ExtendedIOElement *lastByPin;
+
+    constexpr static pin_t lookupBlockSize = 8;
+    constexpr static pin_t lookupTableSize =
+        (EXTIO_LOOKUP_TABLE_PINS + lookupBlockSize - 1) / lookupBlockSize;
+    /// For each block of 8 pins, starting from @ref lookupTableStart, the
+    /// first element that has pins in or after that block.
+    static ExtendedIOElement *lookupTable[lookupTableSize];
+    static pin_t lookupTableStart;
+    static bool lookupTableValid;
 };
 
 END_AH_NAMESPACE
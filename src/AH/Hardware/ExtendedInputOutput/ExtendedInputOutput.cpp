@@ -9,28 +9,13 @@ BEGIN_AH_NAMESPACE
 
 namespace ExtIO {
 
-template <class T>
-bool inRange(T target, T start, T end) {
-    return target >= start && target < end;
-}
-
 ExtendedIOElement &getIOElementOfPin(pin_t pin) {
-    for (auto &el : ExtendedIOElement::getAll())
-        if (pin < el.getStart())
-            break;
-        else if (inRange(pin, el.getStart(), el.getEnd()))
-            return el;
-
-    FATAL_ERROR(
-        F("The given pin does not correspond to an Extended IO element."),
-        0x8888);
-
-    // TODO: why doesn't this give a compilation error?
-    // No return statement. On desktop, FATAL_ERROR throws an exception, so
-    // I get why that works, but on Arduino, it just calls fatalErrorExit, which
-    // is marked 'noreturn'. However, if I remove the 'noreturn' attribute, and
-    // have it return immediately, it still compiles, without returning a valid
-    // reference.
+    ExtendedIOElement *el = ExtendedIOElement::getElementOfPin(pin);
+    if (el == nullptr)
+        FATAL_ERROR(
+            F("The given pin does not correspond to an Extended IO element."),
+            0x8888);
+    return *el;
 }
 
 void pinMode(pin_t pin, PinMode_t mode) {
@@ -10,6 +10,7 @@ AH_DIAGNOSTIC_WERROR() // Enable errors on warnings
 
 AH_DIAGNOSTIC_EXTERNAL_HEADER()
 #include <AH/Arduino-Wrapper.h> // MSBFIRST, SS
+#include <SPI.h>
 AH_DIAGNOSTIC_POP()
 
 BEGIN_AH_NAMESPACE
@@ -18,6 +19,9 @@ BEGIN_AH_NAMESPACE
  * @brief   A class for serial-in/parallel-out shift registers, 
  *          like the 74HC595 that are connected to the SPI bus.
  * 
+ * The entire buffer is sent in a single bulk SPI transfer, in a single
+ * transaction.
+ * 
  * @tparam  N
  *          The number of bits in total. Usually, shift registers (e.g. the
  *          74HC595) have eight bits per chip, so `length = 8 * k` where `k`
@@ -54,6 +58,23 @@ class SPIShiftRegisterOut : public ShiftRegisterOutBase<N> {
      */
     SPIShiftRegisterOut(pin_t latchPin = SS, BitOrder_t bitOrder = MSBFIRST);
 
+    /**
+     * @brief   Create a new SPIShiftRegisterOut object on the given SPI 
+     *          interface, with a given bit order, and a given number of 
+     *          outputs.
+     * 
+     * @param   spi
+     *          The SPI interface to use, e.g. `SPI1`.
+     * @param   latchPin
+     *          The digital output pin connected to the latch pin (ST_CP or 
+     *          RCLK) of the shift register.
+     * @param   bitOrder
+     *          Either `MSBFIRST` (most significant bit first) or `LSBFIRST`
+     *          (least significant bit first).
+     */
+    SPIShiftRegisterOut(SPIClass &spi, pin_t latchPin = SS,
+                        BitOrder_t bitOrder = MSBFIRST);
+
     /**
      * @brief   Initialize the shift register.  
      *          Setup the SPI interface, set the CS pin to output mode,
@@ -65,6 +86,9 @@ class SPIShiftRegisterOut : public ShiftRegisterOutBase<N> {
      * @brief   Write the state buffer to the physical outputs.
      */
     void updateBufferedOutputs() override;
+
+  private:
+    SPIClass &spi;
 };
 
 END_AH_NAMESPACE
@@ -1,22 +1,21 @@
-#ifdef ARDUINO // I'm too lazy to mock the SPI library
-
 #include "ExtendedInputOutput.hpp"
 #include "SPIShiftRegisterOut.hpp"
 
-AH_DIAGNOSTIC_EXTERNAL_HEADER()
-#include <SPI.h>
-AH_DIAGNOSTIC_POP()
-
 BEGIN_AH_NAMESPACE
 
+template <uint8_t N>
+SPIShiftRegisterOut<N>::SPIShiftRegisterOut(SPIClass &spi, pin_t latchPin,
+                                            BitOrder_t bitOrder)
+    : ShiftRegisterOutBase<N>(latchPin, bitOrder), spi(spi) {}
+
 template <uint8_t N>
 SPIShiftRegisterOut<N>::SPIShiftRegisterOut(pin_t latchPin, BitOrder_t bitOrder)
-    : ShiftRegisterOutBase<N>(latchPin, bitOrder) {}
+    : SPIShiftRegisterOut(SPI, latchPin, bitOrder) {}
 
 template <uint8_t N>
 void SPIShiftRegisterOut<N>::begin() {
     ExtIO::pinMode(this->latchPin, OUTPUT);
-    SPI.begin();
+    spi.begin();
     updateBufferedOutputs();
 }
 
@@ -24,21 +23,25 @@ template <uint8_t N>
 void SPIShiftRegisterOut<N>::updateBufferedOutputs() {
     if (!this->dirty)
         return;
+    // Copy the bytes in the order they have to be sent, the bulk transfer
+    // overwrites the buffer with the data that is received.
+    constexpr uint8_t bufferLength = (N + 7) / 8;
+    uint8_t data[bufferLength];
+    for (uint8_t i = 0; i < bufferLength; i++)
+        data[i] = this->bitOrder == LSBFIRST
+                      ? this->buffer.getByte(i)
+                      : this->buffer.getByte(bufferLength - 1 - i);
     SPISettings settings = {SPI_MAX_SPEED, this->bitOrder, SPI_MODE0};
-    SPI.beginTransaction(settings);
+    spi.beginTransaction(settings);
     ExtIO::digitalWrite(this->latchPin, LOW);
-    const uint8_t bufferLength = this->buffer.getBufferLength();
-    if (this->bitOrder == LSBFIRST)
-        for (uint8_t i = 0; i < bufferLength; i++)
-            SPI.transfer(this->buffer.getByte(i));
-    else
-        for (int8_t i = bufferLength - 1; i >= 0; i--)
-            SPI.transfer(this->buffer.getByte(i));
+#ifdef ESP32
+    spi.writeBytes(data, bufferLength);
+#else
+    spi.transfer(data, bufferLength);
+#endif
     ExtIO::digitalWrite(this->latchPin, HIGH);
-    SPI.endTransaction();
+    spi.endTransaction();
     this->dirty = false;
 }
 
 END_AH_NAMESPACE
-
-#endif
\ No newline at end of file
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <AH/Settings/Warnings.hpp>
+AH_DIAGNOSTIC_WERROR() // Enable errors on warnings
+
+#include <AH/Hardware/FilteredAnalog.hpp>
+
+BEGIN_AH_NAMESPACE
+
+/**
+ * @brief   A class that reads and filters many analog inputs at once.
+ *
+ * The result is exactly the same as using one FilteredAnalog object per
+ * input, with the same template parameters, but the filter and hysteresis
+ * states of all inputs are stored in contiguous arrays, and all inputs are
+ * updated in a single call to @ref update. First, all analog inputs are read,
+ * then all of them are filtered in one tight loop without any virtual function
+ * calls, which can be unrolled or vectorized by the compiler.
+ *
+ * Unlike FilteredAnalog, all inputs share the same mapping function.
+ *
+ * @tparam  Count
+ *          The number of analog inputs.
+ * @tparam  Precision
+ *          The number of bits of precision the output should have.
+ * @tparam  FilterShiftFactor
+ *          The number of bits used for the EMA filter.
+ * @tparam  FilterType
+ *          The type to use for the intermediate types of the filter.
+ * @tparam  AnalogType
+ *          The type to use for the analog values.
+ * @tparam  IncRes
+ *          The number of bits to increase the resolution of the analog reading
+ *          by.
+ *
+ * @see     FilteredAnalog for a detailed explanation of the template
+ *          parameters.
+ *
+ * @ingroup AH_HardwareUtils
+ */
+template <uint8_t Count, uint8_t Precision = 10,
+          uint8_t FilterShiftFactor = ANALOG_FILTER_SHIFT_FACTOR,
+          class FilterType = ANALOG_FILTER_TYPE, class AnalogType = analog_t,
+          uint8_t IncRes = MaximumFilteredAnalogIncRes<
+              FilterShiftFactor, FilterType, AnalogType>::value>
+class FilteredAnalogArray {
+  public:
+    /// A function pointer to a mapping function to map analog values.
+    /// @see    map()
+    using MappingFunction = AnalogType (*)(AnalogType);
+
+    /**
+     * @brief   Construct a new FilteredAnalogArray object.
+     *
+     * @param   analogPins
+     *          The analog pins to read from.
+     * @param   initial
+     *          The initial value of all filters.
+     */
+    FilteredAnalogArray(const PinList<Count> &analogPins,
+                        AnalogType initial = 0)
+        : analogPins(analogPins) {
+        reset(initial);
+    }
+
+    /**
+     * @brief   Reset all filters to the given value.
+     *
+     * @param   value
+     *          The value to reset the filter states to.
+     */
+    void reset(AnalogType value = 0) {
+        for (auto &filter : filters)
+            filter.reset(increaseBitDepth<ADC_BITS + IncRes, Precision,
+                                          AnalogType, AnalogType>(value));
+    }
+
+    /**
+     * @brief   Reset the filtered values to the values that are currently
+     *          being measured at the analog inputs.
+     *
+     * This is useful to avoid transient effects upon initialization.
+     */
+    void resetToCurrentValue() {
+        for (uint8_t i = 0; i < Count; ++i)
+            filters[i].reset(getRawValue(i));
+    }
+
+    /**
+     * @brief   Specify a mapping function that is applied to the analog values
+     *          of all inputs after filtering and before applying hysteresis.
+     *
+     * @param   fn
+     *          A function pointer to the mapping function, or `nullptr` to
+     *          disable the mapping function.
+     *
+     * @see     GenericFilteredAnalog::map
+     */
+    void map(MappingFunction fn) { mapFn = fn; }
+
+    /// Get the mapping function.
+    MappingFunction getMappingFunction() const { return mapFn; }
+
+    /**
+     * @brief   Invert the analog values of all inputs.
+     *
+     * @note    This overrides the mapping function set by the `map` method.
+     *
+     * @see     FilteredAnalog::invert
+     */
+    void invert() {
+        constexpr AnalogType maxval = getMaxRawValue();
+        map([](AnalogType val) -> AnalogType { return maxval - val; });
+    }
+
+    /**
+     * @brief   Read all analog inputs, apply the filters, the mapping function
+     *          and hysteresis.
+     *
+     * @retval  true
+     *          The value of at least one of the inputs changed since last time
+     *          it was updated. Use @ref hasChanged to find out which ones.
+     * @retval  false
+     *          All values are still the same.
+     */
+    bool update() {
+        AnalogType input[Count];
+        AnalogType *in = input;
+        for (pin_t pin : analogPins)
+            *in++ = readRawValue(pin);
+        for (uint8_t i = 0; i < Count; ++i)
+            input[i] = filters[i].filter(input[i]);
+        if (mapFn != nullptr)
+            for (uint8_t i = 0; i < Count; ++i)
+                input[i] = mapFn(input[i]);
+        // Collect the flags of 8 inputs at a time, and store them as one byte
+        uint8_t anyChanged = 0;
+        for (uint16_t i = 0; i < Count; i += 8) {
+            uint8_t bits = 0;
+            for (uint8_t j = 0; j < 8 && i + j < Count; ++j)
+                bits |= uint8_t(hysteresis[i + j].update(input[i + j])) << j;
+            changed[i / 8] = bits;
+            anyChanged |= bits;
+        }
+        return anyChanged != 0;
+    }
+
+    /**
+     * @brief   Check whether the value of the given input changed during the
+     *          last call to @ref update.
+     */
+    bool hasChanged(uint8_t index) const {
+        return changed[index / 8] & (1 << (index % 8));
+    }
+
+    /**
+     * @brief   Call the given function with the index of each input whose value
+     *          changed during the last call to @ref update, in increasing
+     *          order.
+     *
+     * This is faster than calling @ref hasChanged for all inputs, because
+     * groups of 8 inputs that didn't change are skipped at once.
+     */
+    template <class Callback>
+    void forEachChanged(Callback &&callback) const {
+        for (uint8_t b = 0; b < sizeof(changed); ++b)
+            for (uint8_t bits = changed[b], j = 0; bits; bits >>= 1, ++j)
+                if (bits & 1)
+                    callback(uint8_t(b * 8 + j));
+    }
+
+    /**
+     * @brief   Get the filtered value of the given analog input (with the
+     *          mapping function applied).
+     *
+     * @note    This function just returns the value from the last call to
+     *          @ref update, it doesn't read the analog input again.
+     *
+     * @return  The filtered value of the analog input, as a number
+     *          of `Precision` bits wide.
+     */
+    AnalogType getValue(uint8_t index) const {
+        return hysteresis[index].getValue();
+    }
+
+    /**
+     * @brief   Get the filtered value of the given analog input with the
+     *          mapping function applied as a floating point number from 0.0 to
+     *          1.0.
+     */
+    float getFloatValue(uint8_t index) const {
+        return getValue(index) * (1.0f / (ldexpf(1.0f, Precision) - 1.0f));
+    }
+
+    /**
+     * @brief   Read the raw value of the given analog input without any
+     *          filtering or mapping applied, but with its bit depth increased
+     *          by @c IncRes.
+     */
+    AnalogType getRawValue(uint8_t index) const {
+        return readRawValue(analogPins[index]);
+    }
+
+    /**
+     * @brief   Get the maximum value that can be returned from @ref getRawValue.
+     */
+    constexpr static AnalogType getMaxRawValue() {
+        return (1ul << (ADC_BITS + IncRes)) - 1ul;
+    }
+
+    /// Get the number of analog inputs.
+    constexpr static uint8_t length() { return Count; }
+
+    /// Get the analog pin of the given input.
+    pin_t getPin(uint8_t index) const { return analogPins[index]; }
+
+  private:
+    /// @see    GenericFilteredAnalog::getRawValue
+    static AnalogType readRawValue(pin_t analogPin) {
+        AnalogType value = ExtIO::analogRead(analogPin);
+#ifdef ESP8266
+        if (value > 1023)
+            value = 1023;
+#endif
+        return increaseBitDepth<ADC_BITS + IncRes, ADC_BITS, AnalogType>(value);
+    }
+
+    using EMA_t = EMA<FilterShiftFactor, AnalogType, FilterType>;
+
+    static_assert(Count > 0, "Error: Count should be at least one");
+    static_assert(
+        ADC_BITS + IncRes + FilterShiftFactor <= sizeof(FilterType) * CHAR_BIT,
+        "Error: FilterType is not wide enough to hold the maximum value");
+    static_assert(
+        ADC_BITS + IncRes <= sizeof(AnalogType) * CHAR_BIT,
+        "Error: AnalogType is not wide enough to hold the maximum value");
+    static_assert(
+        Precision <= ADC_BITS + IncRes,
+        "Error: Precision is larger than the increased ADC precision");
+    static_assert(
+        EMA_t::supports_range(AnalogType(0), getMaxRawValue()),
+        "Error: EMA filter type doesn't support full ADC range");
+
+    PinList<Count> analogPins;
+    MappingFunction mapFn = nullptr;
+    EMA_t filters[Count];
+    Hysteresis<ADC_BITS + IncRes - Precision, AnalogType, AnalogType>
+        hysteresis[Count];
+    uint8_t changed[(Count + 7) / 8] = {};
+};
+
+END_AH_NAMESPACE
+
+AH_DIAGNOSTIC_POP()
@@ -29,6 +29,13 @@ BEGIN_AH_NAMESPACE
 /// Exit when encountering an error, instead of trying to recover (recommended).
 #define FATAL_ERRORS
 
+/// Measure the time spent in the different parts of the main loop, and the
+/// latency between button presses and the MIDI messages they send.
+/// Nothing is measured until the profiler is started.
+/// @see    LoopProfiler
+/// @note   Enabling this will increase memory usage and slow down the program.
+// #define AH_PROFILING
+
 // ----------------------------- User Settings ------------------------------ //
 // ========================================================================== //
 
@@ -84,6 +91,19 @@ constexpr unsigned long FILTERED_INPUT_UPDATE_INTERVAL = 1000; // microseconds
 
 constexpr static Frequency SPI_MAX_SPEED = 8_MHz;
 
+/// The number of extended IO pins for which the ExtendedIOElement they belong
+/// to can be found in constant time, using a lookup table with one pointer
+/// per 8 pins. The pins of elements beyond the first EXTIO_LOOKUP_TABLE_PINS
+/// pins are found using linear search, starting from the last entry of the
+/// table.
+/// On AVR, the table covers 64 pins (e.g. four 16-channel multiplexers), so
+/// it only takes 16 bytes of RAM.
+#ifdef __AVR__
+constexpr uint16_t EXTIO_LOOKUP_TABLE_PINS = 64;
+#else
+constexpr uint16_t EXTIO_LOOKUP_TABLE_PINS = 256;
+#endif
+
 /// Make it possible to invert individual push buttons.
 /// Enabling this will increase memory usage.
 #define AH_INDIVIDUAL_BUTTON_INVERT
@@ -0,0 +1,10 @@
+#include "LatencyProbe.hpp"
+
+BEGIN_AH_NAMESPACE
+
+bool LatencyProbe::running = false;
+bool LatencyProbe::pending = false;
+unsigned long LatencyProbe::inputTime = 0;
+TimingStats LatencyProbe::stats;
+
+END_AH_NAMESPACE
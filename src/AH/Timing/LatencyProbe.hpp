@@ -0,0 +1,87 @@
+#pragma once
+
+#include <AH/Settings/Warnings.hpp>
+AH_DIAGNOSTIC_WERROR() // Enable errors on warnings
+
+#include <AH/Settings/SettingsWrapper.hpp>
+#include <AH/Timing/TimingStats.hpp>
+
+BEGIN_AH_NAMESPACE
+
+/// @addtogroup    AH_Timing
+/// @{
+
+/**
+ * @brief   Measures the latency between an input event (e.g. a button that is
+ *          pressed) and the output it causes (e.g. a MIDI message that is
+ *          sent).
+ *
+ * Inputs call @ref input, outputs call @ref output. The time between the
+ * first input that hasn't been matched yet and the next output is added to
+ * the statistics. Inputs that don't cause any output have to be discarded
+ * using @ref cancel, e.g. at the end of each iteration of the main loop.
+ *
+ * Nothing is measured until @ref start is called. The library only calls
+ * these functions if `AH_PROFILING` is defined, see @ref AH_PROFILE_INPUT and
+ * @ref AH_PROFILE_OUTPUT.
+ */
+class LatencyProbe {
+  public:
+    /// Reset the statistics and start measuring.
+    static void start() {
+        stats.reset();
+        pending = false;
+        running = true;
+    }
+    /// Stop measuring.
+    static void stop() { running = false; }
+    /// Check whether the latency is being measured.
+    static bool isRunning() { return running; }
+
+    /// Mark an input event.
+    static void input() {
+        if (running && !pending) {
+            inputTime = micros();
+            pending = true;
+        }
+    }
+    /// Mark an output event, and measure the latency of the pending input
+    /// event, if any.
+    static void output() {
+        if (pending) {
+            stats.add(micros() - inputTime);
+            pending = false;
+        }
+    }
+    /// Discard the pending input event.
+    static void cancel() { pending = false; }
+
+    /// Get the latency statistics.
+    static const TimingStats &getStats() { return stats; }
+
+  private:
+    static bool running;
+    static bool pending;
+    static unsigned long inputTime;
+    static TimingStats stats;
+};
+
+#ifdef AH_PROFILING
+/// Mark an input event for the LatencyProbe, if profiling is enabled.
+#define AH_PROFILE_INPUT() AH::LatencyProbe::input()
+/// Mark an output event for the LatencyProbe, if profiling is enabled.
+#define AH_PROFILE_OUTPUT() AH::LatencyProbe::output()
+#else
+#define AH_PROFILE_INPUT()                                                     \
+    do {                                                                       \
+    } while (0)
+#define AH_PROFILE_OUTPUT()                                                    \
+    do {                                                                       \
+    } while (0)
+#endif
+
+/// @}
+
+END_AH_NAMESPACE
+
+AH_DIAGNOSTIC_POP()
@@ -0,0 +1,61 @@
+#include "TimingStats.hpp"
+#include <AH/PrintStream/PrintStream.hpp>
+
+AH_DIAGNOSTIC_WERROR() // Enable errors on warnings
+
+BEGIN_AH_NAMESPACE
+
+void TimingStats::add(unsigned long duration) {
+    ++count;
+    sum += duration;
+    if (duration < min)
+        min = duration;
+    if (duration > max)
+        max = duration;
+    uint16_t &bin = histogram[getBinIndex(duration)];
+    if (bin < 0xFFFF)
+        ++bin;
+}
+
+uint8_t TimingStats::getBinIndex(unsigned long duration) {
+    uint8_t bin = 0;
+    while (duration > 0 && bin < NumBins - 1) {
+        duration >>= 1;
+        ++bin;
+    }
+    return bin;
+}
+
+template <class Stream>
+static Stream &printTimingStats(Stream &os, const TimingStats &stats) {
+    os << "n=" << stats.getCount() << " min=" << stats.getMin()
+       << " mean=" << stats.getMean() << " max=" << stats.getMax() << " us |";
+    for (uint8_t i = 0; i < TimingStats::NumBins; ++i) {
+        if (stats.getBin(i) == 0)
+            continue;
+        os << ' ';
+        if (i == 0)
+            os << '0';
+        else if (i == TimingStats::NumBins - 1)
+            os << ">=" << TimingStats::getBinLowerBound(i);
+        else
+            os << TimingStats::getBinLowerBound(i) << ".."
+               << TimingStats::getBinLowerBound(i + 1) - 1;
+        os << ':' << stats.getBin(i);
+    }
+    return os;
+}
+
+Print &operator<<(Print &os, const TimingStats &stats) {
+    return printTimingStats(os, stats);
+}
+
+#ifndef ARDUINO
+std::ostream &operator<<(std::ostream &os, const TimingStats &stats) {
+    return printTimingStats(os, stats);
+}
+#endif
+
+END_AH_NAMESPACE
+
+AH_DIAGNOSTIC_POP()
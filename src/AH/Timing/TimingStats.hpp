@@ -0,0 +1,89 @@
+#pragma once
+
+#include <AH/Settings/Warnings.hpp>
+AH_DIAGNOSTIC_WERROR() // Enable errors on warnings
+
+AH_DIAGNOSTIC_EXTERNAL_HEADER()
+#include <AH/Arduino-Wrapper.h> // Print
+AH_DIAGNOSTIC_POP()
+
+#include <AH/Settings/NamespaceSettings.hpp>
+#include <stdint.h>
+
+#ifndef ARDUINO
+#include <ostream> // std::ostream
+#endif
+
+BEGIN_AH_NAMESPACE
+
+/// @addtogroup    AH_Timing
+/// @{
+
+/**
+ * @brief   Collects statistics of a series of durations (in microseconds):
+ *          the number of measurements, the minimum, the mean, the maximum,
+ *          and a histogram.
+ *
+ * The bins of the histogram grow exponentially: bin 0 counts durations of
+ * 0 µs, bin @f$ i @f$ counts the durations in @f$ [2^{i-1}, 2^i) @f$ µs, and
+ * the last bin counts all durations that are longer.
+ */
+class TimingStats {
+  public:
+    /// The number of bins of the histogram.
+    constexpr static uint8_t NumBins = 16;
+
+    /// Add a measurement.
+    void add(unsigned long duration);
+
+    /// Remove all measurements.
+    void reset() { *this = {}; }
+
+    /// Get the number of measurements.
+    unsigned long getCount() const { return count; }
+    /// Get the shortest duration, or zero if there are no measurements.
+    unsigned long getMin() const { return count == 0 ? 0 : min; }
+    /// Get the longest duration.
+    unsigned long getMax() const { return max; }
+    /// Get the mean duration, rounded down, or zero if there are no
+    /// measurements.
+    unsigned long getMean() const { return count == 0 ? 0 : sum / count; }
+
+    /// Get the number of measurements in the given bin of the histogram.
+    /// Saturates at 65535.
+    uint16_t getBin(uint8_t bin) const { return histogram[bin]; }
+    /// Get the index of the bin that the given duration belongs to.
+    static uint8_t getBinIndex(unsigned long duration);
+    /// Get the shortest duration that belongs to the given bin.
+    static unsigned long getBinLowerBound(uint8_t bin) {
+        return bin == 0 ? 0 : 1ul << (bin - 1);
+    }
+
+  private:
+    unsigned long count = 0;
+    unsigned long min = ~0ul;
+    unsigned long max = 0;
+    uint64_t sum = 0;
+    uint16_t histogram[NumBins] = {};
+};
+
+/**
+ * @brief   Print the statistics on a single line, for example:
+ *          `n=100 min=4 mean=9 max=20 us | 4..7:10 8..15:80 16..31:10`
+ *
+ * Only the bins of the histogram that are not empty are printed.
+ *
+ * @related TimingStats
+ */
+Print &operator<<(Print &os, const TimingStats &stats);
+
+#ifndef ARDUINO
+/// @copydoc operator<<(Print &, const TimingStats &)
+std::ostream &operator<<(std::ostream &os, const TimingStats &stats);
+#endif
+
+/// @}
+
+END_AH_NAMESPACE
+
+AH_DIAGNOSTIC_POP()
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <AH/Settings/Warnings.hpp>
+AH_DIAGNOSTIC_WERROR() // Enable errors on warnings
+
+AH_DIAGNOSTIC_EXTERNAL_HEADER()
+#include <AH/Arduino-Wrapper.h> // micros
+AH_DIAGNOSTIC_POP()
+
+#include <AH/Settings/NamespaceSettings.hpp>
+#include <stdint.h>
+
+BEGIN_AH_NAMESPACE
+
+/// @addtogroup    AH_Timing
+/// @{
+
+/**
+ * @brief   Limits the amount of work a task does in one go, by the number of
+ *          items it processes (e.g. incoming MIDI messages or displays) and/or
+ *          by the time it spends.
+ *
+ * The task calls @ref start when it begins, checks @ref isExhausted before
+ * processing each item, and calls @ref consume after processing it. Items
+ * that are not processed are left for the next time the task runs.
+ *
+ * At least one item is always allowed after each call to @ref start, so a
+ * task always makes progress, even if the budget is too small.
+ *
+ * ~~~cpp
+ * AH::WorkBudget budget = {16, 1000}; // 16 items or 1 ms
+ * budget.start();
+ * while (!budget.isExhausted() && haveWork()) {
+ *     doWork();
+ *     budget.consume();
+ * }
+ * ~~~
+ */
+class WorkBudget {
+  public:
+    /**
+     * @brief   Create a new budget.
+     *
+     * @param   maxItems
+     *          The maximum number of items, or zero for no limit.
+     * @param   maxMicros
+     *          The maximum time in microseconds, or zero for no limit.
+     */
+    WorkBudget(uint16_t maxItems = 0, unsigned long maxMicros = 0)
+        : maxItems(maxItems), maxMicros(maxMicros) {}
+
+    /// Reset the item count and start measuring the time from now.
+    void start() {
+        items = 0;
+        if (maxMicros > 0)
+            startTime = micros();
+    }
+
+    /// Check whether the item or time limit has been reached. Always false if
+    /// no items have been processed since the last call to @ref start.
+    bool isExhausted() const {
+        if (items == 0)
+            return false;
+        if (maxItems > 0 && items >= maxItems)
+            return true;
+        return maxMicros > 0 && micros() - startTime >= maxMicros;
+    }
+
+    /// Count the given number of processed items.
+    void consume(uint16_t count = 1) {
+        items = count > 0xFFFF - items ? 0xFFFF : items + count;
+    }
+
+    /// Get the number of items processed since the last call to @ref start.
+    uint16_t getItemCount() const { return items; }
+
+    /// Get the maximum number of items (zero means no limit).
+    uint16_t getMaxItems() const { return maxItems; }
+    /// Set the maximum number of items (zero means no limit).
+    void setMaxItems(uint16_t maxItems) { this->maxItems = maxItems; }
+
+    /// Get the maximum time in microseconds (zero means no limit).
+    unsigned long getMaxMicros() const { return maxMicros; }
+    /// Set the maximum time in microseconds (zero means no limit).
+    void setMaxMicros(unsigned long maxMicros) { this->maxMicros = maxMicros; }
+
+    /// Check whether neither the number of items nor the time is limited.
+    bool isUnlimited() const { return maxItems == 0 && maxMicros == 0; }
+
+  private:
+    uint16_t maxItems;
+    uint16_t items = 0;
+    unsigned long maxMicros;
+    unsigned long startTime = 0;
+};
+
+/// @}
+
+END_AH_NAMESPACE
+
+AH_DIAGNOSTIC_POP()
@@ -1,3 +1,35 @@
-#ifdef TEST_COMPILE_ALL_HEADERS_SEPARATELY
 #include "Bank.hpp"
-#endif
\ No newline at end of file
+
+BEGIN_CS_NAMESPACE
+
+DoublyLinkedList<InputBankRefresher> InputBankRefresher::dirtyBanks;
+
+void InputBankRefresher::scheduleRefresh() {
+    if (!pending)
+        dirtyBanks.append(this);
+    pending = true;
+}
+
+void InputBankRefresher::finishRefresh() {
+    if (pending)
+        dirtyBanks.remove(this);
+    pending = false;
+}
+
+void InputBankRefresher::refreshAll(AH::WorkBudget &budget) {
+    budget.start();
+    InputBankRefresher *bank = dirtyBanks.getFirst();
+    while (bank != nullptr && !budget.isExhausted()) {
+        InputBankRefresher *next = bank->next;
+        if (bank->refresh(budget))
+            bank->finishRefresh();
+        bank = next;
+    }
+}
+
+void InputBankRefresher::refreshAll() {
+    AH::WorkBudget unlimited;
+    refreshAll(unlimited);
+}
+
+END_CS_NAMESPACE
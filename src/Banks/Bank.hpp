@@ -5,6 +5,8 @@
 #include <AH/Debug/Debug.hpp>
 #include <AH/Error/Error.hpp>
 #include <AH/Containers/LinkedList.hpp>
+#include <AH/Timing/WorkBudget.hpp>
+#include <MIDI_Inputs/MIDIInputElementIndex.hpp>
 #include <Selectors/Selectable.hpp>
 
 BEGIN_CS_NAMESPACE
@@ -63,6 +65,61 @@ class OutputBank {
     setting_t bankSetting;
 };
 
+/**
+ * @brief   Refreshes the BankableMIDIInput%s of a bank after its setting
+ *          changed, spread out over multiple loops.
+ *
+ * Refreshing a BankableMIDIInput (i.e. calling its `onBankSettingChange`
+ * callback) can be expensive, because it updates all of its outputs (e.g.
+ * LEDs or display elements). Selecting a new bank setting therefore only
+ * marks the bank as dirty. Control_Surface_::loop then refreshes a limited
+ * number of BankableMIDIInput%s per loop (see
+ * LoopScheduler::getBankRefreshBudget), so switching banks doesn't stall the
+ * MIDI input and the buttons.
+ *
+ * If the bank setting changes again before the refresh is finished, the
+ * refresh starts over from the first BankableMIDIInput.
+ */
+class InputBankRefresher : public DoublyLinkable<InputBankRefresher> {
+  protected:
+    InputBankRefresher() = default;
+    InputBankRefresher(const InputBankRefresher &) = delete;
+    InputBankRefresher &operator=(const InputBankRefresher &) = delete;
+    ~InputBankRefresher() { finishRefresh(); }
+
+  public:
+    /// Check whether any of the BankableMIDIInput%s of this bank still have to
+    /// be refreshed.
+    bool isRefreshPending() const { return pending; }
+
+    /**
+     * @brief   Refresh the pending BankableMIDIInput%s of all banks, until the
+     *          given budget (which is started first) is exhausted.
+     *
+     * One item of the budget is one BankableMIDIInput.
+     */
+    static void refreshAll(AH::WorkBudget &budget);
+    /// Refresh the pending BankableMIDIInput%s of all banks immediately.
+    static void refreshAll();
+    /// Check whether the BankableMIDIInput%s of any bank still have to be
+    /// refreshed.
+    static bool isAnyRefreshPending() { return dirtyBanks.getFirst(); }
+
+  protected:
+    /// Mark the bank as dirty, so it will be refreshed by @ref refreshAll.
+    void scheduleRefresh();
+    /// Remove the bank from the list of dirty banks.
+    void finishRefresh();
+
+  private:
+    /// Refresh as many BankableMIDIInput%s as the budget allows.
+    /// @return True if all BankableMIDIInput%s have been refreshed.
+    virtual bool refresh(AH::WorkBudget &budget) = 0;
+
+    bool pending = false;
+    static DoublyLinkedList<InputBankRefresher> dirtyBanks;
+};
+
 /**
  * @brief   A class that groups Bankable BankableMIDIOutput%s and 
  *          BankableMIDIInput%s, and allows the user to change the addresses 
@@ -72,7 +129,9 @@ class OutputBank {
  *          The number of banks.
  */
 template <setting_t N>
-class Bank : public Selectable<N>, public OutputBank {
+class Bank : public Selectable<N>,
+             public OutputBank,
+             public InputBankRefresher {
     friend class BankableMIDIInput<N>;
 
   public:
@@ -92,7 +151,9 @@ class Bank : public Selectable<N>, public OutputBank {
     /**
      * @brief   Select the given bank setting.
      * 
-     * All BankableMIDIInput%s will be updated.
+     * All MIDI input dispatch indices are invalidated immediately (see
+     * MIDIInputElementIndex). The BankableMIDIInput%s are refreshed during
+     * the next loops (see InputBankRefresher).
      *
      * @param   bankSetting
      *          The new setting to select.
@@ -125,6 +186,8 @@ class Bank : public Selectable<N>, public OutputBank {
      */
     void remove(BankableMIDIInput<N> *bankable);
 
+    bool refresh(AH::WorkBudget &budget) override;
+
     /**
      * @brief   A linked list of all BankableMIDIInput elements that have been
      *          added to this bank, and that should be updated when the bank
@@ -134,6 +197,9 @@ class Bank : public Selectable<N>, public OutputBank {
      * created or destroyed.
      */
     DoublyLinkedList<BankableMIDIInput<N>> inputBankables;
+
+    /// The next BankableMIDIInput to refresh.
+    BankableMIDIInput<N> *refreshCursor = nullptr;
 };
 
 END_CS_NAMESPACE
@@ -151,6 +217,8 @@ void Bank<N>::add(BankableMIDIInput<N> *bankable) {
 
 template <setting_t N>
 void Bank<N>::remove(BankableMIDIInput<N> *bankable) {
+    if (refreshCursor == bankable)
+        refreshCursor = bankable->next;
     inputBankables.remove(bankable);
 }
 
@@ -158,8 +226,20 @@ template <setting_t N>
 void Bank<N>::select(setting_t bankSetting) {
     bankSetting = this->validateSetting(bankSetting);
     OutputBank::select(bankSetting);
-    for (BankableMIDIInput<N> &e : inputBankables)
-        e.onBankSettingChange();
+    refreshCursor = inputBankables.getFirst();
+    scheduleRefresh();
+    MIDIInputElementIndexBase::invalidateAll();
+}
+
+template <setting_t N>
+bool Bank<N>::refresh(AH::WorkBudget &budget) {
+    while (refreshCursor != nullptr && !budget.isExhausted()) {
+        BankableMIDIInput<N> *bankable = refreshCursor;
+        refreshCursor = bankable->next;
+        bankable->onBankSettingChange();
+        budget.consume();
+    }
+    return refreshCursor == nullptr;
 }
 
 END_CS_NAMESPACE
\ No newline at end of file
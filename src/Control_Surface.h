@@ -34,6 +34,7 @@
 #include <MIDI_Outputs/CCIncrementDecrementButtons.hpp>
 
 #include <MIDI_Outputs/CCPotentiometer.hpp>
+#include <MIDI_Outputs/CCPotentiometers.hpp>
 
 #include <MIDI_Outputs/NoteButton.hpp>
 #include <MIDI_Outputs/NoteButtonLatched.hpp>
@@ -88,10 +89,12 @@
 #include <MIDI_Inputs/MCU/LCD.hpp>
 #include <MIDI_Inputs/MCU/VPotRing.hpp>
 #include <MIDI_Inputs/MCU/VU.hpp>
+#include <MIDI_Inputs/MIDIClock.hpp>
 #include <MIDI_Inputs/NoteCCRange.hpp>
 
 #include <MIDI_Inputs/LEDs/MCU/VPotRingLEDs.hpp>
 #include <MIDI_Inputs/LEDs/MCU/VULEDs.hpp>
+#include <MIDI_Inputs/LEDs/MIDIClockLED.hpp>
 #include <MIDI_Inputs/LEDs/NoteCCRangeLEDBar.hpp>
 #include <MIDI_Inputs/LEDs/NoteCCRangeLEDs.hpp>
 
@@ -117,6 +120,10 @@
 
 // ---------------------------- MIDI Interfaces ----------------------------- //
 #include <MIDI_Interfaces/DebugMIDI_Interface.hpp>
+#include <MIDI_Interfaces/MIDI_OutputCoalescer.hpp>
+#include <MIDI_Interfaces/MIDI_TransmitQueue.hpp>
+#include <MIDI_Interfaces/MIDI_DuplicateFilter.hpp>
+#include <MIDI_Interfaces/ReplayMIDI_Interface.hpp>
 #include <MIDI_Interfaces/SerialMIDI_Interface.hpp>
 #include <MIDI_Interfaces/USBMIDI_Interface.hpp>
 #ifdef ESP32
@@ -2,16 +2,19 @@
 #include <AH/Debug/Debug.hpp>
 #include <AH/Hardware/ExtendedInputOutput/ExtendedIOElement.hpp>
 #include <AH/Hardware/FilteredAnalog.hpp>
+#include <Banks/Bank.hpp>
 #include <MIDI_Constants/Control_Change.hpp>
 #include <MIDI_Inputs/MIDIInputElementCC.hpp>
 #include <MIDI_Inputs/MIDIInputElementChannelPressure.hpp>
 #include <MIDI_Inputs/MIDIInputElementNote.hpp>
 #include <MIDI_Inputs/MIDIInputElementPC.hpp>
+#include <MIDI_Inputs/MIDIInputElementRealTime.hpp>
 #include <MIDI_Inputs/MIDIInputElementSysEx.hpp>
 #include <MIDI_Outputs/Abstract/MIDIOutputElement.hpp>
 #include <Selectors/Selector.hpp>
 
 #include <AH/Arduino-Wrapper.h>
+#include <AH/STL/functional> // std::less
 
 BEGIN_CS_NAMESPACE
 
@@ -39,6 +42,7 @@ void Control_Surface_::begin() {
     MIDIInputElementChannelPressure::beginAll();
     MIDIInputElementNote::beginAll();
     MIDIInputElementSysEx::beginAll();
+    MIDIInputElementRealTime::beginAll();
     Updatable<>::beginAll();
     Updatable<Potentiometer>::beginAll();
     Updatable<MotorFader>::beginAll();
@@ -66,15 +70,68 @@ void Control_Surface_::disconnectMIDI_Interfaces() {
 }
 
 void Control_Surface_::loop() {
-    ExtendedIOElement::updateAllBufferedInputs();
-    Updatable<>::updateAll();
-    if (potentiometerTimer)
-        Updatable<Potentiometer>::updateAll();
-    updateMidiInput();
-    updateInputs();
-    if (displayTimer)
-        updateDisplays();
-    ExtendedIOElement::updateAllBufferedOutputs();
+#ifdef AH_PROFILING
+    if (profiler.isRunning()) {
+        profiledLoop();
+        return;
+    }
+#endif
+    for (LoopStage stage : scheduler)
+        runStage(stage);
+}
+
+#ifdef AH_PROFILING
+void Control_Surface_::profiledLoop() {
+    unsigned long loopStart = micros();
+    for (LoopStage stage : scheduler) {
+        unsigned long stageStart = micros();
+        if (stage == LoopStage::Updatables) {
+            // Measure each Updatable separately
+            Updatable<>::forEach([this](Updatable<> &updatable) {
+                unsigned long start = micros();
+                updatable.update();
+                profiler.addUpdatable(updatable, micros() - start);
+            });
+        } else {
+            runStage(stage);
+        }
+        profiler.addStage(stage, micros() - stageStart);
+    }
+    // Button edges that didn't cause any MIDI output
+    AH::LatencyProbe::cancel();
+    profiler.addLoop(micros() - loopStart);
+}
+#endif
+
+void Control_Surface_::runStage(LoopStage stage) {
+    switch (stage) {
+        case LoopStage::BufferedInputs:
+            ExtendedIOElement::updateAllBufferedInputs();
+            break;
+        case LoopStage::Updatables: Updatable<>::updateAll(); break;
+        case LoopStage::Potentiometers:
+            if (potentiometerTimer)
+                Updatable<Potentiometer>::updateAll();
+            break;
+        case LoopStage::MIDIInput:
+            MIDI_Interface::updateAllWithBudget(scheduler.getMIDIInputBudget());
+            break;
+        case LoopStage::InputElements:
+            updateInputs();
+            InputBankRefresher::refreshAll(scheduler.getBankRefreshBudget());
+            break;
+        case LoopStage::BufferedOutputs:
+            ExtendedIOElement::updateAllBufferedOutputs();
+            break;
+        case LoopStage::MIDIFlush: MIDI_Interface::flushAll(); break;
+        case LoopStage::Displays:
+            // Finish an interrupted frame before waiting for the next one
+            if (displayFramePending || displayTimer)
+                displayFramePending =
+                    !updateDisplays(scheduler.getDisplayBudget());
+            break;
+        default: break;
+    }
 }
 
 void Control_Surface_::updateMidiInput() {
@@ -84,16 +141,25 @@ void Control_Surface_::updateMidiInput() {
 void Control_Surface_::sendImpl(uint8_t header, uint8_t d1, uint8_t d2,
                                 uint8_t cn) {
     this->sourceMIDItoPipe(ChannelMessage{header, d1, d2, cn});
+    AH_PROFILE_OUTPUT();
 }
 void Control_Surface_::sendImpl(uint8_t header, uint8_t d1, uint8_t cn) {
     this->sourceMIDItoPipe(ChannelMessage{header, d1, 0x00, cn});
+    AH_PROFILE_OUTPUT();
 }
 void Control_Surface_::sendImpl(const uint8_t *data, size_t length,
                                 uint8_t cn) {
     this->sourceMIDItoPipe(SysExMessage{data, length, cn});
+    AH_PROFILE_OUTPUT();
+}
+void Control_Surface_::sendChunkImpl(const uint8_t *data, size_t length,
+                                     uint8_t cn) {
+    this->sourceMIDItoPipe(SysExMessage{data, length, cn, true});
+    AH_PROFILE_OUTPUT();
 }
 void Control_Surface_::sendImpl(uint8_t rt, uint8_t cn) {
     this->sourceMIDItoPipe(RealTimeMessage{rt, cn});
+    AH_PROFILE_OUTPUT();
 }
 
 void Control_Surface_::sinkMIDIfromPipe(ChannelMessage midichmsg) {
@@ -171,7 +237,7 @@ void Control_Surface_::sinkMIDIfromPipe(RealTimeMessage rtMessage) {
     // continue handling it.
     if (realTimeMessageCallback && realTimeMessageCallback(rtMessage))
         return;
-    // TODO: handle Real-Time input
+    MIDIInputElementRealTime::updateAllWith(rtMessage);
 }
 
 void Control_Surface_::updateInputs() {
@@ -180,24 +246,119 @@ void Control_Surface_::updateInputs() {
     MIDIInputElementChannelPressure::updateAll();
     MIDIInputElementPC::updateAll();
     MIDIInputElementSysEx::updateAll();
+    MIDIInputElementRealTime::updateAll();
 }
 
-void Control_Surface_::updateDisplays() {
-    DisplayInterface *previousDisplay = nullptr;
-    for (DisplayElement &displayElement : DisplayElement::getAll()) {
-        DisplayInterface *thisDisplay = &displayElement.getDisplay();
-        if (!thisDisplay->isEnabled())
+/// Redraw and update the given display, using the elements in the range
+/// [first, last), which are all elements that draw to this display. Returns
+/// false if the budget ran out before the display was updated, in which case
+/// @p frame contains everything needed to continue later.
+template <class Frame, class Iterator>
+static bool updateDisplay(DisplayInterface &display, Iterator first,
+                          Iterator last, Frame &frame,
+                          AH::WorkBudget &budget) {
+    if (!frame.started) {
+        // Find the region of the display that changed, and clear the regions
+        // of the elements that changed in the same pass, so an element that
+        // becomes dirty halfway is either cleared and redrawn, or neither.
+        PixelRegion dirty = frame.redrawAll ? PixelRegion::everything()
+                                            : PixelRegion{0, 0, 0, 0};
+        bool cleared = false;
+        for (Iterator el = first; el != last && !dirty.isEverything(); ++el) {
+            if (!el->getDirty())
+                continue;
+            // Don't touch the display if there's no budget left
+            if (!cleared && budget.isExhausted())
+                return false;
+            dirty = dirty.isEmpty() ? el->getBounds() : dirty | el->getBounds();
+            if (!dirty.isEverything()) {
+                display.clearRegion(el->getBounds());
+                cleared = true;
+            }
+        }
+        if (dirty.isEmpty())
+            return true; // Nothing changed, don't touch the display
+        // Once a region was cleared, the frame has to be finished
+        if (!cleared && budget.isExhausted())
+            return false;
+        if (dirty.isEverything())
+            display.clearAndDrawBackground();
+        else
+            display.drawBackground();
+        frame.started = true;
+        frame.redrawAll = false;
+        frame.element = 0;
+        frame.dirty = dirty;
+    }
+
+    // Skip the elements that were drawn before the interruption
+    Iterator el = first;
+    for (uint16_t i = 0; i < frame.element && el != last; ++i)
+        ++el;
+    // Only redraw the elements that overlap with the dirty region
+    for (; el != last; ++el, ++frame.element) {
+        if (!frame.dirty.isEverything() &&
+            !el->getBounds().intersects(frame.dirty))
             continue;
-        if (thisDisplay != previousDisplay) {
-            if (previousDisplay)
-                previousDisplay->display();
-            previousDisplay = thisDisplay;
-            thisDisplay->clearAndDrawBackground();
+        if (budget.isExhausted())
+            return false;
+        el->draw();
+        budget.consume();
+    }
+
+    if (budget.isExhausted())
+        return false;
+    if (frame.dirty.isEverything())
+        display.display();
+    else
+        display.displayRegion(frame.dirty);
+    budget.consume();
+    frame.started = false;
+    return true;
+}
+
+void Control_Surface_::updateDisplays() {
+    AH::WorkBudget unlimited;
+    updateDisplays(unlimited);
+}
+
+bool Control_Surface_::updateDisplays(AH::WorkBudget &budget) {
+    budget.start();
+    // If elements were added or removed while the current display was only
+    // partially drawn, the number of elements that were handled is no longer
+    // meaningful, so that display is redrawn entirely.
+    if (displayFrame.started &&
+        displayFrame.listChanges != DisplayElement::getListChanges()) {
+        displayFrame.started = false;
+        displayFrame.redrawAll = true;
+    }
+    auto &elements = DisplayElement::getAll();
+    auto first = elements.begin();
+    while (first != elements.end()) {
+        // All elements that draw to the same display are next to each other
+        DisplayInterface &display = first->getDisplay();
+        auto last = first;
+        while (last != elements.end() && &last->getDisplay() == &display)
+            ++last;
+        // Skip the displays that were updated before the interruption
+        // (std::less gives a total order, even for unrelated pointers and
+        // nullptr.)
+        if (!std::less<const DisplayInterface *>()(&display,
+                                                   displayFrame.display)) {
+            if (&display != displayFrame.display)
+                displayFrame.redrawAll = false;
+            if (display.isEnabled() &&
+                !updateDisplay(display, first, last, displayFrame, budget)) {
+                displayFrame.display = &display;
+                displayFrame.listChanges = DisplayElement::getListChanges();
+                return false;
+            }
+            displayFrame.started = false;
         }
-        displayElement.draw();
+        first = last;
     }
-    if (previousDisplay)
-        previousDisplay->display();
+    displayFrame = {};
+    return true;
 }
 
 Control_Surface_ &Control_Surface = Control_Surface_::getInstance();
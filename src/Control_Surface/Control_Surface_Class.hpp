@@ -5,6 +5,8 @@
 #include <AH/Containers/Updatable.hpp>
 #include <AH/Hardware/FilteredAnalog.hpp>
 #include <AH/Timing/MillisMicrosTimer.hpp>
+#include <Control_Surface/LoopProfiler.hpp>
+#include <Control_Surface/LoopScheduler.hpp>
 #include <Display/DisplayElement.hpp>
 #include <Display/DisplayInterface.hpp>
 #include <MIDI_Interfaces/MIDI_Interface.hpp>
@@ -59,9 +61,23 @@ class Control_Surface_ : public MIDI_Sender<Control_Surface_>,
 
     /**
      * @brief   Update all MIDI elements, send MIDI events and read MIDI input.
+     *
+     * The order of the different stages, and the amount of MIDI input and
+     * display updates that is handled per loop, are determined by the
+     * @ref getScheduler "scheduler".
      */
     void loop();
 
+    /// Get the scheduler that determines the order and the budgets of the
+    /// stages of @ref loop.
+    LoopScheduler &getScheduler() { return scheduler; }
+
+#ifdef AH_PROFILING
+    /// Get the profiler that measures the timing of @ref loop. Nothing is
+    /// measured until it is started using LoopProfiler::start.
+    LoopProfiler &getProfiler() { return profiler; }
+#endif
+
     /**
      * @brief   Connect Control Surface to the default MIDI interface.
      */
@@ -96,10 +112,34 @@ class Control_Surface_ : public MIDI_Sender<Control_Surface_>,
     void updateInputs();
 
     /** 
-     * @brief   Clear, draw and display all displays.
+     * @brief   Redraw and display the parts of all displays that changed.
+     * 
+     * @see     DisplayElement::getDirty
+     * @see     DisplayElement::getBounds
      */
     void updateDisplays();
 
+    /**
+     * @brief   Redraw and display the parts of all displays that changed, but
+     *          stop when the given budget is exhausted.
+     *
+     * The next call continues where the previous one left off.
+     *
+     * @retval  true
+     *          All displays are up to date.
+     * @retval  false
+     *          The frame is not finished yet, call this function again.
+     */
+    bool updateDisplays(AH::WorkBudget &budget);
+
+  private:
+    /// Run a single stage of @ref loop.
+    void runStage(LoopStage stage);
+#ifdef AH_PROFILING
+    /// Run all stages of @ref loop and measure how long they take.
+    void profiledLoop();
+#endif
+
   private:
     /**
      * @brief   Low-level function for sending a 3-byte MIDI message.
@@ -114,6 +154,11 @@ class Control_Surface_ : public MIDI_Sender<Control_Surface_>,
      * @brief   Low-level function for sending a system exclusive MIDI message.
      */
     void sendImpl(const uint8_t *data, size_t length, uint8_t cn);
+    /**
+     * @brief   Low-level function for sending a chunk of a long system
+     *          exclusive MIDI message.
+     */
+    void sendChunkImpl(const uint8_t *data, size_t length, uint8_t cn);
 
     /** 
      * @brief   Low-level function for sending a single-byte MIDI message.
@@ -130,6 +175,31 @@ class Control_Surface_ : public MIDI_Sender<Control_Surface_>,
     Timer<micros> potentiometerTimer = {AH::FILTERED_INPUT_UPDATE_INTERVAL};
     /// A timer to know when to refresh the displays.
     Timer<micros> displayTimer = {1000000UL / MAX_FPS};
+    /// Whether the displays were interrupted during the previous loop.
+    bool displayFramePending = false;
+    /// Where to continue drawing the displays after an interruption.
+    struct DisplayFrame {
+        /// The display to continue with. The elements are sorted by the
+        /// address of their display, so all displays with a lower address are
+        /// up to date.
+        const DisplayInterface *display = nullptr;
+        /// Whether drawing the current display has started.
+        bool started = false;
+        /// Whether the current display has to be redrawn entirely.
+        bool redrawAll = false;
+        /// The number of elements of the current display that were handled.
+        uint16_t element = 0;
+        /// The region of the current display that has to be redrawn.
+        PixelRegion dirty = {0, 0, 0, 0};
+        /// DisplayElement::getListChanges() when the frame was interrupted.
+        uint16_t listChanges = 0;
+    } displayFrame;
+    /// Determines the order and the budgets of the stages of @ref loop.
+    LoopScheduler scheduler;
+#ifdef AH_PROFILING
+    /// Collects timing statistics of @ref loop.
+    LoopProfiler profiler;
+#endif
 
   public:
     /// @name MIDI Input Callbacks
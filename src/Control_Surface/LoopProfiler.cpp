@@ -0,0 +1,70 @@
+#include "LoopProfiler.hpp"
+#include <AH/PrintStream/PrintStream.hpp>
+
+BEGIN_CS_NAMESPACE
+
+void LoopProfiler::start() {
+    loopStats.reset();
+    for (auto &stats : stageStats)
+        stats.reset();
+    numUpdatables = 0;
+    AH::LatencyProbe::start();
+    running = true;
+}
+
+void LoopProfiler::stop() {
+    AH::LatencyProbe::stop();
+    running = false;
+}
+
+const AH::TimingStats *
+LoopProfiler::getUpdatableStats(const AH::Updatable<> &updatable) const {
+    for (uint8_t i = 0; i < numUpdatables; ++i)
+        if (updatableStats[i].updatable == &updatable)
+            return &updatableStats[i].stats;
+    return nullptr;
+}
+
+void LoopProfiler::addUpdatable(const AH::Updatable<> &updatable,
+                                unsigned long duration) {
+    uint8_t i = 0;
+    while (i < numUpdatables && updatableStats[i].updatable != &updatable)
+        ++i;
+    if (i == numUpdatables) {
+        if (numUpdatables == LOOP_PROFILER_MAX_UPDATABLES)
+            return; // No more room
+        updatableStats[numUpdatables++] = {&updatable, {}};
+    }
+    updatableStats[i].stats.add(duration);
+}
+
+template <class Stream>
+static Stream &printLoopProfiler(Stream &os, const LoopProfiler &profiler) {
+    os << F("Loop: ") << profiler.getLoopStats() << "\r\n";
+    for (uint8_t i = 0; i < LoopScheduler::NumStages; ++i) {
+        LoopStage stage = LoopStage(i);
+        os << LoopScheduler::getName(stage) << F(": ")
+           << profiler.getStageStats(stage) << "\r\n";
+    }
+    unsigned i = 0;
+    AH::Updatable<>::forEach([&](const AH::Updatable<> &updatable) {
+        auto stats = profiler.getUpdatableStats(updatable);
+        if (stats != nullptr)
+            os << F("  Updatable ") << i << F(": ") << *stats << "\r\n";
+        ++i;
+    });
+    os << F("Latency: ") << profiler.getLatencyStats() << "\r\n";
+    return os;
+}
+
+Print &operator<<(Print &os, const LoopProfiler &profiler) {
+    return printLoopProfiler(os, profiler);
+}
+
+#ifndef ARDUINO
+std::ostream &operator<<(std::ostream &os, const LoopProfiler &profiler) {
+    return printLoopProfiler(os, profiler);
+}
+#endif
+
+END_CS_NAMESPACE
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <AH/Containers/Updatable.hpp>
+#include <AH/Timing/LatencyProbe.hpp>
+#include <AH/Timing/TimingStats.hpp>
+#include <Control_Surface/LoopScheduler.hpp>
+#include <Settings/SettingsWrapper.hpp>
+
+BEGIN_CS_NAMESPACE
+
+/**
+ * @brief   Collects timing statistics of Control_Surface_::loop.
+ *
+ * It measures how long each iteration of the loop takes, how long each of its
+ * stages takes, how long the update of each Updatable takes (for the first
+ * @ref LOOP_PROFILER_MAX_UPDATABLES of them), and the latency between a
+ * button edge in AH::Button::update and the MIDI message it causes, sent by
+ * Control_Surface_::sendImpl (see AH::LatencyProbe). Button edges that don't
+ * cause a MIDI message in the same iteration of the loop are ignored.
+ *
+ * The profiler is only available if `AH_PROFILING` is defined. It has to be
+ * started explicitly, e.g. `Control_Surface.getProfiler().start()` in the
+ * setup, until then, the loop runs without any measurements. The statistics
+ * can be printed using `DEBUG_OUT << Control_Surface.getProfiler()`.
+ *
+ * @ingroup ControlSurfaceModule
+ */
+class LoopProfiler {
+  public:
+    /// Reset all statistics and start measuring.
+    void start();
+    /// Stop measuring.
+    void stop();
+    /// Check whether the profiler is measuring.
+    bool isRunning() const { return running; }
+
+    /// Statistics of the duration of the entire loop.
+    const AH::TimingStats &getLoopStats() const { return loopStats; }
+    /// Statistics of the duration of the given stage.
+    const AH::TimingStats &getStageStats(LoopStage stage) const {
+        return stageStats[uint8_t(stage)];
+    }
+    /// Statistics of the duration of updating the given Updatable, or
+    /// `nullptr` if it wasn't measured.
+    const AH::TimingStats *
+    getUpdatableStats(const AH::Updatable<> &updatable) const;
+    /// Statistics of the latency between button edges and MIDI output.
+    const AH::TimingStats &getLatencyStats() const {
+        return AH::LatencyProbe::getStats();
+    }
+
+    /// @name   Measurements
+    /// Called by Control_Surface_::loop.
+    /// @{
+
+    /// Add a measurement of the duration of the entire loop.
+    void addLoop(unsigned long duration) { loopStats.add(duration); }
+    /// Add a measurement of the duration of the given stage.
+    void addStage(LoopStage stage, unsigned long duration) {
+        stageStats[uint8_t(stage)].add(duration);
+    }
+    /// Add a measurement of the duration of updating the given Updatable.
+    void addUpdatable(const AH::Updatable<> &updatable,
+                      unsigned long duration);
+
+    /// @}
+
+  private:
+    bool running = false;
+    AH::TimingStats loopStats;
+    AH::TimingStats stageStats[LoopScheduler::NumStages];
+    struct UpdatableStats {
+        const AH::Updatable<> *updatable;
+        AH::TimingStats stats;
+    } updatableStats[LOOP_PROFILER_MAX_UPDATABLES];
+    uint8_t numUpdatables = 0;
+};
+
+/**
+ * @brief   Print a report of all statistics: one line for the entire loop,
+ *          one line per stage, one line per Updatable (numbered in the order
+ *          they're updated), and one line for the latency.
+ *
+ * @related LoopProfiler
+ */
+Print &operator<<(Print &os, const LoopProfiler &profiler);
+
+#ifndef ARDUINO
+/// @copydoc operator<<(Print &, const LoopProfiler &)
+std::ostream &operator<<(std::ostream &os, const LoopProfiler &profiler);
+#endif
+
+END_CS_NAMESPACE
@@ -0,0 +1,42 @@
+#include "LoopScheduler.hpp"
+
+BEGIN_CS_NAMESPACE
+
+LoopScheduler::LoopScheduler() {
+    for (uint8_t i = 0; i < NumStages; ++i) {
+        priorities[i] = 10 * i;
+        order[i] = LoopStage(i);
+    }
+}
+
+void LoopScheduler::setPriority(LoopStage stage, uint8_t priority) {
+    priorities[uint8_t(stage)] = priority;
+    // Insertion sort by priority, ties are sorted by the default order
+    auto before = [this](LoopStage a, LoopStage b) {
+        return getPriority(a) < getPriority(b) ||
+               (getPriority(a) == getPriority(b) && a < b);
+    };
+    for (uint8_t i = 1; i < NumStages; ++i) {
+        LoopStage s = order[i];
+        uint8_t j = i;
+        for (; j > 0 && before(s, order[j - 1]); --j)
+            order[j] = order[j - 1];
+        order[j] = s;
+    }
+}
+
+FlashString_t LoopScheduler::getName(LoopStage stage) {
+    switch (stage) {
+        case LoopStage::BufferedInputs: return F("BufferedInputs");
+        case LoopStage::Updatables: return F("Updatables");
+        case LoopStage::Potentiometers: return F("Potentiometers");
+        case LoopStage::MIDIInput: return F("MIDIInput");
+        case LoopStage::InputElements: return F("InputElements");
+        case LoopStage::BufferedOutputs: return F("BufferedOutputs");
+        case LoopStage::MIDIFlush: return F("MIDIFlush");
+        case LoopStage::Displays: return F("Displays");
+        default: return F("<invalid>"); // Keeps the compiler happy
+    }
+}
+
+END_CS_NAMESPACE
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <AH/Arduino-Wrapper.h> // FlashString_t
+#include <AH/Timing/WorkBudget.hpp>
+#include <Settings/SettingsWrapper.hpp>
+
+BEGIN_CS_NAMESPACE
+
+/**
+ * @brief   The stages of Control_Surface_::loop, in their default order.
+ *
+ * @ingroup ControlSurfaceModule
+ */
+enum class LoopStage : uint8_t {
+    BufferedInputs, ///< Read the inputs of all ExtendedIOElement%s.
+    Updatables,     ///< Update buttons, encoders, etc. and send MIDI.
+    Potentiometers, ///< Update the potentiometers (at a fixed rate).
+    MIDIInput,      ///< Handle the incoming MIDI messages.
+    InputElements,  ///< Update the MIDIInputElement%s.
+    BufferedOutputs, ///< Write the outputs of all ExtendedIOElement%s.
+    MIDIFlush,       ///< Send the buffered outgoing MIDI messages.
+    Displays,        ///< Draw the display elements and update the displays.
+};
+
+/**
+ * @brief   Determines the order of the stages of Control_Surface_::loop, and
+ *          how much work the stages that can be interrupted may do per loop.
+ *
+ * Each stage has a priority: stages with a lower priority value run first,
+ * stages with the same priority run in their default order (see LoopStage).
+ * By default, the priority of each stage is ten times its index, so the
+ * stages run in the default order, and there's room to put stages in between.
+ *
+ * The MIDI input and display stages can be interrupted when their budget is
+ * exhausted, they continue where they left off during the next loop:
+ *
+ *  - MIDI input is interrupted between two incoming messages. The MIDI
+ *    interfaces take turns, so a busy interface can't delay the messages on
+ *    the other ones (see MIDI_Interface::updateAllWithBudget).
+ *  - Displays are interrupted between drawing two display elements, or before
+ *    writing a frame to a display. A frame is never written to a display
+ *    before all of its elements have been drawn.
+ *
+ * The input elements stage also refreshes the BankableMIDIInput%s after a
+ * bank change, which is interrupted between two elements when its budget is
+ * exhausted (see InputBankRefresher).
+ *
+ * All other stages are short and always run to completion.
+ *
+ * @ingroup ControlSurfaceModule
+ */
+class LoopScheduler {
+  public:
+    /// The number of stages.
+    constexpr static uint8_t NumStages = uint8_t(LoopStage::Displays) + 1;
+
+    LoopScheduler();
+
+    /// Set the priority of the given stage: stages with lower values run
+    /// first.
+    void setPriority(LoopStage stage, uint8_t priority);
+    /// Get the priority of the given stage.
+    uint8_t getPriority(LoopStage stage) const {
+        return priorities[uint8_t(stage)];
+    }
+
+    /// The budget for handling incoming MIDI messages during one loop. One
+    /// item is one message.
+    AH::WorkBudget &getMIDIInputBudget() { return midiInputBudget; }
+    /// The budget for updating the displays during one loop. One item is
+    /// drawing one display element, or writing to one display.
+    AH::WorkBudget &getDisplayBudget() { return displayBudget; }
+    /// The budget for refreshing BankableMIDIInput%s after a bank change
+    /// during one loop, as part of the input elements stage. One item is one
+    /// BankableMIDIInput.
+    AH::WorkBudget &getBankRefreshBudget() { return bankRefreshBudget; }
+
+    /// Get the name of the given stage.
+    static FlashString_t getName(LoopStage stage);
+
+    /// Iterate over the stages in the order they run.
+    const LoopStage *begin() const { return order; }
+    /// @copydoc begin
+    const LoopStage *end() const { return order + NumStages; }
+
+  private:
+    uint8_t priorities[NumStages];
+    LoopStage order[NumStages];
+    AH::WorkBudget midiInputBudget = {
+        MIDI_INPUT_MAX_MESSAGES_PER_LOOP,
+        MIDI_INPUT_MAX_MICROS_PER_LOOP,
+    };
+    AH::WorkBudget displayBudget = {
+        DISPLAY_MAX_ITEMS_PER_LOOP,
+        DISPLAY_MAX_MICROS_PER_LOOP,
+    };
+    AH::WorkBudget bankRefreshBudget = {
+        BANK_REFRESH_MAX_ITEMS_PER_LOOP,
+        BANK_REFRESH_MAX_MICROS_PER_LOOP,
+    };
+};
+
+END_CS_NAMESPACE
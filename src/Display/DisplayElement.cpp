@@ -3,5 +3,6 @@
 BEGIN_CS_NAMESPACE
 
 DoublyLinkedList<DisplayElement> DisplayElement::elements;
+uint16_t DisplayElement::listChanges = 0;
 
 END_CS_NAMESPACE
\ No newline at end of file
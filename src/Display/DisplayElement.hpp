@@ -24,14 +24,38 @@ class DisplayElement : public DoublyLinkable<DisplayElement> {
             this, [](const DisplayElement &lhs, const DisplayElement &rhs) {
                 return &lhs.getDisplay() < &rhs.getDisplay();
             });
+        ++listChanges;
     }
 
   public:
-    virtual ~DisplayElement() { elements.remove(this); }
+    virtual ~DisplayElement() {
+        elements.remove(this);
+        ++listChanges;
+    }
 
     /// Draw this DisplayElement to the display buffer.
     virtual void draw() = 0;
 
+    /**
+     * @brief   Check whether this element has changed since it was last
+     *          drawn.
+     * 
+     * Elements that are not dirty are not redrawn, and if none of the 
+     * elements of a display are dirty, the display is not updated at all.
+     * Elements that can't tell whether they changed are always dirty.
+     */
+    virtual bool getDirty() { return true; }
+
+    /**
+     * @brief   Get the region of the display this element draws to.
+     * 
+     * When an element is dirty, only its region of the display is cleared,
+     * redrawn and written to the display. Elements that can't tell where they
+     * draw return PixelRegion::everything(), which causes the entire display 
+     * to be redrawn when they're dirty.
+     */
+    virtual PixelRegion getBounds() const { return PixelRegion::everything(); }
+
     /// Get a reference to the display that this element draws to.
     DisplayInterface &getDisplay() { return display; }
     /// Get a const reference to the display that this element draws to.
@@ -39,11 +63,23 @@ class DisplayElement : public DoublyLinkable<DisplayElement> {
 
     /// Get the list of all DisplayElement instances.
     static DoublyLinkedList<DisplayElement> &getAll() { return elements; }
+    /// Get the number of times an element was added to or removed from the
+    /// list of all instances (wraps around).
+    static uint16_t getListChanges() { return listChanges; }
+
+  protected:
+    /// Get the region occupied by the given number of characters of text
+    /// with the default 6×8 pixel font.
+    static PixelRegion getTextBounds(int16_t x, int16_t y, uint8_t chars,
+                                     uint8_t size) {
+        return {x, y, int16_t(6 * size * chars), int16_t(8 * size)};
+    }
 
   protected:
     DisplayInterface &display;
 
     static DoublyLinkedList<DisplayElement> elements;
+    static uint16_t listChanges;
 };
 
 END_CS_NAMESPACE
\ No newline at end of file
@@ -1,11 +1,53 @@
 #pragma once
 
 #include <AH/Containers/LinkedList.hpp>
+#include <AH/STL/cstdint>
 #include <Def/Def.hpp>
 #include <Print.h>
 
 BEGIN_CS_NAMESPACE
 
+/// A rectangular region of a display, in pixels.
+struct PixelRegion {
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+
+    /// A region that covers the entire display, no matter its size.
+    static PixelRegion everything() {
+        return {INT16_MIN / 2, INT16_MIN / 2, INT16_MAX, INT16_MAX};
+    }
+    /// Check whether this region covers the entire display.
+    bool isEverything() const { return *this == everything(); }
+
+    /// Check whether this region contains any pixels.
+    bool isEmpty() const { return w <= 0 || h <= 0; }
+
+    /// Check whether this region and the given region have pixels in common.
+    bool intersects(const PixelRegion &other) const {
+        return x < other.x + other.w && other.x < x + w && //
+               y < other.y + other.h && other.y < y + h;
+    }
+
+    /// Get the smallest region that contains both this region and the given
+    /// region.
+    PixelRegion operator|(const PixelRegion &other) const {
+        if (isEverything() || other.isEverything())
+            return everything();
+        int16_t left = x < other.x ? x : other.x;
+        int16_t top = y < other.y ? y : other.y;
+        int16_t right = x + w > other.x + other.w ? x + w : other.x + other.w;
+        int16_t bottom = y + h > other.y + other.h ? y + h : other.y + other.h;
+        return {left, top, int16_t(right - left), int16_t(bottom - top)};
+    }
+
+    bool operator==(const PixelRegion &o) const {
+        return x == o.x && y == o.y && w == o.w && h == o.h;
+    }
+    bool operator!=(const PixelRegion &o) const { return !(*this == o); }
+};
+
 /**
  * @brief   An interface for displays. 
  * 
@@ -34,6 +76,17 @@ class DisplayInterface : public Print, public DoublyLinkable<DisplayInterface> {
     /// Write the frame buffer to the display.
     virtual void display() = 0;
 
+    /// Clear the given region of the frame buffer.
+    virtual void clearRegion(const PixelRegion &region) {
+        fillRect(region.x, region.y, region.w, region.h, 0);
+    }
+    /// Write (at least) the given region of the frame buffer to the display.
+    /// By default, the entire frame buffer is written.
+    virtual void displayRegion(const PixelRegion &region) {
+        (void)region;
+        display();
+    }
+
     /// Paint a single pixel with the given color.
     virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
 
@@ -2,6 +2,7 @@
 
 #include <Adafruit_SSD1306.h>
 #include <Display/DisplayInterface.hpp>
+#include <SPI.h>
 
 BEGIN_CS_NAMESPACE
 
@@ -19,6 +20,90 @@ class SSD1306_DisplayInterface : public DisplayInterface {
     void drawBackground() override = 0;
     void display() override { disp.display(); }
 
+    void clearRegion(const PixelRegion &region) override {
+        disp.fillRect(region.x, region.y, region.w, region.h, BLACK);
+    }
+    /// Only write the pages (groups of 8 rows) that overlap with the given
+    /// region.
+    void displayRegion(const PixelRegion &region) override {
+        // Rows of the frame buffer, which is not affected by the rotation
+        int16_t height = getBufferHeight();
+        int16_t top, bottom;
+        switch (disp.getRotation()) {
+            case 0:
+                top = region.y;
+                bottom = region.y + region.h;
+                break;
+            case 1: // The x axis runs down the frame buffer
+                top = region.x;
+                bottom = region.x + region.w;
+                break;
+            case 2: // The y axis runs up the frame buffer
+                top = height - region.y - region.h;
+                bottom = height - region.y;
+                break;
+            default: // The x axis runs up the frame buffer
+                top = height - region.x - region.w;
+                bottom = height - region.x;
+                break;
+        }
+        if (top < 0)
+            top = 0;
+        if (bottom > height)
+            bottom = height;
+        if (top >= bottom)
+            return;
+        displayPages(top / 8, (bottom - 1) / 8);
+    }
+
+    /**
+     * @brief   Write the given range of pages of the frame buffer to the
+     *          display.
+     * 
+     * The SSD1306_DisplayInterface has no access to the I²C or SPI bus of the
+     * display, so by default, this function writes the entire frame buffer.
+     * Use SSD1306_I2C_DisplayInterface or SSD1306_SPI_DisplayInterface to
+     * transfer only the given pages.
+     * 
+     * @param   firstPage
+     *          The first page to write (inclusive).
+     * @param   lastPage
+     *          The last page to write (inclusive).
+     */
+    virtual void displayPages(uint8_t firstPage, uint8_t lastPage) {
+        (void)firstPage, (void)lastPage;
+        display();
+    }
+
+  protected:
+    /// Get the width of the frame buffer in pixels (i.e. the number of bytes
+    /// per page), regardless of the rotation.
+    int16_t getBufferWidth() const {
+        return disp.getRotation() & 1 ? disp.height() : disp.width();
+    }
+    /// Get the height of the frame buffer in pixels, regardless of the
+    /// rotation.
+    int16_t getBufferHeight() const {
+        return disp.getRotation() & 1 ? disp.width() : disp.height();
+    }
+
+    /// Select the given range of pages (and all columns), so the next
+    /// `getBufferWidth()` bytes of display data per page are written to them.
+    void setPageAddresses(uint8_t firstPage, uint8_t lastPage) {
+        disp.ssd1306_command(SSD1306_PAGEADDR);
+        disp.ssd1306_command(firstPage);
+        disp.ssd1306_command(lastPage);
+        disp.ssd1306_command(SSD1306_COLUMNADDR);
+        disp.ssd1306_command(0);
+        disp.ssd1306_command(getBufferWidth() - 1);
+    }
+
+    /// Get a pointer to the start of the given page in the frame buffer.
+    const uint8_t *getPage(uint8_t page) {
+        return disp.getBuffer() + page * getBufferWidth();
+    }
+
+  public:
     void drawPixel(int16_t x, int16_t y, uint16_t color) override {
         disp.drawPixel(x, y, color);
     }
@@ -51,4 +136,102 @@ class SSD1306_DisplayInterface : public DisplayInterface {
     Adafruit_SSD1306 &disp;
 };
 
+/**
+ * @brief   SSD1306_DisplayInterface for displays that are connected over I²C.
+ *          Only the pages that changed are written to the display.
+ * 
+ * @tparam  WireType
+ *          The type of the `Wire` I²C driver to use.
+ */
+template <class WireType>
+class SSD1306_I2C_DisplayInterface : public SSD1306_DisplayInterface {
+  protected:
+    /**
+     * @param   display
+     *          The display driver.
+     * @param   wire
+     *          The I²C interface the display is connected to, e.g. `Wire`.
+     * @param   address
+     *          The I²C address of the display.
+     */
+    SSD1306_I2C_DisplayInterface(Adafruit_SSD1306 &display, WireType &wire,
+                                 uint8_t address = SSD1306_I2C_ADDRESS)
+        : SSD1306_DisplayInterface(display), wire(&wire), address(address) {}
+
+  public:
+    void displayPages(uint8_t firstPage, uint8_t lastPage) override {
+        setPageAddresses(firstPage, lastPage);
+        const uint8_t *data = getPage(firstPage);
+        uint16_t remaining = (lastPage - firstPage + 1) * getBufferWidth();
+        while (remaining > 0) {
+            uint8_t length = remaining < MAX_DATA_LENGTH //
+                                 ? remaining
+                                 : MAX_DATA_LENGTH;
+            wire->beginTransmission(address);
+            wire->write(uint8_t(0x40)); // Co = 0, D/C# = 1: data bytes follow
+            wire->write(data, length);
+            wire->endTransmission();
+            data += length;
+            remaining -= length;
+        }
+    }
+
+    /// The maximum number of data bytes per I²C transmission. The `Wire`
+    /// library has a buffer of 32 bytes on most boards, one of which is used
+    /// for the control byte.
+    constexpr static uint8_t MAX_DATA_LENGTH = 31;
+
+  private:
+    WireType *wire;
+    uint8_t address;
+};
+
+/**
+ * @brief   SSD1306_DisplayInterface for displays that are connected over SPI.
+ *          Only the pages that changed are written to the display.
+ */
+class SSD1306_SPI_DisplayInterface : public SSD1306_DisplayInterface {
+  protected:
+    /**
+     * @param   display
+     *          The display driver.
+     * @param   spi
+     *          The SPI interface the display is connected to, e.g. `SPI`.
+     * @param   dcPin
+     *          The data/command pin of the display.
+     * @param   csPin
+     *          The chip select pin of the display.
+     * @param   settings
+     *          The SPI settings to use for the data transfers.
+     */
+    SSD1306_SPI_DisplayInterface(Adafruit_SSD1306 &display, SPIClass &spi,
+                                 uint8_t dcPin, uint8_t csPin,
+                                 SPISettings settings = {8000000, MSBFIRST,
+                                                         SPI_MODE0})
+        : SSD1306_DisplayInterface(display), spi(&spi), dcPin(dcPin),
+          csPin(csPin), settings(settings) {}
+
+  public:
+    void displayPages(uint8_t firstPage, uint8_t lastPage) override {
+        setPageAddresses(firstPage, lastPage);
+        const uint8_t *data = getPage(firstPage);
+        uint16_t length = (lastPage - firstPage + 1) * getBufferWidth();
+        spi->beginTransaction(settings);
+        digitalWrite(dcPin, HIGH); // Data mode
+        digitalWrite(csPin, LOW);
+        // Send the bytes one by one: a bulk transfer would overwrite the
+        // frame buffer with the received data.
+        for (uint16_t i = 0; i < length; ++i)
+            spi->transfer(data[i]);
+        digitalWrite(csPin, HIGH);
+        spi->endTransaction();
+    }
+
+  private:
+    SPIClass *spi;
+    uint8_t dcPin;
+    uint8_t csPin;
+    SPISettings settings;
+};
+
 END_CS_NAMESPACE
\ No newline at end of file
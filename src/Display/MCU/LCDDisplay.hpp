@@ -67,27 +67,29 @@ class LCDDisplay : public DisplayElement {
                const OutputBank &bank, uint8_t track, uint8_t line,
                PixelLocation loc, uint8_t textSize, uint16_t color)
         : DisplayElement(display), lcd(lcd), bank(bank), offset(track - 1),
-          line(line), x(loc.x), y(loc.y), size(textSize), color(color) {}
+          line(line > 1 ? 1 : line), x(loc.x), y(loc.y), size(textSize),
+          color(color) {}
 
     void draw() override {
+        getText(drawnText);
         // If it's a message across all tracks, don't display anything.
-        if (!separateTracks())
+        if (drawnText[0] == '\0')
             return;
-        // Extract the six-character substring for this track.
-        uint8_t trackoffset = bank.getOffset() + offset;
-        if (trackoffset > 7) // TODO
-            trackoffset = 7;
-        if (line > 1) // TODO
-            line = 1;
-        const char *text = lcd.getText() + 7 * trackoffset + 56 * line;
-        char buffer[7];
-        strncpy(buffer, text, 6);
-        buffer[6] = '\0';
         // Print it to the display
         display.setCursor(x, y);
         display.setTextSize(size);
         display.setTextColor(color);
-        display.print(buffer);
+        display.print(drawnText);
+    }
+
+    bool getDirty() override {
+        char buffer[7];
+        getText(buffer);
+        return strcmp(buffer, drawnText) != 0;
+    }
+
+    PixelRegion getBounds() const override {
+        return getTextBounds(x, y, 6, size);
     }
 
     /**
@@ -116,7 +118,22 @@ class LCDDisplay : public DisplayElement {
         return true;
     }
 
-    void setLine(uint8_t line) { this->line = line; }
+    void setLine(uint8_t line) { this->line = line > 1 ? 1 : line; }
+
+  private:
+    /// Extract the six-character substring for this track, or an empty string
+    /// if it's a message across all tracks.
+    void getText(char (&buffer)[7]) const {
+        buffer[0] = '\0';
+        if (!separateTracks())
+            return;
+        uint8_t trackoffset = bank.getOffset() + offset;
+        if (trackoffset > 7) // TODO
+            trackoffset = 7;
+        const char *text = lcd.getText() + 7 * trackoffset + 56 * line;
+        strncpy(buffer, text, 6);
+        buffer[6] = '\0';
+    }
 
   private:
     const MCU::LCD<> &lcd;
@@ -126,6 +143,7 @@ class LCDDisplay : public DisplayElement {
     int16_t x, y;
     uint8_t size;
     uint16_t color;
+    char drawnText[7] = {'\xFF', '\0'};
 };
 
 } // namespace MCU
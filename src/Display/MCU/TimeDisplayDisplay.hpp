@@ -3,6 +3,7 @@
 #include <Display/DisplayElement.hpp>
 #include <Display/DisplayInterface.hpp>
 #include <MIDI_Inputs/MCU/TimeDisplay.hpp>
+#include <stdio.h> // snprintf
 
 BEGIN_CS_NAMESPACE
 
@@ -21,15 +22,18 @@ class TimeDisplayDisplay : public DisplayElement {
         display.setTextSize(size);
         display.setCursor(x, y);
 
-        char barStr[6], beatStr[3], frameStr[4];
-        timedisplay.getBars(barStr);
-        timedisplay.getBeats(beatStr);
-        timedisplay.getFrames(frameStr);
-        display.print(barStr);
-        display.print(' ');
-        display.print(beatStr);
-        display.print(' ');
-        display.print(frameStr);
+        getText(drawnText);
+        display.print(drawnText);
+    }
+
+    bool getDirty() override {
+        char text[TextLength + 1];
+        getText(text);
+        return strcmp(text, drawnText) != 0;
+    }
+
+    PixelRegion getBounds() const override {
+        return getTextBounds(x, y, TextLength, size);
     }
 
     int16_t getX() const { return x; }
@@ -43,10 +47,22 @@ class TimeDisplayDisplay : public DisplayElement {
     void setColor(uint16_t color) { this->color = color; }
 
   private:
+    /// "bars beats frames", e.g. "  1  1  1"
+    constexpr static uint8_t TextLength = 5 + 1 + 2 + 1 + 3;
+
+    void getText(char *text) const {
+        char barStr[6], beatStr[3], frameStr[4];
+        timedisplay.getBars(barStr);
+        timedisplay.getBeats(beatStr);
+        timedisplay.getFrames(frameStr);
+        snprintf(text, TextLength + 1, "%s %s %s", barStr, beatStr, frameStr);
+    }
+
     const TimeDisplay &timedisplay;
     int16_t x, y;
     uint8_t size;
     uint16_t color;
+    char drawnText[TextLength + 1] = {'\xFF', '\0'};
 };
 
 } // namespace MCU
@@ -18,6 +18,7 @@ class VPotDisplay : public DisplayElement {
           y(loc.y + radius), radius(radius), innerRadius(innerRadius),
           color(color) {}
     void draw() override {
+        drawnState = getState();
         display.drawCircle(x, y, radius, color);
         if (vpot.getCenterLed())
             display.fillCircle(x, y, innerRadius / 4, color);
@@ -29,11 +30,25 @@ class VPotDisplay : public DisplayElement {
             drawVPotSegment(segment);
     }
 
+    bool getDirty() override { return getState() != drawnState; }
+
+    PixelRegion getBounds() const override {
+        return {int16_t(x - radius), int16_t(y - radius),
+                int16_t(2 * radius + 1), int16_t(2 * radius + 1)};
+    }
+
   private:
+    /// Everything that determines what the V-Pot looks like.
+    uint16_t getState() {
+        return vpot.getStartOn() | (vpot.getStartOff() << 4) |
+               (vpot.getCenterLed() << 8);
+    }
+
     IVPotRing &vpot;
 
     int16_t x, y;
     uint16_t radius, innerRadius, color;
+    uint16_t drawnState = 0xFFFF;
 
     const static float angleSpacing;
 
@@ -19,13 +19,36 @@ class VUDisplay : public DisplayElement {
                         ? VU_PEAK_DECAY_TIME / (blockheight + spacing)
                         : VU_PEAK_DECAY_TIME) {}
 
+    /// Draw the VU meter, this is the only place where the peak is updated.
     void draw() override {
         uint8_t value = vu.getValue();
-        updatePeak(value);
+        unsigned long now = millis();
+        Peak newPeak = getPeak(value, now);
+        int16_t peak = getDecayedPeak(newPeak, now);
         if (peak > 0) {
             drawPeak(peak);
             drawBlocks(value);
         }
+        this->peak = newPeak;
+        drawnValue = value;
+        drawnPeak = peak;
+    }
+
+    /// The VU meter is dirty when its value changes, or when the peak bar
+    /// decays.
+    bool getDirty() override {
+        uint8_t value = vu.getValue();
+        unsigned long now = millis();
+        return value != drawnValue ||
+               getDecayedPeak(getPeak(value, now), now) != drawnPeak;
+    }
+
+    PixelRegion getBounds() const override {
+        // From the highest possible peak bar to the bottom of the first block
+        int16_t top = y - spacing + blockheight -
+                      vu.getMax() * (blockheight + spacing);
+        int16_t bottom = y + blockheight;
+        return {x, top, int16_t(width), int16_t(bottom - top)};
     }
 
   protected:
@@ -46,22 +69,42 @@ class VUDisplay : public DisplayElement {
     }
 
   private:
-    void updatePeak(uint8_t value) {
-        int16_t newPeak = (int16_t)value * (blockheight + spacing);
-        if (newPeak >= peak) {
-            peak = newPeak;
-            previousDecay = millis();
-            decaying = false;
-        } else if (!decaying &&
-                   (millis() - previousDecay > VU_PEAK_HOLD_TIME)) {
-            decaying = true;
-            previousDecay += VU_PEAK_HOLD_TIME - decayTime;
-        } else if (decaying && (millis() - previousDecay > decayTime)) {
-            if (peak > 0) {
-                peak -= VU_PEAK_SMOOTH_DECAY ? 1 : (blockheight + spacing);
-                previousDecay += decayTime;
-            }
-        }
+    /// The height of the peak bar, and the time it was last pushed up.
+    struct Peak {
+        int16_t height;
+        unsigned long time;
+    };
+
+    int16_t getHeight(uint8_t value) const {
+        return int16_t(value) * (blockheight + spacing);
+    }
+
+    /// Get the height of the peak bar at the given time: it is held for
+    /// VU_PEAK_HOLD_TIME, and then it decays by one step per decay time.
+    int16_t getDecayedPeak(Peak peak, unsigned long now) const {
+        unsigned long elapsed = now - peak.time;
+        if (elapsed <= VU_PEAK_HOLD_TIME)
+            return peak.height;
+        unsigned long steps =
+            (elapsed - VU_PEAK_HOLD_TIME - 1) / (decayTime ? decayTime : 1) + 1;
+        if (steps >= unsigned(peak.height))
+            return 0;
+        unsigned long step = VU_PEAK_SMOOTH_DECAY ? 1 : blockheight + spacing;
+        unsigned long decay = steps * step;
+        return decay >= unsigned(peak.height) ? 0 : peak.height - decay;
+    }
+
+    /// Get the peak after the value that was drawn last and the given value.
+    /// The drawn value was shown until now, so while it wasn't lower than the
+    /// decaying peak, it pushed the peak up.
+    Peak getPeak(uint8_t value, unsigned long now) const {
+        Peak result = peak;
+        if (drawnValue != NoValue &&
+            getHeight(drawnValue) >= getDecayedPeak(result, now))
+            result = {getHeight(drawnValue), now};
+        if (getHeight(value) >= getDecayedPeak(result, now))
+            result = {getHeight(value), now};
+        return result;
     }
 
     IVU &vu;
@@ -73,11 +116,13 @@ class VUDisplay : public DisplayElement {
     uint8_t spacing;
     uint16_t color;
 
-    int16_t peak = 0;
-    unsigned long previousDecay = 0;
-    bool decaying = false;
+    Peak peak = {0, 0};
 
     unsigned long decayTime;
+
+    constexpr static uint8_t NoValue = 0xFF;
+    uint8_t drawnValue = NoValue;
+    int16_t drawnPeak = -1;
 };
 
 } // namespace MCU
@@ -100,8 +145,16 @@ class AnalogVUDisplay : public DisplayElement {
           color(color) {}
 
     void draw() override {
-        float value = vu.getFloatValue();
-        drawNeedle(theta_min + value * theta_diff);
+        drawnValue = vu.getFloatValue();
+        drawNeedle(theta_min + drawnValue * theta_diff);
+    }
+
+    bool getDirty() override { return vu.getFloatValue() != drawnValue; }
+
+    PixelRegion getBounds() const override {
+        int16_t r = ceil(sqrt(r_sq)) + 1;
+        return {int16_t(x - r), int16_t(y - r), int16_t(2 * r + 1),
+                int16_t(2 * r + 1)};
     }
 
     void drawNeedle(float angle) {
@@ -122,6 +175,7 @@ class AnalogVUDisplay : public DisplayElement {
     float theta_min;
     float theta_diff;
     uint16_t color;
+    float drawnValue = -1;
 };
 
 } // namespace MCU
@@ -15,15 +15,23 @@ class NoteBitmapDisplay : public DisplayElement {
           color(color) {}
 
     void draw() override {
-        if (note.getValue())
+        drawnState = note.getValue() != 0;
+        if (drawnState)
             display.drawXBitmap(x, y, xbm.bits, xbm.width, xbm.height, color);
     }
 
+    bool getDirty() override { return (note.getValue() != 0) != drawnState; }
+
+    PixelRegion getBounds() const override {
+        return {x, y, int16_t(xbm.width), int16_t(xbm.height)};
+    }
+
   private:
     INoteCCValue &note;
     const XBitmap &xbm;
     int16_t x, y;
     uint16_t color;
+    uint8_t drawnState = 0xFF;
 };
 
 END_CS_NAMESPACE
\ No newline at end of file
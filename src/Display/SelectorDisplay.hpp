@@ -1,5 +1,6 @@
 #pragma once
 
+#include <AH/STL/climits> // LONG_MIN
 #include <Banks/Bank.hpp>
 #include <Display/DisplayElement.hpp>
 #include <Selectors/Selector.hpp>
@@ -18,17 +19,27 @@ class SelectorDisplay : public DisplayElement {
           multiplier(multiplier), x(loc.x), y(loc.y), size(size), color(color) {
     }
     void draw() override {
+        drawnValue = getValue();
         display.setTextColor(color);
         display.setTextSize(size);
         display.setCursor(x, y);
-        display.print(selector.get() * multiplier + offset);
+        display.print(drawnValue);
+    }
+
+    bool getDirty() override { return getValue() != drawnValue; }
+
+    PixelRegion getBounds() const override {
+        return getTextBounds(x, y, 6, size); // -32768
     }
 
   private:
+    long getValue() const { return selector.get() * multiplier + offset; }
+
     SelectorBase &selector;
     int16_t offset, multiplier, x, y;
     uint8_t size;
     uint16_t color;
+    long drawnValue = LONG_MIN;
 };
 
 /**
@@ -42,17 +53,27 @@ class BankDisplay : public DisplayElement {
           y(loc.y), size(size), color(color) {}
 
     void draw() override {
+        drawnValue = getValue();
         display.setTextColor(color);
         display.setTextSize(size);
         display.setCursor(x, y);
-        display.print(bank.getOffset() + offset);
+        display.print(drawnValue);
+    }
+
+    bool getDirty() override { return getValue() != drawnValue; }
+
+    PixelRegion getBounds() const override {
+        return getTextBounds(x, y, 6, size); // -32768
     }
 
   private:
+    long getValue() const { return bank.getOffset() + offset; }
+
     OutputBank &bank;
     int16_t offset, x, y;
     uint8_t size;
     uint16_t color;
+    long drawnValue = LONG_MIN;
 };
 
 END_CS_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <AH/Hardware/ExtendedInputOutput/ExtendedInputOutput.hpp>
+#include <Def/Def.hpp>
+#include <MIDI_Inputs/MIDIClock.hpp>
+
+BEGIN_CS_NAMESPACE
+
+/**
+ * @brief   MIDI Input Element that blinks an LED in time with the MIDI Timing
+ *          Clock: the LED is on during the first part of every beat, while
+ *          the clock is running.
+ *
+ * @ingroup midi-input-elements-leds
+ */
+class MIDIClockLED : public MIDIClock {
+  public:
+    /**
+     * @brief   Constructor.
+     *
+     * @param   ledPin
+     *          The pin with the LED connected.
+     * @param   cable
+     *          The MIDI USB cable to listen to.
+     */
+    MIDIClockLED(pin_t ledPin, Cable cable = CABLE_1)
+        : MIDIClock(cable), ledPin(ledPin) {}
+
+    void begin() override {
+        AH::ExtIO::pinMode(ledPin, OUTPUT);
+        AH::ExtIO::digitalWrite(ledPin, LOW);
+    }
+
+    void update() override {
+        bool state = isRunning() && getBeatPhase() < onTime;
+        if (state != this->state) {
+            AH::ExtIO::digitalWrite(ledPin, state ? HIGH : LOW);
+            this->state = state;
+        }
+    }
+
+    /// Set the fraction of every beat that the LED is on, where 65536 is the
+    /// entire beat. The default is one quarter of a beat.
+    void setOnTime(uint16_t onTime) { this->onTime = onTime; }
+    /// Get the fraction of every beat that the LED is on.
+    uint16_t getOnTime() const { return onTime; }
+
+  private:
+    pin_t ledPin;
+    uint16_t onTime = 0x4000;
+    bool state = false;
+};
+
+END_CS_NAMESPACE
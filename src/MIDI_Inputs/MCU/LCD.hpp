@@ -47,12 +47,56 @@ class LCD : public MIDIInputElementSysEx, private LCDCounter {
         // nn = model number (10 for Logic Control, 11 for Logic Control XT)
         // oo = offset [0x00, 0x6F]
         // yy... = ASCII data
+        if (midimsg.length < 8 || midimsg.length > 8 + DisplaySize)
+            return false;
         if (midimsg.data[5] != 0x12)
             return false;
 
-        const uint8_t midiOffset = midimsg.data[6];
-        const uint8_t midiLength = midimsg.length - 8;
-        const uint8_t *text = midimsg.data + 7;
+        return updateText(midimsg.data[6], midimsg.data + 7,
+                          midimsg.length - 8);
+    }
+
+    /// Long messages are received in chunks when SysEx chunking is enabled.
+    /// With a small buffer, the header can be split over multiple chunks.
+    bool updateChunkImpl(SysExMessage chunk) override {
+        const uint8_t *text = chunk.data;
+        uint16_t length = chunk.length;
+        bool last = chunk.isLastChunk();
+        if (last)
+            --length; // SysEx end
+        if (chunk.isFirstChunk())
+            headerIndex = 0;
+        if (headerIndex == NoChunk)
+            return false;
+        // F0 mm mm mm nn 12 oo, see updateImpl
+        for (; headerIndex < HeaderSize && length > 0; ++headerIndex) {
+            if (headerIndex == 5 && *text != 0x12) {
+                headerIndex = NoChunk;
+                return false;
+            }
+            if (headerIndex == 6)
+                chunkOffset = *text;
+            ++text;
+            --length;
+        }
+        bool handled = false;
+        if (headerIndex == HeaderSize) {
+            // Ignore everything that doesn't fit on the display
+            uint8_t space =
+                chunkOffset < DisplaySize ? DisplaySize - chunkOffset : 0;
+            uint8_t textLength = length < space ? length : space;
+            handled = updateText(chunkOffset, text, textLength);
+            chunkOffset += textLength;
+        }
+        if (last)
+            headerIndex = NoChunk;
+        return handled;
+    }
+
+    /// Copy the part of the given text that falls within the range of this
+    /// LCD instance to the buffer.
+    bool updateText(uint8_t midiOffset, const uint8_t *text,
+                    uint8_t midiLength) {
         const uint8_t midiBufferEnd = midiOffset + midiLength;
 
         const uint8_t bufferEnd = this->offset + BufferSize;
@@ -91,8 +135,19 @@ class LCD : public MIDIInputElementSysEx, private LCDCounter {
         return getInstances() == 1;
     }
 
+    /// The display has 2 lines of 56 characters.
+    constexpr static uint8_t DisplaySize = 2 * 56;
+    /// The length of the header of a message, up to the offset byte.
+    constexpr static uint8_t HeaderSize = 7;
+    constexpr static uint8_t NoChunk = 0xFF;
+
     Array<char, BufferSize + 1> buffer;
     uint8_t offset;
+    /// The number of header bytes of the chunked message that have been
+    /// received, or NoChunk if no chunked message is being received.
+    uint8_t headerIndex = NoChunk;
+    /// Position of the next chunk of text on the display.
+    uint8_t chunkOffset = 0;
 };
 
 } // namespace MCU
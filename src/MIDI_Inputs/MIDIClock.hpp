@@ -0,0 +1,73 @@
+#pragma once
+
+#include <AH/Arduino-Wrapper.h> // micros
+#include <MIDI_Inputs/MIDIInputElementRealTime.hpp>
+#include <MIDI_Inputs/MIDITempoTracker.hpp>
+
+BEGIN_CS_NAMESPACE
+
+/**
+ * @brief   MIDI Input Element that follows the MIDI Timing Clock and the
+ *          transport (Start, Continue, Stop) of a MIDI clock source, e.g. a
+ *          DAW or a drum machine.
+ *
+ * The tempo and the position within the beat are estimated by a
+ * MIDITempoTracker.
+ *
+ * ~~~cpp
+ * MIDIClock clock;
+ *
+ * void loop() {
+ *     Control_Surface.loop();
+ *     if (clock.isRunning() && clock.getBeatPhase() < 0x4000)
+ *         ; // first quarter of every beat
+ * }
+ * ~~~
+ *
+ * @ingroup MIDIInputElements
+ */
+class MIDIClock : public MIDIInputElementRealTime {
+  public:
+    /**
+     * @brief   Constructor.
+     *
+     * @param   cable
+     *          The MIDI USB cable to listen to.
+     */
+    MIDIClock(Cable cable = CABLE_1) : MIDIInputElementRealTime(cable) {}
+
+    void reset() override { tracker.reset(); }
+
+    /// Get the tempo tracker, for the full set of tempo and position
+    /// information.
+    const MIDITempoTracker &getTracker() const { return tracker; }
+
+    /// @copydoc MIDITempoTracker::isRunning
+    bool isRunning() const { return tracker.isRunning(); }
+    /// @copydoc MIDITempoTracker::getBPM
+    uint16_t getBPM() const { return tracker.getBPM(); }
+    /// @copydoc MIDITempoTracker::getCentiBPM
+    uint32_t getCentiBPM() const { return tracker.getCentiBPM(); }
+    /// @copydoc MIDITempoTracker::getTickCount
+    uint32_t getTickCount() const { return tracker.getTickCount(); }
+    /// @copydoc MIDITempoTracker::getBeatCount
+    uint32_t getBeatCount() const { return tracker.getBeatCount(); }
+    /// Get the position within the current beat, at the current time.
+    /// @see MIDITempoTracker::getBeatPhase
+    uint16_t getBeatPhase() const { return tracker.getBeatPhase(micros()); }
+
+  protected:
+    /// Called for every Timing Clock message that advances the song position.
+    virtual void onTick() {}
+
+  private:
+    void updateImpl(RealTimeMessage midimsg) override {
+        if (tracker.update(midimsg, micros()))
+            onTick();
+    }
+
+  protected:
+    MIDITempoTracker tracker;
+};
+
+END_CS_NAMESPACE
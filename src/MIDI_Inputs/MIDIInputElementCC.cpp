@@ -3,6 +3,8 @@
 BEGIN_CS_NAMESPACE
 
 DoublyLinkedList<MIDIInputElementCC> MIDIInputElementCC::elements;
+MIDIInputElementIndex<MIDIInputElementCC>
+    *MIDIInputElementCC::dispatchIndex = nullptr;
 #ifdef ESP32
 std::mutex MIDIInputElementCC::mutex;
 #endif
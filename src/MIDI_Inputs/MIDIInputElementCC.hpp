@@ -2,6 +2,7 @@
 
 #include <AH/Containers/LinkedList.hpp>
 #include <MIDI_Inputs/MIDIInputElement.hpp>
+#include <MIDI_Inputs/MIDIInputElementIndex.hpp>
 
 
 #if defined(ESP32)
@@ -39,12 +40,14 @@ class MIDIInputElementCC : public MIDIInputElement,
         : MIDIInputElement(address) {
         GUARD_LIST_LOCK;
         elements.append(this);
+        invalidateDispatchIndex();
     }
 
     /// Destructor: delete from the linked list.
     virtual ~MIDIInputElementCC() {
         GUARD_LIST_LOCK;
         elements.remove(this);
+        invalidateDispatchIndex();
     }
 
     /// Initialize all MIDIInputElementCC elements.
@@ -53,6 +56,7 @@ class MIDIInputElementCC : public MIDIInputElement,
         GUARD_LIST_LOCK;
         for (MIDIInputElementCC &e : elements)
             e.begin();
+        invalidateDispatchIndex();
     }
 
     /// Update all MIDIInputElementCC elements.
@@ -74,16 +78,43 @@ class MIDIInputElementCC : public MIDIInputElement,
     /// Update all MIDIInputElementCC elements with a new MIDI message.
     /// @see     MIDIInputElementCC#updateWith
     static void updateAllWith(const ChannelMessageMatcher &midimsg) {
+        MIDIInputElementCC *cached = nullptr;
+        if (dispatchIndex && dispatchIndex->find(midimsg, cached) &&
+            (cached == nullptr || cached->updateWith(midimsg)))
+            return;
         for (MIDIInputElementCC &e : elements)
             if (e.updateWith(midimsg)) {
+                if (dispatchIndex)
+                    dispatchIndex->insert(midimsg, &e);
                 e.moveDown();
                 return;
             }
+        if (dispatchIndex)
+            dispatchIndex->insert(midimsg, nullptr);
         // No mutex required:
         // e.moveDown may alter the list, but if it does, it always returns,
         // and we stop iterating, so it doesn't matter.
     }
 
+    /// A dispatch index for this type of element, with the given number of
+    /// slots. Creating an instance enables it. @see MIDIInputElementIndex
+    template <uint16_t Size>
+    using DispatchIndex = StaticMIDIInputElementIndex<MIDIInputElementCC, Size>;
+
+    /// Use the given index to look up the element that handles an incoming
+    /// message, instead of searching the linked list of all elements.
+    /// Pass `nullptr` to disable the index again.
+    static void
+    setDispatchIndex(MIDIInputElementIndex<MIDIInputElementCC> *index) {
+        dispatchIndex = index;
+        invalidateDispatchIndex();
+    }
+
+    /// Get the dispatch index in use, or `nullptr` if there is none.
+    static MIDIInputElementIndex<MIDIInputElementCC> *getDispatchIndex() {
+        return dispatchIndex;
+    }
+
   private:
     /**
      * @brief   Move down this element in the linked list of elements.
@@ -96,7 +127,14 @@ class MIDIInputElementCC : public MIDIInputElement,
         elements.moveDown(this);
     }
 
+    /// Forget the cached lookups of the dispatch index, if there is one.
+    static void invalidateDispatchIndex() {
+        if (dispatchIndex)
+            dispatchIndex->invalidate();
+    }
+
     static DoublyLinkedList<MIDIInputElementCC> elements;
+    static MIDIInputElementIndex<MIDIInputElementCC> *dispatchIndex;
 #ifdef ESP32
     static std::mutex mutex;
 #endif
@@ -4,6 +4,8 @@ BEGIN_CS_NAMESPACE
 
 DoublyLinkedList<MIDIInputElementChannelPressure>
     MIDIInputElementChannelPressure::elements;
+MIDIInputElementIndex<MIDIInputElementChannelPressure>
+    *MIDIInputElementChannelPressure::dispatchIndex = nullptr;
 #ifdef ESP32
 std::mutex MIDIInputElementChannelPressure::mutex;
 #endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MIDIInputElement.hpp"
+#include "MIDIInputElementIndex.hpp"
 #include <AH/Containers/LinkedList.hpp>
 
 #if defined(ESP32)
@@ -30,6 +31,7 @@ class MIDIInputElementChannelPressure
         : MIDIInputElement(address) {
         GUARD_LIST_LOCK;
         elements.append(this);
+        invalidateDispatchIndex();
     }
 
     /**
@@ -39,12 +41,14 @@ class MIDIInputElementChannelPressure
     virtual ~MIDIInputElementChannelPressure() {
         GUARD_LIST_LOCK;
         elements.remove(this);
+        invalidateDispatchIndex();
     }
 
     static void beginAll() {
         GUARD_LIST_LOCK;
         for (MIDIInputElementChannelPressure &el : elements)
             el.begin();
+        invalidateDispatchIndex();
     }
 
     /**
@@ -75,16 +79,45 @@ class MIDIInputElementChannelPressure
      * @see     MIDIInputElementChannelPressure#updateWith
      */
     static void updateAllWith(const ChannelMessageMatcher &midimsg) {
+        MIDIInputElementChannelPressure *cached = nullptr;
+        if (dispatchIndex && dispatchIndex->find(midimsg, cached) &&
+            (cached == nullptr || cached->updateWith(midimsg)))
+            return;
         for (MIDIInputElementChannelPressure &e : elements)
             if (e.updateWith(midimsg)) {
+                if (dispatchIndex)
+                    dispatchIndex->insert(midimsg, &e);
                 e.moveDown();
                 return;
             }
+        if (dispatchIndex)
+            dispatchIndex->insert(midimsg, nullptr);
         // No mutex required:
         // e.moveDown may alter the list, but if it does, it always returns,
         // and we stop iterating, so it doesn't matter.
     }
 
+    /// A dispatch index for this type of element, with the given number of
+    /// slots. Creating an instance enables it. @see MIDIInputElementIndex
+    template <uint16_t Size>
+    using DispatchIndex =
+        StaticMIDIInputElementIndex<MIDIInputElementChannelPressure, Size>;
+
+    /// Use the given index to look up the element that handles an incoming
+    /// message, instead of searching the linked list of all elements.
+    /// Pass `nullptr` to disable the index again.
+    static void setDispatchIndex(
+        MIDIInputElementIndex<MIDIInputElementChannelPressure> *index) {
+        dispatchIndex = index;
+        invalidateDispatchIndex();
+    }
+
+    /// Get the dispatch index in use, or `nullptr` if there is none.
+    static MIDIInputElementIndex<MIDIInputElementChannelPressure> *
+    getDispatchIndex() {
+        return dispatchIndex;
+    }
+
   private:
     /// Channel Pressure doesn't have an address, so the target consists of just
     /// the channel and the cable number.
@@ -107,7 +140,15 @@ class MIDIInputElementChannelPressure
         elements.moveDown(this);
     }
 
+    /// Forget the cached lookups of the dispatch index, if there is one.
+    static void invalidateDispatchIndex() {
+        if (dispatchIndex)
+            dispatchIndex->invalidate();
+    }
+
     static DoublyLinkedList<MIDIInputElementChannelPressure> elements;
+    static MIDIInputElementIndex<MIDIInputElementChannelPressure>
+        *dispatchIndex;
 #ifdef ESP32
     static std::mutex mutex;
 #endif
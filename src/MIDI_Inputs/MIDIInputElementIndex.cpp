@@ -0,0 +1,7 @@
+#include "MIDIInputElementIndex.hpp"
+
+BEGIN_CS_NAMESPACE
+
+DoublyLinkedList<MIDIInputElementIndexBase> MIDIInputElementIndexBase::indices;
+
+END_CS_NAMESPACE
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "ChannelMessageMatcher.hpp"
+#include <AH/Containers/LinkedList.hpp>
+
+BEGIN_CS_NAMESPACE
+
+/**
+ * @brief   Non-templated base class for all MIDI input dispatch indices.
+ *
+ * All indices are added to a linked list, so they can all be invalidated at
+ * once, e.g. when the setting of a Bank changes.
+ *
+ * @ingroup MIDIInputElements
+ */
+class MIDIInputElementIndexBase
+    : public DoublyLinkable<MIDIInputElementIndexBase> {
+  protected:
+    MIDIInputElementIndexBase() { indices.append(this); }
+
+  public:
+    MIDIInputElementIndexBase(const MIDIInputElementIndexBase &) = delete;
+    MIDIInputElementIndexBase &
+    operator=(const MIDIInputElementIndexBase &) = delete;
+
+    virtual ~MIDIInputElementIndexBase() { indices.remove(this); }
+
+    /// Forget all cached lookups of this index.
+    virtual void invalidate() = 0;
+
+    /// Forget all cached lookups of all indices.
+    static void invalidateAll() {
+        for (MIDIInputElementIndexBase &index : indices)
+            index.invalidate();
+    }
+
+  private:
+    static DoublyLinkedList<MIDIInputElementIndexBase> indices;
+};
+
+/**
+ * @brief   A lookup table that maps the address of incoming MIDI messages
+ *          (cable number, channel and data 1) to the MIDI input element that
+ *          handles them.
+ *
+ * Program Change and Channel Pressure messages have no address in data 1
+ * (it's the program or the pressure), so for these messages, only the cable
+ * number and the channel are used.
+ *
+ * Without an index, every incoming message is matched against all elements in
+ * the linked list of its type, until one matches. The index remembers the
+ * result of that search (including "no element matches"), so the next message
+ * with the same address can be dispatched in constant time.
+ *
+ * The table is direct-mapped: each address maps to a single slot, and if two
+ * addresses map to the same slot, the most recent one is kept. The index is
+ * invalidated automatically when elements are added or removed, when the
+ * elements are initialized, and when a bank setting changes.
+ *
+ * @note    Only the @ref MIDIInputElement::match "match" function is assumed
+ *          to determine which element handles a message, it should only depend
+ *          on the address of the message and on the (constant) address of the
+ *          element. This is the case for all MIDI input elements in this
+ *          library.
+ *
+ * @tparam  Element
+ *          The type of MIDI input elements to index, e.g. MIDIInputElementCC.
+ *
+ * @see     StaticMIDIInputElementIndex
+ *
+ * @ingroup MIDIInputElements
+ */
+template <class Element>
+class MIDIInputElementIndex : public MIDIInputElementIndexBase {
+  protected:
+    struct Entry {
+        uint16_t key;
+        Element *element;
+    };
+
+    MIDIInputElementIndex(Entry *entries, uint8_t bits)
+        : entries(entries), bits(bits) {}
+
+  public:
+    /**
+     * @brief   Look up the element that handles the given MIDI message.
+     *
+     * @param   midimsg
+     *          The MIDI message to look up.
+     * @param   element
+     *          The element that handles the message, or `nullptr` if no
+     *          element handles messages with this address. Only valid if the
+     *          lookup succeeded.
+     * @retval  true
+     *          The address of the message is in the index.
+     * @retval  false
+     *          The address of the message is not in the index, the caller
+     *          should search the list of elements, and call
+     *          MIDIInputElementIndex::insert with the result.
+     */
+    bool find(const ChannelMessageMatcher &midimsg, Element *&element) const {
+        uint16_t key = getKey(midimsg);
+        const Entry &entry = entries[getSlot(key)];
+        if (entry.key != key)
+            return false;
+        element = entry.element;
+        return true;
+    }
+
+    /// Remember which element (possibly `nullptr`) handles the given message.
+    void insert(const ChannelMessageMatcher &midimsg, Element *element) {
+        uint16_t key = getKey(midimsg);
+        entries[getSlot(key)] = {key, element};
+    }
+
+    void invalidate() override {
+        for (uint16_t i = 0; i < (uint16_t(1) << bits); ++i)
+            entries[i] = {emptyKey, nullptr};
+    }
+
+  private:
+    /// Pack the cable number (4 bits), the channel (4 bits) and data 1
+    /// (7 bits) into one 15-bit key. Data 1 is left out for messages where
+    /// it's not part of the address.
+    static uint16_t getKey(const ChannelMessageMatcher &midimsg) {
+        bool hasAddress = midimsg.type != MIDIMessageType::PROGRAM_CHANGE &&
+                          midimsg.type != MIDIMessageType::CHANNEL_PRESSURE;
+        return (uint16_t(midimsg.CN & 0x0F) << 11) |
+               (uint16_t(midimsg.channel.getRaw()) << 7) |
+               (hasAddress ? midimsg.data1 & 0x7F : 0);
+    }
+
+    /// Fold the key onto the table. Consecutive addresses never collide, as
+    /// long as there are fewer of them than there are slots.
+    uint16_t getSlot(uint16_t key) const {
+        uint16_t mask = (uint16_t(1) << bits) - 1;
+        return (key ^ (key >> bits)) & mask;
+    }
+
+    /// A key that can never be produced by getKey.
+    constexpr static uint16_t emptyKey = 0xFFFF;
+
+    Entry *entries;
+    uint8_t bits;
+};
+
+/**
+ * @brief   A MIDIInputElementIndex with statically allocated storage.
+ *
+ * Creating an instance enables the index for the given element type, e.g.
+ *
+ * ~~~cpp
+ * MIDIInputElementCC::DispatchIndex<256> ccIndex;
+ * ~~~
+ *
+ * When the index is destroyed, the element type falls back to searching the
+ * linked list of elements.
+ *
+ * @tparam  Element
+ *          The type of MIDI input elements to index, e.g. MIDIInputElementCC.
+ * @tparam  Size
+ *          The number of slots in the table, must be a power of two. For best
+ *          results, it should be larger than the number of different addresses
+ *          that are received.
+ *
+ * @ingroup MIDIInputElements
+ */
+template <class Element, uint16_t Size>
+class StaticMIDIInputElementIndex : public MIDIInputElementIndex<Element> {
+    static_assert(Size >= 2 && Size <= 0x8000 && (Size & (Size - 1)) == 0,
+                  "Size should be a power of two in [2, 32768]");
+
+  public:
+    StaticMIDIInputElementIndex()
+        : MIDIInputElementIndex<Element>(storage, log2(Size)) {
+        this->invalidate();
+        Element::setDispatchIndex(this);
+    }
+
+    ~StaticMIDIInputElementIndex() {
+        if (Element::getDispatchIndex() == this)
+            Element::setDispatchIndex(nullptr);
+    }
+
+  private:
+    constexpr static uint8_t log2(uint16_t x) {
+        return x <= 1 ? 0 : 1 + log2(x >> 1);
+    }
+
+    typename MIDIInputElementIndex<Element>::Entry storage[Size];
+};
+
+END_CS_NAMESPACE
@@ -3,6 +3,8 @@
 BEGIN_CS_NAMESPACE
 
 DoublyLinkedList<MIDIInputElementNote> MIDIInputElementNote::elements;
+MIDIInputElementIndex<MIDIInputElementNote>
+    *MIDIInputElementNote::dispatchIndex = nullptr;
 #ifdef ESP32
 std::mutex MIDIInputElementNote::mutex;
 #endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MIDIInputElement.hpp"
+#include "MIDIInputElementIndex.hpp"
 #include <AH/Containers/Updatable.hpp>
 
 #if defined(ESP32)
@@ -29,6 +30,7 @@ class MIDIInputElementNote : public MIDIInputElement,
         : MIDIInputElement(address) {
         GUARD_LIST_LOCK;
         elements.append(this);
+        invalidateDispatchIndex();
     }
 
   public:
@@ -39,6 +41,7 @@ class MIDIInputElementNote : public MIDIInputElement,
     virtual ~MIDIInputElementNote() {
         GUARD_LIST_LOCK;
         elements.remove(this);
+        invalidateDispatchIndex();
     }
 
     /**
@@ -50,6 +53,7 @@ class MIDIInputElementNote : public MIDIInputElement,
         GUARD_LIST_LOCK;
         for (MIDIInputElementNote &e : elements)
             e.begin();
+        invalidateDispatchIndex();
     }
 
     /**
@@ -82,16 +86,44 @@ class MIDIInputElementNote : public MIDIInputElement,
      * @see     MIDIInputElementNote#updateWith
      */
     static void updateAllWith(const ChannelMessageMatcher &midimsg) {
+        MIDIInputElementNote *cached = nullptr;
+        if (dispatchIndex && dispatchIndex->find(midimsg, cached) &&
+            (cached == nullptr || cached->updateWith(midimsg)))
+            return;
         for (MIDIInputElementNote &e : elements)
             if (e.updateWith(midimsg)) {
+                if (dispatchIndex)
+                    dispatchIndex->insert(midimsg, &e);
                 e.moveDown();
                 return;
             }
+        if (dispatchIndex)
+            dispatchIndex->insert(midimsg, nullptr);
         // No mutex required:
         // e.moveDown may alter the list, but if it does, it always returns,
         // and we stop iterating, so it doesn't matter.
     }
 
+    /// A dispatch index for this type of element, with the given number of
+    /// slots. Creating an instance enables it. @see MIDIInputElementIndex
+    template <uint16_t Size>
+    using DispatchIndex =
+        StaticMIDIInputElementIndex<MIDIInputElementNote, Size>;
+
+    /// Use the given index to look up the element that handles an incoming
+    /// message, instead of searching the linked list of all elements.
+    /// Pass `nullptr` to disable the index again.
+    static void
+    setDispatchIndex(MIDIInputElementIndex<MIDIInputElementNote> *index) {
+        dispatchIndex = index;
+        invalidateDispatchIndex();
+    }
+
+    /// Get the dispatch index in use, or `nullptr` if there is none.
+    static MIDIInputElementIndex<MIDIInputElementNote> *getDispatchIndex() {
+        return dispatchIndex;
+    }
+
   private:
     /**
      * @brief   Move down this element in the linked list of elements.
@@ -104,7 +136,14 @@ class MIDIInputElementNote : public MIDIInputElement,
         elements.moveDown(this);
     }
 
+    /// Forget the cached lookups of the dispatch index, if there is one.
+    static void invalidateDispatchIndex() {
+        if (dispatchIndex)
+            dispatchIndex->invalidate();
+    }
+
     static DoublyLinkedList<MIDIInputElementNote> elements;
+    static MIDIInputElementIndex<MIDIInputElementNote> *dispatchIndex;
 #ifdef ESP32
     static std::mutex mutex;
 #endif
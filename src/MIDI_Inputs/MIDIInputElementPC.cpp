@@ -3,6 +3,8 @@
 BEGIN_CS_NAMESPACE
 
 DoublyLinkedList<MIDIInputElementPC> MIDIInputElementPC::elements;
+MIDIInputElementIndex<MIDIInputElementPC>
+    *MIDIInputElementPC::dispatchIndex = nullptr;
 #ifdef ESP32
 std::mutex MIDIInputElementPC::mutex;
 #endif
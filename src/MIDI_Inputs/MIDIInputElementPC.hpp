@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MIDIInputElement.hpp"
+#include "MIDIInputElementIndex.hpp"
 #include <AH/Containers/LinkedList.hpp>
 
 #if defined(ESP32)
@@ -28,6 +29,7 @@ class MIDIInputElementPC : public MIDIInputElement,
     MIDIInputElementPC(const MIDIAddress &address) : MIDIInputElement(address) {
         GUARD_LIST_LOCK;
         elements.append(this);
+        invalidateDispatchIndex();
     }
 
     /**
@@ -37,12 +39,14 @@ class MIDIInputElementPC : public MIDIInputElement,
     virtual ~MIDIInputElementPC() {
         GUARD_LIST_LOCK;
         elements.remove(this);
+        invalidateDispatchIndex();
     }
 
     static void beginAll() {
         GUARD_LIST_LOCK;
         for (MIDIInputElementPC &el : elements)
             el.begin();
+        invalidateDispatchIndex();
     }
 
     /**
@@ -73,16 +77,43 @@ class MIDIInputElementPC : public MIDIInputElement,
      * @see     MIDIInputElementPC#updateWith
      */
     static void updateAllWith(const ChannelMessageMatcher &midimsg) {
+        MIDIInputElementPC *cached = nullptr;
+        if (dispatchIndex && dispatchIndex->find(midimsg, cached) &&
+            (cached == nullptr || cached->updateWith(midimsg)))
+            return;
         for (MIDIInputElementPC &e : elements)
             if (e.updateWith(midimsg)) {
+                if (dispatchIndex)
+                    dispatchIndex->insert(midimsg, &e);
                 e.moveDown();
                 return;
             }
+        if (dispatchIndex)
+            dispatchIndex->insert(midimsg, nullptr);
         // No mutex required:
         // e.moveDown may alter the list, but if it does, it always returns,
         // and we stop iterating, so it doesn't matter.
     }
 
+    /// A dispatch index for this type of element, with the given number of
+    /// slots. Creating an instance enables it. @see MIDIInputElementIndex
+    template <uint16_t Size>
+    using DispatchIndex = StaticMIDIInputElementIndex<MIDIInputElementPC, Size>;
+
+    /// Use the given index to look up the element that handles an incoming
+    /// message, instead of searching the linked list of all elements.
+    /// Pass `nullptr` to disable the index again.
+    static void
+    setDispatchIndex(MIDIInputElementIndex<MIDIInputElementPC> *index) {
+        dispatchIndex = index;
+        invalidateDispatchIndex();
+    }
+
+    /// Get the dispatch index in use, or `nullptr` if there is none.
+    static MIDIInputElementIndex<MIDIInputElementPC> *getDispatchIndex() {
+        return dispatchIndex;
+    }
+
   private:
     /// Program Change doesn't have an address, so the target consists of just
     /// the channel and the cable number.
@@ -105,7 +136,14 @@ class MIDIInputElementPC : public MIDIInputElement,
         elements.moveDown(this);
     }
 
+    /// Forget the cached lookups of the dispatch index, if there is one.
+    static void invalidateDispatchIndex() {
+        if (dispatchIndex)
+            dispatchIndex->invalidate();
+    }
+
     static DoublyLinkedList<MIDIInputElementPC> elements;
+    static MIDIInputElementIndex<MIDIInputElementPC> *dispatchIndex;
 #ifdef ESP32
     static std::mutex mutex;
 #endif
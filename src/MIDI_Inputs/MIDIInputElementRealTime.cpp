@@ -0,0 +1,8 @@
+#include "MIDIInputElementRealTime.hpp"
+
+BEGIN_CS_NAMESPACE
+DoublyLinkedList<MIDIInputElementRealTime> MIDIInputElementRealTime::elements;
+#ifdef ESP32
+std::mutex MIDIInputElementRealTime::mutex;
+#endif
+END_CS_NAMESPACE
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <AH/Containers/LinkedList.hpp>
+#include <MIDI_Parsers/MIDI_MessageTypes.hpp>
+
+#if defined(ESP32)
+#include <mutex>
+#define GUARD_LIST_LOCK std::lock_guard<std::mutex> guard_(mutex)
+#else
+#define GUARD_LIST_LOCK
+#endif
+
+BEGIN_CS_NAMESPACE
+
+/**
+ * @brief   Class for objects that listen for incoming MIDI Real-Time events
+ *          (Timing Clock, Start, Continue, Stop, etc.).
+ *
+ * Unlike the other MIDI input elements, Real-Time messages don't have an
+ * address: every message is passed to all elements on the same cable.
+ * 
+ * @ingroup MIDIInputElements
+ */
+class MIDIInputElementRealTime
+    : public DoublyLinkable<MIDIInputElementRealTime> {
+  protected:
+    /**
+     * @brief   Constructor.
+     *
+     * @param   cable
+     *          The MIDI USB cable to listen to.
+     */
+    MIDIInputElementRealTime(Cable cable = CABLE_1) : CN(cable.getRaw()) {
+        GUARD_LIST_LOCK;
+        elements.append(this);
+    }
+
+  public:
+    /// Destructor.
+    virtual ~MIDIInputElementRealTime() {
+        GUARD_LIST_LOCK;
+        elements.remove(this);
+    }
+
+    /// Initialize the input element.
+    virtual void begin() {}
+
+    /// Reset the input element to its initial state.
+    virtual void reset() {}
+
+    /// Update the input element. Used for blinking LEDs etc.
+    virtual void update() {}
+
+    /**
+     * @brief   Initialize all MIDIInputElementRealTime elements.
+     * 
+     * @see     MIDIInputElementRealTime#begin
+     */
+    static void beginAll() {
+        GUARD_LIST_LOCK;
+        for (MIDIInputElementRealTime &e : elements)
+            e.begin();
+    }
+
+    /**
+     * @brief   Update all MIDIInputElementRealTime elements.
+     * 
+     * @see     MIDIInputElementRealTime#update
+     */
+    static void updateAll() {
+        GUARD_LIST_LOCK;
+        for (MIDIInputElementRealTime &e : elements)
+            e.update();
+    }
+
+    /** 
+     * @brief   Reset all MIDIInputElementRealTime elements to their initial
+     *          state.
+     * 
+     * @see     MIDIInputElementRealTime#reset
+     */
+    static void resetAll() {
+        GUARD_LIST_LOCK;
+        for (MIDIInputElementRealTime &e : elements)
+            e.reset();
+    }
+
+    /**
+     * @brief   Pass a new MIDI Real-Time message to all
+     *          MIDIInputElementRealTime elements on the same cable.
+     */
+    static void updateAllWith(RealTimeMessage midimsg) {
+        GUARD_LIST_LOCK;
+        for (MIDIInputElementRealTime &e : elements)
+            if (e.CN == midimsg.CN)
+                e.updateImpl(midimsg);
+    }
+
+  private:
+    /// Handle a Real-Time message on the cable of this element.
+    virtual void updateImpl(RealTimeMessage midimsg) = 0;
+
+    uint8_t CN;
+
+    static DoublyLinkedList<MIDIInputElementRealTime> elements;
+#ifdef ESP32
+    static std::mutex mutex;
+#endif
+};
+
+#undef GUARD_LIST_LOCK
+
+END_CS_NAMESPACE
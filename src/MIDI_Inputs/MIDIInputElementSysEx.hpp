@@ -87,8 +87,10 @@ class MIDIInputElementSysEx : public DoublyLinkable<MIDIInputElementSysEx> {
      * @see     MIDIInputElementSysEx#updateWith
      */
     static void updateAllWith(SysExMessage midimsg) {
+        // Long messages that are received in chunks are handled separately
+        bool chunk = midimsg.chunked;
         for (MIDIInputElementSysEx &e : elements)
-            if (e.updateWith(midimsg)) {
+            if (chunk ? e.updateChunkWith(midimsg) : e.updateWith(midimsg)) {
                 e.moveDown();
                 return;
             }
@@ -103,9 +105,37 @@ class MIDIInputElementSysEx : public DoublyLinkable<MIDIInputElementSysEx> {
         return midimsg.CN == this->CN && updateImpl(midimsg);
     }
 
+    bool updateChunkWith(SysExMessage chunk) {
+        return chunk.CN == this->CN && updateChunkImpl(chunk);
+    }
+
     /// @todo   Documentation.
     virtual bool updateImpl(SysExMessage midimsg) = 0;
 
+    /**
+     * @brief   Handle a chunk of a long SysEx message.
+     *
+     * When chunked SysEx delivery is enabled (see 
+     * MIDI_Parser::setSysExChunking), messages that don't fit in the SysEx
+     * buffer of the MIDI interface are delivered in multiple chunks, as they
+     * arrive, with the SysExMessage::chunked flag set. The first chunk starts
+     * with 0xF0, the last one ends with 0xF7 (see SysExMessage::isFirstChunk
+     * and SysExMessage::isLastChunk). Messages that fit in the buffer (or
+     * that were truncated because chunking is disabled) are passed to
+     * @ref updateImpl as usual.
+     *
+     * Elements that have to process long messages should override this 
+     * function and keep track of their position in the message. By default,
+     * chunks are ignored.
+     *
+     * @return  Whether the chunk was handled, and shouldn't be passed on to
+     *          the other elements.
+     */
+    virtual bool updateChunkImpl(SysExMessage chunk) {
+        (void)chunk;
+        return false;
+    }
+
     /**
      * @brief   Move down this element in the linked list of elements.
      * 
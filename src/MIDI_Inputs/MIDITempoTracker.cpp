@@ -0,0 +1,72 @@
+#include "MIDITempoTracker.hpp"
+
+BEGIN_CS_NAMESPACE
+
+constexpr uint8_t MIDITempoTracker::PPQN;
+
+bool MIDITempoTracker::update(RealTimeMessage msg, unsigned long time) {
+    switch (msg.message) {
+        case uint8_t(MIDIMessageType::TIMING_CLOCK): {
+            if (clockReceived)
+                updateInterval(time - lastClockTime);
+            clockReceived = true;
+            lastClockTime = time;
+            if (!running)
+                return false;
+            if (startPending)
+                startPending = false;
+            else
+                ++tickCount;
+            return true;
+        }
+        case uint8_t(MIDIMessageType::START):
+            tickCount = 0;
+            running = true;
+            startPending = true;
+            return false;
+        case uint8_t(MIDIMessageType::CONTINUE): running = true; return false;
+        case uint8_t(MIDIMessageType::STOP): running = false; return false;
+        case uint8_t(MIDIMessageType::RESET): reset(); return false;
+        default: return false;
+    }
+}
+
+void MIDITempoTracker::updateInterval(uint32_t interval) {
+    if (interval == 0)
+        return;
+    if (tickInterval == 0) { // First interval
+        filter.reset(interval);
+        tickInterval = interval;
+        return;
+    }
+    uint32_t deviation = interval > tickInterval ? interval - tickInterval
+                                                 : tickInterval - interval;
+    if (deviation > tickInterval / MIDI_CLOCK_MAX_DEVIATION_FRACTION) {
+        // A lost or late clock message, or a sudden change of tempo
+        if (++outliers < MIDI_CLOCK_MAX_OUTLIERS)
+            return;
+        filter.reset(interval);
+        tickInterval = interval;
+    } else {
+        tickInterval = filter(interval);
+    }
+    outliers = 0;
+}
+
+void MIDITempoTracker::reset() { *this = {}; }
+
+uint16_t MIDITempoTracker::getBeatPhase(unsigned long time) const {
+    // Position in 256ths of a tick, the last tick of the beat ends at
+    // 24 * 256 = 6144
+    uint16_t position = getTickInBeat() * 256u;
+    if (running && hasTempo()) {
+        uint32_t elapsed = time - lastClockTime;
+        if (elapsed >= tickInterval)
+            elapsed = tickInterval - 1;
+        position += elapsed * 256 / tickInterval;
+    }
+    // Scale from [0, 6144) to [0, 65536)
+    return (uint32_t(position) << 5) / 3;
+}
+
+END_CS_NAMESPACE
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <AH/Filters/EMA.hpp>
+#include <MIDI_Parsers/MIDI_MessageTypes.hpp>
+#include <Settings/SettingsWrapper.hpp>
+
+BEGIN_CS_NAMESPACE
+
+/**
+ * @brief   Estimates the tempo and the song position from incoming MIDI Timing
+ *          Clock, Start, Continue and Stop messages.
+ *
+ * The interval between Timing Clock messages (24 per quarter note) is filtered
+ * using an integer exponential moving average (see
+ * @ref MIDI_CLOCK_FILTER_SHIFT_FACTOR), so the jitter of the incoming clock
+ * doesn't show up in the tempo. Intervals that deviate too much from the
+ * current estimate (e.g. because clock messages were lost, or because the
+ * clock was paused) are ignored, unless several of them in a row agree on a
+ * new tempo, in which case the filter jumps to that tempo immediately.
+ *
+ * All calculations use integers, and handling a Timing Clock message only
+ * takes a couple of additions and shifts, so thousands of clock messages per
+ * second can be handled even on small microcontrollers.
+ *
+ * Between two clock messages, the position within the beat is interpolated
+ * using the estimated interval, see @ref getBeatPhase.
+ */
+class MIDITempoTracker {
+  public:
+    /// The number of Timing Clock messages per quarter note.
+    constexpr static uint8_t PPQN = 24;
+
+    /**
+     * @brief   Handle a MIDI Real-Time message.
+     *
+     * @param   msg
+     *          The message.
+     * @param   time
+     *          The time the message was received, in microseconds.
+     * @return  Returns true if the message was a Timing Clock message that
+     *          advanced the song position.
+     */
+    bool update(RealTimeMessage msg, unsigned long time);
+
+    /// Forget the tempo and the song position, and stop.
+    void reset();
+
+    /// @name   Tempo
+    /// @{
+
+    /// Check whether enough Timing Clock messages were received to estimate
+    /// the tempo.
+    bool hasTempo() const { return tickInterval != 0; }
+    /// Get the filtered interval between Timing Clock messages in
+    /// microseconds, or zero if the tempo is unknown.
+    uint32_t getTickInterval() const { return tickInterval; }
+    /// Get the tempo in hundredths of beats per minute, or zero if the tempo
+    /// is unknown.
+    uint32_t getCentiBPM() const {
+        // 60e6 µs/min * 100 / 24 ticks/beat
+        return hasTempo() ? (250000000ul + tickInterval / 2) / tickInterval
+                          : 0;
+    }
+    /// Get the tempo in beats per minute, rounded to the nearest integer, or
+    /// zero if the tempo is unknown.
+    uint16_t getBPM() const { return (getCentiBPM() + 50) / 100; }
+
+    /// @}
+
+    /// @name   Transport and Position
+    /// @{
+
+    /// Check whether the clock is running, i.e. whether a Start or Continue
+    /// message was received, and no Stop message.
+    bool isRunning() const { return running; }
+    /// Get the number of Timing Clock messages since the last Start message
+    /// (while running). This is the song position in 24ths of a quarter note.
+    uint32_t getTickCount() const { return tickCount; }
+    /// Get the number of beats (quarter notes) since the last Start message.
+    uint32_t getBeatCount() const { return tickCount / PPQN; }
+    /// Get the position within the current beat, in Timing Clock messages.
+    /// [0, 23]
+    uint8_t getTickInBeat() const { return tickCount % PPQN; }
+    /// Check whether the last Timing Clock message was on a beat.
+    bool isOnBeat() const { return getTickInBeat() == 0; }
+
+    /**
+     * @brief   Get the position within the current beat, interpolated between
+     *          the Timing Clock messages using the estimated tempo.
+     *
+     * @param   time
+     *          The current time in microseconds.
+     * @return  The phase, where 0 is the start of the beat and 65536 would be
+     *          the start of the next beat. The interpolated position never
+     *          advances past the next Timing Clock message that hasn't been
+     *          received yet.
+     */
+    uint16_t getBeatPhase(unsigned long time) const;
+
+    /// @}
+
+  private:
+    /// Update the filtered interval with the interval between the last two
+    /// Timing Clock messages.
+    void updateInterval(uint32_t interval);
+
+  private:
+    using Filter = EMA<MIDI_CLOCK_FILTER_SHIFT_FACTOR, uint32_t, uint32_t>;
+    Filter filter;
+    uint32_t tickInterval = 0;
+    unsigned long lastClockTime = 0;
+    uint32_t tickCount = 0;
+    /// The number of consecutive intervals that were rejected.
+    uint8_t outliers = 0;
+    bool clockReceived = false;
+    bool running = false;
+    /// The first Timing Clock message after a Start message is the first tick
+    /// of the song, it doesn't advance the position.
+    bool startPending = false;
+};
+
+END_CS_NAMESPACE
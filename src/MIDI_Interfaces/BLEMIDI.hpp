@@ -96,6 +96,9 @@ class BLEMIDI {
 
     std::string getValue() { return pCharacteristic->getValue(); }
 
+    /// Get the ATT MTU negotiated with the connected client.
+    uint16_t getMTU() { return pServer->getPeerMTU(pServer->getConnId()); }
+
   private:
     BLECharacteristic *pCharacteristic = nullptr;
     BLEServer *pServer = nullptr;
@@ -129,11 +132,18 @@ class BLECharacteristicCallbacks {
 
 class BLEServer {};
 
+union esp_ble_gatts_cb_param_t;
+
 class BLEServerCallbacks {
   public:
     virtual ~BLEServerCallbacks() = default;
     virtual void onConnect(BLEServer *pServer) { (void)pServer; }
     virtual void onDisconnect(BLEServer *pServer) { (void)pServer; }
+    virtual void onMtuChanged(BLEServer *pServer,
+                              esp_ble_gatts_cb_param_t *param) {
+        (void)pServer;
+        (void)param;
+    }
 };
 
 BEGIN_CS_NAMESPACE
@@ -147,6 +157,7 @@ class BLEMIDI {
                 (BLEServerCallbacks *, BLECharacteristicCallbacks *));
     MOCK_METHOD(void, notifyValue, (uint8_t * data, size_t len));
     MOCK_METHOD(std::string, getValue, ());
+    MOCK_METHOD(uint16_t, getMTU, ());
 };
 
 END_CS_NAMESPACE
@@ -3,13 +3,21 @@
 #include "BLEMIDI.hpp"
 #include "SerialMIDI_Interface.hpp"
 
+#include <AH/Containers/SPSCQueue.hpp>
 #include <AH/Error/Error.hpp>
+#include <atomic>
 
 BEGIN_CS_NAMESPACE
 
 /**
  * @brief   Bluetooth Low Energy MIDI Interface for the ESP32.
  * 
+ * Incoming MIDI data is received in a callback of the Bluetooth stack, which
+ * runs in a different task than the main loop. The data is passed to the main
+ * loop through a lock-free queue, and it is parsed and dispatched in 
+ * @ref update. If the queue is full, incoming packets are dropped (see
+ * @ref getOverflowCount).
+ * 
  * @ingroup MIDIInterfaces
  */
 class BluetoothMIDI_Interface : public Parsing_MIDI_Interface,
@@ -22,6 +30,7 @@ class BluetoothMIDI_Interface : public Parsing_MIDI_Interface,
         (void)pServer;
         DEBUGFN("Connected");
         connected++;
+        mtuChanged = true;
     };
     void onDisconnect(BLEServer *pServer) override {
         (void)pServer;
@@ -32,6 +41,16 @@ class BluetoothMIDI_Interface : public Parsing_MIDI_Interface,
         }
         connected--;
     }
+    /// The MTU exchange usually happens after connecting. The new MTU is
+    /// applied by the main loop in @ref update, so the packet that's being
+    /// assembled is never accessed from the Bluetooth task.
+    void onMtuChanged(BLEServer *pServer,
+                      esp_ble_gatts_cb_param_t *param) override {
+        (void)pServer;
+        (void)param;
+        DEBUGFN("MTU changed");
+        mtuChanged = true;
+    }
 
     void onRead(BLECharacteristic *pCharacteristic) override {
         DEBUGFN("Read");
@@ -46,14 +65,39 @@ class BluetoothMIDI_Interface : public Parsing_MIDI_Interface,
         parse(data, len);
     }
 
+    /// The default time outgoing messages can be buffered before they are
+    /// sent (see @ref setConnectionInterval).
     constexpr static unsigned long MAX_MESSAGE_TIME = 10000; // microseconds
 
-    unsigned long startTime = 0;
+    /// The number of received MIDI bytes that can be waiting to be handled
+    /// by the main loop.
+    constexpr static size_t RECEIVE_QUEUE_LENGTH = 512;
+    AH::SPSCQueue<uint8_t, RECEIVE_QUEUE_LENGTH> receiveQueue;
+    std::atomic<unsigned long> overflowCount{0};
 
-    constexpr static size_t BUFFER_LENGTH = 1024;
+    /// The maximum length of a characteristic value.
+    constexpr static size_t BUFFER_LENGTH = 512;
+    /// The default ATT MTU, the actual MTU is negotiated after connecting.
+    constexpr static uint16_t DEFAULT_MTU = 23;
 
     uint8_t buffer[BUFFER_LENGTH] = {};
+    /// The number of bytes in the packet that's being assembled.
     size_t index = 0;
+    /// The maximum size of one packet (ATT MTU - 3).
+    size_t packetSize = DEFAULT_MTU - 3;
+    /// Set by the Bluetooth task when a client connects or when the MTU was
+    /// negotiated, the main loop then queries the new MTU.
+    std::atomic<bool> mtuChanged{false};
+    /// The time the first message was added to the current packet.
+    unsigned long startTime = 0;
+    /// The maximum time outgoing messages are buffered.
+    unsigned long flushTimeout = MAX_MESSAGE_TIME;
+    /// The status byte of the last channel message in the current packet, or
+    /// zero if the next message can't use running status.
+    uint8_t runningHeader = 0;
+    /// The timestamp byte of the last message in the current packet, or zero
+    /// if the next message must have a timestamp.
+    uint8_t runningTimestamp = 0;
 
     SerialMIDI_Parser parser;
 
@@ -61,123 +105,272 @@ class BluetoothMIDI_Interface : public Parsing_MIDI_Interface,
 
     uint8_t connected = 0;
 
-    bool hasSpaceFor(size_t bytes) { return bytes <= BUFFER_LENGTH - index; }
+    bool hasSpaceFor(size_t bytes) const { return index + bytes <= packetSize; }
 
   public:
     BluetoothMIDI_Interface() : Parsing_MIDI_Interface(parser) {}
 
     void begin() override { bleMidi.begin(this, this); }
 
+    /// Send the current packet (if any) to the connected clients as a single
+    /// notification. If no clients are connected, the packet is discarded.
     void publish() {
         if (index == 0)
             return;
-        if (!connected) {
+        if (!connected)
             DEBUGFN("No connected BLE clients");
-            return;
-        }
-        bleMidi.notifyValue(buffer, index);
+        else
+            bleMidi.notifyValue(buffer, index);
         index = 0;
+        runningHeader = 0;
+        runningTimestamp = 0;
     }
 
+    /// @name   Packet coalescing
+    /// @{
+
+    /**
+     * @brief   Set the negotiated ATT MTU.
+     *
+     * Outgoing messages are collected into packets of at most `mtu - 3`
+     * bytes, and a packet is sent as soon as no other message fits.
+     * The MTU is queried automatically in @ref update after a client connects
+     * and after every MTU exchange.
+     */
+    void setMTU(uint16_t mtu) {
+        if (mtu < DEFAULT_MTU) // unknown or invalid
+            mtu = DEFAULT_MTU;
+        size_t newPacketSize = mtu - 3;
+        if (newPacketSize > BUFFER_LENGTH)
+            newPacketSize = BUFFER_LENGTH;
+        if (index > newPacketSize)
+            publish();
+        packetSize = newPacketSize;
+    }
+    /// Get the maximum number of bytes per packet (ATT MTU - 3).
+    size_t getPacketSize() const { return packetSize; }
+
+    /**
+     * @brief   Set the connection interval (in microseconds).
+     *
+     * The Bluetooth stack can only send packets once per connection interval,
+     * so messages are coalesced for at most one connection interval, sending
+     * them earlier would not reduce latency, but it would use more packets.
+     */
+    void setConnectionInterval(unsigned long interval) {
+        flushTimeout = interval;
+    }
+    /// Get the maximum time messages are buffered (in microseconds).
+    unsigned long getConnectionInterval() const { return flushTimeout; }
+
+    /// @}
+
+    /// Parse the MIDI data that was received by the Bluetooth stack.
     MIDIReadEvent read() override {
-        update();                         // TODO
-        return MIDIReadEvent::NO_MESSAGE; // TODO
+        uint8_t midiByte;
+        while (receiveQueue.pop(midiByte)) {
+            MIDIReadEvent event = parser.parse(midiByte);
+            if (event != MIDIReadEvent::NO_MESSAGE)
+                return event;
+        }
+        return MIDIReadEvent::NO_MESSAGE;
     }
 
-    template <size_t N>
-    void addToBuffer(const uint8_t (&data)[N]) {
-        addToBuffer(&data[0], N);
+    /// Get the number of incoming BLE packets that were dropped because the
+    /// receive queue was full.
+    unsigned long getOverflowCount() const { return overflowCount; }
+
+  protected:
+    /// Apply the negotiated MTU, and send the buffered outgoing messages if
+    /// they have been waiting for too long.
+    void updateHousekeeping() override {
+        if (mtuChanged.exchange(false))
+            setMTU(bleMidi.getMTU());
+        publishIfTimedOut();
     }
 
-    void addToBuffer(const uint8_t *data, size_t len) {
-        bool first = index == 0;
-        if (!hasSpaceFor(len + 1 + first)) { // TODO
-            DEBUGFN("Buffer full");
+  public:
+    /// Send the current packet if its first message has been waiting for
+    /// longer than one connection interval.
+    void publishIfTimedOut() {
+        if (index > 0 && micros() - startTime >= flushTimeout)
             publish();
-            if (!hasSpaceFor(len + 1 + first)) { // TODO
-                DEBUGFN("Message is larger than buffer");
-                return;
-            }
-        }
+    }
+
+  private:
+    /// Get the 13-bit BLE-MIDI timestamp (in milliseconds).
+    static uint16_t getTimestamp(unsigned long now) {
+        return (now / 1000) & 0x1FFF;
+    }
 
-        if (first)
-            startTime = micros();
+    /// Get the header byte of a packet, containing the six most significant
+    /// bits of the timestamp.
+    static uint8_t getHeader(unsigned long now) {
+        return 0x80 | (getTimestamp(now) >> 7);
+    }
 
-        if (first)
-            buffer[index++] = 0x80; // header / timestamp msb
-        buffer[index++] = 0x80;     // timestamp lsb
-        memcpy(&buffer[index], data, len);
-        index += len;
+    /// Check whether the given number of bytes can be added to the current
+    /// (non-empty) packet. All timestamps in a packet share the same header.
+    bool fitsInPacket(size_t bytes, unsigned long now) const {
+        return hasSpaceFor(bytes) && buffer[0] == getHeader(now);
+    }
 
-        update();
+    /**
+     * @brief   Make sure that there's room for the given number of bytes in the
+     *          current packet, sending it and starting a new one if necessary.
+     *
+     * @param   bytes
+     *          The number of bytes to add to the packet, excluding the header.
+     * @param   now
+     *          The current time in microseconds.
+     * @retval  true
+     *          There's enough space.
+     * @retval  false
+     *          The bytes don't fit in an empty packet.
+     */
+    bool reserve(size_t bytes, unsigned long now) {
+        if (index > 0 && !fitsInPacket(bytes, now))
+            publish();
+        if (index == 0) {
+            if (!hasSpaceFor(bytes + 1)) {
+                DEBUGFN("Message is larger than packet");
+                return false;
+            }
+            buffer[index++] = getHeader(now);
+            startTime = now;
+        }
+        return true;
     }
 
-    void update() override {
-        if (micros() - startTime >= MAX_MESSAGE_TIME)
+    /// Add the timestamp to the packet, unless it's the same as the previous
+    /// one and the message uses running status.
+    void addTimestamp(uint8_t timestamp) {
+        buffer[index++] = timestamp;
+        runningTimestamp = timestamp;
+    }
+
+    /// Send the packet if it's full, otherwise, send it if it has been waiting
+    /// for too long. Larger messages that don't fit anymore start a new packet
+    /// when they are added.
+    void endMessage() {
+        if (!hasSpaceFor(2)) // e.g. timestamp + real-time message
             publish();
+        else
+            publishIfTimedOut();
+    }
+
+    /// Add a channel message or system common message to the packet.
+    void addMessage(const uint8_t *data, size_t len) {
+        unsigned long now = micros();
+        uint8_t timestamp = 0x80 | (getTimestamp(now) & 0x7F);
+        // Running status can't continue in the next packet
+        if (data[0] == runningHeader) {
+            size_t size = len - 1 + (timestamp != runningTimestamp);
+            if (!fitsInPacket(size, now))
+                publish();
+        }
+        bool running = data[0] == runningHeader;
+        bool sameTimestamp = running && timestamp == runningTimestamp;
+        if (!reserve(len - running + !sameTimestamp, now))
+            return;
+        if (!sameTimestamp)
+            addTimestamp(timestamp);
+        if (!running)
+            buffer[index++] = data[0];
+        memcpy(&buffer[index], data + 1, len - 1);
+        index += len - 1;
+        // Only channel messages can use running status
+        runningHeader = data[0] < 0xF0 ? data[0] : 0;
+        endMessage();
     }
 
+  public:
     void sendImpl(uint8_t header, uint8_t d1, uint8_t d2, uint8_t cn) override {
         (void)cn;
         uint8_t msg[3] = {header, d1, d2};
-        addToBuffer(msg);
+        addMessage(msg, 3);
     }
     void sendImpl(uint8_t header, uint8_t d1, uint8_t cn) override {
         (void)cn;
         uint8_t msg[2] = {header, d1};
-        addToBuffer(msg);
+        addMessage(msg, 2);
     }
 
+    /**
+     * @brief   Send a (chunk of a) System Exclusive message.
+     *
+     * The start and end bytes are preceded by a timestamp, SysEx data that
+     * doesn't fit in the current packet continues in the next packet, right
+     * after the header byte.
+     */
     void sendImpl(const uint8_t *data, size_t length, uint8_t cn) override {
-        (void)data;
-        (void)length;
-        (void)cn; // TODO
+        (void)cn;
+        runningHeader = 0;
+        unsigned long now = micros();
+        uint8_t timestamp = 0x80 | (getTimestamp(now) & 0x7F);
+        for (const uint8_t *end = data + length; data < end; ++data) {
+            bool status = *data == 0xF0 || *data == 0xF7;
+            if (!reserve(1 + status, now))
+                return;
+            if (status)
+                addTimestamp(timestamp);
+            buffer[index++] = *data;
+        }
+        runningTimestamp = 0;
+        endMessage();
     }
 
+    /// Real-Time messages don't cancel running status, but they always get
+    /// their own timestamp.
     void sendImpl(uint8_t rt, uint8_t cn) override {
-        (void)rt;
-        (void)cn; // TODO
+        (void)cn;
+        unsigned long now = micros();
+        if (!reserve(2, now))
+            return;
+        addTimestamp(0x80 | (getTimestamp(now) & 0x7F));
+        buffer[index++] = rt;
+        runningTimestamp = 0;
+        endMessage();
     }
 
+    /**
+     * @brief   Handle a BLE-MIDI packet. Called from the callback of the
+     *          Bluetooth stack.
+     *
+     * The timestamps are removed, and the MIDI data is added to the receive
+     * queue, to be parsed in @ref update. This never blocks: if the queue is
+     * full, the entire packet is dropped, and the overflow counter is
+     * incremented.
+     */
     void parse(const uint8_t *const data, const size_t len) {
         // TODO: documentation and link to BLE MIDI spec
         if (len <= 1)
             return;
         if (MIDI_Parser::isData(data[0]))
             return;
+        // Without the header and timestamps, the MIDI data is always shorter
+        // than the packet, so if there's enough space for the entire packet,
+        // all MIDI data will fit in the queue
+        if (receiveQueue.spaceLeft() < len - 1) {
+            DEBUGFN("Receive queue full");
+            ++overflowCount;
+            return;
+        }
         if (MIDI_Parser::isData(data[1]))
-            parse(data[1]);
+            receiveQueue.push(data[1]);
         bool prevWasTimestamp = true;
         for (const uint8_t *d = data + 2; d < data + len; d++) {
             if (MIDI_Parser::isData(*d)) {
-                parse(*d);
+                receiveQueue.push(*d);
                 prevWasTimestamp = false;
             } else {
                 if (prevWasTimestamp)
-                    parse(*d);
+                    receiveQueue.push(*d);
                 prevWasTimestamp = !prevWasTimestamp;
             }
         }
     }
 
-    void parse(uint8_t data) {
-        event = parser.parse(data);
-        // Best we can do is just retry until the pipe is no longer in exclusive
-        // mode.
-        // Keep in mind that this is executed in the callback of the BLE stack,
-        // I don't know what happens to the Bluetooth connection if we let it
-        // wait for longer than the communication interval.
-        //
-        // TODO: If this causes problems, we could buffer the data until the
-        //       pipe is available for writing again.
-        while (!dispatchMIDIEvent(event))
-#ifdef ARDUINO
-            delay(1);
-#else
-            usleep(1e3);
-#endif
-    }
-
     BLEMIDI &getBLEMIDI() { return bleMidi; }
 };
 
@@ -0,0 +1,61 @@
+#include "MIDI_DuplicateFilter.hpp"
+
+BEGIN_CS_NAMESPACE
+
+MIDI_DuplicateFilterBase::Entry *
+MIDI_DuplicateFilterBase::find(ChannelMessage msg) {
+    // Channel Pressure and Pitch Bend have no controller number
+    auto type = msg.getMessageType();
+    bool hasController = type == MIDIMessageType::KEY_PRESSURE ||
+                         type == MIDIMessageType::CONTROL_CHANGE;
+    for (uint8_t i = 0; i < numEntries; ++i) {
+        Entry &entry = storage[i];
+        if (entry.header == msg.header &&
+            (!hasController || entry.data1 == msg.data1))
+            return &entry;
+    }
+    return nullptr;
+}
+
+bool MIDI_DuplicateFilterBase::hasSameValue(const Entry &entry,
+                                            ChannelMessage msg) {
+    return entry.data1 == msg.data1 &&
+           (!msg.hasTwoDataBytes() || entry.data2 == msg.data2);
+}
+
+bool MIDI_DuplicateFilterBase::isFiltered(ChannelMessage msg) const {
+    return MIDI_OutputCoalescerBase::isCoalescable(msg) && !isExcluded(msg);
+}
+
+bool MIDI_DuplicateFilterBase::isDuplicate(ChannelMessage msg) {
+    if (!isFiltered(msg))
+        return false;
+    if (Entry *entry = find(msg)) {
+        if (hasSameValue(*entry, msg)) {
+            ++suppressedCount;
+            return true;
+        }
+        entry->data1 = msg.data1;
+        entry->data2 = msg.data2;
+        return false;
+    }
+    if (numEntries < capacity) {
+        storage[numEntries++] = {msg.header, msg.data1, msg.data2};
+    } else {
+        storage[nextToReplace] = {msg.header, msg.data1, msg.data2};
+        if (++nextToReplace == capacity)
+            nextToReplace = 0;
+    }
+    return false;
+}
+
+void MIDI_DuplicateFilterBase::forget(ChannelMessage msg) {
+    if (!isFiltered(msg))
+        return;
+    Entry *entry = find(msg);
+    if (entry == nullptr || !hasSameValue(*entry, msg))
+        return;
+    *entry = storage[--numEntries];
+}
+
+END_CS_NAMESPACE
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "MIDI_OutputCoalescer.hpp"
+#include <MIDI_Parsers/MIDI_MessageTypes.hpp>
+
+BEGIN_CS_NAMESPACE
+
+/// Non-templated base class for MIDI_DuplicateFilter.
+class MIDI_DuplicateFilterBase : public MIDI_ExcludedControllers {
+  public:
+    /// The last value that was sent for a controller.
+    struct Entry {
+        uint8_t header;
+        uint8_t data1;
+        uint8_t data2;
+    };
+
+  protected:
+    MIDI_DuplicateFilterBase(Entry *storage, uint8_t capacity)
+        : storage(storage), capacity(capacity) {}
+
+  public:
+    MIDI_DuplicateFilterBase(const MIDI_DuplicateFilterBase &) = delete;
+    MIDI_DuplicateFilterBase &
+    operator=(const MIDI_DuplicateFilterBase &) = delete;
+
+    /**
+     * @brief   Check whether the given message has the same value as the
+     *          previous message for the same channel, type and controller
+     *          (or note), and remember its value.
+     *
+     * Only messages that can be coalesced are checked (see
+     * MIDI_OutputCoalescerBase::isCoalescable), and only if their controller
+     * is not excluded (see @ref excludeController). All other messages are
+     * never duplicates.
+     *
+     * @retval  true
+     *          The message is a duplicate, it doesn't have to be sent.
+     * @retval  false
+     *          The message should be sent.
+     */
+    bool isDuplicate(ChannelMessage msg);
+
+    /**
+     * @brief   Forget the value of the given message, if it is the value that
+     *          was remembered for its controller.
+     *
+     * Used when a message that passed the filter is discarded before it is
+     * sent, so the next message with the same value isn't suppressed.
+     */
+    void forget(ChannelMessage msg);
+
+    /// Forget all values, so the next message for every controller is sent.
+    void clear() { numEntries = 0; }
+
+    /// Get the number of controllers whose value is remembered.
+    uint8_t getNumberOfEntries() const { return numEntries; }
+    /// Get the maximum number of controllers whose value is remembered.
+    uint8_t getCapacity() const { return capacity; }
+    /// Get the number of messages that were suppressed.
+    unsigned long getSuppressedCount() const { return suppressedCount; }
+
+  private:
+    bool isFiltered(ChannelMessage msg) const;
+    Entry *find(ChannelMessage msg);
+    static bool hasSameValue(const Entry &entry, ChannelMessage msg);
+
+  private:
+    Entry *storage;
+    uint8_t capacity;
+    uint8_t numEntries = 0;
+    /// The entry that is replaced when a new controller doesn't fit.
+    uint8_t nextToReplace = 0;
+    unsigned long suppressedCount = 0;
+};
+
+/**
+ * @brief   Suppresses outgoing messages that don't change the value of a
+ *          controller.
+ *
+ * Bouncy buttons, noisy potentiometers that are quantized to the same value,
+ * or a bank change that resends all values often cause the same Control
+ * Change, Pitch Bend or pressure message to be sent multiple times in a row.
+ * On a serial MIDI connection, each of them takes up to a millisecond.
+ *
+ * When a duplicate filter is attached to a StreamMIDI_Interface (see
+ * @ref StreamMIDI_Interface::setDuplicateFilter), the last value that was
+ * sent for each controller is remembered, and a message with the same value
+ * as the previous one is not sent again.
+ *
+ * ~~~cpp
+ * HardwareSerialMIDI_Interface midi = Serial1;
+ * MIDI_DuplicateFilter<16> filter;
+ *
+ * void setup() {
+ *     midi.setDuplicateFilter(filter);
+ *     Control_Surface.begin();
+ * }
+ * ~~~
+ *
+ * If more controllers are used than the filter can remember, the oldest
+ * controller is forgotten, and its next value is always sent.
+ *
+ * @warning Only use the filter for controllers with absolute values.
+ *          Relative controllers (e.g. CCRotaryEncoder or MCU V-Pots) send the
+ *          same value for every step in the same direction, so all steps but
+ *          the first would be suppressed. Exclude their controllers using
+ *          @ref excludeController:
+ *          ~~~cpp
+ *          filter.excludeControllers(0x10, 0x17); // MCU V-Pots
+ *          ~~~
+ *
+ * @tparam  N
+ *          The number of controllers whose value is remembered.
+ *
+ * @ingroup MIDIInterfaces
+ */
+template <uint8_t N>
+class MIDI_DuplicateFilter : public MIDI_DuplicateFilterBase {
+  public:
+    MIDI_DuplicateFilter() : MIDI_DuplicateFilterBase(entryStorage, N) {}
+
+  private:
+    Entry entryStorage[N];
+};
+
+END_CS_NAMESPACE
@@ -1,4 +1,5 @@
 #include "MIDI_Interface.hpp"
+#include "MIDI_OutputCoalescer.hpp"
 
 BEGIN_CS_NAMESPACE
 
@@ -25,6 +26,141 @@ MIDI_Interface *MIDI_Interface::getDefault() {
 
 // -------------------------------- SENDING --------------------------------- //
 
+void MIDI_Interface::flushAll() {
+    for (auto &updatable : updatables) {
+        auto &interface = static_cast<MIDI_Interface &>(updatable);
+        interface.sendCoalescedOutput();
+        interface.flush();
+    }
+}
+
+void MIDI_Interface::setOutputCoalescer(MIDI_OutputCoalescerBase *coalescer) {
+    sendAllCoalescedMessages();
+    outputCoalescer = coalescer;
+}
+
+void MIDI_Interface::sendCoalescedOutput() {
+    if (outputCoalescer == nullptr)
+        return;
+    while (!outputCoalescer->isEmpty()) {
+        bool twoBytes = outputCoalescer->front().hasTwoDataBytes();
+        if (!canSendWithoutBlocking(twoBytes ? 3 : 2))
+            break;
+        sendNextCoalescedMessage();
+    }
+}
+
+void MIDI_Interface::sendAllCoalescedMessages() {
+    if (outputCoalescer == nullptr)
+        return;
+    while (!outputCoalescer->isEmpty())
+        sendNextCoalescedMessage();
+}
+
+void MIDI_Interface::sendNextCoalescedMessage() {
+    ChannelMessage msg = outputCoalescer->front();
+    outputCoalescer->pop();
+    if (msg.hasTwoDataBytes())
+        sendImpl(msg.header, msg.data1, msg.data2, msg.CN);
+    else
+        sendImpl(msg.header, msg.data1, msg.CN);
+}
+
+bool MIDI_Interface::coalesceOutput(ChannelMessage msg) {
+    if (outputCoalescer == nullptr)
+        return false;
+    // Other messages can't overtake the pending ones, e.g. a note must not
+    // arrive before the controller values that were sent earlier.
+    if (!outputCoalescer->shouldCoalesce(msg)) {
+        sendAllCoalescedMessages();
+        return false;
+    }
+    // A newer value for a pending controller simply replaces the old value
+    if (outputCoalescer->replace(msg))
+        return true;
+    // Send right away if that doesn't overtake pending messages or block
+    if (outputCoalescer->isEmpty() &&
+        canSendWithoutBlocking(msg.hasTwoDataBytes() ? 3 : 2))
+        return false;
+    // If the queue is full, fall back to blocking
+    return outputCoalescer->push(msg);
+}
+
+void MIDI_Interface::sendChannelMessageImpl(uint8_t header, uint8_t d1,
+                                            uint8_t d2, uint8_t cn) {
+    if (!coalesceOutput({header, d1, d2, cn}))
+        sendImpl(header, d1, d2, cn);
+}
+
+void MIDI_Interface::sendChannelMessageImpl(uint8_t header, uint8_t d1,
+                                            uint8_t cn) {
+    if (!coalesceOutput({header, d1, 0x00, cn}))
+        sendImpl(header, d1, cn);
+}
+
+void MIDI_Interface::sendSysExImpl(SysExMessage message) {
+    sendAllCoalescedMessages();
+    MIDI_Sender<MIDI_Interface>::sendSysExImpl(message);
+}
+
+// -------------------------------- READING --------------------------------- //
+
+uint8_t MIDI_Interface::roundRobinPosition = 0;
+
+void MIDI_Interface::updateAllWithBudget(AH::WorkBudget &budget) {
+    budget.start();
+    for (auto &updatable : updatables) {
+        auto &interface = static_cast<MIDI_Interface &>(updatable);
+        interface.updateBudget.start();
+        interface.idle = false;
+        interface.updateHousekeeping();
+    }
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        // Two sweeps over the list: first the interfaces starting at
+        // roundRobinPosition, then the ones before it.
+        uint8_t first = roundRobinPosition;
+        for (uint8_t sweep = 0; sweep < 2; ++sweep) {
+            uint8_t position = 0;
+            for (auto &interface : updatables) {
+                bool turn = (position++ >= first) == (sweep == 0);
+                if (!turn)
+                    continue;
+                if (budget.isExhausted())
+                    return;
+                if (static_cast<MIDI_Interface &>(interface)
+                        .updateSingleMessage()) {
+                    budget.consume();
+                    progress = true;
+                    roundRobinPosition = position; // the next one goes first
+                }
+            }
+        }
+    }
+}
+
+bool MIDI_Interface::updateSingleMessage() {
+    if (idle)
+        return false;
+    if (updateBudget.isExhausted()) {
+        idle = true;
+        return false;
+    }
+    AH::WorkBudget single = 1;
+    single.start();
+    readWithBudget(single);
+    // Interfaces that don't count their messages are only updated once.
+    if (single.getItemCount() == 0) {
+        idle = true;
+        return false;
+    }
+    updateBudget.consume();
+    return true;
+}
+
+// -------------------------------------------------------------------------- //
+
 void MIDI_Interface::sinkMIDIfromPipe(ChannelMessage msg) { send(msg); }
 void MIDI_Interface::sinkMIDIfromPipe(SysExMessage msg) { send(msg); }
 void MIDI_Interface::sinkMIDIfromPipe(RealTimeMessage msg) { send(msg); }
@@ -32,16 +168,24 @@ void MIDI_Interface::sinkMIDIfromPipe(RealTimeMessage msg) { send(msg); }
 // -------------------------------- READING --------------------------------- //
 
 void Parsing_MIDI_Interface::update() {
-    if (event == MIDIReadEvent::NO_MESSAGE) // If previous event was handled
-        event = read();                     // Read the next incoming message
-    while (event != MIDIReadEvent::NO_MESSAGE) { // As long as there are
-                                                 // incoming messages
-        if (dispatchMIDIEvent(event)) // If event was handled successfully
-            event = read();           // Read the next incoming message
-        else                          // If pipe is locked
-            break;                    // Try sending again next time
+    updateBudget.start();
+    updateWithBudget(updateBudget);
+}
+
+void Parsing_MIDI_Interface::readWithBudget(AH::WorkBudget &budget) {
+    while (true) {
+        if (event == MIDIReadEvent::NO_MESSAGE) { // If previous event was handled
+            if (budget.isExhausted())             // No time for another one
+                return;
+            event = read(); // Read the next incoming message
+            if (event == MIDIReadEvent::NO_MESSAGE) // No more incoming messages
+                return;
+        }
+        if (!dispatchMIDIEvent(event)) // If pipe is locked
+            return;                    // Try sending again next time
+        event = MIDIReadEvent::NO_MESSAGE;
+        budget.consume();
     }
-    // TODO: maximum number of iterations? Timeout?
 }
 
 bool Parsing_MIDI_Interface::dispatchMIDIEvent(MIDIReadEvent event) {
@@ -49,6 +193,7 @@ bool Parsing_MIDI_Interface::dispatchMIDIEvent(MIDIReadEvent event) {
         case MIDIReadEvent::NO_MESSAGE: return true;
         case MIDIReadEvent::CHANNEL_MESSAGE: return onChannelMessage();
         case MIDIReadEvent::SYSEX_MESSAGE: return onSysExMessage();
+        case MIDIReadEvent::SYSEX_CHUNK: return onSysExMessage();
         case MIDIReadEvent::REALTIME_MESSAGE: return onRealTimeMessage();
         default: return true;
     }
@@ -2,9 +2,11 @@
 
 #include "MIDI_Pipes.hpp"
 #include <AH/Containers/Updatable.hpp>
+#include <AH/Timing/WorkBudget.hpp>
 #include <Def/Def.hpp>
 #include <Def/MIDIAddress.hpp>
 #include <MIDI_Parsers/MIDI_Parser.hpp>
+#include <Settings/SettingsWrapper.hpp>
 
 BEGIN_CS_NAMESPACE
 
@@ -124,8 +126,23 @@ class MIDI_Sender {
     void send(MIDIMessageType rt, Cable cable = CABLE_1);
 
     /// @}
+
+  protected:
+    /// All channel messages pass through these functions before they are
+    /// passed to `sendImpl`. The derived class can hide them to intercept
+    /// the outgoing channel messages.
+    void sendChannelMessageImpl(uint8_t header, uint8_t d1, uint8_t d2,
+                                uint8_t cn);
+    /// @copydoc sendChannelMessageImpl(uint8_t, uint8_t, uint8_t, uint8_t)
+    void sendChannelMessageImpl(uint8_t header, uint8_t d1, uint8_t cn);
+    /// All System Exclusive messages (and chunks) pass through this function
+    /// before they are passed to `sendImpl` or `sendChunkImpl`. The derived
+    /// class can hide it to intercept them.
+    void sendSysExImpl(SysExMessage message);
 };
 
+class MIDI_OutputCoalescerBase;
+
 /**
  * @brief   An abstract class for MIDI interfaces.
  */
@@ -157,6 +174,115 @@ class MIDI_Interface : public TrueMIDI_SinkSource,
      */
     void update() override = 0;
 
+    /**
+     * @brief   Read the MIDI interface, but stop handling incoming messages
+     *          when the given budget is exhausted. The remaining messages are
+     *          handled during the next update.
+     *
+     * Each message that is handled counts as one item of the budget.
+     * This first calls @ref updateHousekeeping, and then
+     * @ref readWithBudget.
+     */
+    void updateWithBudget(AH::WorkBudget &budget) {
+        updateHousekeeping();
+        readWithBudget(budget);
+    }
+
+    /**
+     * @brief   Update all MIDI interfaces, sharing the given budget, which is
+     *          started first.
+     *
+     * First, @ref updateHousekeeping is called once for every interface.
+     * Then the interfaces take turns handling a single message (round-robin),
+     * until all of them are idle, or until the budget is exhausted. When
+     * the budget runs out, the interface after the one that handled the last
+     * message goes first during the next call. This way, a flood of messages
+     * on one interface can't starve the others.
+     *
+     * The limits of each interface (see @ref setUpdateLimits) apply in
+     * addition to the shared budget.
+     */
+    static void updateAllWithBudget(AH::WorkBudget &budget);
+
+    /**
+     * @brief   Limit the number of incoming messages handled by a single call
+     *          to @ref update, and/or the time spent.
+     *
+     * Messages that don't fit are handled during the next update, none of
+     * them are lost (as long as the buffers of the underlying hardware don't
+     * overflow). At least one message is handled per update.
+     *
+     * @param   maxMessages
+     *          The maximum number of messages, or zero for no limit.
+     * @param   maxMicros
+     *          The maximum time in microseconds, or zero for no limit.
+     */
+    void setUpdateLimits(uint16_t maxMessages, unsigned long maxMicros) {
+        updateBudget.setMaxItems(maxMessages);
+        updateBudget.setMaxMicros(maxMicros);
+    }
+    /// Get the maximum number of messages per update (zero means no limit).
+    uint16_t getMaxMessagesPerUpdate() const {
+        return updateBudget.getMaxItems();
+    }
+    /// Get the maximum time per update in microseconds (zero means no limit).
+    unsigned long getMaxMicrosPerUpdate() const {
+        return updateBudget.getMaxMicros();
+    }
+
+    /**
+     * @brief   Send any outgoing MIDI messages that are still buffered by the
+     *          interface.
+     */
+    virtual void flush() {}
+
+    /// Send the pending messages of the output coalescer and flush all MIDI
+    /// interfaces.
+    static void flushAll();
+
+    /// @name   Output Coalescing
+    /// @{
+
+    /**
+     * @brief   Only send the latest value of continuous controllers while the
+     *          interface is busy, see @ref MIDI_OutputCoalescer.
+     *
+     * @param   coalescer
+     *          The queue for the pending messages, or `nullptr` to disable
+     *          coalescing. The messages that are still pending in the
+     *          previous coalescer are sent first.
+     */
+    void setOutputCoalescer(MIDI_OutputCoalescerBase *coalescer);
+    /// @copydoc setOutputCoalescer(MIDI_OutputCoalescerBase *)
+    void setOutputCoalescer(MIDI_OutputCoalescerBase &coalescer) {
+        setOutputCoalescer(&coalescer);
+    }
+    /// Get the output coalescer, or `nullptr` if coalescing is disabled.
+    MIDI_OutputCoalescerBase *getOutputCoalescer() { return outputCoalescer; }
+    /// @copydoc getOutputCoalescer()
+    const MIDI_OutputCoalescerBase *getOutputCoalescer() const {
+        return outputCoalescer;
+    }
+
+    /// Send the messages that are pending in the output coalescer, as long as
+    /// the interface can accept them without blocking.
+    void sendCoalescedOutput();
+
+    /**
+     * @brief   Check whether a message of the given number of bytes can be
+     *          sent right away, without having to wait for the interface to
+     *          transmit earlier messages.
+     *
+     * Used by the output coalescer. The default implementation always
+     * returns true.
+     */
+    virtual bool canSendWithoutBlocking(uint8_t length) {
+        (void)length;
+        return true;
+    }
+
+    /// @}
+
     /// @name   Default MIDI Interfaces
     /// @{
     /**
@@ -194,6 +320,15 @@ class MIDI_Interface : public TrueMIDI_SinkSource,
 
   protected:
     friend class MIDI_Sender<MIDI_Interface>;
+    /// Send the message through the output coalescer, if there is one.
+    void sendChannelMessageImpl(uint8_t header, uint8_t d1, uint8_t d2,
+                                uint8_t cn);
+    /// @copydoc sendChannelMessageImpl(uint8_t, uint8_t, uint8_t, uint8_t)
+    void sendChannelMessageImpl(uint8_t header, uint8_t d1, uint8_t cn);
+    /// Send the pending messages of the output coalescer before the System
+    /// Exclusive message.
+    void sendSysExImpl(SysExMessage message);
+
     /**
      * @brief   Low-level function for sending a 3-byte MIDI message.
      */
@@ -209,6 +344,17 @@ class MIDI_Interface : public TrueMIDI_SinkSource,
      */
     virtual void sendImpl(const uint8_t *data, size_t length, uint8_t cn) = 0;
 
+    /**
+     * @brief   Low-level function for sending a chunk of a long system
+     *          exclusive MIDI message (see SysExMessage::chunked).
+     *
+     * By default, the chunk is sent as-is, using the function for sending
+     * complete system exclusive messages.
+     */
+    virtual void sendChunkImpl(const uint8_t *data, size_t length, uint8_t cn) {
+        sendImpl(data, length, cn);
+    }
+
     /** 
      * @brief   Low-level function for sending a single-byte MIDI message.
      */
@@ -222,8 +368,62 @@ class MIDI_Interface : public TrueMIDI_SinkSource,
     /// Accept an incoming MIDI Real-Time message.
     void sinkMIDIfromPipe(RealTimeMessage) override;
 
+  protected:
+    /**
+     * @brief   Do the periodic work that doesn't depend on the incoming
+     *          messages, e.g. sending buffered outgoing messages whose
+     *          deadline has expired.
+     *
+     * Called once per update, before reading. Does nothing by default.
+     */
+    virtual void updateHousekeeping() {}
+
+    /**
+     * @brief   Handle incoming messages until the given budget is exhausted.
+     *
+     * The default implementation ignores the budget and simply calls
+     * @ref update.
+     */
+    virtual void readWithBudget(AH::WorkBudget &budget) {
+        (void)budget;
+        update();
+    }
+
+  protected:
+    /// The limits of a single update, see @ref setUpdateLimits.
+    AH::WorkBudget updateBudget = {
+        MIDI_INTERFACE_MAX_MESSAGES_PER_UPDATE,
+        MIDI_INTERFACE_MAX_MICROS_PER_UPDATE,
+    };
+
   private:
+    /// Handle a single incoming message, unless the limits of this interface
+    /// have been reached. Returns false if no message was handled, in which
+    /// case the interface is marked as idle until the next call to
+    /// @ref updateAllWithBudget.
+    bool updateSingleMessage();
+
+    /// Whether this interface had no more messages to handle (or reached its
+    /// limits) during the current call to @ref updateAllWithBudget.
+    bool idle = false;
+
+    /// Queue the message in the output coalescer if it should not be sent
+    /// right away.
+    /// @return Returns true if the message was queued or coalesced.
+    bool coalesceOutput(ChannelMessage msg);
+    /// Send all pending messages of the output coalescer, blocking if
+    /// necessary.
+    void sendAllCoalescedMessages();
+    /// Remove the oldest message from the output coalescer and send it.
+    void sendNextCoalescedMessage();
+
+  private:
+    MIDI_OutputCoalescerBase *outputCoalescer = nullptr;
+
     static MIDI_Interface *DefaultMIDI_Interface;
+    /// The position in the list of MIDI interfaces of the interface that gets
+    /// the first turn in @ref updateAllWithBudget.
+    static uint8_t roundRobinPosition;
 };
 
 /**
@@ -268,6 +468,7 @@ class Parsing_MIDI_Interface : public MIDI_Interface {
     using MIDI_Interface::setCallbacks;
 
   protected:
+    void readWithBudget(AH::WorkBudget &budget) override;
     bool dispatchMIDIEvent(MIDIReadEvent event);
 
   private:
@@ -297,7 +498,8 @@ class MIDI_Callbacks {
     /// Callback for incoming MIDI Channel Messages (notes, control change,
     /// pitch bend, etc.)
     virtual void onChannelMessage(Parsing_MIDI_Interface &midi) { (void)midi; }
-    /// Callback for incoming MIDI System Exclusive Messages.
+    /// Callback for incoming MIDI System Exclusive Messages (or chunks of
+    /// long messages, see MIDI_Parser::setSysExChunking).
     virtual void onSysExMessage(Parsing_MIDI_Interface &midi) { (void)midi; }
     /// Callback for incoming MIDI Real-Time Messages.
     virtual void onRealTimeMessage(Parsing_MIDI_Interface &midi) { (void)midi; }
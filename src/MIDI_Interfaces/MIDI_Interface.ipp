@@ -24,7 +24,7 @@ void MIDI_Sender<Derived>::sendOnCable(MIDIMessageType m, Channel c, uint8_t d1,
     mm |= 0b10000000; // set msb
     d1 &= 0x7F;       // clear msb
     d2 &= 0x7F;       // clear msb
-    CRTP(Derived).sendImpl(mm | cc, d1, d2, cable.getRaw());
+    CRTP(Derived).sendChannelMessageImpl(mm | cc, d1, d2, cable.getRaw());
 }
 
 template <class Derived>
@@ -35,7 +35,7 @@ void MIDI_Sender<Derived>::sendOnCable(MIDIMessageType m, Channel c, uint8_t d1,
     mm &= 0xF0;       // bitmask high nibble
     mm |= 0b10000000; // set msb
     d1 &= 0x7F;       // clear msb
-    CRTP(Derived).sendImpl(mm | cc, d1, cable.getRaw());
+    CRTP(Derived).sendChannelMessageImpl(mm | cc, d1, cable.getRaw());
 }
 
 template <class Derived>
@@ -96,16 +96,17 @@ void MIDI_Sender<Derived>::sendPB(MIDIChannelCN address, uint16_t value) {
 template <class Derived>
 void MIDI_Sender<Derived>::send(SysExMessage message) {
     if (message.length) {
-        if (message.length < 2) {
+        // Chunks of long messages can have any length
+        if (!message.chunked && message.length < 2) {
             ERROR(F("Error: invalid SysEx length"), 0x7F7F);
             return;
         }
-        CRTP(Derived).sendImpl(message.data, message.length, message.CN);
+        CRTP(Derived).sendSysExImpl(message);
     }
 }
 template <class Derived>
 void MIDI_Sender<Derived>::send(MIDIMessageType rt, Cable cable) {
-    CRTP(Derived).sendImpl(rt, cable.getRaw());
+    CRTP(Derived).sendImpl(uint8_t(rt), cable.getRaw());
 }
 
 template <class Derived>
@@ -116,10 +117,31 @@ void MIDI_Sender<Derived>::send(RealTimeMessage message) {
 template <class Derived>
 void MIDI_Sender<Derived>::send(ChannelMessage message) {
     if (message.hasTwoDataBytes())
-        CRTP(Derived).sendImpl(message.header, message.data1, message.data2,
-                               message.CN);
+        CRTP(Derived).sendChannelMessageImpl(message.header, message.data1,
+                                             message.data2, message.CN);
+    else
+        CRTP(Derived).sendChannelMessageImpl(message.header, message.data1,
+                                             message.CN);
+}
+
+template <class Derived>
+void MIDI_Sender<Derived>::sendChannelMessageImpl(uint8_t header, uint8_t d1,
+                                                  uint8_t d2, uint8_t cn) {
+    CRTP(Derived).sendImpl(header, d1, d2, cn);
+}
+
+template <class Derived>
+void MIDI_Sender<Derived>::sendChannelMessageImpl(uint8_t header, uint8_t d1,
+                                                  uint8_t cn) {
+    CRTP(Derived).sendImpl(header, d1, cn);
+}
+
+template <class Derived>
+void MIDI_Sender<Derived>::sendSysExImpl(SysExMessage message) {
+    if (message.chunked)
+        CRTP(Derived).sendChunkImpl(message.data, message.length, message.CN);
     else
-        CRTP(Derived).sendImpl(message.header, message.data1, message.CN);
+        CRTP(Derived).sendImpl(message.data, message.length, message.CN);
 }
 
 END_CS_NAMESPACE
\ No newline at end of file
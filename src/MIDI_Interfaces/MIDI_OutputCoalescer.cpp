@@ -0,0 +1,77 @@
+#include "MIDI_OutputCoalescer.hpp"
+
+BEGIN_CS_NAMESPACE
+
+bool MIDI_OutputCoalescerBase::isCoalescable(ChannelMessage msg) {
+    auto type = msg.getMessageType();
+    if (type == MIDIMessageType::PITCH_BEND ||
+        type == MIDIMessageType::CHANNEL_PRESSURE ||
+        type == MIDIMessageType::KEY_PRESSURE)
+        return true;
+    if (type != MIDIMessageType::CONTROL_CHANGE)
+        return false;
+    switch (msg.data1) {
+        case 0x00: // Bank Select MSB
+        case 0x20: // Bank Select LSB
+        case 0x06: // Data Entry MSB
+        case 0x26: // Data Entry LSB
+        case 0x40: // Sustain
+        case 0x41: // Portamento
+        case 0x42: // Sostenuto
+        case 0x43: // Soft Pedal
+        case 0x44: // Legato Footswitch
+        case 0x45: // Hold 2
+        case 0x60: // Data Increment
+        case 0x61: // Data Decrement
+        case 0x62: // NRPN LSB
+        case 0x63: // NRPN MSB
+        case 0x64: // RPN LSB
+        case 0x65: return false; // RPN MSB
+        default: return msg.data1 < 0x78; // No Channel Mode messages
+    }
+}
+
+bool MIDI_OutputCoalescerBase::replace(ChannelMessage msg) {
+    // Channel Pressure and Pitch Bend have no controller number
+    auto type = msg.getMessageType();
+    bool hasController = type == MIDIMessageType::KEY_PRESSURE ||
+                         type == MIDIMessageType::CONTROL_CHANGE;
+    uint8_t index = first;
+    for (uint8_t i = 0; i < numPending; ++i) {
+        PendingMessage &pending = storage[index];
+        if (pending.header == msg.header && pending.CN == msg.CN &&
+            (!hasController || pending.data1 == msg.data1)) {
+            pending.data1 = msg.data1;
+            pending.data2 = msg.data2;
+            ++coalescedCount;
+            return true;
+        }
+        if (++index == capacity)
+            index = 0;
+    }
+    return false;
+}
+
+bool MIDI_OutputCoalescerBase::push(ChannelMessage msg) {
+    if (numPending == capacity)
+        return false;
+    uint8_t index = first + numPending;
+    if (index >= capacity)
+        index -= capacity;
+    storage[index] = {msg.header, msg.data1, msg.data2, msg.CN};
+    ++numPending;
+    return true;
+}
+
+ChannelMessage MIDI_OutputCoalescerBase::front() const {
+    const PendingMessage &pending = storage[first];
+    return {pending.header, pending.data1, pending.data2, pending.CN};
+}
+
+void MIDI_OutputCoalescerBase::pop() {
+    if (++first == capacity)
+        first = 0;
+    --numPending;
+}
+
+END_CS_NAMESPACE
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <AH/Containers/BitArray.hpp>
+#include <MIDI_Parsers/MIDI_MessageTypes.hpp>
+
+BEGIN_CS_NAMESPACE
+
+/**
+ * @brief   A set of Control Change controllers whose messages must never be
+ *          coalesced, replaced or suppressed.
+ *
+ * Relative controllers, such as a CCRotaryEncoder or the V-Pots of the Mackie
+ * Control Universal protocol, send a change instead of an absolute value, and
+ * every detent of the encoder sends the same byte. Each of these messages has
+ * to reach the receiver, so the controllers they use have to be excluded.
+ */
+class MIDI_ExcludedControllers {
+  public:
+    /// Never coalesce the given controller.
+    void excludeController(uint8_t controller) {
+        excluded.set(controller & 0x7F);
+    }
+    /// Never coalesce the controllers from @p first up to and including
+    /// @p last.
+    void excludeControllers(uint8_t first, uint8_t last) {
+        for (uint8_t controller = first; controller <= last && controller < 128;
+             ++controller)
+            excludeController(controller);
+    }
+    /// Allow the given controller to be coalesced again.
+    void includeController(uint8_t controller) {
+        excluded.clear(controller & 0x7F);
+    }
+    /// Check whether the given message is a Control Change message for an
+    /// excluded controller.
+    bool isExcluded(ChannelMessage msg) const {
+        return msg.getMessageType() == MIDIMessageType::CONTROL_CHANGE &&
+               excluded.get(msg.data1 & 0x7F);
+    }
+
+  private:
+    AH::BitArray<128> excluded;
+};
+
+/// Non-templated base class for MIDI_OutputCoalescer.
+class MIDI_OutputCoalescerBase : public MIDI_ExcludedControllers {
+  public:
+    /// A channel message that is waiting to be sent.
+    struct PendingMessage {
+        uint8_t header;
+        uint8_t data1;
+        uint8_t data2;
+        uint8_t CN;
+    };
+
+  protected:
+    MIDI_OutputCoalescerBase(PendingMessage *storage, uint8_t capacity)
+        : storage(storage), capacity(capacity) {}
+
+  public:
+    MIDI_OutputCoalescerBase(const MIDI_OutputCoalescerBase &) = delete;
+    MIDI_OutputCoalescerBase &
+    operator=(const MIDI_OutputCoalescerBase &) = delete;
+
+    /**
+     * @brief   Check whether only the latest value of the given message has
+     *          to be sent.
+     *
+     * This is the case for Control Change, Pitch Bend, Channel Pressure and
+     * Key Pressure messages. Control Change messages for Bank Select, (N)RPN
+     * and Data Entry, the switches (Sustain, Portamento, Sostenuto, Soft
+     * Pedal, Legato and Hold 2), and Channel Mode messages are not coalesced,
+     * because the receiver needs every one of them, in the right order.
+     */
+    static bool isCoalescable(ChannelMessage msg);
+
+    /// Check whether the given message can be coalesced, and its controller
+    /// is not excluded (see @ref excludeController).
+    bool shouldCoalesce(ChannelMessage msg) const {
+        return isCoalescable(msg) && !isExcluded(msg);
+    }
+
+    /**
+     * @brief   If a message with the same cable, channel, type and controller
+     *          (or note) is pending, replace its value by the value of the
+     *          given message.
+     *
+     * The pending message keeps its position in the queue.
+     *
+     * @retval  true
+     *          The pending message was updated, the given message should not
+     *          be sent.
+     * @retval  false
+     *          No such message is pending.
+     */
+    bool replace(ChannelMessage msg);
+
+    /// Add a message to the back of the queue.
+    /// @return Returns false if the queue is full.
+    bool push(ChannelMessage msg);
+
+    /// Get the oldest pending message. The queue should not be empty.
+    ChannelMessage front() const;
+    /// Remove the oldest pending message. The queue should not be empty.
+    void pop();
+    /// Remove all pending messages.
+    void clear() { numPending = 0; }
+
+    /// Check whether there are any pending messages.
+    bool isEmpty() const { return numPending == 0; }
+    /// Get the number of pending messages.
+    uint8_t getNumberOfPending() const { return numPending; }
+    /// Get the maximum number of pending messages.
+    uint8_t getCapacity() const { return capacity; }
+    /// Get the number of messages that were replaced by a newer value before
+    /// they could be sent.
+    unsigned long getCoalescedCount() const { return coalescedCount; }
+
+  private:
+    PendingMessage *storage;
+    uint8_t capacity;
+    /// Index of the oldest pending message.
+    uint8_t first = 0;
+    uint8_t numPending = 0;
+    unsigned long coalescedCount = 0;
+};
+
+/**
+ * @brief   Keeps only the latest value of continuous controllers while the
+ *          MIDI interface is busy.
+ *
+ * When a fader moves quickly, it generates a new message for every change of
+ * the filtered value. If the MIDI interface is slower than that (e.g. serial
+ * MIDI at 31250 baud or BLE), the messages pile up in the transmit buffer,
+ * and the value on the wire lags further and further behind the position of
+ * the fader.
+ *
+ * When a coalescer is attached to a MIDI interface (see
+ * @ref MIDI_Interface::setOutputCoalescer), Control Change, Pitch Bend and
+ * pressure messages are only sent immediately if the interface can accept
+ * them without blocking. Otherwise, they are queued, and a newer message for
+ * the same cable, channel, type and controller simply replaces the value of
+ * the pending one. The queued messages are sent when the interface is
+ * flushed, in the MIDIFlush stage of @ref Control_Surface_::loop. The
+ * freshest value is always sent, and the bandwidth is bounded by the number
+ * of different controllers rather than the number of changes.
+ *
+ * ~~~cpp
+ * HardwareSerialMIDI_Interface midi = Serial1;
+ * MIDI_OutputCoalescer<8> coalescer;
+ *
+ * void setup() {
+ *     midi.setOutputCoalescer(coalescer);
+ *     Control_Surface.begin();
+ * }
+ * ~~~
+ *
+ * Whether the interface is busy is determined by
+ * @ref MIDI_Interface::canSendWithoutBlocking. For serial interfaces, this
+ * requires a Stream that implements `availableForWrite()`, otherwise all
+ * messages are sent immediately.
+ *
+ * Other messages (e.g. notes, switches like the sustain pedal, or System
+ * Exclusive messages) are never queued. The pending messages are sent before
+ * them, blocking if necessary, so a note can't arrive before the controller
+ * values that were sent earlier. Only Real-Time messages may overtake the
+ * pending messages.
+ *
+ * If the queue is full, messages for new controllers are sent immediately,
+ * blocking if necessary. The relative order of messages for different
+ * controllers is not preserved.
+ *
+ * Relative controllers (e.g. CCRotaryEncoder) send the same value for every
+ * step, so replacing a pending message would lose steps. Their controllers
+ * have to be excluded using @ref excludeController:
+ *
+ * ~~~cpp
+ * coalescer.excludeControllers(0x10, 0x17); // MCU V-Pots
+ * ~~~
+ *
+ * @tparam  N
+ *          The maximum number of pending messages, i.e. the number of
+ *          controllers that can be coalesced at the same time.
+ *
+ * @ingroup MIDIInterfaces
+ */
+template <uint8_t N>
+class MIDI_OutputCoalescer : public MIDI_OutputCoalescerBase {
+  public:
+    MIDI_OutputCoalescer() : MIDI_OutputCoalescerBase(pendingStorage, N) {}
+
+  private:
+    PendingMessage pendingStorage[N];
+};
+
+END_CS_NAMESPACE
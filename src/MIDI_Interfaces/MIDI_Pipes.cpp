@@ -118,7 +118,11 @@ MIDI_Source &MIDI_Source::operator=(MIDI_Source &&other) {
     return *this;
 }
 
-MIDI_Source::~MIDI_Source() { disconnectSinkPipes(); }
+MIDI_Source::~MIDI_Source() {
+    if (isFrozen())
+        MIDI_RoutingTableBase::thawAll();
+    disconnectSinkPipes();
+}
 
 void MIDI_Source::exclusive(cn_t cn, bool exclusive) {
     if (hasSinkPipe())
@@ -126,21 +130,32 @@ void MIDI_Source::exclusive(cn_t cn, bool exclusive) {
 }
 
 bool MIDI_Source::canWrite(cn_t cn) const {
+    if (isFrozen())
+        return (route->locks & (1u << cn)) == 0;
     return !hasSinkPipe() || sinkPipe->isAvailableForWrite(cn);
 }
 
 void MIDI_Source::sourceMIDItoPipe(ChannelMessage msg) {
-    if (sinkPipe != nullptr) {
+    if (isFrozen()) {
+        for (uint8_t i = 0; i < route->numPipes; ++i)
+            route->pipes[i]->mapForwardMIDI(msg);
+    } else if (sinkPipe != nullptr) {
         sinkPipe->pipeMIDI(msg);
     }
 }
 void MIDI_Source::sourceMIDItoPipe(SysExMessage msg) {
-    if (sinkPipe != nullptr) {
+    if (isFrozen()) {
+        for (uint8_t i = 0; i < route->numPipes; ++i)
+            route->pipes[i]->mapForwardMIDI(msg);
+    } else if (sinkPipe != nullptr) {
         sinkPipe->pipeMIDI(msg);
     }
 }
 void MIDI_Source::sourceMIDItoPipe(RealTimeMessage msg) {
-    if (sinkPipe != nullptr) {
+    if (isFrozen()) {
+        for (uint8_t i = 0; i < route->numPipes; ++i)
+            route->pipes[i]->mapForwardMIDI(msg);
+    } else if (sinkPipe != nullptr) {
         sinkPipe->pipeMIDI(msg);
     }
 }
@@ -152,20 +167,28 @@ void MIDI_Pipe::connectSink(MIDI_Sink *sink) {
         FATAL_ERROR(F("This pipe is already connected to a sink"), 0x9145);
         return; // LCOV_EXCL_LINE
     }
+    MIDI_RoutingTableBase::thawAll();
     this->sink = sink;
 }
 
-void MIDI_Pipe::disconnectSink() { this->sink = nullptr; }
+void MIDI_Pipe::disconnectSink() {
+    MIDI_RoutingTableBase::thawAll();
+    this->sink = nullptr;
+}
 
 void MIDI_Pipe::connectSource(MIDI_Source *source) {
     if (this->source != nullptr) {
         FATAL_ERROR(F("This pipe is already connected to a source"), 0x9146);
         return; // LCOV_EXCL_LINE
     }
+    MIDI_RoutingTableBase::thawAll();
     this->source = source;
 }
 
-void MIDI_Pipe::disconnectSource() { this->source = nullptr; }
+void MIDI_Pipe::disconnectSource() {
+    MIDI_RoutingTableBase::thawAll();
+    this->source = nullptr;
+}
 
 void MIDI_Pipe::disconnect() {
     if (hasSink() && hasThroughIn()) {
@@ -206,6 +229,88 @@ void MIDI_Pipe::exclusive(cn_t cn, bool exclusive) {
         sink->lockDownstream(cn, exclusive);
     if (hasThroughIn())
         throughIn->lockUpstream(cn, exclusive);
+    MIDI_RoutingTableBase::updateAllLocks();
+}
+
+// :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+DoublyLinkedList<MIDI_RoutingTableBase> MIDI_RoutingTableBase::tables;
+
+MIDI_RoutingTableBase::MIDI_RoutingTableBase(MIDI_Route *routes,
+                                             uint8_t maxRoutes,
+                                             MIDI_Pipe **pipes,
+                                             uint8_t maxPipes)
+    : routes(routes), pipes(pipes), maxRoutes(maxRoutes), maxPipes(maxPipes) {
+    tables.append(this);
+}
+
+MIDI_RoutingTableBase::~MIDI_RoutingTableBase() {
+    thaw();
+    tables.remove(this);
+}
+
+bool MIDI_RoutingTableBase::freeze(MIDI_Source &source) {
+    if (source.isFrozen()) {
+        ERROR(F("This source is frozen already"), 0x9148);
+        return false;
+    }
+    if (numRoutes >= maxRoutes) {
+        ERROR(F("Not enough routes available"), 0x9149);
+        return false;
+    }
+    // Collect the pipe the source is connected to, and all pipes connected to
+    // its "through" output
+    uint8_t first = numPipes;
+    for (MIDI_Pipe *pipe = source.sinkPipe; pipe; pipe = pipe->throughOut) {
+        if (numPipes >= maxPipes) {
+            numPipes = first;
+            ERROR(F("Not enough pipes available"), 0x914A);
+            return false;
+        }
+        pipes[numPipes++] = pipe;
+    }
+    // MIDI_Pipe::pipeMIDI forwards the message to the "through" output before
+    // forwarding it to its own sink, so the last pipe receives it first
+    for (uint8_t i = first, j = numPipes; i + 1 < j; ++i, --j)
+        std::swap(pipes[i], pipes[j - 1]);
+    for (uint8_t i = first; i < numPipes; ++i)
+        pipes[i]->frozenSink = pipes[i]->getFinalSink();
+
+    MIDI_Route &route = routes[numRoutes++];
+    route = {&source, pipes + first, uint8_t(numPipes - first), 0};
+    source.route = &route;
+    updateLocks();
+    return true;
+}
+
+void MIDI_RoutingTableBase::thaw() {
+    for (uint8_t i = 0; i < numRoutes; ++i)
+        routes[i].source->route = nullptr;
+    for (uint8_t i = 0; i < numPipes; ++i)
+        pipes[i]->frozenSink = nullptr;
+    numRoutes = 0;
+    numPipes = 0;
+}
+
+void MIDI_RoutingTableBase::updateLocks() {
+    for (uint8_t r = 0; r < numRoutes; ++r) {
+        MIDI_Route &route = routes[r];
+        route.locks = 0;
+        for (uint8_t p = 0; p < route.numPipes; ++p)
+            for (cn_t cn = 0; cn < 16; ++cn)
+                if (route.pipes[p]->isLocked(cn))
+                    route.locks |= 1u << cn;
+    }
+}
+
+void MIDI_RoutingTableBase::thawAll() {
+    for (MIDI_RoutingTableBase &table : tables)
+        table.thaw();
+}
+
+void MIDI_RoutingTableBase::updateAllLocks() {
+    for (MIDI_RoutingTableBase &table : tables)
+        table.updateLocks();
 }
 
 END_CS_NAMESPACE
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <AH/Containers/BitArray.hpp>
+#include <AH/Containers/LinkedList.hpp>
 #include <AH/STL/utility>
 #include <AH/Settings/Warnings.hpp>
 #include <MIDI_Parsers/MIDI_MessageTypes.hpp>
@@ -46,6 +47,8 @@ using cn_t = uint8_t;
 class MIDI_Pipe;
 struct TrueMIDI_Sink;
 struct TrueMIDI_Source;
+struct MIDI_Route;
+class MIDI_RoutingTableBase;
 
 /// Class that can receive MIDI messages from a MIDI pipe.
 class MIDI_Sink {
@@ -187,6 +190,9 @@ class MIDI_Source {
     bool disconnect(TrueMIDI_Sink &sink);
     /// Check if this source is connected to a sink pipe.
     bool hasSinkPipe() const { return sinkPipe != nullptr; }
+    /// Check if the routes of this source have been compiled by a
+    /// MIDI_RoutingTable.
+    bool isFrozen() const { return route != nullptr; }
 
 #ifndef ARDUINO
     MIDI_Pipe *getSinkPipe() { return sinkPipe; }
@@ -207,8 +213,11 @@ class MIDI_Source {
 
   protected:
     MIDI_Pipe *sinkPipe = nullptr;
+    /// The compiled routes of this source, or `nullptr` if it is not frozen.
+    MIDI_Route *route = nullptr;
 
     friend class MIDI_Pipe;
+    friend class MIDI_RoutingTableBase;
 };
 
 // :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -339,20 +348,27 @@ class MIDI_Pipe : private MIDI_Sink, private MIDI_Source {
   protected:
     /// Send the given MIDI message to the sink of this pipe.
     void sourceMIDItoSink(ChannelMessage msg) {
-        if (hasSink())
-            sink->sinkMIDIfromPipe(msg);
+        if (MIDI_Sink *next = getNextSink())
+            next->sinkMIDIfromPipe(msg);
     }
 
     /// @copydoc sourceMIDItoSink
     void sourceMIDItoSink(SysExMessage msg) {
-        if (hasSink())
-            sink->sinkMIDIfromPipe(msg);
+        if (MIDI_Sink *next = getNextSink())
+            next->sinkMIDIfromPipe(msg);
     }
 
     /// @copydoc sourceMIDItoSink
     void sourceMIDItoSink(RealTimeMessage msg) {
-        if (hasSink())
-            sink->sinkMIDIfromPipe(msg);
+        if (MIDI_Sink *next = getNextSink())
+            next->sinkMIDIfromPipe(msg);
+    }
+
+  private:
+    /// Get the sink to send messages to: the final sink if the pipe is frozen,
+    /// otherwise the sink it's connected to (which can be another pipe).
+    MIDI_Sink *getNextSink() const {
+        return frozenSink != nullptr ? frozenSink : sink;
     }
 
   private:
@@ -489,10 +505,13 @@ class MIDI_Pipe : private MIDI_Sink, private MIDI_Source {
     MIDI_Source *source = nullptr;
     MIDI_Pipe *&throughOut = MIDI_Source::sinkPipe;
     MIDI_Pipe *&throughIn = MIDI_Sink::sourcePipe;
+    /// The sink this pipe eventually sinks to, cached by MIDI_RoutingTable.
+    MIDI_Sink *frozenSink = nullptr;
     AH::BitArray<16> locks;
 
     friend class MIDI_Sink;
     friend class MIDI_Source;
+    friend class MIDI_RoutingTableBase;
 };
 
 // :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
@@ -609,6 +628,124 @@ operator|(TrueMIDI_SinkSource &sinksource,
     return sinksource | pipe_fact.getNext();
 }
 
+// :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: //
+
+/// The compiled routes of a single MIDI_Source.
+/// @see    MIDI_RoutingTable
+struct MIDI_Route {
+    /// The source these routes belong to.
+    MIDI_Source *source;
+    /// All pipes the source sends to: the pipe it's connected to, and all
+    /// pipes connected to its "through" output, in the order in which the
+    /// messages are delivered.
+    MIDI_Pipe **pipes;
+    /// The number of pipes.
+    uint8_t numPipes;
+    /// Bit mask of the cable numbers for which any of the pipes is locked.
+    uint16_t locks;
+};
+
+/// Non-templated base class for MIDI_RoutingTable.
+class MIDI_RoutingTableBase : public DoublyLinkable<MIDI_RoutingTableBase> {
+  protected:
+    MIDI_RoutingTableBase(MIDI_Route *routes, uint8_t maxRoutes,
+                          MIDI_Pipe **pipes, uint8_t maxPipes);
+    ~MIDI_RoutingTableBase();
+
+  public:
+    MIDI_RoutingTableBase(const MIDI_RoutingTableBase &) = delete;
+    MIDI_RoutingTableBase &operator=(const MIDI_RoutingTableBase &) = delete;
+
+    /**
+     * @brief   Compile the routes of the given source into the table.
+     * 
+     * @retval  true
+     *          The source was frozen successfully.
+     * @retval  false
+     *          The source was frozen already, or the table is full. The
+     *          source keeps using the pipes directly.
+     */
+    bool freeze(MIDI_Source &source);
+    /// Freeze multiple sources at once.
+    template <class... Sources>
+    bool freeze(MIDI_Source &source, MIDI_Source &next, Sources &...others) {
+        return freeze(source) && freeze(next, others...);
+    }
+
+    /// Remove all sources from the table, they fall back to using the pipes
+    /// directly.
+    void thaw();
+
+    /// Get the number of frozen sources in this table.
+    uint8_t getNumberOfSources() const { return numRoutes; }
+    /// Get the number of pipes in this table.
+    uint8_t getNumberOfPipes() const { return numPipes; }
+
+    /// Thaw all routing tables. Called when pipes are connected or
+    /// disconnected.
+    static void thawAll();
+    /// Update the cached lock state of all routing tables. Called when a
+    /// source enters or exits exclusive mode.
+    static void updateAllLocks();
+
+  private:
+    void updateLocks();
+
+    MIDI_Route *routes;
+    MIDI_Pipe **pipes;
+    uint8_t maxRoutes;
+    uint8_t maxPipes;
+    uint8_t numRoutes = 0;
+    uint8_t numPipes = 0;
+
+    static DoublyLinkedList<MIDI_RoutingTableBase> tables;
+};
+
+/**
+ * @brief   Flat routing table that replaces the walk along the chains of
+ *          pipes by a single array lookup.
+ * 
+ * Normally, a message from a source is passed along the chain of "through"
+ * outputs of the pipes it's connected to, and from each pipe, along the chain
+ * of "through" inputs until it reaches the final sink. Similarly, checking
+ * whether a source can write walks the entire chain of "through" outputs.
+ * 
+ * After setting up the connections, the pipe graph can be frozen: for each
+ * source, the table stores the list of pipes it sends to, every pipe 
+ * remembers its final sink, and the lock state of all pipes of a source is 
+ * cached as a bit mask. Mappings and filters of the pipes are still applied.
+ * 
+ * ~~~cpp
+ * BidirectionalMIDI_PipeFactory<6> pipes;
+ * MIDI_RoutingTable<4, 6> routes;
+ * 
+ * void setup() {
+ *     midiA | pipes | midiB;
+ *     // ...
+ *     routes.freeze(midiA, midiB, midiC, midiD);
+ * }
+ * ~~~
+ * 
+ * Connecting or disconnecting any pipe thaws all routing tables, the sources
+ * then have to be frozen again.
+ * 
+ * @tparam  MaxSources
+ *          The maximum number of sources that can be frozen.
+ * @tparam  MaxPipes
+ *          The maximum number of pipes these sources send to in total.
+ */
+template <uint8_t MaxSources, uint8_t MaxPipes>
+class MIDI_RoutingTable : public MIDI_RoutingTableBase {
+  public:
+    MIDI_RoutingTable()
+        : MIDI_RoutingTableBase(routeStorage, MaxSources, pipeStorage,
+                                MaxPipes) {}
+
+  private:
+    MIDI_Route routeStorage[MaxSources];
+    MIDI_Pipe *pipeStorage[MaxPipes];
+};
+
 /// @}
 
 END_CS_NAMESPACE
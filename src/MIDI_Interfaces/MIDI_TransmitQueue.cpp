@@ -0,0 +1,89 @@
+#include "MIDI_TransmitQueue.hpp"
+
+BEGIN_CS_NAMESPACE
+
+uint8_t MIDI_TransmitQueueBase::getMessageLength(uint8_t status) {
+    if (status >= 0xF8) // Real-Time
+        return 1;
+    if (status >= 0xF0) { // System Common
+        switch (status) {
+            case 0xF1: // MTC Quarter Frame
+            case 0xF3: return 2; // Song Select
+            case 0xF2: return 3; // Song Position Pointer
+            default: return 1;
+        }
+    }
+    uint8_t type = status & 0xF0;
+    return type == 0xC0 || type == 0xD0 ? 2 : 3;
+}
+
+bool MIDI_TransmitQueueBase::push(const uint8_t *data, uint8_t length) {
+    if (!hasRoom(length))
+        return false;
+    uint16_t index = wrap(first + used);
+    for (uint8_t i = 0; i < length; ++i) {
+        storage[index] = data[i];
+        index = wrap(index + 1);
+    }
+    used += length;
+    return true;
+}
+
+bool MIDI_TransmitQueueBase::replace(ChannelMessage msg) {
+    if (!shouldCoalesce(msg))
+        return false;
+    // Channel Pressure and Pitch Bend have no controller number
+    auto type = msg.getMessageType();
+    bool hasController = type == MIDIMessageType::KEY_PRESSURE ||
+                         type == MIDIMessageType::CONTROL_CHANGE;
+    uint16_t match = NoMatch;
+    uint16_t index = first;
+    uint16_t remaining = used;
+    while (remaining > 0) {
+        uint8_t status = storage[index];
+        uint8_t length = getMessageLength(status);
+        uint16_t d1 = wrap(index + 1), d2 = wrap(index + 2);
+        if (status == msg.header &&
+            (!hasController || storage[d1] == msg.data1))
+            match = index;
+        // Real-Time messages may be inserted anywhere, all other messages
+        // that can't be coalesced must not be overtaken by the new value.
+        else if (status < 0xF8 &&
+                 (status >= 0xF0 ||
+                  !shouldCoalesce({status, storage[d1],
+                                   length == 3 ? storage[d2] : uint8_t(0),
+                                   0})))
+            match = NoMatch;
+        index = wrap(index + length);
+        remaining -= length;
+    }
+    if (match == NoMatch)
+        return false;
+    storage[wrap(match + 1)] = msg.data1;
+    if (getMessageLength(msg.header) == 3)
+        storage[wrap(match + 2)] = msg.data2;
+    ++coalescedCount;
+    return true;
+}
+
+bool MIDI_TransmitQueueBase::shouldCoalesce(ChannelMessage msg) const {
+    return MIDI_OutputCoalescerBase::isCoalescable(msg) && !isExcluded(msg);
+}
+
+uint8_t MIDI_TransmitQueueBase::copyFront(uint8_t *data) const {
+    uint8_t length = getFrontLength();
+    uint16_t index = first;
+    for (uint8_t i = 0; i < length; ++i) {
+        data[i] = storage[index];
+        index = wrap(index + 1);
+    }
+    return length;
+}
+
+void MIDI_TransmitQueueBase::pop() {
+    uint8_t length = getFrontLength();
+    first = wrap(first + length);
+    used -= length;
+}
+
+END_CS_NAMESPACE
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "MIDI_OutputCoalescer.hpp"
+#include <MIDI_Parsers/MIDI_MessageTypes.hpp>
+
+BEGIN_CS_NAMESPACE
+
+/// What to do when a message is sent while the transmit queue is full.
+enum class TransmitOverflowPolicy : uint8_t {
+    /// Wait until the oldest messages have been written to the Stream.
+    Block,
+    /// Discard the oldest messages to make room for the new one.
+    DropOldest,
+    /// Replace the value of a pending message for the same controller, see
+    /// MIDI_TransmitQueueBase::replace. Other messages block.
+    Coalesce,
+};
+
+/// Non-templated base class for MIDI_TransmitQueue.
+class MIDI_TransmitQueueBase : public MIDI_ExcludedControllers {
+  protected:
+    MIDI_TransmitQueueBase(uint8_t *storage, uint16_t capacity,
+                           TransmitOverflowPolicy policy)
+        : storage(storage), capacity(capacity), policy(policy) {}
+
+  public:
+    MIDI_TransmitQueueBase(const MIDI_TransmitQueueBase &) = delete;
+    MIDI_TransmitQueueBase &operator=(const MIDI_TransmitQueueBase &) = delete;
+
+    /**
+     * @brief   Get the length of a queued message with the given status byte.
+     *
+     * Only channel messages, system common messages other than System
+     * Exclusive, and real-time messages can be queued.
+     */
+    static uint8_t getMessageLength(uint8_t status);
+
+    /// Add a complete message to the back of the queue.
+    /// @return Returns false if there's not enough room.
+    bool push(const uint8_t *data, uint8_t length);
+
+    /**
+     * @brief   If a message with the same status byte and controller (or note)
+     *          is pending, replace its value by the value of the given
+     *          message, as long as it can be coalesced.
+     *
+     * Only messages that can be coalesced (see
+     * MIDI_OutputCoalescerBase::isCoalescable) and whose controller is not
+     * excluded (see @ref excludeController) are replaced. The pending message
+     * keeps its position in the queue, so it is only replaced if no other
+     * message that can't be coalesced (e.g. a note or the sustain pedal) was
+     * queued after it: the new value must not overtake such a message.
+     *
+     * @return  Returns true if a pending message was updated.
+     */
+    bool replace(ChannelMessage msg);
+
+    /// Get the length of the oldest message. The queue should not be empty.
+    uint8_t getFrontLength() const { return getMessageLength(storage[first]); }
+    /// Copy the oldest message to the given buffer, which should be large
+    /// enough to hold three bytes. Returns the length of the message. The
+    /// queue should not be empty.
+    uint8_t copyFront(uint8_t *data) const;
+    /// Remove the oldest message. The queue should not be empty.
+    void pop();
+    /// Remove the oldest message, and count it as dropped.
+    void drop() {
+        pop();
+        ++droppedCount;
+    }
+    /// Remove all messages.
+    void clear() { used = 0; }
+
+    /// Check whether there are any queued messages.
+    bool isEmpty() const { return used == 0; }
+    /// Check whether a message of the given length fits in the queue.
+    bool hasRoom(uint8_t length) const { return capacity - used >= length; }
+    /// Get the number of queued bytes.
+    uint16_t getNumberOfBytes() const { return used; }
+    /// Get the size of the queue in bytes.
+    uint16_t getCapacity() const { return capacity; }
+
+    /// Get the policy for sending messages when the queue is full.
+    TransmitOverflowPolicy getOverflowPolicy() const { return policy; }
+    /// Set the policy for sending messages when the queue is full.
+    void setOverflowPolicy(TransmitOverflowPolicy policy) {
+        this->policy = policy;
+    }
+
+    /// Get the number of messages that were discarded because the queue was
+    /// full.
+    unsigned long getDroppedCount() const { return droppedCount; }
+    /// Get the number of messages that were replaced by a newer value because
+    /// the queue was full.
+    unsigned long getCoalescedCount() const { return coalescedCount; }
+
+  private:
+    bool shouldCoalesce(ChannelMessage msg) const;
+    uint16_t wrap(uint16_t index) const {
+        return index >= capacity ? index - capacity : index;
+    }
+
+  private:
+    constexpr static uint16_t NoMatch = 0xFFFF;
+    uint8_t *storage;
+    uint16_t capacity;
+    /// Index of the first byte of the oldest message.
+    uint16_t first = 0;
+    uint16_t used = 0;
+    TransmitOverflowPolicy policy;
+    unsigned long droppedCount = 0;
+    unsigned long coalescedCount = 0;
+};
+
+/**
+ * @brief   Software transmit buffer for a StreamMIDI_Interface, so sending
+ *          MIDI messages doesn't block the main loop.
+ *
+ * Hardware serial ports only have a small transmit buffer. At 31250 baud,
+ * it takes 320 µs to transmit a single byte, so when a burst of messages is
+ * sent (e.g. after a bank change, or when moving multiple faders), the
+ * sender waits for the buffer to empty, and the entire main loop is blocked.
+ *
+ * When a transmit queue is attached to the interface (see
+ * @ref StreamMIDI_Interface::setTransmitQueue), messages that don't fit in the
+ * transmit buffer of the Stream are added to the queue instead. The queue is
+ * moved to the Stream as its buffer empties (using `availableForWrite()`),
+ * every time the interface is updated or flushed.
+ *
+ * ~~~cpp
+ * HardwareSerialMIDI_Interface midi = Serial1;
+ * MIDI_TransmitQueue<128> txqueue {TransmitOverflowPolicy::Coalesce};
+ *
+ * void setup() {
+ *     midi.setTransmitQueue(txqueue);
+ *     Control_Surface.begin();
+ * }
+ * ~~~
+ *
+ * The overflow policy determines what happens when the queue is full, see
+ * @ref TransmitOverflowPolicy. With TransmitOverflowPolicy::Coalesce, the
+ * controllers of relative encoders have to be excluded (see
+ * @ref excludeController), otherwise steps are lost when the queue is full.
+ * System Exclusive messages are never queued: the queue is emptied first,
+ * blocking if necessary, and the message is then written to the Stream
+ * directly.
+ *
+ * @tparam  N
+ *          The size of the queue in bytes.
+ *
+ * @ingroup MIDIInterfaces
+ */
+template <uint16_t N>
+class MIDI_TransmitQueue : public MIDI_TransmitQueueBase {
+  public:
+    MIDI_TransmitQueue(
+        TransmitOverflowPolicy policy = TransmitOverflowPolicy::Block)
+        : MIDI_TransmitQueueBase(queueStorage, N, policy) {}
+
+    static_assert(N >= 3, "The queue should be able to hold any message");
+
+  private:
+    uint8_t queueStorage[N];
+};
+
+END_CS_NAMESPACE
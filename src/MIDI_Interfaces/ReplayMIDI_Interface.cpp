@@ -0,0 +1,238 @@
+#include "ReplayMIDI_Interface.hpp"
+#include <AH/Error/Error.hpp>
+
+#ifndef ARDUINO
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#endif
+
+BEGIN_CS_NAMESPACE
+
+void ReplayMIDI_Interface::begin() {
+    startTime = micros();
+    index = 0;
+    offset = 0;
+    receivedCount = 0;
+    inputLag.reset();
+    recordLength = 0;
+    sentCount = 0;
+    droppedCount = 0;
+    sysexPendingLength = 0;
+    responsePending = false;
+    responseLatency.reset();
+}
+
+MIDIReadEvent ReplayMIDI_Interface::read() {
+    unsigned long now = getTime();
+    while (index < numEvents && events[index].timestamp <= now) {
+        const MIDICaptureEvent &event = events[index];
+        MIDIReadEvent result;
+        if (format == MIDICaptureFormat::USB) {
+            uint8_t packet[4] = {event.data[0], event.data[1], event.data[2],
+                                 event.data[3]};
+            result = usbParser.parse(packet);
+            ++index;
+        } else {
+            size_t consumed;
+            result = serialParser.parse(event.data + offset,
+                                        event.length - offset, consumed);
+            offset += consumed;
+            if (offset >= event.length) {
+                offset = 0;
+                ++index;
+            }
+        }
+        if (result != MIDIReadEvent::NO_MESSAGE) {
+            ++receivedCount;
+            inputLag.add(now - event.timestamp);
+            if (!responsePending)
+                lastInputTimestamp = event.timestamp;
+            responsePending = true;
+            return result;
+        }
+    }
+    return MIDIReadEvent::NO_MESSAGE;
+}
+
+bool ReplayMIDI_Interface::startRecording(size_t requiredEvents) {
+    recordTime = getTime();
+    ++sentCount;
+    if (responsePending) {
+        responseLatency.add(recordTime - lastInputTimestamp);
+        responsePending = false;
+    }
+    if (recording == nullptr)
+        return false;
+    if (recordCapacity - recordLength < requiredEvents) {
+        ++droppedCount;
+        return false;
+    }
+    return true;
+}
+
+void ReplayMIDI_Interface::record(uint8_t d0, uint8_t d1, uint8_t d2,
+                                  uint8_t d3, uint8_t length) {
+    recording[recordLength++] = {recordTime, {d0, d1, d2, d3}, length};
+}
+
+void ReplayMIDI_Interface::sendImpl(uint8_t header, uint8_t d1, uint8_t d2,
+                                    uint8_t cn) {
+    if (!startRecording(1))
+        return;
+    if (format == MIDICaptureFormat::USB)
+        record(cn << 4 | header >> 4, header, d1, d2, 4);
+    else
+        record(header, d1, d2, 0, 3);
+}
+
+void ReplayMIDI_Interface::sendImpl(uint8_t header, uint8_t d1, uint8_t cn) {
+    if (!startRecording(1))
+        return;
+    if (format == MIDICaptureFormat::USB)
+        record(cn << 4 | header >> 4, header, d1, 0, 4);
+    else
+        record(header, d1, 0, 0, 2);
+}
+
+void ReplayMIDI_Interface::recordUSBSysExEnd(const uint8_t *data,
+                                             uint8_t length, uint8_t cn) {
+    if (length == 0)
+        return;
+    record(cn << 4 | (0x4 + length), data[0], length > 1 ? data[1] : 0,
+           length > 2 ? data[2] : 0, 4);
+}
+
+void ReplayMIDI_Interface::recordPendingSysExEnd() {
+    // Room for this packet was reserved when the chunk was recorded, unless
+    // the message was never terminated.
+    if (recording != nullptr && recordLength < recordCapacity)
+        recordUSBSysExEnd(sysexPending, sysexPendingLength, sysexPendingCN);
+    sysexPendingLength = 0;
+}
+
+void ReplayMIDI_Interface::sendImpl(const uint8_t *data, size_t length,
+                                    uint8_t cn) {
+    if (format == MIDICaptureFormat::USB) {
+        // If the previous chunked message was never terminated, end it now
+        if (sysexPendingLength > 0) {
+            recordTime = getTime();
+            recordPendingSysExEnd();
+        }
+        // Packets of three bytes, the last packet ends the message (CIN 0x5,
+        // 0x6 or 0x7)
+        if (!startRecording((length + 2) / 3))
+            return;
+        for (; length > 3; data += 3, length -= 3)
+            record(cn << 4 | 0x4, data[0], data[1], data[2], 4);
+        recordUSBSysExEnd(data, length, cn);
+    } else {
+        // Events of up to four bytes
+        if (!startRecording((length + 3) / 4))
+            return;
+        for (; length > 0; data += 4) {
+            uint8_t n = length < 4 ? length : 4;
+            length -= n;
+            record(data[0], n > 1 ? data[1] : 0, n > 2 ? data[2] : 0,
+                   n > 3 ? data[3] : 0, n);
+        }
+    }
+}
+
+void ReplayMIDI_Interface::sendChunkImpl(const uint8_t *data, size_t length,
+                                         uint8_t cn) {
+    // Serial events don't have to be aligned to messages
+    if (format != MIDICaptureFormat::USB)
+        return sendImpl(data, length, cn);
+    if (length == 0)
+        return;
+    const uint8_t SysExStart = uint8_t(MIDIMessageType::SYSEX_START);
+    const uint8_t SysExEnd = uint8_t(MIDIMessageType::SYSEX_END);
+    // If the previous message was never terminated, end it now
+    if (sysexPendingLength > 0 &&
+        (cn != sysexPendingCN || data[0] == SysExStart)) {
+        recordTime = getTime();
+        recordPendingSysExEnd();
+    }
+    // Only complete packets are recorded, plus the last packet if this chunk
+    // ends the message
+    size_t total = sysexPendingLength + length;
+    bool end = data[length - 1] == SysExEnd;
+    if (!startRecording(end ? (total + 2) / 3 : total / 3)) {
+        sysexPendingLength = 0;
+        return;
+    }
+    sysexPendingCN = cn;
+    for (; length > 0; --length) {
+        uint8_t byte = *data++;
+        sysexPending[sysexPendingLength++] = byte;
+        if (byte == SysExEnd) {
+            recordPendingSysExEnd();
+        } else if (sysexPendingLength == 3) {
+            record(cn << 4 | 0x4, sysexPending[0], sysexPending[1],
+                   sysexPending[2], 4);
+            sysexPendingLength = 0;
+        }
+    }
+}
+
+void ReplayMIDI_Interface::sendImpl(uint8_t rt, uint8_t cn) {
+    if (!startRecording(1))
+        return;
+    if (format == MIDICaptureFormat::USB)
+        record(cn << 4 | 0xF, rt, 0, 0, 4);
+    else
+        record(rt, 0, 0, 0, 1);
+}
+
+#ifndef ARDUINO
+
+std::vector<MIDICaptureEvent> readMIDICapture(std::istream &is) {
+    std::vector<MIDICaptureEvent> events;
+    std::string line;
+    for (unsigned lineNumber = 1; std::getline(is, line); ++lineNumber) {
+        std::istringstream ls(line);
+        unsigned long timestamp;
+        ls >> std::ws;
+        if (ls.eof() || ls.peek() == '#')
+            continue; // Empty line or comment
+        if (!(ls >> timestamp))
+            FATAL_ERROR(F("Invalid timestamp on line ") << lineNumber, 0x6C30);
+        MIDICaptureEvent event = {timestamp, {}, 0};
+        unsigned byte;
+        while (ls >> std::hex >> byte) {
+            if (byte > 0xFF)
+                FATAL_ERROR(F("Invalid byte on line ") << lineNumber, 0x6C31);
+            if (event.length == sizeof(event.data)) {
+                events.push_back(event);
+                event = {timestamp, {}, 0};
+            }
+            event.data[event.length++] = byte;
+        }
+        if (!ls.eof())
+            FATAL_ERROR(F("Invalid byte on line ") << lineNumber, 0x6C31);
+        if (event.length > 0)
+            events.push_back(event);
+    }
+    return events;
+}
+
+void writeMIDICapture(std::ostream &os, const MIDICaptureEvent *events,
+                      size_t numEvents) {
+    auto flags = os.flags();
+    auto fill = os.fill('0');
+    for (size_t i = 0; i < numEvents; ++i) {
+        os << std::dec << events[i].timestamp << std::hex << std::uppercase;
+        for (uint8_t j = 0; j < events[i].length; ++j)
+            os << ' ' << std::setw(2) << unsigned(events[i].data[j]);
+        os << '\n';
+    }
+    os.fill(fill);
+    os.flags(flags);
+}
+
+#endif
+
+END_CS_NAMESPACE
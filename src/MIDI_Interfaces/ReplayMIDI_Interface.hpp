@@ -0,0 +1,243 @@
+#pragma once
+
+#include "MIDI_Interface.hpp"
+#include <AH/Arduino-Wrapper.h> // micros
+#include <AH/Timing/TimingStats.hpp>
+#include <MIDI_Parsers/SerialMIDI_Parser.hpp>
+#include <MIDI_Parsers/USBMIDI_Parser.hpp>
+
+#ifndef ARDUINO
+#include <iosfwd>
+#include <vector>
+#endif
+
+BEGIN_CS_NAMESPACE
+
+/// The format of the data of a MIDI capture.
+enum class MIDICaptureFormat : uint8_t {
+    Serial, ///< Raw MIDI bytes, like on a serial MIDI connection.
+    USB,    ///< 4-byte USB MIDI event packets.
+};
+
+/**
+ * @brief   A single timestamped event of a MIDI capture.
+ *
+ * For the @ref MIDICaptureFormat::Serial "serial format", an event contains
+ * up to four MIDI bytes. Messages are not required to be aligned to events:
+ * longer messages (e.g. System Exclusive) are simply split over multiple
+ * events. For the @ref MIDICaptureFormat::USB "USB format", every event
+ * contains exactly one USB MIDI event packet.
+ */
+struct MIDICaptureEvent {
+    /// The time the data was received or sent, in microseconds since the
+    /// start of the capture.
+    unsigned long timestamp;
+    /// The MIDI bytes or USB packet.
+    uint8_t data[4];
+    /// The number of valid bytes in @ref data.
+    uint8_t length;
+};
+
+/**
+ * @brief   A MIDI interface that replays a timestamped MIDI capture as its
+ *          input, and that records all MIDI messages sent to it.
+ *
+ * This makes it possible to reproduce timing problems with real-world MIDI
+ * traffic (e.g. captured from a DAW) on a desktop computer, using the mock
+ * clock, and to measure the throughput, the latency and the number of
+ * dropped messages offline.
+ *
+ * The replay starts when @ref begin is called: the data of each event is made
+ * available to the parser as soon as `micros()` has advanced past the
+ * timestamp of the event. Outgoing messages are encoded in the same format as
+ * the capture, and are stored in the record buffer (see @ref setRecordBuffer)
+ * with a timestamp relative to the start of the replay.
+ *
+ * The following statistics are collected (see AH::TimingStats):
+ *
+ *  - **Input lag**: for each incoming message, the time between the
+ *    timestamp of the event that completed it and the moment it was read.
+ *    This grows when the MIDI input can't keep up with the capture.
+ *  - **Response latency**: for the first outgoing message after an incoming
+ *    message, the time between the timestamp of that incoming message and the
+ *    moment the outgoing message was sent.
+ *
+ * @ingroup MIDIInterfaces
+ */
+class ReplayMIDI_Interface : public Parsing_MIDI_Interface {
+  public:
+    /**
+     * @brief   Construct a replay interface for the given capture.
+     *
+     * @param   events
+     *          The events of the capture, sorted by timestamp. The array is
+     *          not copied, it should outlive the interface.
+     * @param   numEvents
+     *          The number of events in the capture.
+     * @param   format
+     *          The format of the data of the events.
+     */
+    ReplayMIDI_Interface(const MIDICaptureEvent *events, size_t numEvents,
+                         MIDICaptureFormat format = MIDICaptureFormat::Serial)
+        : Parsing_MIDI_Interface(format == MIDICaptureFormat::USB
+                                     ? static_cast<MIDI_Parser &>(usbParser)
+                                     : serialParser),
+          events(events), numEvents(numEvents), format(format) {}
+
+    /// @copydoc ReplayMIDI_Interface(const MIDICaptureEvent *, size_t,
+    ///                               MIDICaptureFormat)
+    template <size_t N>
+    ReplayMIDI_Interface(const MIDICaptureEvent (&events)[N],
+                         MIDICaptureFormat format = MIDICaptureFormat::Serial)
+        : ReplayMIDI_Interface(events, N, format) {}
+
+    /// Start (or restart) the replay, clear the recording and reset all
+    /// statistics.
+    void begin() override;
+
+    /// @name   Replay
+    /// @{
+
+    /// Get the format of the capture and the recording.
+    MIDICaptureFormat getFormat() const { return format; }
+    /// Get the number of microseconds since the start of the replay.
+    unsigned long getTime() const { return micros() - startTime; }
+    /// Check whether all events of the capture have been parsed.
+    bool isFinished() const { return index == numEvents; }
+    /// Get the number of MIDI messages (or SysEx chunks) that were read.
+    unsigned long getReceivedCount() const { return receivedCount; }
+    /// Statistics of the time between receiving and reading an incoming
+    /// message.
+    const AH::TimingStats &getInputLagStats() const { return inputLag; }
+
+    /// @}
+
+    /// @name   Recording
+    /// @{
+
+    /**
+     * @brief   Use the given array to record the outgoing messages.
+     *
+     * Without a record buffer, outgoing messages are counted and timed, but
+     * they are not stored. Messages that don't fit in the buffer are dropped,
+     * see @ref getDroppedCount.
+     */
+    void setRecordBuffer(MIDICaptureEvent *storage, size_t capacity) {
+        recording = storage;
+        recordCapacity = capacity;
+        recordLength = 0;
+    }
+    /// @copydoc setRecordBuffer(MIDICaptureEvent *, size_t)
+    template <size_t N>
+    void setRecordBuffer(MIDICaptureEvent (&storage)[N]) {
+        setRecordBuffer(storage, N);
+    }
+
+    /// Get the recorded events.
+    const MIDICaptureEvent *getRecording() const { return recording; }
+    /// Get the number of recorded events.
+    size_t getRecordingLength() const { return recordLength; }
+    /// Get the number of MIDI messages (or SysEx chunks) that were sent.
+    unsigned long getSentCount() const { return sentCount; }
+    /// Get the number of outgoing messages that didn't fit in the record
+    /// buffer.
+    unsigned long getDroppedCount() const { return droppedCount; }
+    /// Statistics of the time between an incoming message and the first
+    /// outgoing message that follows it.
+    const AH::TimingStats &getResponseLatencyStats() const {
+        return responseLatency;
+    }
+
+    /// @}
+
+    MIDIReadEvent read() override;
+
+  protected:
+    void sendImpl(uint8_t header, uint8_t d1, uint8_t d2,
+                  uint8_t cn) override;
+    void sendImpl(uint8_t header, uint8_t d1, uint8_t cn) override;
+    void sendImpl(const uint8_t *data, size_t length, uint8_t cn) override;
+    /// In the USB format, bytes that don't fill a complete packet are kept
+    /// until the next chunk arrives.
+    void sendChunkImpl(const uint8_t *data, size_t length,
+                       uint8_t cn) override;
+    void sendImpl(uint8_t rt, uint8_t cn) override;
+
+  private:
+    /// Check that an outgoing message of the given number of events fits in
+    /// the record buffer, and update the counters and the response latency.
+    /// Returns false if the message should be dropped.
+    bool startRecording(size_t requiredEvents);
+    /// Append an event to the record buffer.
+    void record(uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3,
+                uint8_t length);
+    /// Append the USB packet that ends a SysEx message with the given (one,
+    /// two or three) bytes.
+    void recordUSBSysExEnd(const uint8_t *data, uint8_t length, uint8_t cn);
+    /// Record the bytes that were kept by @ref sendChunkImpl as the end of a
+    /// SysEx message.
+    void recordPendingSysExEnd();
+
+  private:
+    SerialMIDI_Parser serialParser;
+    USBMIDI_Parser usbParser;
+
+    const MIDICaptureEvent *events;
+    size_t numEvents;
+    MIDICaptureFormat format;
+    /// The next event to parse.
+    size_t index = 0;
+    /// The number of bytes of the next event that were already parsed.
+    uint8_t offset = 0;
+    unsigned long startTime = 0;
+    unsigned long receivedCount = 0;
+    AH::TimingStats inputLag;
+
+    MIDICaptureEvent *recording = nullptr;
+    size_t recordCapacity = 0;
+    size_t recordLength = 0;
+    unsigned long recordTime = 0;
+    unsigned long sentCount = 0;
+    unsigned long droppedCount = 0;
+    uint8_t sysexPending[3];
+    uint8_t sysexPendingLength = 0;
+    uint8_t sysexPendingCN = 0;
+    /// Timestamp of the last incoming message that hasn't been responded to.
+    unsigned long lastInputTimestamp = 0;
+    bool responsePending = false;
+    AH::TimingStats responseLatency;
+};
+
+#ifndef ARDUINO
+/**
+ * @brief   Read a MIDI capture in text format.
+ *
+ * Every line contains a single event: the timestamp in microseconds (in
+ * decimal), followed by the data bytes (in hexadecimal, separated by
+ * whitespace). Lines with more than four bytes are split into multiple events
+ * with the same timestamp. Empty lines and lines that start with `#` are
+ * ignored.
+ *
+ * ~~~
+ * # Note on, timing clock and note off
+ * 0 90 3C 7F
+ * 20833 F8
+ * 41666 80 3C 40
+ * ~~~
+ *
+ * A malformed line is a fatal error.
+ *
+ * @related ReplayMIDI_Interface
+ */
+std::vector<MIDICaptureEvent> readMIDICapture(std::istream &is);
+/**
+ * @brief   Write a MIDI capture (or recording) in the text format of
+ *          @ref readMIDICapture.
+ *
+ * @related ReplayMIDI_Interface
+ */
+void writeMIDICapture(std::ostream &os, const MIDICaptureEvent *events,
+                      size_t numEvents);
+#endif
+
+END_CS_NAMESPACE
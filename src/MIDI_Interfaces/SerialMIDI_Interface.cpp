@@ -1,3 +1,120 @@
-#ifdef TEST_COMPILE_ALL_HEADERS_SEPARATELY
 #include "SerialMIDI_Interface.hpp"
-#endif
\ No newline at end of file
+
+BEGIN_CS_NAMESPACE
+
+void StreamMIDI_Interface::setTransmitQueue(MIDI_TransmitQueueBase *queue) {
+#if defined(ESP32) || !defined(ARDUINO)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+    if (transmitQueue)
+        writeQueuedMessages(true);
+    transmitQueue = queue;
+}
+
+void StreamMIDI_Interface::transmitQueuedMessages() {
+    if (transmitQueue == nullptr || transmitQueue->isEmpty())
+        return;
+#if defined(ESP32) || !defined(ARDUINO)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+    writeQueuedMessages(false);
+}
+
+void StreamMIDI_Interface::sendImpl(const uint8_t *data, size_t length,
+                                    uint8_t cn) {
+#if defined(ESP32) || !defined(ARDUINO)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+    (void)cn;
+    // System Exclusive messages are not queued, but they can't overtake the
+    // messages that are already in the queue either.
+    if (transmitQueue)
+        writeQueuedMessages(true);
+    runningStatus = 0;
+    stream.write(data, length);
+}
+
+void StreamMIDI_Interface::sendMessage(const uint8_t *data, uint8_t length) {
+    if (duplicateFilter && data[0] < 0xF0) {
+        uint8_t data2 = length == 3 ? data[2] : 0;
+        if (duplicateFilter->isDuplicate({data[0], data[1], data2, 0}))
+            return;
+    }
+    if (transmitQueue == nullptr) {
+        writeMessage(data, length, canUseRunningStatus(data[0]));
+        return;
+    }
+    writeQueuedMessages(false);
+    // Real-Time messages may be inserted anywhere in the stream, so they
+    // don't have to wait for the queued messages.
+    bool realTime = data[0] >= 0xF8;
+    bool omitStatus = canUseRunningStatus(data[0]);
+    if ((realTime || transmitQueue->isEmpty()) &&
+        streamHasRoom(omitStatus ? length - 1 : length)) {
+        writeMessage(data, length, omitStatus);
+        return;
+    }
+    if (transmitQueue->push(data, length))
+        return;
+    // The queue is full
+    auto policy = transmitQueue->getOverflowPolicy();
+    if (policy == TransmitOverflowPolicy::Coalesce && data[0] < 0xF0) {
+        uint8_t data2 = length == 3 ? data[2] : 0;
+        ChannelMessage msg = {data[0], data[1], data2, 0};
+        if (transmitQueue->replace(msg))
+            return;
+    }
+    while (!transmitQueue->push(data, length)) {
+        if (policy == TransmitOverflowPolicy::DropOldest) {
+            // The dropped value never reaches the wire, so it must not
+            // suppress the next message with the same value.
+            if (duplicateFilter) {
+                uint8_t front[3];
+                uint8_t frontLength = transmitQueue->copyFront(front);
+                if (front[0] < 0xF0)
+                    duplicateFilter->forget({front[0], front[1],
+                                             frontLength == 3 ? front[2]
+                                                              : uint8_t(0),
+                                             0});
+            }
+            transmitQueue->drop();
+        } else {
+            // Blocks until the Stream accepts the oldest message
+            uint8_t front[3];
+            uint8_t frontLength = transmitQueue->copyFront(front);
+            writeMessage(front, frontLength, canUseRunningStatus(front[0]));
+            transmitQueue->pop();
+        }
+    }
+}
+
+void StreamMIDI_Interface::writeMessage(const uint8_t *data, uint8_t length,
+                                        bool omitStatus) {
+    uint8_t status = data[0];
+    if (status < 0xF0) { // Channel message
+        if (omitStatus) {
+            ++data;
+            --length;
+        } else if (runningStatusEnabled && runningStatusRefresh > 0) {
+            runningStatusTime = millis();
+        }
+        runningStatus = status;
+    } else if (status < 0xF8) { // System Common message
+        runningStatus = 0;
+    }
+    stream.write(data, length);
+}
+
+void StreamMIDI_Interface::writeQueuedMessages(bool block) {
+    while (!transmitQueue->isEmpty()) {
+        uint8_t message[3];
+        uint8_t length = transmitQueue->copyFront(message);
+        bool omitStatus = canUseRunningStatus(message[0]);
+        if (!block && !streamHasRoom(omitStatus ? length - 1 : length))
+            break;
+        writeMessage(message, length, omitStatus);
+        transmitQueue->pop();
+    }
+}
+
+END_CS_NAMESPACE
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "MIDI_DuplicateFilter.hpp"
 #include "MIDI_Interface.hpp"
+#include "MIDI_TransmitQueue.hpp"
 #include <AH/Arduino-Wrapper.h> // Stream
+#include <AH/Containers/Array.hpp>
 #include <AH/STL/utility>
 #include <AH/Teensy/TeensyUSBTypes.hpp>
 #include <MIDI_Parsers/SerialMIDI_Parser.hpp>
@@ -31,17 +34,222 @@ class StreamMIDI_Interface : public Parsing_MIDI_Interface {
         : Parsing_MIDI_Interface(parser), stream(stream) {}
 
     StreamMIDI_Interface(StreamMIDI_Interface &&other)
-        : Parsing_MIDI_Interface(std::move(other)), stream(other.stream) {}
+        : Parsing_MIDI_Interface(std::move(other)), stream(other.stream),
+          readBuffer(other.readBuffer), readIndex(other.readIndex),
+          readLength(other.readLength), transmitQueue(other.transmitQueue),
+          duplicateFilter(other.duplicateFilter),
+          runningStatusEnabled(other.runningStatusEnabled),
+          runningStatus(other.runningStatus),
+          runningStatusRefresh(other.runningStatusRefresh),
+          runningStatusTime(other.runningStatusTime),
+          availableForWriteSupported(other.availableForWriteSupported) {
+        other.transmitQueue = nullptr;
+    }
     // TODO: should I move the mutex too?
 
+#if !IGNORE_SYSEX
+    /**
+     * @brief   Use a statically allocated array to receive System Exclusive
+     *          messages on this interface, instead of the default buffer of
+     *          @ref SYSEX_BUFFER_SIZE bytes.
+     *
+     * For example, to receive SysEx messages of up to 4 KiB:
+     * ~~~cpp
+     * static uint8_t sysexbuffer[4096];
+     * midi.setSysExBuffer(sysexbuffer);
+     * ~~~
+     */
+    template <size_t N>
+    void setSysExBuffer(uint8_t (&storage)[N]) {
+        parser.setSysExBuffer(storage);
+    }
+#endif
+
+    /**
+     * @brief   Read the next MIDI message.
+     * 
+     * All bytes that are available in the Stream are read at once (up to 
+     * @ref STREAM_MIDI_READ_BUFFER_SIZE bytes), and are then parsed from that
+     * buffer, so multiple messages can be read using a single Stream call.
+     */
     MIDIReadEvent read() override {
-        while (stream.available() > 0) {
-            uint8_t midiByte = stream.read();
-            MIDIReadEvent parseResult = parser.parse(midiByte);
+        while (true) {
+            if (readIndex == readLength && !fillReadBuffer())
+                return MIDIReadEvent::NO_MESSAGE;
+            size_t consumed;
+            MIDIReadEvent parseResult =
+                parser.parse(readBuffer.data + readIndex,
+                             readLength - readIndex, consumed);
+            readIndex += consumed;
             if (parseResult != MIDIReadEvent::NO_MESSAGE)
                 return parseResult;
         }
-        return MIDIReadEvent::NO_MESSAGE;
+    }
+
+  protected:
+    /// Write the messages in the transmit queue to the Stream.
+    void updateHousekeeping() override { transmitQueuedMessages(); }
+
+  public:
+    /// Write as many messages from the transmit queue to the Stream as fit in
+    /// its transmit buffer, without blocking.
+    void flush() override { transmitQueuedMessages(); }
+
+    /**
+     * @brief   Check whether a message of the given number of bytes can be
+     *          sent without blocking.
+     *
+     * This is the case if the transmit buffer of the Stream has room for it,
+     * or, when a transmit queue is used, if the message fits in the queue.
+     *
+     * Streams that don't implement `availableForWrite()` always return zero.
+     * Until the Stream has reported a nonzero value at least once, it is
+     * assumed to be unsupported, and messages are always sent right away.
+     */
+    bool canSendWithoutBlocking(uint8_t length) override {
+        if (transmitQueue && !transmitQueue->isEmpty())
+            return transmitQueue->hasRoom(length);
+        return streamHasRoom(length);
+    }
+
+    /// @name   Transmit Queue, Running Status and Duplicate Suppression
+    /// @{
+
+    /**
+     * @brief   Queue the messages that don't fit in the transmit buffer of the
+     *          Stream, instead of blocking, see @ref MIDI_TransmitQueue.
+     *
+     * @param   queue
+     *          The queue, or `nullptr` to write all messages to the Stream
+     *          directly. The messages that are still in the previous queue
+     *          are written to the Stream first.
+     */
+    void setTransmitQueue(MIDI_TransmitQueueBase *queue);
+    /// @copydoc setTransmitQueue(MIDI_TransmitQueueBase *)
+    void setTransmitQueue(MIDI_TransmitQueueBase &queue) {
+        setTransmitQueue(&queue);
+    }
+    /// Get the transmit queue, or `nullptr` if there is none.
+    MIDI_TransmitQueueBase *getTransmitQueue() { return transmitQueue; }
+    /// @copydoc getTransmitQueue()
+    const MIDI_TransmitQueueBase *getTransmitQueue() const {
+        return transmitQueue;
+    }
+
+    /// Write as many messages from the transmit queue to the Stream as fit in
+    /// its transmit buffer, without blocking. This is done automatically when
+    /// the interface is updated or flushed.
+    void transmitQueuedMessages();
+
+    /**
+     * @brief   Omit the status byte of channel messages if it is the same as
+     *          the status byte of the previous channel message (running
+     *          status).
+     *
+     * This saves up to a third of the bandwidth when many messages of the
+     * same type are sent on the same channel, e.g. when moving a fader.
+     * System Exclusive and System Common messages cancel the running status,
+     * Real-Time messages don't.
+     *
+     * @param   enabled
+     *          Whether to use running status.
+     * @param   refresh
+     *          The status byte is sent again if it hasn't been sent for this
+     *          amount of time (in milliseconds), so a receiver that missed it
+     *          can recover. Zero means that the status byte is only sent when
+     *          it changes.
+     */
+    void setRunningStatus(
+        bool enabled,
+        unsigned long refresh = STREAM_MIDI_RUNNING_STATUS_REFRESH) {
+        runningStatusEnabled = enabled;
+        runningStatusRefresh = refresh;
+        runningStatus = 0;
+    }
+    /// Check whether running status is enabled.
+    bool getRunningStatus() const { return runningStatusEnabled; }
+    /// Get the time after which the running status byte is sent again (in
+    /// milliseconds, zero means never).
+    unsigned long getRunningStatusRefresh() const {
+        return runningStatusRefresh;
+    }
+
+    /**
+     * @brief   Don't send Control Change, Pitch Bend and pressure messages
+     *          that have the same value as the previous message for the same
+     *          controller, see @ref MIDI_DuplicateFilter.
+     *
+     * @param   filter
+     *          The filter that remembers the last values, or `nullptr` to
+     *          send all messages.
+     */
+    void setDuplicateFilter(MIDI_DuplicateFilterBase *filter) {
+        duplicateFilter = filter;
+    }
+    /// @copydoc setDuplicateFilter(MIDI_DuplicateFilterBase *)
+    void setDuplicateFilter(MIDI_DuplicateFilterBase &filter) {
+        setDuplicateFilter(&filter);
+    }
+    /// Get the duplicate filter, or `nullptr` if there is none.
+    MIDI_DuplicateFilterBase *getDuplicateFilter() { return duplicateFilter; }
+    /// @copydoc getDuplicateFilter()
+    const MIDI_DuplicateFilterBase *getDuplicateFilter() const {
+        return duplicateFilter;
+    }
+
+    /// @}
+
+  private:
+    /// Check whether the transmit buffer of the Stream has room for the given
+    /// number of bytes (always true if the Stream doesn't implement
+    /// `availableForWrite()`).
+    bool streamHasRoom(uint8_t length) {
+        int available = stream.availableForWrite();
+        if (available > 0)
+            availableForWriteSupported = true;
+        return !availableForWriteSupported || available >= length;
+    }
+
+    /// Check whether the status byte can be omitted from a message with the
+    /// given status byte.
+    bool canUseRunningStatus(uint8_t status) const {
+        return runningStatusEnabled && status == runningStatus &&
+               (runningStatusRefresh == 0 ||
+                millis() - runningStatusTime < runningStatusRefresh);
+    }
+
+    /// Write the given message to the Stream, or add it to the transmit queue
+    /// if that's not possible without blocking.
+    void sendMessage(const uint8_t *data, uint8_t length);
+    /// Write the given message to the Stream, omitting the status byte if
+    /// @p omitStatus is true (see @ref canUseRunningStatus).
+    void writeMessage(const uint8_t *data, uint8_t length, bool omitStatus);
+    /// Write the messages in the transmit queue to the Stream. If @p block is
+    /// false, stop when the transmit buffer of the Stream is full.
+    void writeQueuedMessages(bool block);
+
+  private:
+    /// Read all available bytes (as many as fit) from the Stream into the
+    /// read buffer. Returns false if no bytes were available.
+    bool fillReadBuffer() {
+        int available = stream.available();
+        if (available <= 0)
+            return false;
+        uint8_t length = available < STREAM_MIDI_READ_BUFFER_SIZE
+                             ? available
+                             : STREAM_MIDI_READ_BUFFER_SIZE;
+#if defined(TEENSYDUINO) || defined(ESP32) || !defined(ARDUINO)
+        // These cores have an efficient readBytes implementation
+        length = stream.readBytes(reinterpret_cast<char *>(readBuffer.data),
+                                  length);
+#else
+        // The default readBytes implementation checks millis() for every byte
+        for (uint8_t i = 0; i < length; ++i)
+            readBuffer[i] = stream.read();
+#endif
+        readIndex = 0;
+        readLength = length;
+        return length > 0;
     }
 
   protected:
@@ -53,10 +261,8 @@ class StreamMIDI_Interface : public Parsing_MIDI_Interface {
         std::lock_guard<std::mutex> lock(mutex);
 #endif
         (void)cn;
-        stream.write(header); // Send the MIDI message over the stream
-        stream.write(d1);
-        stream.write(d2);
-        // stream.flush(); // TODO
+        uint8_t message[] = {header, d1, d2};
+        sendMessage(message, 3);
     }
 
     void sendImpl(uint8_t header, uint8_t d1, uint8_t cn) override {
@@ -64,27 +270,18 @@ class StreamMIDI_Interface : public Parsing_MIDI_Interface {
         std::lock_guard<std::mutex> lock(mutex);
 #endif
         (void)cn;
-        stream.write(header); // Send the MIDI message over the stream
-        stream.write(d1);
-        // stream.flush(); // TODO
+        uint8_t message[] = {header, d1};
+        sendMessage(message, 2);
     }
 
-    void sendImpl(const uint8_t *data, size_t length, uint8_t cn) override {
-#if defined(ESP32) || !defined(ARDUINO)
-        std::lock_guard<std::mutex> lock(mutex);
-#endif
-        (void)cn;
-        stream.write(data, length);
-        // stream.flush(); // TODO
-    }
+    void sendImpl(const uint8_t *data, size_t length, uint8_t cn) override;
 
     void sendImpl(uint8_t rt, uint8_t cn) override {
 #if defined(ESP32) || !defined(ARDUINO)
         std::lock_guard<std::mutex> lock(mutex);
 #endif
         (void)cn;
-        stream.write(rt); // Send the MIDI message over the stream
-        // stream.flush(); // TODO
+        sendMessage(&rt, 1);
     }
 
   protected:
@@ -92,6 +289,25 @@ class StreamMIDI_Interface : public Parsing_MIDI_Interface {
 #if defined(ESP32) || !defined(ARDUINO)
     std::mutex mutex;
 #endif
+
+  private:
+    /// Bytes that were read from the Stream, but not yet parsed.
+    Array<uint8_t, STREAM_MIDI_READ_BUFFER_SIZE> readBuffer = {{}};
+    uint8_t readIndex = 0;
+    uint8_t readLength = 0;
+    /// Messages that didn't fit in the transmit buffer of the Stream yet.
+    MIDI_TransmitQueueBase *transmitQueue = nullptr;
+    /// The last values of the controllers, to suppress duplicate messages.
+    MIDI_DuplicateFilterBase *duplicateFilter = nullptr;
+    bool runningStatusEnabled = false;
+    /// The status byte of the last channel message that was written to the
+    /// Stream, or zero if running status is not possible.
+    uint8_t runningStatus = 0;
+    unsigned long runningStatusRefresh = STREAM_MIDI_RUNNING_STATUS_REFRESH;
+    /// The time (in milliseconds) the running status byte was last written.
+    unsigned long runningStatusTime = 0;
+    /// Whether the Stream has ever reported free space in its transmit buffer.
+    bool availableForWriteSupported = false;
 };
 
 /**
@@ -7,9 +7,26 @@ namespace USBMIDI {
 
 using MIDIUSBPacket_t = AH::Array<uint8_t, 4>;
 MIDIUSBPacket_t read();
+/// Read up to @p maxPackets packets from the OUT endpoint into the given
+/// array, until the host has no more packets. Returns the number of packets
+/// that were read.
+uint8_t read(MIDIUSBPacket_t *packets, uint8_t maxPackets);
 void write(uint8_t cn, uint8_t cin, uint8_t d0, uint8_t d1, uint8_t d2);
 void flush();
 
+/// The default implementation of the multi-packet read, for cores that can
+/// only read one packet at a time.
+inline uint8_t readEach(MIDIUSBPacket_t *packets, uint8_t maxPackets) {
+    uint8_t count = 0;
+    while (count < maxPackets) {
+        packets[count] = read();
+        if (packets[count].data[0] == 0)
+            break;
+        ++count;
+    }
+    return count;
+}
+
 } // namespace USBMIDI
 
 END_CS_NAMESPACE
\ No newline at end of file
@@ -11,6 +11,31 @@ MIDIUSBPacket_t read() {
                             midipacket.byte2, midipacket.byte3}};
 }
 
+#ifdef ARDUINO_ARCH_AVR
+/// Gives access to the OUT endpoint of the MIDIUSB module, which is a
+/// protected member of PluggableUSBModule.
+struct MIDIUSBEndpoint : MIDI_ {
+    static uint8_t rx(MIDI_ &midi) {
+        return midi.*(&MIDIUSBEndpoint::pluggedEndpoint);
+    }
+};
+
+uint8_t read(MIDIUSBPacket_t *packets, uint8_t maxPackets) {
+    // Receive all packets of the endpoint bank in a single USB_Recv call,
+    // instead of one call (and one interrupt lock) per packet.
+    static_assert(sizeof(*packets) == 4, "incorrect packet size");
+    uint8_t rx = MIDIUSBEndpoint::rx(MidiUSB);
+    if (USB_Available(rx) <= 0)
+        return 0;
+    int length = USB_Recv(rx, packets, maxPackets * sizeof(*packets));
+    return length > 0 ? length / sizeof(*packets) : 0;
+}
+#else
+uint8_t read(MIDIUSBPacket_t *packets, uint8_t maxPackets) {
+    return readEach(packets, maxPackets);
+}
+#endif
+
 void write(uint8_t cn, uint8_t cin, uint8_t d0, uint8_t d1, uint8_t d2) {
     midiEventPacket_t msg = {
         uint8_t((cn << 4) | cin), // CN|CIN
@@ -43,6 +43,40 @@ retry:
     return packet;
 }
 
+uint8_t read(MIDIUSBPacket_t *packets, uint8_t maxPackets) {
+    // Same as above, but drains the endpoint without re-enabling interrupts
+    // and selecting the endpoint for every packet.
+    uint8_t c, intr_state, count = 0;
+
+    intr_state = SREG;
+    cli();
+    if (!usb_configuration) {
+        SREG = intr_state;
+        return 0;
+    }
+    UENUM = MIDI_RX_ENDPOINT;
+    while (count < maxPackets) {
+        c = UEINTX;
+        if (!(c & (1 << RWAL))) {
+            if (c & (1 << RXOUTI)) {
+                UEINTX = 0x6B;
+                continue;
+            }
+            break;
+        }
+        packets[count].data[0] = UEDATX;
+        packets[count].data[1] = UEDATX;
+        packets[count].data[2] = UEDATX;
+        packets[count].data[3] = UEDATX;
+        ++count;
+        if (!(UEINTX & (1 << RWAL)))
+            UEINTX = 0x6B;
+    }
+    SREG = intr_state;
+
+    return count;
+}
+
 void write(uint8_t cn, uint8_t cin, uint8_t d0, uint8_t d1, uint8_t d2) {
     uint8_t intr_state, timeout;
 
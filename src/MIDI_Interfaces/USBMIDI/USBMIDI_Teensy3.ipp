@@ -19,6 +19,10 @@ MIDIUSBPacket_t read() {
     return packet;
 }
 
+uint8_t read(MIDIUSBPacket_t *packets, uint8_t maxPackets) {
+    return readEach(packets, maxPackets);
+}
+
 void write(uint8_t cn, uint8_t cin, uint8_t d0, uint8_t d1, uint8_t d2) {
     usb_midi_write_packed((cn << 4) | cin | // CN|CIN
                           (d0 << 8) |       // status
@@ -2,6 +2,7 @@
 
 #include "MIDI_Interface.hpp"
 #include "USBMIDI/USBMIDI.hpp"
+#include <AH/Arduino-Wrapper.h> // micros
 #include <AH/Error/Error.hpp>
 #include <AH/Teensy/TeensyUSBTypes.hpp>
 #include <MIDI_Parsers/USBMIDI_Parser.hpp>
@@ -47,6 +48,24 @@ class USBMIDI_Interface : public Parsing_MIDI_Interface {
 
     using MIDIUSBPacket_t = USBMIDI::MIDIUSBPacket_t;
 
+#if !IGNORE_SYSEX
+    /**
+     * @brief   Use a statically allocated array to receive System Exclusive
+     *          messages on the given cable, instead of the default buffer of
+     *          @ref SYSEX_BUFFER_SIZE bytes.
+     *
+     * For example, to receive SysEx messages of up to 4 KiB:
+     * ~~~cpp
+     * static uint8_t sysexbuffer[4096];
+     * midi.setSysExBuffer(sysexbuffer);
+     * ~~~
+     */
+    template <size_t N>
+    void setSysExBuffer(uint8_t (&storage)[N], Cable cable = CABLE_1) {
+        parser.setSysExBuffer(storage, cable);
+    }
+#endif
+
   private:
     USBMIDI_Parser parser;
 
@@ -55,24 +74,114 @@ class USBMIDI_Interface : public Parsing_MIDI_Interface {
     MOCK_METHOD(void, writeUSBPacket,
                 (uint8_t, uint8_t, uint8_t, uint8_t, uint8_t));
     MOCK_METHOD(MIDIUSBPacket_t, readUSBPacket, ());
-    void flushUSB() {}
+    MOCK_METHOD(void, flushUSB, ());
 
   private:
+    /// Reads one packet at a time, like the USB cores without a multi-packet
+    /// read (see USBMIDI::readEach).
+    uint8_t readUSBPackets(MIDIUSBPacket_t *packets, uint8_t maxPackets) {
+        uint8_t count = 0;
+        while (count < maxPackets) {
+            packets[count] = readUSBPacket();
+            if (packets[count].data[0] == 0)
+                break;
+            ++count;
+        }
+        return count;
+    }
 #else
     void writeUSBPacket(uint8_t cn, uint8_t cin, uint8_t d0, uint8_t d1,
                         uint8_t d2) {
         USBMIDI::write(cn, cin, d0, d1, d2);
     }
-    MIDIUSBPacket_t readUSBPacket() { return USBMIDI::read(); }
+    /// Read up to @p maxPackets packets from the USB endpoint at once.
+    uint8_t readUSBPackets(MIDIUSBPacket_t *packets, uint8_t maxPackets) {
+        return USBMIDI::read(packets, maxPackets);
+    }
     void flushUSB() { USBMIDI::flush(); }
 #endif
 
-    void sendImpl(uint8_t header, uint8_t d1, uint8_t d2, uint8_t cn) override {
-        writeUSBPacket(cn, header >> 4, // CN|CIN
-                       header,          // status
-                       d1,              // data 1
-                       d2);             // data 2
+  public:
+    /// @name   Write combining
+    /// @{
+
+    /**
+     * @brief   Enable or disable write combining.
+     *
+     * When write combining is disabled, every message is sent in its own USB
+     * transfer. When it is enabled, outgoing packets are collected, and they
+     * are sent together when @ref flush is called (i.e. once per
+     * Control_Surface_::loop), when the buffer of one USB transfer is full,
+     * or when the oldest packet has been waiting for longer than the maximum
+     * latency.
+     *
+     * @see     USB_MIDI_WRITE_COMBINING
+     */
+    void setWriteCombining(bool enable) {
+        if (!enable)
+            flush();
+        writeCombining = enable;
+    }
+    /// Check whether write combining is enabled.
+    bool getWriteCombining() const { return writeCombining; }
+
+    /**
+     * @brief   Set the maximum time outgoing packets are kept in the buffer
+     *          when write combining is enabled.
+     *
+     * The deadline is checked when sending messages, and in @ref update.
+     *
+     * @param   microseconds
+     *          The maximum latency in microseconds.
+     *
+     * @see     USB_MIDI_MAX_LATENCY
+     */
+    void setMaxLatency(unsigned long microseconds) {
+        maxLatency = microseconds;
+    }
+    /// Get the maximum latency in microseconds.
+    unsigned long getMaxLatency() const { return maxLatency; }
+
+    /// Send all buffered packets to the host.
+    void flush() override {
+        if (pendingPackets == 0)
+            return;
         flushUSB();
+        pendingPackets = 0;
+    }
+
+    /// @}
+
+  private:
+    void writePacket(uint8_t cn, uint8_t cin, uint8_t d0, uint8_t d1,
+                     uint8_t d2) {
+        if (writeCombining && pendingPackets == 0)
+            firstPendingTime = micros();
+        writeUSBPacket(cn, cin, d0, d1, d2);
+        if (++pendingPackets >= USB_MIDI_PACKETS_PER_TRANSFER)
+            flush();
+    }
+
+    /// Called after each message: flush immediately, or only if the latency
+    /// deadline has passed when write combining is enabled.
+    void endMessage() {
+        if (!writeCombining)
+            flush();
+        else
+            flushIfDeadlineExpired();
+    }
+
+    void flushIfDeadlineExpired() {
+        if (pendingPackets > 0 && micros() - firstPendingTime >= maxLatency)
+            flush();
+    }
+
+    void sendImpl(uint8_t header, uint8_t d1, uint8_t d2, uint8_t cn) override {
+        writePacket(cn, header >> 4, // CN|CIN
+                    header,          // status
+                    d1,              // data 1
+                    d2);             // data 2
+        endMessage();
     }
 
     void sendImpl(uint8_t header, uint8_t d1, uint8_t cn) override {
@@ -80,42 +189,148 @@ class USBMIDI_Interface : public Parsing_MIDI_Interface {
     }
 
     void sendImpl(const uint8_t *data, size_t length, uint8_t cn) override {
+        // If the previous chunked message was never terminated, end it now
+        if (sysexPendingLength > 0)
+            sendPendingSysExEnd();
         while (length > 3) {
-            writeUSBPacket(cn, 0x4, data[0], data[1], data[2]);
+            writePacket(cn, 0x4, data[0], data[1], data[2]);
             data += 3;
             length -= 3;
         }
         switch (length) {
-            case 3: writeUSBPacket(cn, 0x7, data[0], data[1], data[2]); break;
-            case 2: writeUSBPacket(cn, 0x6, data[0], data[1], 0); break;
-            case 1: writeUSBPacket(cn, 0x5, data[0], 0, 0); break;
+            case 3: writePacket(cn, 0x7, data[0], data[1], data[2]); break;
+            case 2: writePacket(cn, 0x6, data[0], data[1], 0); break;
+            case 1: writePacket(cn, 0x5, data[0], 0, 0); break;
             default: break;
         }
-        flushUSB();
+        endMessage();
+    }
+
+    /// Send a chunk of a long SysEx message (see
+    /// MIDI_Parser::setSysExChunking). Bytes that don't fill a complete packet
+    /// are kept until the next chunk arrives.
+    void sendChunkImpl(const uint8_t *data, size_t length,
+                       uint8_t cn) override {
+        // If the previous message was never terminated, end it now
+        if (sysexPendingLength > 0 &&
+            (cn != sysexPendingCN || data[0] == SysExStart))
+            sendPendingSysExEnd();
+        sysexPendingCN = cn;
+        for (; length > 0; --length) {
+            uint8_t byte = *data++;
+            sysexPending[sysexPendingLength++] = byte;
+            if (byte == SysExEnd) {
+                sendPendingSysExEnd();
+            } else if (sysexPendingLength == 3) {
+                writePacket(cn, 0x4, sysexPending[0], sysexPending[1],
+                            sysexPending[2]);
+                sysexPendingLength = 0;
+            }
+        }
+        endMessage();
+    }
+
+    /// Send the bytes that were kept by @ref sendChunkImpl as the end of a
+    /// SysEx message.
+    void sendPendingSysExEnd() {
+        uint8_t cn = sysexPendingCN;
+        switch (sysexPendingLength) {
+            case 3:
+                writePacket(cn, 0x7, sysexPending[0], sysexPending[1],
+                            sysexPending[2]);
+                break;
+            case 2:
+                writePacket(cn, 0x6, sysexPending[0], sysexPending[1], 0);
+                break;
+            case 1: writePacket(cn, 0x5, sysexPending[0], 0, 0); break;
+            default: break;
+        }
+        sysexPendingLength = 0;
     }
 
     void sendImpl(uint8_t rt, uint8_t cn) override {
-        writeUSBPacket(cn, 0xF, // CN|CIN
-                       rt,      // single byte
-                       0,       // no data
-                       0);      // no data
-        flushUSB();
+        writePacket(cn, 0xF, // CN|CIN
+                    rt,      // single byte
+                    0,       // no data
+                    0);      // no data
+        endMessage();
     }
 
+    bool writeCombining = USB_MIDI_WRITE_COMBINING;
+    uint8_t pendingPackets = 0;
+    unsigned long firstPendingTime = 0;
+    unsigned long maxLatency = USB_MIDI_MAX_LATENCY;
+
+    constexpr static uint8_t SysExStart =
+        static_cast<uint8_t>(MIDIMessageType::SYSEX_START);
+    constexpr static uint8_t SysExEnd =
+        static_cast<uint8_t>(MIDIMessageType::SYSEX_END);
+    uint8_t sysexPending[3];
+    uint8_t sysexPendingLength = 0;
+    uint8_t sysexPendingCN = 0;
+
+  protected:
+    /// Send the buffered outgoing packets if they have been waiting for too
+    /// long.
+    void updateHousekeeping() override { flushIfDeadlineExpired(); }
+
   public:
+    /**
+     * @brief   Read the next MIDI message.
+     *
+     * All packets that are available are read at once (up to
+     * @ref USB_MIDI_READ_BUFFER_SIZE packets), straight from the USB endpoint
+     * on cores that support it, and are then parsed in place from that
+     * buffer. If the host had no more packets when the buffer was
+     * filled, the end of the buffer is reported as `NO_MESSAGE` without
+     * polling the host again, and the next call starts a new read.
+     */
     MIDIReadEvent read() override {
-        for (uint8_t i = 0; i < (SYSEX_BUFFER_SIZE + 2) / 3; ++i) {
-            MIDIUSBPacket_t midi_packet = readUSBPacket();
-            if (midi_packet.data[0] == 0)
+        for (uint16_t i = 0; i < getMaxPacketsPerRead(); ++i) {
+            if (readIndex == readLength && !fillReadBuffer())
                 return MIDIReadEvent::NO_MESSAGE;
 
-            MIDIReadEvent parseResult = parser.parse(midi_packet.data);
+            MIDIReadEvent parseResult =
+                parser.parse(readBuffer[readIndex++].data);
 
             if (parseResult != MIDIReadEvent::NO_MESSAGE)
                 return parseResult;
         }
         return MIDIReadEvent::NO_MESSAGE;
     }
+
+  private:
+    /// The maximum number of packets handled by a single call to @ref read:
+    /// enough for a SysEx message that fills the largest SysEx buffer.
+    uint16_t getMaxPacketsPerRead() const {
+#if !IGNORE_SYSEX
+        return (parser.getMaxSysExCapacity() + 2) / 3;
+#else
+        return (SYSEX_BUFFER_SIZE + 2) / 3;
+#endif
+    }
+
+    /// Read all available packets (as many as fit) into the read buffer.
+    /// Returns false if no packets were available.
+    bool fillReadBuffer() {
+        if (readBufferDrained) {
+            readBufferDrained = false;
+            return false;
+        }
+        readIndex = 0;
+        readLength = readUSBPackets(readBuffer.data, readBuffer.length);
+        // If the host ran out of packets, there's no need to poll it again
+        // when the buffer is empty, until the next read.
+        readBufferDrained = readLength > 0 && readLength < readBuffer.length;
+        return readLength > 0;
+    }
+
+    /// Packets that were read from the host, but not yet parsed.
+    Array<MIDIUSBPacket_t, USB_MIDI_READ_BUFFER_SIZE> readBuffer = {{}};
+    uint8_t readIndex = 0;
+    uint8_t readLength = 0;
+    /// Whether the host had no more packets when the buffer was last filled.
+    bool readBufferDrained = false;
 };
 
 END_CS_NAMESPACE
@@ -0,0 +1,3 @@
+#ifdef TEST_COMPILE_ALL_HEADERS_SEPARATELY
+#include "MIDIFilteredAnalogs.hpp"
+#endif
\ No newline at end of file
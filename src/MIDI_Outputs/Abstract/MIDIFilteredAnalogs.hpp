@@ -0,0 +1,94 @@
+#pragma once
+
+#include <AH/Hardware/FilteredAnalogArray.hpp>
+#include <Def/Def.hpp>
+#include <MIDI_Outputs/Abstract/MIDIOutputElement.hpp>
+
+BEGIN_CS_NAMESPACE
+
+/**
+ * @brief   An abstract class for a collection of potentiometers and faders
+ *          that send MIDI events.
+ *
+ * The analog inputs are filtered and hysteresis is applied. All inputs are
+ * updated at once, using a single FilteredAnalogArray, which is faster than
+ * using many separate MIDIFilteredAnalog elements.
+ *
+ * @see     FilteredAnalogArray
+ */
+template <class Sender, uint8_t NumPots>
+class MIDIFilteredAnalogs : public MIDIOutputElement {
+  protected:
+    /**
+     * @brief   Construct a new MIDIFilteredAnalogs.
+     *
+     * @param   analogPins
+     *          The analog input pins with the wipers of the potentiometers
+     *          connected.
+     * @param   baseAddress
+     *          The MIDI address of the first potentiometer.
+     * @param   incrementAddress
+     *          The number of addresses to increment for each next
+     *          potentiometer.
+     * @param   sender
+     *          The MIDI sender to use.
+     */
+    MIDIFilteredAnalogs(const PinList<NumPots> &analogPins,
+                        const MIDIAddress &baseAddress,
+                        const RelativeMIDIAddress &incrementAddress,
+                        const Sender &sender)
+        : filteredAnalogs(analogPins), baseAddress(baseAddress),
+          incrementAddress(incrementAddress), sender(sender) {}
+
+  public:
+    void begin() override { filteredAnalogs.resetToCurrentValue(); }
+
+    void update() override {
+        if (!filteredAnalogs.update())
+            return;
+        MIDIAddress address = baseAddress;
+        uint8_t index = 0;
+        filteredAnalogs.forEachChanged([&](uint8_t changed) {
+            for (; index < changed; ++index)
+                address += incrementAddress;
+            sender.send(filteredAnalogs.getValue(changed), address);
+        });
+    }
+
+    /**
+     * @brief   Specify a mapping function that is applied to the raw
+     *          analog values of all potentiometers before sending.
+     *
+     * @see     FilteredAnalogArray::map
+     */
+    void map(MappingFunction fn) { filteredAnalogs.map(fn); }
+
+    /// Invert the analog values of all potentiometers.
+    void invert() { filteredAnalogs.invert(); }
+
+    /**
+     * @brief   Get the raw value of the given analog input (this is the value 
+     *          without applying the filter or the mapping function first).
+     */
+    analog_t getRawValue(uint8_t index) const {
+        return filteredAnalogs.getRawValue(index);
+    }
+
+    /**
+     * @brief   Get the value of the given analog input (this is the value
+     *          after first applying the mapping function).
+     */
+    analog_t getValue(uint8_t index) const {
+        return filteredAnalogs.getValue(index);
+    }
+
+  private:
+    AH::FilteredAnalogArray<NumPots, Sender::precision()> filteredAnalogs;
+    const MIDIAddress baseAddress;
+    const RelativeMIDIAddress incrementAddress;
+
+  public:
+    Sender sender;
+};
+
+END_CS_NAMESPACE
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <MIDI_Outputs/Abstract/MIDIFilteredAnalogs.hpp>
+#include <MIDI_Senders/ContinuousCCSender.hpp>
+
+BEGIN_CS_NAMESPACE
+
+/**
+ * @brief   A class of MIDIOutputElement%s that read the analog inputs of a 
+ *          **collection of potentiometers or faders**, and send out 7-bit MIDI
+ *          **Control Change** events.
+ * 
+ * The analog inputs are filtered and hysteresis is applied for maximum
+ * stability. The result is the same as using a CCPotentiometer for each input,
+ * but all inputs are filtered in a single tight loop, which is faster when 
+ * there are many potentiometers.  
+ * This version cannot be banked.
+ *
+ * @tparam  NumPots
+ *          The number of potentiometers in the collection.
+ *
+ * @ingroup MIDIOutputElements
+ */
+template <uint8_t NumPots>
+class CCPotentiometers
+    : public MIDIFilteredAnalogs<ContinuousCCSender, NumPots> {
+  public:
+    /** 
+     * @brief   Create a new CCPotentiometers object with the given analog
+     *          pins, controller number and channel.
+     * 
+     * @param   analogPins
+     *          A list of analog input pins to read from.
+     * @param   baseAddress
+     *          The MIDI address of the first potentiometer, containing the
+     *          controller number [0, 119], channel [CHANNEL_1, CHANNEL_16], and
+     *          optional cable number [CABLE_1, CABLE_16].
+     * @param   incrementAddress
+     *          The number of addresses to increment for each next
+     *          potentiometer.  
+     *          E.g. if `baseAddress` is 8, and `incrementAddress` is 2,
+     *          then the first potentiometer will send on address 8, the second
+     *          one on address 10, the third one on address 12, etc.
+     * @param   sender
+     *          The MIDI sender to use.
+     */
+    CCPotentiometers(const PinList<NumPots> &analogPins,
+                     const MIDIAddress &baseAddress,
+                     const RelativeMIDIAddress &incrementAddress,
+                     const ContinuousCCSender &sender = {})
+        : MIDIFilteredAnalogs<ContinuousCCSender, NumPots>(
+              analogPins, baseAddress, incrementAddress, sender) {}
+};
+
+END_CS_NAMESPACE
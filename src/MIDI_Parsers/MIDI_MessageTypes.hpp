@@ -139,13 +139,16 @@ struct SysExMessage {
     /// Constructor.
     SysExMessage() : data(nullptr), length(0), CN(0) {}
 
-    /// Constructor.
-    SysExMessage(const uint8_t *data, size_t length, uint8_t CN)
-        : data(data), length(length), CN(CN) {}
+    /// Constructor. Messages longer than 65535 bytes are truncated.
+    SysExMessage(const uint8_t *data, size_t length, uint8_t CN,
+                 bool chunked = false)
+        : data(data), length(clampLength(length)), CN(CN), chunked(chunked) {}
 
-    /// Constructor.
-    SysExMessage(const uint8_t *data, size_t length, Cable cable = CABLE_1)
-        : data(data), length(length), CN(cable.getRaw()) {}
+    /// Constructor. Messages longer than 65535 bytes are truncated.
+    SysExMessage(const uint8_t *data, size_t length, Cable cable = CABLE_1,
+                 bool chunked = false)
+        : data(data), length(clampLength(length)), CN(cable.getRaw()),
+          chunked(chunked) {}
 
 #ifndef ARDUINO
     /// Constructor.
@@ -154,8 +157,11 @@ struct SysExMessage {
 #endif
 
     const uint8_t *data;
-    uint8_t length;
+    uint16_t length;
     uint8_t CN;
+    /// Whether this is a chunk of a long message that is delivered in
+    /// multiple parts, rather than a complete message.
+    bool chunked = false;
 
     bool operator==(SysExMessage other) const {
         return this->length == other.length &&
@@ -164,10 +170,38 @@ struct SysExMessage {
     }
     bool operator!=(SysExMessage other) const { return !(*this == other); }
 
+    /// @name   Chunked messages
+    /// Long messages can be received in multiple chunks, see
+    /// MIDI_Parser::setSysExChunking. All chunks of such a message have the
+    /// @ref chunked flag set, including the first and the last one.
+    /// @{
+
+    /// Check if this is the first chunk of a message (it starts with 0xF0).
+    bool isFirstChunk() const {
+        return length > 0 && data[0] == uint8_t(MIDIMessageType::SYSEX_START);
+    }
+    /// Check if this is the last chunk of a message (it ends with 0xF7).
+    bool isLastChunk() const {
+        return length > 0 &&
+               data[length - 1] == uint8_t(MIDIMessageType::SYSEX_END);
+    }
+    /// Check if this is a complete message, not a chunk of a longer message.
+    /// Messages that were truncated because they didn't fit in the buffer are
+    /// not chunks either.
+    bool isCompleteMessage() const { return !chunked; }
+
+    /// @}
+
     /// Get the MIDI USB cable number of the message.
     Cable getCable() const { return Cable(CN); }
     /// Set the MIDI USB cable number of the message.
     void setCable(Cable cable) { CN = cable.getRaw(); }
+
+  private:
+    /// The length is stored in 16 bits, longer messages can't be represented.
+    static uint16_t clampLength(size_t length) {
+        return length > 0xFFFF ? 0xFFFF : length;
+    }
 };
 
 struct RealTimeMessage {
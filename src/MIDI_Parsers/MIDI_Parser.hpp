@@ -17,6 +17,8 @@ enum class MIDIReadEvent : uint8_t {
     CHANNEL_MESSAGE = 1,  ///< A MIDI channel message was received.
     SYSEX_MESSAGE = 2,    ///< A MIDI system exclusive message was received.
     REALTIME_MESSAGE = 3, ///< A MIDI real-time message was received.
+    SYSEX_CHUNK = 4,      ///< A chunk of a long MIDI system exclusive message
+                          ///< was received, the message is not finished yet.
 };
 
 class MIDI_Parser {
@@ -36,9 +38,36 @@ class MIDI_Parser {
     /** Get the length of the SysEx message. */
     size_t getSysExLength() const { return getSysExMessage().length; }
 
+#if !IGNORE_SYSEX
+    /**
+     * @brief   Enable or disable chunked delivery of System Exclusive
+     *          messages.
+     *
+     * By default, a SysEx message is only returned once it has been received
+     * completely, and messages that don't fit in the SysEx buffer are 
+     * truncated or dropped. When chunking is enabled, the contents of the 
+     * buffer are returned as a `MIDIReadEvent::SYSEX_CHUNK` event whenever it
+     * is full, and the buffer is reused for the rest of the message. The last
+     * chunk is returned as a normal `MIDIReadEvent::SYSEX_MESSAGE`.  
+     * All chunks have the SysExMessage::chunked flag set. The first chunk
+     * starts with 0xF0, and the last chunk ends with 0xF7, see
+     * SysExMessage::isFirstChunk and SysExMessage::isLastChunk.
+     * This way, arbitrarily long messages can be received using a small
+     * buffer.
+     *
+     * @note    The SysEx buffer should be at least 3 bytes long.
+     */
+    void setSysExChunking(bool enable) { sysexChunks = enable; }
+    /// Check whether chunked delivery of SysEx messages is enabled.
+    bool getSysExChunking() const { return sysexChunks; }
+#endif
+
   protected:
     ChannelMessage midimsg = {0xFF, 0x00, 0x00, 0x0};
     RealTimeMessage rtmsg = {0xFF, 0x0};
+#if !IGNORE_SYSEX
+    bool sysexChunks = false;
+#endif
 
   public:
     /** Check if the given byte is a MIDI header byte. */
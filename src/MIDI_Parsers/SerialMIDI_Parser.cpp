@@ -93,6 +93,8 @@ MIDIReadEvent SerialMIDI_Parser::parse(uint8_t midiByte) {
             // SysEx data byte
             else if (midimsg.header == SysExStart) {
                 addSysExByte(midiByte);
+                if (sysExChunkFull())
+                    return returnSysExChunk();
             }
 #endif // IGNORE_SYSEX
             else {
@@ -103,4 +105,40 @@ MIDIReadEvent SerialMIDI_Parser::parse(uint8_t midiByte) {
     return MIDIReadEvent::NO_MESSAGE;
 }
 
+MIDIReadEvent SerialMIDI_Parser::parse(const uint8_t *data, size_t length,
+                                       size_t &consumed) {
+    const uint8_t *const begin = data;
+    const uint8_t *const end = data + length;
+    MIDIReadEvent event = MIDIReadEvent::NO_MESSAGE;
+    while (data != end && event == MIDIReadEvent::NO_MESSAGE) {
+#if !IGNORE_SYSEX
+        // If we're in the middle of a SysEx message, copy all data bytes up
+        // to the next status byte at once
+        if (midimsg.header == uint8_t(MIDIMessageType::SYSEX_START) &&
+            sysexbuffer.isReceiving()) {
+            const uint8_t *run = data;
+            while (run != end && isData(*run))
+                ++run;
+            if (run != data) {
+                size_t count = run - data;
+                if (sysexChunks) {
+                    if (sysExChunkFull())
+                        sysexbuffer.startChunk();
+                    if (count > sysexbuffer.getSpaceLeft())
+                        count = sysexbuffer.getSpaceLeft();
+                }
+                sysexbuffer.add(data, count);
+                data += count;
+                if (sysExChunkFull())
+                    event = returnSysExChunk();
+                continue;
+            }
+        }
+#endif
+        event = parse(*data++);
+    }
+    consumed = data - begin;
+    return event;
+}
+
 END_CS_NAMESPACE
\ No newline at end of file
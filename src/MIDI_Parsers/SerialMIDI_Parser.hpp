@@ -7,11 +7,51 @@ BEGIN_CS_NAMESPACE
 
 class SerialMIDI_Parser : public MIDI_Parser {
   public:
+    /// Parse a single byte of MIDI data.
     MIDIReadEvent parse(uint8_t midibyte);
 
+    /**
+     * @brief   Parse a buffer of MIDI data, until a complete message has been
+     *          received, or until all bytes have been consumed.
+     * 
+     * This is equivalent to calling @ref parse(uint8_t) for each byte until
+     * it returns a message, but runs of SysEx data bytes are copied to the
+     * SysEx buffer at once. If the buffer contains multiple messages, call 
+     * this function again with the remaining bytes after handling each 
+     * message. Running status and Real-Time bytes that interrupt other 
+     * messages are handled in exactly the same way as by @ref parse(uint8_t).
+     * The same goes for chunks of long SysEx messages (see 
+     * @ref setSysExChunking).
+     * 
+     * @param   data
+     *          A pointer to the MIDI data to parse.
+     * @param   length
+     *          The number of bytes in the buffer.
+     * @param[out] consumed
+     *          The number of bytes that were parsed. The remaining bytes
+     *          should be parsed in the next call.
+     */
+    MIDIReadEvent parse(const uint8_t *data, size_t length, size_t &consumed);
+
 #if !IGNORE_SYSEX
     SysExMessage getSysExMessage() const override {
-        return {sysexbuffer.getBuffer(), sysexbuffer.getLength(), 0};
+        return {sysexbuffer.getBuffer(), sysexbuffer.getLength(), 0,
+                sysexbuffer.isChunked()};
+    }
+
+    /**
+     * @brief   Use the given array to store incoming SysEx messages, instead
+     *          of the default buffer of @ref SYSEX_BUFFER_SIZE bytes.
+     *
+     * @see     SysExBuffer::setStorage
+     */
+    void setSysExBuffer(uint8_t *storage, uint16_t capacity) {
+        sysexbuffer.setStorage(storage, capacity);
+    }
+    /// @copydoc setSysExBuffer(uint8_t *, uint16_t)
+    template <size_t N>
+    void setSysExBuffer(uint8_t (&storage)[N]) {
+        sysexbuffer.setStorage(storage);
     }
 #endif
 
@@ -19,7 +59,21 @@ class SerialMIDI_Parser : public MIDI_Parser {
 #if !IGNORE_SYSEX
     SysExBuffer sysexbuffer;
 
-    bool addSysExByte(uint8_t data) { return sysexbuffer.add(data); }
+    bool addSysExByte(uint8_t data) {
+        // If the previous chunk was returned, the buffer can be reused
+        if (sysExChunkFull())
+            sysexbuffer.startChunk();
+        return sysexbuffer.add(data);
+    }
+    /// Check if the buffer is full and should be returned as a chunk.
+    bool sysExChunkFull() const {
+        return sysexChunks && sysexbuffer.getSpaceLeft() == 0;
+    }
+    /// Return the full buffer as a chunk of a long message.
+    MIDIReadEvent returnSysExChunk() {
+        sysexbuffer.markChunked();
+        return MIDIReadEvent::SYSEX_CHUNK;
+    }
     void startSysEx() { sysexbuffer.start(); }
     void endSysEx() { sysexbuffer.end(); }
 #endif
@@ -1,10 +1,34 @@
 #include "SysExBuffer.hpp"
+#include <string.h> // memcpy
 
 BEGIN_CS_NAMESPACE
 
+SysExBuffer &SysExBuffer::operator=(const SysExBuffer &other) {
+    if (this == &other)
+        return *this;
+    // Don't point to the default storage of the other buffer
+    bool otherDefault = other.SysExData == other.defaultStorage;
+    SysExData = otherDefault ? defaultStorage : other.SysExData;
+    SysExCapacity = other.SysExCapacity;
+    SysExLength = other.SysExLength;
+    receiving = other.receiving;
+    chunked = other.chunked;
+    memcpy(defaultStorage, other.defaultStorage, sizeof(defaultStorage));
+    return *this;
+}
+
+void SysExBuffer::setStorage(uint8_t *storage, uint16_t capacity) {
+    SysExData = storage;
+    SysExCapacity = capacity;
+    SysExLength = 0;
+    receiving = false;
+    chunked = false;
+}
+
 void SysExBuffer::start() {
     SysExLength = 0; // if the previous message wasn't finished, overwrite it
     receiving = true;
+    chunked = false;
     DEBUG("Start SysEx");
 }
 
@@ -13,25 +37,48 @@ void SysExBuffer::end() {
     DEBUG("End SysEx");
 }
 
+void SysExBuffer::startChunk() { SysExLength = 0; }
+
+void SysExBuffer::markChunked() { chunked = true; }
+
+bool SysExBuffer::isChunked() const { return chunked; }
+
 bool SysExBuffer::add(uint8_t data) {
     if (!hasSpaceLeft()) // if the buffer is full
         return false;
-    SysExBuffer[SysExLength] = data; // add the data to the buffer
+    SysExData[SysExLength] = data; // add the data to the buffer
     ++SysExLength;
     return true;
 }
 
+bool SysExBuffer::add(const uint8_t *data, size_t length) {
+    bool fits = length <= getSpaceLeft();
+    if (!fits) {
+        DEBUG("SysEx buffer full");
+        length = getSpaceLeft();
+    }
+    memcpy(SysExData + SysExLength, data, length);
+    SysExLength += length;
+    return fits;
+}
+
 bool SysExBuffer::hasSpaceLeft() const {
-    bool avail = SysExLength < SYSEX_BUFFER_SIZE;
+    bool avail = SysExLength < SysExCapacity;
     if (!avail)
         DEBUG("SysEx buffer full");
     return avail;
 }
 
+uint16_t SysExBuffer::getSpaceLeft() const {
+    return SysExCapacity - SysExLength;
+}
+
 bool SysExBuffer::isReceiving() const { return receiving; }
 
-const uint8_t *SysExBuffer::getBuffer() const { return SysExBuffer; }
+const uint8_t *SysExBuffer::getBuffer() const { return SysExData; }
+
+uint16_t SysExBuffer::getLength() const { return SysExLength; }
 
-size_t SysExBuffer::getLength() const { return SysExLength; }
+uint16_t SysExBuffer::getCapacity() const { return SysExCapacity; }
 
 END_CS_NAMESPACE
\ No newline at end of file
@@ -4,27 +4,76 @@
 
 BEGIN_CS_NAMESPACE
 
+/**
+ * @brief   Buffer for receiving MIDI System Exclusive messages.
+ *
+ * By default, every buffer has room for @ref SYSEX_BUFFER_SIZE bytes. If a
+ * MIDI interface has to receive larger messages (e.g. firmware or sample
+ * dumps), a larger, statically allocated array can be used instead, using
+ * @ref setStorage.
+ */
 class SysExBuffer {
   private:
-    uint8_t SysExBuffer[SYSEX_BUFFER_SIZE];
-    size_t SysExLength = 0;
+    uint8_t defaultStorage[SYSEX_BUFFER_SIZE];
+    uint8_t *SysExData = defaultStorage;
+    uint16_t SysExCapacity = SYSEX_BUFFER_SIZE;
+    uint16_t SysExLength = 0;
     bool receiving = false;
+    bool chunked = false;
 
   public:
+    SysExBuffer() = default;
+    SysExBuffer(const SysExBuffer &other) { *this = other; }
+    SysExBuffer &operator=(const SysExBuffer &other);
+
+    /**
+     * @brief   Use the given array to store incoming SysEx messages, instead
+     *          of the default buffer of @ref SYSEX_BUFFER_SIZE bytes.
+     *
+     * Any message that is currently being received is discarded.
+     *
+     * @param   storage
+     *          Pointer to the array to use. It should outlive this buffer.
+     * @param   capacity
+     *          The size of the array in bytes. [2, 65535]
+     */
+    void setStorage(uint8_t *storage, uint16_t capacity);
+    /// @copydoc setStorage(uint8_t *, uint16_t)
+    template <size_t N>
+    void setStorage(uint8_t (&storage)[N]) {
+        static_assert(N >= 2 && N <= 0xFFFF, "Invalid SysEx buffer size");
+        setStorage(storage, N);
+    }
+
     /// Start a new SysEx message.
     void start();
     /// Finish the current SysEx message.
     void end();
+    /// Discard the data in the buffer, but continue receiving the current
+    /// SysEx message. Used for receiving long messages in chunks.
+    void startChunk();
+    /// Mark the data in the buffer as a chunk of a long SysEx message. The
+    /// flag is cleared when the next message starts.
+    void markChunked();
+    /// Check whether the current message is being received in chunks.
+    bool isChunked() const;
     /// Add a byte to the current SysEx message.
     bool add(uint8_t data);
+    /// Add multiple bytes to the current SysEx message. Returns false if not
+    /// all bytes fit in the buffer.
+    bool add(const uint8_t *data, size_t length);
     /// Check if the buffer has at least 1 byte of free space available.
     bool hasSpaceLeft() const;
+    /// Get the number of bytes that can still be added to the buffer.
+    uint16_t getSpaceLeft() const;
     /// Check if the buffer is receiving a SysEx message.
     bool isReceiving() const;
     /// Get a pointer to the buffer.
     const uint8_t *getBuffer() const;
     /// Get the length of the SysEx message in the buffer.
-    size_t getLength() const;
+    uint16_t getLength() const;
+    /// Get the maximum length of a SysEx message that fits in the buffer.
+    uint16_t getCapacity() const;
 };
 
-END_CS_NAMESPACE
\ No newline at end of file
+END_CS_NAMESPACE
@@ -48,10 +48,13 @@ MIDIReadEvent USBMIDI_Parser::parse(uint8_t *packet) {
         else if (!receivingSysEx(CN)) { // If we haven't received a SysExStart
             DEBUGREF(F("Error: No SysExStart received"));
             return MIDIReadEvent::NO_MESSAGE; // ignore the data
-        }
+        } else
+            continueSysEx(CN);
         addSysExByte(CN, packet[1]) &&     // add three data bytes to buffer
             addSysExByte(CN, packet[2]) && //
             addSysExByte(CN, packet[3]);
+        if (sysExChunkFull(CN)) // Return a chunk of a long message
+            return returnSysExChunk(CN);
         return MIDIReadEvent::NO_MESSAGE; // SysEx is not finished yet
     }
 
@@ -67,6 +70,7 @@ MIDIReadEvent USBMIDI_Parser::parse(uint8_t *packet) {
             DEBUGFN(F("Error: No SysExStart received"));
             return MIDIReadEvent::NO_MESSAGE; // ignore the data
         }
+        continueSysEx(CN);
         if (addSysExByte(CN, packet[1])) {
             endSysEx(CN);
             return MIDIReadEvent::SYSEX_MESSAGE;
@@ -85,7 +89,8 @@ MIDIReadEvent USBMIDI_Parser::parse(uint8_t *packet) {
         else if (!receivingSysEx(CN)) { // If we haven't received a SysExStart
             DEBUGFN(F("Error: No SysExStart received"));
             return MIDIReadEvent::NO_MESSAGE; // ignore the data
-        }
+        } else
+            continueSysEx(CN);
         if ( // add two data bytes to buffer
             addSysExByte(CN, packet[1]) && addSysExByte(CN, SysExEnd)) {
             endSysEx(CN);
@@ -104,7 +109,8 @@ MIDIReadEvent USBMIDI_Parser::parse(uint8_t *packet) {
         else if (!receivingSysEx(CN)) { // If we haven't received a SysExStart
             DEBUGFN(F("Error: No SysExStart received"));
             return MIDIReadEvent::NO_MESSAGE; // ignore the data
-        }
+        } else
+            continueSysEx(CN);
         if (                               // add three data bytes to buffer
             addSysExByte(CN, packet[1]) && //
             addSysExByte(CN, packet[2]) && //
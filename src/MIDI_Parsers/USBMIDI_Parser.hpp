@@ -23,8 +23,31 @@ class USBMIDI_Parser : public MIDI_Parser {
 #if !IGNORE_SYSEX
     SysExMessage getSysExMessage() const override {
         return {sysexbuffers[activeSysExCN].getBuffer(),
-                sysexbuffers[activeSysExCN].getLength(), activeSysExCN};
+                sysexbuffers[activeSysExCN].getLength(), activeSysExCN,
+                sysexbuffers[activeSysExCN].isChunked()};
     }
+
+    /**
+     * @brief   Use the given array to store incoming SysEx messages on the
+     *          given cable, instead of the default buffer of
+     *          @ref SYSEX_BUFFER_SIZE bytes.
+     *
+     * @see     SysExBuffer::setStorage
+     */
+    void setSysExBuffer(uint8_t *storage, uint16_t capacity,
+                        Cable cable = CABLE_1) {
+        sysexbuffers[cable.getRaw()].setStorage(storage, capacity);
+        updateMaxSysExCapacity();
+    }
+    /// @copydoc setSysExBuffer(uint8_t *, uint16_t, Cable)
+    template <size_t N>
+    void setSysExBuffer(uint8_t (&storage)[N], Cable cable = CABLE_1) {
+        sysexbuffers[cable.getRaw()].setStorage(storage);
+        updateMaxSysExCapacity();
+    }
+
+    /// Get the size of the largest SysEx buffer of all cables.
+    uint16_t getMaxSysExCapacity() const { return maxSysExCapacity; }
 #endif
 
   protected:
@@ -40,13 +63,37 @@ class USBMIDI_Parser : public MIDI_Parser {
     bool receivingSysEx(uint8_t CN) const {
         return sysexbuffers[CN].isReceiving();
     }
+    /// Check if the buffer has no room for another packet, and should be
+    /// returned as a chunk.
+    bool sysExChunkFull(uint8_t CN) const {
+        return sysexChunks && sysexbuffers[CN].getSpaceLeft() < 3;
+    }
+    /// Return the full buffer as a chunk of a long message.
+    MIDIReadEvent returnSysExChunk(uint8_t CN) {
+        sysexbuffers[CN].markChunked();
+        activeSysExCN = CN;
+        return MIDIReadEvent::SYSEX_CHUNK;
+    }
+    /// If the previous chunk was returned, the buffer can be reused.
+    void continueSysEx(uint8_t CN) {
+        if (sysExChunkFull(CN))
+            sysexbuffers[CN].startChunk();
+    }
 #endif
 
     uint8_t activeSysExCN = 0;
 
   private:
 #if !IGNORE_SYSEX
+    void updateMaxSysExCapacity() {
+        maxSysExCapacity = 0;
+        for (const SysExBuffer &buffer : sysexbuffers)
+            if (buffer.getCapacity() > maxSysExCapacity)
+                maxSysExCapacity = buffer.getCapacity();
+    }
+
     Array<SysExBuffer, USB_MIDI_NUMBER_OF_CABLES> sysexbuffers;
+    uint16_t maxSysExCapacity = SYSEX_BUFFER_SIZE;
 #endif
 };
 
@@ -50,15 +50,104 @@ constexpr uint8_t NOTE_VELOCITY_THRESHOLD = 1;
 /** The length of the maximum System Exclusive message
  *  that can be received. The maximum length sent by
  *  the MCU protocol is 120 bytes.
+ *  Interfaces that have to receive larger messages can use a larger buffer
+ *  using `setSysExBuffer` (up to 65535 bytes).
  */
 constexpr size_t SYSEX_BUFFER_SIZE = 128;
 
+/// The number of bytes a StreamMIDI_Interface reads from its Stream at once,
+/// before parsing them.
+constexpr uint8_t STREAM_MIDI_READ_BUFFER_SIZE = 16;
+
+/// When running status is enabled on a StreamMIDI_Interface, the status byte is
+/// sent again if it hasn't been sent for this amount of time (in
+/// milliseconds), so a receiver that missed it (e.g. because it was connected
+/// later) can recover. Zero disables the refresh. Can be changed at runtime
+/// using StreamMIDI_Interface::setRunningStatus.
+constexpr unsigned long STREAM_MIDI_RUNNING_STATUS_REFRESH = 250;
+
+/// Collect outgoing USB MIDI packets and send them in a single USB transfer at
+/// the end of each Control_Surface_::loop, instead of sending every message in
+/// its own transfer. Can be changed at runtime using
+/// USBMIDI_Interface::setWriteCombining.
+constexpr bool USB_MIDI_WRITE_COMBINING = false;
+
+/// The maximum time (in microseconds) outgoing USB MIDI packets are kept in the
+/// buffer when write combining is enabled.
+constexpr unsigned long USB_MIDI_MAX_LATENCY = 1000;
+
+/// The number of 4-byte USB MIDI event packets that fit in a single USB
+/// transfer (64-byte full-speed bulk endpoint).
+constexpr uint8_t USB_MIDI_PACKETS_PER_TRANSFER = 16;
+
+/// The maximum number of 4-byte USB MIDI event packets a USBMIDI_Interface
+/// reads at once, before parsing them. The default is one full-speed transfer,
+/// a high-speed transfer (e.g. Teensy 4) holds up to 128 packets.
+constexpr uint8_t USB_MIDI_READ_BUFFER_SIZE = 16;
+
 /// The baud rate to use for Hairless MIDI.
 constexpr unsigned long HAIRLESS_BAUD = 115200;
 
 /// The maximum frame rate of the displays.
 constexpr uint8_t MAX_FPS = 60;
 
+/// The maximum number of incoming MIDI messages that are handled during a
+/// single Control_Surface_::loop, or zero for no limit. Messages that don't fit
+/// are handled during the next loop, so a flood of incoming MIDI messages can't
+/// starve the buttons and potentiometers.
+constexpr uint16_t MIDI_INPUT_MAX_MESSAGES_PER_LOOP = 0;
+
+/// The maximum time (in microseconds) spent handling incoming MIDI messages
+/// during a single Control_Surface_::loop, or zero for no limit.
+constexpr unsigned long MIDI_INPUT_MAX_MICROS_PER_LOOP = 1000;
+
+/// The maximum number of incoming MIDI messages that are handled by a single
+/// call to MIDI_Interface::update, or zero for no limit. Can be changed at
+/// runtime using MIDI_Interface::setUpdateLimits.
+constexpr uint16_t MIDI_INTERFACE_MAX_MESSAGES_PER_UPDATE = 0;
+
+/// The maximum time (in microseconds) spent by a single call to
+/// MIDI_Interface::update, or zero for no limit. Can be changed at runtime
+/// using MIDI_Interface::setUpdateLimits.
+constexpr unsigned long MIDI_INTERFACE_MAX_MICROS_PER_UPDATE = 0;
+
+/// The maximum number of display elements that are drawn (or displays that are
+/// written to) during a single Control_Surface_::loop, or zero for no limit.
+/// The rest of the frame is drawn during the next loops.
+constexpr uint16_t DISPLAY_MAX_ITEMS_PER_LOOP = 0;
+
+/// The maximum time (in microseconds) spent drawing and writing to the
+/// displays during a single Control_Surface_::loop, or zero for no limit.
+constexpr unsigned long DISPLAY_MAX_MICROS_PER_LOOP = 2000;
+
+/// The maximum number of BankableMIDIInput%s that are refreshed after a bank
+/// change during a single Control_Surface_::loop, or zero for no limit. The
+/// rest are refreshed during the next loops (see InputBankRefresher).
+constexpr uint16_t BANK_REFRESH_MAX_ITEMS_PER_LOOP = 16;
+
+/// The maximum time (in microseconds) spent refreshing BankableMIDIInput%s
+/// after a bank change during a single Control_Surface_::loop, or zero for no
+/// limit.
+constexpr unsigned long BANK_REFRESH_MAX_MICROS_PER_LOOP = 0;
+
+/// The shift factor of the EMA filter that smooths the interval between
+/// incoming MIDI Timing Clock messages (see MIDITempoTracker). Higher values
+/// reduce the jitter of the tempo estimate, but make it follow gradual tempo
+/// changes more slowly.
+constexpr uint8_t MIDI_CLOCK_FILTER_SHIFT_FACTOR = 4;
+
+/// Intervals between MIDI Timing Clock messages that deviate from the tempo
+/// estimate by more than 1/N of the estimate are considered outliers.
+constexpr uint8_t MIDI_CLOCK_MAX_DEVIATION_FRACTION = 4;
+
+/// The number of consecutive outliers after which the MIDITempoTracker
+/// assumes that the tempo changed, and jumps to the new tempo.
+constexpr uint8_t MIDI_CLOCK_MAX_OUTLIERS = 3;
+
+/// The maximum number of Updatable%s that the LoopProfiler keeps separate
+/// statistics for, if `AH_PROFILING` is enabled.
+constexpr uint8_t LOOP_PROFILER_MAX_UPDATABLES = 16;
+
 // ========================================================================== //
 
 END_CS_NAMESPACE
\ No newline at end of file
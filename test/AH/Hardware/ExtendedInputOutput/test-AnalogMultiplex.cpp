@@ -2,6 +2,7 @@
 
 #include <AH/Hardware/ExtendedInputOutput/AnalogMultiplex.hpp>
 #include <AH/Hardware/ExtendedInputOutput/ExtendedInputOutput.hpp>
+#include <AH/Hardware/FilteredAnalog.hpp>
 
 USING_AH_NAMESPACE;
 
@@ -260,4 +261,216 @@ TEST(AnalogMultiplex, pinModeBuffered) {
     ExtIO::pinModeBuffered(mux.pin(0b1111), INPUT_PULLUP);
 
     ::testing::Mock::VerifyAndClear(&ArduinoMock::getInstance());
-}
\ No newline at end of file
+}
+/// Simulates multiplexers with shared address lines: the value read from an
+/// analog pin depends on the state of the address lines. The output takes
+/// one reading to settle after the address changed: until then, it still
+/// has the value of the previous address.
+struct MuxSimulator {
+    MuxSimulator(const Array<pin_t, 4> &addressPins)
+        : addressPins(addressPins) {
+        using namespace ::testing;
+        auto &mock = ArduinoMock::getInstance();
+        EXPECT_CALL(mock, pinMode(_, _)).Times(AnyNumber());
+        EXPECT_CALL(mock, digitalWrite(_, _))
+            .WillRepeatedly(Invoke([this](uint8_t pin, uint8_t val) {
+                ++writes;
+                for (uint8_t i = 0; i < 4; ++i)
+                    if (this->addressPins[i] == pin)
+                        address = val ? address | (1 << i)
+                                      : address & ~(1 << i);
+            }));
+        EXPECT_CALL(mock, analogRead(_))
+            .WillRepeatedly(Invoke([this](uint8_t pin) {
+                ++reads;
+                uint8_t previous = settledAddress;
+                settledAddress = address;
+                return value(pin, previous);
+            }));
+    }
+    ~MuxSimulator() {
+        ::testing::Mock::VerifyAndClear(&ArduinoMock::getInstance());
+    }
+
+    static analog_t value(pin_t analogPin, uint8_t address) {
+        return analogPin * 100 + address;
+    }
+
+    /// The rest of the main loop gives the output time to settle.
+    void restOfLoop() { settledAddress = address; }
+
+    Array<pin_t, 4> addressPins;
+    uint8_t address = 0;
+    /// The address the output has settled to.
+    uint8_t settledAddress = 0;
+    unsigned writes = 0, reads = 0;
+};
+
+TEST(AnalogMultiplex, bufferedScan) {
+    MuxSimulator sim = {{2, 3, 4, 5}};
+    BufferedCD74HC4067 mux = {A0, {2, 3, 4, 5}};
+
+    // The first scan is done by begin: all address lines have to be written,
+    // and every channel needs a dummy reading to settle. Gray code order
+    // means that only one address line changes between channels, and the
+    // address of the next channel is selected at the end.
+    sim.writes = sim.reads = 0;
+    mux.begin();
+    EXPECT_EQ(sim.writes, 4u + 16u);
+    EXPECT_EQ(sim.reads, 2u * 16u);
+    // Only samples taken after the address settled end up in the buffer.
+    for (pin_t pin = 0; pin < 16; ++pin)
+        EXPECT_EQ(ExtIO::analogRead(mux.pin(pin)),
+                  MuxSimulator::value(A0, pin));
+
+    // The address of the first channel was selected at the end of the
+    // previous scan, so it has settled. The other channels haven't.
+    sim.restOfLoop();
+    sim.writes = sim.reads = 0;
+    mux.updateBufferedInputs();
+    EXPECT_EQ(sim.writes, 16u);
+    EXPECT_EQ(sim.reads, 1u + 2u * 15u);
+
+    // Reading from the buffer doesn't do any IO.
+    sim.writes = sim.reads = 0;
+    for (pin_t pin = 0; pin < 16; ++pin) {
+        EXPECT_EQ(ExtIO::analogRead(mux.pin(pin)),
+                  MuxSimulator::value(A0, pin));
+        EXPECT_EQ(ExtIO::analogReadBuffered(mux.pin(pin)),
+                  MuxSimulator::value(A0, pin));
+    }
+    EXPECT_EQ(sim.writes, 0u);
+    EXPECT_EQ(sim.reads, 0u);
+}
+
+TEST(AnalogMultiplex, bufferedRoundRobin) {
+    MuxSimulator sim = {{2, 3, 4, 5}};
+    BufferedCD74HC4067 mux = {A0, {2, 3, 4, 5}};
+    mux.setChannelsPerUpdate(1);
+    mux.begin();
+
+    // One channel per update: one address line toggle and a single reading.
+    for (unsigned i = 0; i < 16; ++i) {
+        sim.restOfLoop();
+        sim.writes = sim.reads = 0;
+        mux.updateBufferedInputs();
+        EXPECT_EQ(sim.writes, 1u);
+        EXPECT_EQ(sim.reads, 1u);
+    }
+    for (pin_t pin = 0; pin < 16; ++pin)
+        EXPECT_EQ(mux.analogRead(pin), MuxSimulator::value(A0, pin));
+}
+
+TEST(AnalogMultiplex, bufferedSharedAddressLines) {
+    MuxSimulator sim = {{2, 3, 4, 5}};
+    BufferedCD74HC4067 mux1 = {A0, {2, 3, 4, 5}};
+    BufferedCD74HC4067 mux2 = {A1, {2, 3, 4, 5}};
+    CD74HC4051 mux3 = {A2, {2, 3, 4}};
+    mux1.setChannelsPerUpdate(5);
+    mux2.setChannelsPerUpdate(3);
+    mux1.begin();
+    mux2.begin();
+    mux3.begin();
+
+    // The multiplexers change each other's address lines, the buffers must
+    // still contain the right values.
+    for (unsigned i = 0; i < 16; ++i) {
+        mux1.updateBufferedInputs();
+        mux2.updateBufferedInputs();
+        // The fourth address line is not connected to the CD74HC4051.
+        EXPECT_EQ(ExtIO::analogRead(mux3.pin(i % 8)) & ~0x08,
+                  MuxSimulator::value(A2, i % 8));
+    }
+    for (pin_t pin = 0; pin < 16; ++pin) {
+        EXPECT_EQ(mux1.analogRead(pin), MuxSimulator::value(A0, pin));
+        EXPECT_EQ(mux2.analogRead(pin), MuxSimulator::value(A1, pin));
+    }
+}
+
+TEST(AnalogMultiplex, bufferedEnable) {
+    BufferedCD74HC4051 mux = {A0, {2, 3, 4}, 6};
+    mux.setChannelsPerUpdate(2);
+
+    ::testing::Sequence begin;
+    EXPECT_CALL(ArduinoMock::getInstance(), pinMode(2, OUTPUT));
+    EXPECT_CALL(ArduinoMock::getInstance(), pinMode(3, OUTPUT));
+    EXPECT_CALL(ArduinoMock::getInstance(), pinMode(4, OUTPUT));
+    EXPECT_CALL(ArduinoMock::getInstance(), pinMode(6, OUTPUT));
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(6, HIGH))
+        .InSequence(begin);
+    // All eight channels are scanned, the multiplexer is enabled once
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(6, LOW))
+        .InSequence(begin);
+    EXPECT_CALL(ArduinoMock::getInstance(), analogRead(A0))
+        .Times(2 * 8)
+        .InSequence(begin)
+        .WillRepeatedly(::testing::Return(0));
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(6, HIGH))
+        .InSequence(begin);
+    EXPECT_CALL(ArduinoMock::getInstance(),
+                digitalWrite(::testing::Ne(6), ::testing::_))
+        .Times(3 + 8);
+    mux.begin();
+    ::testing::Mock::VerifyAndClear(&ArduinoMock::getInstance());
+
+    ::testing::InSequence seq;
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(6, LOW));
+    EXPECT_CALL(ArduinoMock::getInstance(), analogRead(A0))
+        .WillOnce(::testing::Return(0))
+        .WillOnce(::testing::Return(10));
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(2, 1));
+    EXPECT_CALL(ArduinoMock::getInstance(), analogRead(A0))
+        .WillOnce(::testing::Return(0))
+        .WillOnce(::testing::Return(11));
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(3, 1));
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(6, HIGH));
+    mux.updateBufferedInputs();
+    ::testing::Mock::VerifyAndClear(&ArduinoMock::getInstance());
+
+    // With an enable pin, the output has to settle after enabling, so the
+    // first reading is always discarded, and so is the first reading after
+    // every address change.
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(6, LOW));
+    EXPECT_CALL(ArduinoMock::getInstance(), analogRead(A0))
+        .WillOnce(::testing::Return(0))
+        .WillOnce(::testing::Return(13));
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(2, 0));
+    EXPECT_CALL(ArduinoMock::getInstance(), analogRead(A0))
+        .WillOnce(::testing::Return(0))
+        .WillOnce(::testing::Return(12));
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(4, 1));
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(6, HIGH));
+    mux.updateBufferedInputs();
+    ::testing::Mock::VerifyAndClear(&ArduinoMock::getInstance());
+
+    EXPECT_EQ(mux.analogRead(0), 10);
+    EXPECT_EQ(mux.analogRead(1), 11);
+    EXPECT_EQ(mux.analogRead(2), 12);
+    EXPECT_EQ(mux.analogRead(3), 13);
+}
+
+TEST(AnalogMultiplex, bufferedChannelsPerUpdateClamped) {
+    MuxSimulator sim = {{2, 3, 4, 5}};
+    BufferedCD74HC4051 mux = {A0, {2, 3, 4}};
+    mux.setChannelsPerUpdate(100);
+    mux.begin();
+    sim.writes = sim.reads = 0;
+    mux.updateBufferedInputs();
+    EXPECT_EQ(sim.reads, 1u + 2u * 7u);
+    mux.setChannelsPerUpdate(0);
+    sim.writes = sim.reads = 0;
+    mux.updateBufferedInputs();
+    EXPECT_EQ(sim.reads, 1u);
+}
+
+/// The buffer is filled by begin, so the filters don't start at zero.
+TEST(AnalogMultiplex, bufferedFilteredAnalogBegin) {
+    MuxSimulator sim = {{2, 3, 4, 5}};
+    BufferedCD74HC4067 mux = {7, {2, 3, 4, 5}};
+    FilteredAnalog<10> analog = mux.pin(5);
+    mux.begin();
+    analog.resetToCurrentValue();
+    mux.updateBufferedInputs();
+    analog.update();
+    EXPECT_NEAR(analog.getValue(), MuxSimulator::value(7, 5), 1);
+}
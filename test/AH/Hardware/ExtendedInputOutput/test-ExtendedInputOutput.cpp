@@ -2,7 +2,9 @@
 
 #include <AH/Hardware/ExtendedInputOutput/ExtendedInputOutput.hpp>
 #include <AH/Hardware/ExtendedInputOutput/ExtendedIOElement.hpp>
+#include <memory>
 #include <type_traits>
+#include <vector>
 
 using namespace ::testing;
 USING_AH_NAMESPACE;
@@ -491,4 +493,46 @@ TEST(ExtendedIOElement, updateAllBufferedOutputs) {
     EXPECT_CALL(el1, updateBufferedOutputs());
     EXPECT_CALL(el2, updateBufferedOutputs());
     ExtendedIOElement::updateAllBufferedOutputs();
-}
\ No newline at end of file
+}
+
+TEST(ExtendedIOElement, getElementOfPin) {
+    // Elements of different sizes, some of them sharing a lookup block, and
+    // one that spans multiple blocks.
+    std::vector<std::unique_ptr<MinimalMockExtIOElement>> elements;
+    for (pin_t length : {8, 1, 3, 16, 5, 2, 64, 8, 7, 1, 300, 8})
+        elements.emplace_back(new MinimalMockExtIOElement(length));
+
+    EXPECT_EQ(ExtendedIOElement::getElementOfPin(0), nullptr);
+    EXPECT_EQ(ExtendedIOElement::getElementOfPin(
+                  NUM_DIGITAL_PINS + NUM_ANALOG_INPUTS - 1),
+              nullptr);
+    for (auto &el : elements)
+        for (pin_t i = 0; i < el->getLength(); ++i)
+            EXPECT_EQ(ExtendedIOElement::getElementOfPin(el->pin(i)), el.get())
+                << el->pin(i);
+    EXPECT_EQ(ExtendedIOElement::getElementOfPin(elements.back()->getEnd()),
+              nullptr);
+    EXPECT_EQ(ExtendedIOElement::getElementOfPin(NO_PIN), nullptr);
+
+    // Disabled elements are still found
+    elements[3]->disable();
+    EXPECT_EQ(ExtendedIOElement::getElementOfPin(elements[3]->pin(15)),
+              elements[3].get());
+    elements[3]->enable();
+
+    // The pins of destroyed elements are no longer found
+    pin_t pin2 = elements[2]->pin(1), pin6 = elements[6]->pin(33);
+    elements[2].reset();
+    elements[6].reset();
+    EXPECT_EQ(ExtendedIOElement::getElementOfPin(pin2), nullptr);
+    EXPECT_EQ(ExtendedIOElement::getElementOfPin(pin6), nullptr);
+    EXPECT_EQ(ExtendedIOElement::getElementOfPin(pin2 + 2),
+              elements[3].get());
+    EXPECT_EQ(ExtendedIOElement::getElementOfPin(pin6 + 31),
+              elements[7].get());
+    EXPECT_THROW(ExtIO::digitalRead(pin6), AH::ErrorException);
+
+    EXPECT_CALL(*elements[11], digitalReadBuffered(7)).WillOnce(Return(HIGH));
+    EXPECT_CALL(*elements[11], updateBufferedInputs());
+    EXPECT_EQ(ExtIO::digitalRead(elements[11]->pin(7)), HIGH);
+}
@@ -0,0 +1,95 @@
+#include <gmock-wrapper.h>
+#include <gtest-wrapper.h>
+
+#include <AH/Hardware/ExtendedInputOutput/SPIShiftRegisterOut.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace ::testing;
+USING_AH_NAMESPACE;
+
+/// Record the bytes of all bulk SPI transfers.
+static void recordTransfers(std::vector<std::vector<uint8_t>> &transfers) {
+    EXPECT_CALL(ArduinoMock::getSPI(), transfer(_, _))
+        .WillRepeatedly(Invoke([&](void *buf, size_t count) {
+            auto data = static_cast<uint8_t *>(buf);
+            transfers.emplace_back(data, data + count);
+            // The received data overwrites the buffer
+            std::fill(data, data + count, 0xEE);
+        }));
+}
+
+TEST(SPIShiftRegisterOut, bulkTransferMSBFirst) {
+    SPIShiftRegisterOut<24> sr = {10, MSBFIRST};
+    std::vector<std::vector<uint8_t>> transfers;
+
+    InSequence seq;
+    EXPECT_CALL(ArduinoMock::getInstance(), pinMode(10, OUTPUT));
+    EXPECT_CALL(ArduinoMock::getSPI(), begin());
+    EXPECT_CALL(ArduinoMock::getSPI(),
+                beginTransaction(SPISettings{SPI_MAX_SPEED, MSBFIRST,
+                                             SPI_MODE0}));
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(10, LOW));
+    recordTransfers(transfers);
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(10, HIGH));
+    EXPECT_CALL(ArduinoMock::getSPI(), endTransaction());
+    sr.begin();
+
+    ASSERT_EQ(transfers.size(), 1u);
+    EXPECT_EQ(transfers[0], (std::vector<uint8_t>{0x00, 0x00, 0x00}));
+
+    // Nothing changed, so nothing is sent
+    sr.updateBufferedOutputs();
+    EXPECT_EQ(transfers.size(), 1u);
+
+    Mock::VerifyAndClear(&ArduinoMock::getInstance());
+    Mock::VerifyAndClear(&ArduinoMock::getSPI());
+
+    // Multiple changes are sent in a single transaction, with the last shift
+    // register first.
+    sr.digitalWriteBuffered(0, HIGH);
+    sr.digitalWriteBuffered(9, HIGH);
+    sr.digitalWriteBuffered(23, HIGH);
+    EXPECT_CALL(ArduinoMock::getSPI(), beginTransaction(_));
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(10, LOW));
+    recordTransfers(transfers);
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(10, HIGH));
+    EXPECT_CALL(ArduinoMock::getSPI(), endTransaction());
+    sr.updateBufferedOutputs();
+
+    ASSERT_EQ(transfers.size(), 2u);
+    EXPECT_EQ(transfers[1], (std::vector<uint8_t>{0x80, 0x02, 0x01}));
+
+    // The buffer itself is not affected by the received data
+    EXPECT_EQ(sr.digitalRead(0), HIGH);
+    EXPECT_EQ(sr.digitalRead(1), LOW);
+
+    Mock::VerifyAndClear(&ArduinoMock::getInstance());
+    Mock::VerifyAndClear(&ArduinoMock::getSPI());
+}
+
+TEST(SPIShiftRegisterOut, bulkTransferLSBFirst) {
+    SPIShiftRegisterOut<16> sr = {SPI, 10, LSBFIRST};
+    std::vector<std::vector<uint8_t>> transfers;
+
+    EXPECT_CALL(ArduinoMock::getInstance(), pinMode(10, OUTPUT));
+    EXPECT_CALL(ArduinoMock::getSPI(), begin());
+    EXPECT_CALL(ArduinoMock::getSPI(),
+                beginTransaction(SPISettings{SPI_MAX_SPEED, LSBFIRST,
+                                             SPI_MODE0}))
+        .Times(2);
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(10, LOW)).Times(2);
+    recordTransfers(transfers);
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(10, HIGH)).Times(2);
+    EXPECT_CALL(ArduinoMock::getSPI(), endTransaction()).Times(2);
+    sr.begin();
+    sr.digitalWrite(3, HIGH);
+    sr.digitalWriteBuffered(8, HIGH); // not sent until the next update
+
+    ASSERT_EQ(transfers.size(), 2u);
+    EXPECT_EQ(transfers[1], (std::vector<uint8_t>{0x08, 0x00}));
+
+    Mock::VerifyAndClear(&ArduinoMock::getInstance());
+    Mock::VerifyAndClear(&ArduinoMock::getSPI());
+}
@@ -0,0 +1,237 @@
+#include <AH/Hardware/ButtonMatrix.hpp>
+#include <AH/Hardware/ExtendedInputOutput/ExtendedIOElement.hpp>
+#include <gmock-wrapper.h>
+#include <gtest-wrapper.h>
+
+#include <vector>
+
+using namespace ::testing;
+USING_AH_NAMESPACE;
+
+struct ButtonMatrixEvent {
+    uint8_t row, col;
+    bool state;
+    bool operator==(const ButtonMatrixEvent &o) const {
+        return row == o.row && col == o.col && state == o.state;
+    }
+};
+
+std::ostream &operator<<(std::ostream &os, const ButtonMatrixEvent &e) {
+    return os << "(" << +e.row << ", " << +e.col << ", " << e.state << ")";
+}
+
+/// Button matrix that records all changes.
+template <uint8_t nb_rows, uint8_t nb_cols>
+struct RecordingButtonMatrix : ButtonMatrix<nb_rows, nb_cols> {
+    using ButtonMatrix<nb_rows, nb_cols>::ButtonMatrix;
+    void onButtonChanged(uint8_t row, uint8_t col, bool state) override {
+        events.push_back({row, col, state});
+    }
+    std::vector<ButtonMatrixEvent> events;
+};
+
+/// Simulates the electrical behavior of a button matrix: the column inputs
+/// read low if the button on the active row is pressed.
+template <uint8_t nb_rows, uint8_t nb_cols>
+struct MatrixSimulator {
+    MatrixSimulator(const PinList<nb_rows> &rowPins,
+                    const PinList<nb_cols> &colPins)
+        : rowPins(rowPins), colPins(colPins) {
+        auto &mock = ArduinoMock::getInstance();
+        EXPECT_CALL(mock, millis()).WillRepeatedly(Invoke([this] {
+            return time;
+        }));
+        EXPECT_CALL(mock, pinMode(_, _))
+            .WillRepeatedly(Invoke([this](uint8_t pin, uint8_t mode) {
+                for (uint8_t r = 0; r < nb_rows; ++r)
+                    if (this->rowPins[r] == pin) {
+                        if (mode == OUTPUT)
+                            activeRow = r;
+                        else if (activeRow == r)
+                            activeRow = -1;
+                    }
+            }));
+        EXPECT_CALL(mock, digitalRead(_))
+            .WillRepeatedly(Invoke([this](uint8_t pin) -> int {
+                for (uint8_t c = 0; c < nb_cols; ++c)
+                    if (this->colPins[c] == pin)
+                        return readColumn(c);
+                ADD_FAILURE() << "Unexpected digitalRead(" << +pin << ")";
+                return HIGH;
+            }));
+    }
+    ~MatrixSimulator() { Mock::VerifyAndClear(&ArduinoMock::getInstance()); }
+
+    int readColumn(uint8_t c) const {
+        return activeRow >= 0 && pressed[activeRow][c] ? LOW : HIGH;
+    }
+
+    PinList<nb_rows> rowPins;
+    PinList<nb_cols> colPins;
+    bool pressed[nb_rows][nb_cols] = {};
+    int activeRow = -1;
+    unsigned long time = 1000;
+};
+
+TEST(ButtonMatrix, pressAndRelease) {
+    MatrixSimulator<2, 3> sim = {{2, 3}, {4, 5, 6}};
+    RecordingButtonMatrix<2, 3> matrix = {{2, 3}, {4, 5, 6}};
+    matrix.begin();
+
+    matrix.update();
+    EXPECT_TRUE(matrix.events.empty());
+
+    sim.pressed[1][2] = true;
+    matrix.update();
+    ASSERT_EQ(matrix.events.size(), 1u);
+    EXPECT_EQ(matrix.events[0], (ButtonMatrixEvent{1, 2, LOW}));
+    EXPECT_EQ(matrix.getPrevState(2, 1), LOW);
+
+    sim.time += BUTTON_DEBOUNCE_TIME * 2;
+    sim.pressed[1][2] = false;
+    matrix.update();
+    ASSERT_EQ(matrix.events.size(), 2u);
+    EXPECT_EQ(matrix.events[1], (ButtonMatrixEvent{1, 2, HIGH}));
+    EXPECT_EQ(matrix.getPrevState(2, 1), HIGH);
+}
+
+/// Bounces of a button are ignored for the debounce time, and the final state
+/// is reported after the debounce time.
+TEST(ButtonMatrix, ignoreBounces) {
+    MatrixSimulator<1, 1> sim = {{2}, {3}};
+    RecordingButtonMatrix<1, 1> matrix = {{2}, {3}};
+    matrix.begin();
+
+    for (unsigned i = 0; i < 10; ++i) {
+        sim.pressed[0][0] = i % 2 == 0;
+        matrix.update();
+        sim.time += 1;
+    }
+    ASSERT_EQ(matrix.events.size(), 1u);
+    EXPECT_EQ(matrix.events[0], (ButtonMatrixEvent{0, 0, LOW}));
+
+    // Bounced back to released at the end
+    sim.time += BUTTON_DEBOUNCE_TIME * 3 / 2;
+    matrix.update();
+    ASSERT_EQ(matrix.events.size(), 2u);
+    EXPECT_EQ(matrix.events[1], (ButtonMatrixEvent{0, 0, HIGH}));
+}
+
+/// The lockout of a button lasts at least the debounce time, and at most 1.5
+/// times the debounce time.
+TEST(ButtonMatrix, lockoutTime) {
+    for (unsigned long start = 0; start < BUTTON_DEBOUNCE_TIME; ++start) {
+        MatrixSimulator<1, 1> sim = {{2}, {3}};
+        RecordingButtonMatrix<1, 1> matrix = {{2}, {3}};
+        matrix.begin();
+        sim.time += start;
+        matrix.update();
+
+        unsigned long pressTime = sim.time;
+        sim.pressed[0][0] = true;
+        matrix.update();
+        ASSERT_EQ(matrix.events.size(), 1u);
+        sim.pressed[0][0] = false;
+        while (matrix.events.size() == 1) {
+            ++sim.time;
+            matrix.update();
+        }
+        unsigned long lockout = sim.time - pressTime;
+        EXPECT_GT(lockout, BUTTON_DEBOUNCE_TIME - 2) << start;
+        EXPECT_LE(lockout, BUTTON_DEBOUNCE_TIME * 3 / 2) << start;
+    }
+}
+
+/// I/O expander with the columns of a simulated button matrix connected to
+/// its inputs.
+template <uint8_t nb_rows, uint8_t nb_cols>
+struct SimulatedColumnExpander : ExtendedIOElement {
+    SimulatedColumnExpander() : ExtendedIOElement(nb_cols) {}
+
+    void pinModeBuffered(pin_t, PinMode_t) override {}
+    void digitalWriteBuffered(pin_t, PinStatus_t) override {}
+    int digitalReadBuffered(pin_t pin) override { return buffer[pin]; }
+    void analogWriteBuffered(pin_t, analog_t) override {}
+    analog_t analogReadBuffered(pin_t) override { return 0; }
+    void begin() override {}
+    void updateBufferedOutputs() override {}
+    void updateBufferedInputs() override {
+        for (uint8_t c = 0; c < nb_cols; ++c)
+            buffer[c] = sim->readColumn(c);
+        ++reads;
+    }
+
+    PinList<nb_cols> getPins() const {
+        PinList<nb_cols> pins;
+        for (uint8_t c = 0; c < nb_cols; ++c)
+            pins[c] = pin(c);
+        return pins;
+    }
+
+    MatrixSimulator<nb_rows, nb_cols> *sim = nullptr;
+    int buffer[nb_cols] = {};
+    unsigned reads = 0;
+};
+
+/// Fast successive presses of different buttons, all bouncing at the same
+/// time, must all be reported, each exactly once.
+TEST(ButtonMatrix, simultaneousBouncingKeys) {
+    constexpr uint8_t rows = 8, cols = 16;
+    PinList<rows> rowPins = {2, 3, 4, 5, 6, 7, 8, 9};
+    // The columns are connected to an I/O expander, which should be read only
+    // once per row.
+    SimulatedColumnExpander<rows, cols> expander;
+    PinList<cols> colPins = expander.getPins();
+    MatrixSimulator<rows, cols> sim = {rowPins, colPins};
+    expander.sim = &sim;
+    RecordingButtonMatrix<rows, cols> matrix = {rowPins, colPins};
+    matrix.begin();
+
+    // Drum roll: a new pad is hit every millisecond, every hit bounces for
+    // 3 ms, and the pad is released 20 ms later (also bouncing).
+    constexpr unsigned numHits = 64;
+    constexpr unsigned bounce = 3, hold = 20;
+    auto padOf = [&](unsigned hit) { return (hit * 37) % (rows * cols); };
+    unsigned long t0 = sim.time;
+    constexpr unsigned long duration =
+        numHits + hold + 4 * BUTTON_DEBOUNCE_TIME;
+    for (unsigned long t = 0; t < duration; ++t) {
+        sim.time = t0 + t;
+        for (unsigned hit = 0; hit < numHits; ++hit) {
+            unsigned pad = padOf(hit);
+            bool &pressed = sim.pressed[pad / cols][pad % cols];
+            if (t >= hit && t < hit + bounce)
+                pressed = (t - hit) % 2 == 0;
+            else if (t >= hit + bounce && t < hit + hold)
+                pressed = true;
+            else if (t >= hit + hold && t < hit + hold + bounce)
+                pressed = (t - hit - hold) % 2 == 1;
+            else if (t >= hit + hold + bounce)
+                pressed = false;
+        }
+        matrix.update();
+    }
+
+    EXPECT_EQ(expander.reads, duration * rows);
+
+    ASSERT_EQ(matrix.events.size(), 2 * numHits);
+    std::vector<unsigned> presses(rows * cols), releases(rows * cols);
+    for (auto &e : matrix.events)
+        ++(e.state == LOW ? presses : releases)[e.row * cols + e.col];
+    for (unsigned hit = 0; hit < numHits; ++hit) {
+        EXPECT_EQ(presses[padOf(hit)], 1u) << hit;
+        EXPECT_EQ(releases[padOf(hit)], 1u) << hit;
+    }
+    // Presses are reported in the order the pads were hit.
+    unsigned hit = 0;
+    for (auto &e : matrix.events) {
+        if (e.state != LOW)
+            continue;
+        unsigned pad = padOf(hit++);
+        EXPECT_EQ(e, (ButtonMatrixEvent{uint8_t(pad / cols),
+                                        uint8_t(pad % cols), LOW}));
+    }
+    for (uint8_t r = 0; r < rows; ++r)
+        for (uint8_t c = 0; c < cols; ++c)
+            EXPECT_EQ(matrix.getPrevState(c, r), HIGH);
+}
@@ -0,0 +1,118 @@
+#include <gmock-wrapper.h>
+
+#include <AH/Hardware/FilteredAnalogArray.hpp>
+
+#include <array>
+#include <random>
+#include <vector>
+
+USING_AH_NAMESPACE;
+
+using namespace ::testing;
+
+/// Feed the same random walk to a FilteredAnalogArray and to separate
+/// FilteredAnalog objects, and check that the results are identical.
+template <uint8_t Precision, uint8_t FilterShiftFactor, class Configure>
+static void compareWithFilteredAnalog(Configure configure) {
+    constexpr uint8_t N = 3;
+    PinList<N> pins = {A0, A1, A2};
+    std::array<analog_t, N> inputs = {{0, 512, 1023}};
+    auto &mock = ArduinoMock::getInstance();
+    EXPECT_CALL(mock, analogRead(_))
+        .WillRepeatedly(Invoke([&](uint8_t pin) -> int {
+            for (uint8_t i = 0; i < N; ++i)
+                if (pins[i] == pin)
+                    return inputs[i];
+            ADD_FAILURE() << "Unexpected analogRead(" << +pin << ")";
+            return 0;
+        }));
+
+    FilteredAnalogArray<N, Precision, FilterShiftFactor> array = {pins, 100};
+    FilteredAnalog<Precision, FilterShiftFactor> separate[N] = {
+        {A0, 100}, {A1, 100}, {A2, 100}};
+    configure(array);
+    for (auto &analog : separate)
+        configure(analog);
+
+    std::mt19937 rng(0x1234);
+    std::uniform_int_distribution<int> step(-40, 40);
+    for (unsigned t = 0; t < 2000; ++t) {
+        for (auto &input : inputs)
+            input = constrain(int(input) + step(rng), 0, 1023);
+        bool anyChanged = false;
+        bool arrayChanged = array.update();
+        for (uint8_t i = 0; i < N; ++i) {
+            bool changed = separate[i].update();
+            anyChanged |= changed;
+            ASSERT_EQ(array.hasChanged(i), changed) << t << ", " << +i;
+            ASSERT_EQ(array.getValue(i), separate[i].getValue())
+                << t << ", " << +i;
+            ASSERT_FLOAT_EQ(array.getFloatValue(i),
+                            separate[i].getFloatValue());
+        }
+        ASSERT_EQ(arrayChanged, anyChanged) << t;
+    }
+
+    Mock::VerifyAndClear(&mock);
+}
+
+template <class T>
+static void noConfig(T &) {}
+
+TEST(FilteredAnalogArray, sameAsFilteredAnalog) {
+    compareWithFilteredAnalog<10, ANALOG_FILTER_SHIFT_FACTOR>(
+        [](auto &a) { noConfig(a); });
+}
+
+TEST(FilteredAnalogArray, sameAsFilteredAnalog7Bits) {
+    compareWithFilteredAnalog<7, 5>([](auto &a) { noConfig(a); });
+}
+
+TEST(FilteredAnalogArray, sameAsFilteredAnalogNoFilter) {
+    compareWithFilteredAnalog<9, 0>([](auto &a) { noConfig(a); });
+}
+
+TEST(FilteredAnalogArray, sameAsFilteredAnalogMapped) {
+    compareWithFilteredAnalog<10, ANALOG_FILTER_SHIFT_FACTOR>([](auto &a) {
+        a.map([](analog_t x) -> analog_t { return x / 2; });
+    });
+}
+
+TEST(FilteredAnalogArray, sameAsFilteredAnalogInverted) {
+    compareWithFilteredAnalog<7, ANALOG_FILTER_SHIFT_FACTOR>(
+        [](auto &a) { a.invert(); });
+}
+
+TEST(FilteredAnalogArray, resetToCurrentValue) {
+    FilteredAnalogArray<2, 7> array = {{A0, A1}};
+    auto &mock = ArduinoMock::getInstance();
+    EXPECT_CALL(mock, analogRead(A0)).WillRepeatedly(Return(1023));
+    EXPECT_CALL(mock, analogRead(A1)).WillRepeatedly(Return(512));
+    array.resetToCurrentValue();
+    EXPECT_TRUE(array.update());
+    EXPECT_TRUE(array.hasChanged(0));
+    EXPECT_TRUE(array.hasChanged(1));
+    EXPECT_EQ(array.getValue(0), 127);
+    EXPECT_EQ(array.getValue(1), 64);
+    EXPECT_FALSE(array.update());
+    EXPECT_FALSE(array.hasChanged(0));
+    EXPECT_FALSE(array.hasChanged(1));
+    Mock::VerifyAndClear(&mock);
+}
+
+TEST(FilteredAnalogArray, forEachChanged) {
+    constexpr uint8_t N = 11;
+    PinList<N> pins = {A0, A1, A2, A0, A1, A2, A0, A1, A2, A0, A1};
+    FilteredAnalogArray<N, 7, 0> array = pins;
+    auto &mock = ArduinoMock::getInstance();
+    EXPECT_CALL(mock, analogRead(A0)).WillRepeatedly(Return(0));
+    EXPECT_CALL(mock, analogRead(A1)).WillRepeatedly(Return(1023));
+    EXPECT_CALL(mock, analogRead(A2)).WillRepeatedly(Return(0));
+    EXPECT_TRUE(array.update());
+    std::vector<uint8_t> changed;
+    array.forEachChanged([&](uint8_t i) { changed.push_back(i); });
+    EXPECT_EQ(changed, (std::vector<uint8_t>{1, 4, 7, 10}));
+    for (uint8_t i = 0; i < N; ++i)
+        EXPECT_EQ(array.hasChanged(i), i % 3 == 1) << +i;
+    Mock::VerifyAndClear(&mock);
+}
@@ -0,0 +1,62 @@
+#include <gmock-wrapper.h>
+
+#include <AH/Timing/TimingStats.hpp>
+
+#include <sstream>
+
+USING_AH_NAMESPACE;
+
+TEST(TimingStats, empty) {
+    TimingStats stats;
+    EXPECT_EQ(stats.getCount(), 0ul);
+    EXPECT_EQ(stats.getMin(), 0ul);
+    EXPECT_EQ(stats.getMean(), 0ul);
+    EXPECT_EQ(stats.getMax(), 0ul);
+    for (uint8_t i = 0; i < TimingStats::NumBins; ++i)
+        EXPECT_EQ(stats.getBin(i), 0);
+}
+
+TEST(TimingStats, minMeanMax) {
+    TimingStats stats;
+    for (unsigned long d : {7, 3, 12, 2})
+        stats.add(d);
+    EXPECT_EQ(stats.getCount(), 4ul);
+    EXPECT_EQ(stats.getMin(), 2ul);
+    EXPECT_EQ(stats.getMean(), 6ul);
+    EXPECT_EQ(stats.getMax(), 12ul);
+    stats.reset();
+    EXPECT_EQ(stats.getCount(), 0ul);
+    EXPECT_EQ(stats.getMax(), 0ul);
+}
+
+TEST(TimingStats, bins) {
+    EXPECT_EQ(TimingStats::getBinIndex(0), 0);
+    EXPECT_EQ(TimingStats::getBinIndex(1), 1);
+    EXPECT_EQ(TimingStats::getBinIndex(2), 2);
+    EXPECT_EQ(TimingStats::getBinIndex(3), 2);
+    EXPECT_EQ(TimingStats::getBinIndex(4), 3);
+    EXPECT_EQ(TimingStats::getBinIndex(16383), 14);
+    EXPECT_EQ(TimingStats::getBinIndex(16384), 15);
+    EXPECT_EQ(TimingStats::getBinIndex(~0ul), 15);
+    for (uint8_t i = 0; i < TimingStats::NumBins; ++i)
+        EXPECT_EQ(TimingStats::getBinIndex(TimingStats::getBinLowerBound(i)),
+                  i);
+}
+
+TEST(TimingStats, histogramSaturates) {
+    TimingStats stats;
+    for (unsigned long i = 0; i < 70000; ++i)
+        stats.add(5);
+    EXPECT_EQ(stats.getCount(), 70000ul);
+    EXPECT_EQ(stats.getBin(3), 0xFFFF);
+}
+
+TEST(TimingStats, print) {
+    TimingStats stats;
+    for (unsigned long d : {0, 3, 5, 20000})
+        stats.add(d);
+    std::ostringstream s;
+    s << stats;
+    EXPECT_EQ(s.str(),
+              "n=4 min=0 mean=5002 max=20000 us | 0:1 2..3:1 4..7:1 >=16384:1");
+}
@@ -0,0 +1,71 @@
+#include <gmock-wrapper.h>
+
+#include <AH/Timing/WorkBudget.hpp>
+
+USING_AH_NAMESPACE;
+
+using namespace testing;
+
+TEST(WorkBudget, unlimited) {
+    WorkBudget budget;
+    EXPECT_TRUE(budget.isUnlimited());
+    budget.start();
+    for (unsigned i = 0; i < 100000; ++i) {
+        ASSERT_FALSE(budget.isExhausted());
+        budget.consume();
+    }
+    EXPECT_EQ(budget.getItemCount(), 0xFFFF);
+}
+
+TEST(WorkBudget, items) {
+    WorkBudget budget = 3;
+    for (unsigned j = 0; j < 2; ++j) {
+        budget.start();
+        for (unsigned i = 0; i < 3; ++i) {
+            EXPECT_FALSE(budget.isExhausted());
+            budget.consume();
+        }
+        EXPECT_TRUE(budget.isExhausted());
+    }
+}
+
+TEST(WorkBudget, time) {
+    WorkBudget budget = {0, 100};
+    EXPECT_CALL(ArduinoMock::getInstance(), micros()).WillOnce(Return(1000));
+    budget.start();
+    // At least one item is always allowed, without checking the time
+    EXPECT_FALSE(budget.isExhausted());
+    budget.consume();
+    EXPECT_CALL(ArduinoMock::getInstance(), micros())
+        .WillOnce(Return(1099))
+        .WillOnce(Return(1100));
+    EXPECT_FALSE(budget.isExhausted());
+    EXPECT_TRUE(budget.isExhausted());
+    Mock::VerifyAndClear(&ArduinoMock::getInstance());
+}
+
+TEST(WorkBudget, timeOverflow) {
+    WorkBudget budget = {0, 100};
+    EXPECT_CALL(ArduinoMock::getInstance(), micros())
+        .WillOnce(Return(static_cast<unsigned long>(-16)))
+        .WillOnce(Return(0x00000040))
+        .WillOnce(Return(0x00000054));
+    budget.start();
+    budget.consume();
+    EXPECT_FALSE(budget.isExhausted());
+    EXPECT_TRUE(budget.isExhausted());
+    Mock::VerifyAndClear(&ArduinoMock::getInstance());
+}
+
+TEST(WorkBudget, itemsAndTime) {
+    WorkBudget budget = {2, 100};
+    EXPECT_CALL(ArduinoMock::getInstance(), micros()).WillOnce(Return(0));
+    budget.start();
+    budget.consume();
+    EXPECT_CALL(ArduinoMock::getInstance(), micros()).WillOnce(Return(10));
+    EXPECT_FALSE(budget.isExhausted());
+    budget.consume();
+    // The item limit is checked first, no need to read the time
+    EXPECT_TRUE(budget.isExhausted());
+    Mock::VerifyAndClear(&ArduinoMock::getInstance());
+}
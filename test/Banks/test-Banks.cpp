@@ -2,6 +2,10 @@
 
 #include <Banks/Bank.hpp>
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 USING_CS_NAMESPACE;
 using AH::ErrorException;
 
@@ -73,15 +77,141 @@ TEST(Bank, onBankSettingChange) {
     TestInputBankable<10> ib1 = {bank, CHANGE_ADDRESS};
     EXPECT_CALL(ib1, onBankSettingChange());
     bank.select(6);
+    InputBankRefresher::refreshAll();
     {
         TestInputBankable<10> ib2 = {bank, CHANGE_ADDRESS};
         EXPECT_CALL(ib1, onBankSettingChange());
         EXPECT_CALL(ib2, onBankSettingChange());
         bank.select(5);
+        InputBankRefresher::refreshAll();
     }
     TestInputBankable<10> ib3 = {bank, CHANGE_ADDRESS};
     // Check that destructor correctly removed ib2 from bank
     EXPECT_CALL(ib1, onBankSettingChange());
     EXPECT_CALL(ib3, onBankSettingChange());
     bank.select(4);
-}
\ No newline at end of file
+    InputBankRefresher::refreshAll();
+}
+
+/// Counts how often it is refreshed, and remembers the bank setting of the
+/// last refresh.
+template <uint8_t N>
+class CountingInputBankable : public BankableMIDIInput<N> {
+  public:
+    CountingInputBankable(Bank<N> &bank)
+        : BankableMIDIInput<N>(bank, CHANGE_ADDRESS) {}
+
+    void onBankSettingChange() override {
+        ++refreshes;
+        refreshedSelection = this->getSelection();
+    }
+
+    unsigned refreshes = 0;
+    setting_t refreshedSelection = 0;
+};
+
+template <uint8_t N>
+std::vector<std::unique_ptr<CountingInputBankable<N>>>
+makeBankables(Bank<N> &bank, unsigned count) {
+    std::vector<std::unique_ptr<CountingInputBankable<N>>> bankables;
+    for (unsigned i = 0; i < count; ++i)
+        bankables.emplace_back(new CountingInputBankable<N>(bank));
+    return bankables;
+}
+
+template <uint8_t N>
+unsigned countRefreshes(
+    const std::vector<std::unique_ptr<CountingInputBankable<N>>> &bankables) {
+    unsigned count = 0;
+    for (auto &bankable : bankables)
+        count += bankable->refreshes;
+    return count;
+}
+
+TEST(InputBankRefresher, amortized) {
+    Bank<4> bank = {4};
+    auto bankables = makeBankables(bank, 100);
+    AH::WorkBudget budget = {16};
+
+    bank.select(1);
+    EXPECT_TRUE(bank.isRefreshPending());
+    EXPECT_EQ(countRefreshes(bankables), 0u);
+    unsigned loops = 0, maxPerLoop = 0, total = 0;
+    while (InputBankRefresher::isAnyRefreshPending()) {
+        InputBankRefresher::refreshAll(budget);
+        unsigned refreshes = countRefreshes(bankables);
+        maxPerLoop = std::max(maxPerLoop, refreshes - total);
+        total = refreshes;
+        ++loops;
+    }
+    EXPECT_EQ(loops, 7u); // ⌈100 / 16⌉
+    EXPECT_EQ(maxPerLoop, 16u);
+    EXPECT_FALSE(bank.isRefreshPending());
+    for (auto &bankable : bankables) {
+        EXPECT_EQ(bankable->refreshes, 1u);
+        EXPECT_EQ(bankable->refreshedSelection, 1);
+    }
+}
+
+TEST(InputBankRefresher, selectDuringRefresh) {
+    Bank<4> bank = {4};
+    auto bankables = makeBankables(bank, 40);
+    AH::WorkBudget budget = {16};
+
+    bank.select(1);
+    InputBankRefresher::refreshAll(budget);
+    // Start over when the setting changes before the refresh is finished
+    bank.select(2);
+    InputBankRefresher::refreshAll(budget);
+    InputBankRefresher::refreshAll(budget);
+    EXPECT_TRUE(bank.isRefreshPending());
+    InputBankRefresher::refreshAll(budget);
+    EXPECT_FALSE(bank.isRefreshPending());
+    EXPECT_EQ(countRefreshes(bankables), 16u + 40u);
+    for (auto &bankable : bankables)
+        EXPECT_EQ(bankable->refreshedSelection, 2);
+}
+
+TEST(InputBankRefresher, removeDuringRefresh) {
+    Bank<4> bank = {4};
+    auto bankables = makeBankables(bank, 8);
+    AH::WorkBudget budget = {4};
+
+    bank.select(1);
+    InputBankRefresher::refreshAll(budget);
+    // Remove the next bankable to refresh, and the one after it
+    bankables.erase(bankables.begin() + 4, bankables.begin() + 6);
+    InputBankRefresher::refreshAll(budget);
+    EXPECT_FALSE(bank.isRefreshPending());
+    for (auto &bankable : bankables)
+        EXPECT_EQ(bankable->refreshes, 1u);
+}
+
+TEST(InputBankRefresher, multipleBanks) {
+    Bank<4> bank1 = {4}, bank2 = {4};
+    auto bankables1 = makeBankables(bank1, 10);
+    auto bankables2 = makeBankables(bank2, 10);
+    AH::WorkBudget budget = {16};
+
+    bank1.select(1);
+    bank2.select(1);
+    // The budget is shared by all banks
+    InputBankRefresher::refreshAll(budget);
+    EXPECT_EQ(countRefreshes(bankables1), 10u);
+    EXPECT_EQ(countRefreshes(bankables2), 6u);
+    EXPECT_FALSE(bank1.isRefreshPending());
+    EXPECT_TRUE(bank2.isRefreshPending());
+    InputBankRefresher::refreshAll(budget);
+    EXPECT_EQ(countRefreshes(bankables2), 10u);
+    EXPECT_FALSE(InputBankRefresher::isAnyRefreshPending());
+}
+
+TEST(InputBankRefresher, destroyPendingBank) {
+    {
+        Bank<4> bank = {4};
+        CountingInputBankable<4> bankable = bank;
+        bank.select(1);
+        EXPECT_TRUE(InputBankRefresher::isAnyRefreshPending());
+    }
+    EXPECT_FALSE(InputBankRefresher::isAnyRefreshPending());
+}
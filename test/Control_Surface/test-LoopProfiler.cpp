@@ -0,0 +1,197 @@
+#include <AH/Hardware/Button.hpp>
+#include <Control_Surface/Control_Surface_Class.hpp>
+#include <MIDI_Outputs/NoteButton.hpp>
+#include <MockMIDI_Interface.hpp>
+#include <gmock-wrapper.h>
+
+#include <string>
+
+#ifdef AH_PROFILING
+
+using namespace ::testing;
+USING_CS_NAMESPACE;
+
+/// Updatable that takes a fixed time to update.
+struct SlowUpdatable : AH::Updatable<> {
+    SlowUpdatable(unsigned long &now, unsigned long cost)
+        : now(now), cost(cost) {}
+    void begin() override {}
+    void update() override { now += cost; }
+    unsigned long &now;
+    unsigned long cost;
+};
+
+/// Updatable with a button that doesn't send any MIDI messages.
+struct SilentButton : AH::Updatable<> {
+    SilentButton(pin_t pin) : button(pin) {}
+    void begin() override { button.begin(); }
+    void update() override { button.update(); }
+    AH::Button button;
+};
+
+struct StringPrint : Print {
+    using Print::write;
+    size_t write(uint8_t c) override {
+        str += char(c);
+        return 1;
+    }
+    std::string str;
+};
+
+/// Runs the main loop on a simulated clock, where only the updatables and
+/// sending MIDI messages take time.
+class LoopProfilerTest : public ::testing::Test {
+  protected:
+    /// The time it takes to send a MIDI message.
+    constexpr static unsigned long sendCost = 30;
+
+    void SetUp() override {
+        // Don't depend on settings that were changed by other tests
+        AH::Button::setDebounceTime();
+        Control_Surface.getScheduler() = {};
+        auto &mock = ArduinoMock::getInstance();
+        EXPECT_CALL(mock, micros()).WillRepeatedly(Invoke([this] {
+            return now;
+        }));
+        EXPECT_CALL(mock, millis()).WillRepeatedly(Invoke([this] {
+            return now / 1000;
+        }));
+        EXPECT_CALL(mock, pinMode(_, INPUT_PULLUP)).Times(2);
+        EXPECT_CALL(mock, digitalRead(2)).WillRepeatedly(Invoke([this] {
+            return notePressed ? LOW : HIGH;
+        }));
+        EXPECT_CALL(mock, digitalRead(3)).WillRepeatedly(Invoke([this] {
+            return silentPressed ? LOW : HIGH;
+        }));
+        EXPECT_CALL(midi, read())
+            .WillRepeatedly(Return(MIDIReadEvent::NO_MESSAGE));
+        EXPECT_CALL(midi, sendImpl(_, 0x3C, 0x7F, 0x0))
+            .WillRepeatedly(InvokeWithoutArgs([this] { now += sendCost; }));
+        Control_Surface.connectDefaultMIDI_Interface();
+        button.begin();
+        silent.begin();
+        Control_Surface.getProfiler().start();
+    }
+
+    void TearDown() override {
+        Control_Surface.getProfiler().stop();
+        Control_Surface.disconnectMIDI_Interfaces();
+        Mock::VerifyAndClear(&ArduinoMock::getInstance());
+    }
+
+    void loop(unsigned count) {
+        while (count-- > 0) {
+            Control_Surface.loop();
+            now += 10;
+        }
+    }
+
+    unsigned long now = 1000000;
+    bool notePressed = false;
+    bool silentPressed = false;
+    MockMIDI_Interface midi;
+    NoteButton button = {2, {0x3C, CHANNEL_1}};
+    SlowUpdatable slow1 = {now, 100};
+    SilentButton silent = 3;
+    SlowUpdatable slow2 = {now, 250};
+};
+
+constexpr unsigned long LoopProfilerTest::sendCost;
+
+TEST_F(LoopProfilerTest, stages) {
+    loop(100);
+    notePressed = true;
+    loop(100);
+    notePressed = false;
+    loop(100);
+
+    const LoopProfiler &profiler = Control_Surface.getProfiler();
+    EXPECT_EQ(profiler.getLoopStats().getCount(), 300ul);
+    EXPECT_EQ(profiler.getLoopStats().getMin(), 350ul);
+    EXPECT_EQ(profiler.getLoopStats().getMax(), 350ul + sendCost);
+
+    auto &updatables = profiler.getStageStats(LoopStage::Updatables);
+    EXPECT_EQ(updatables.getCount(), 300ul);
+    EXPECT_EQ(updatables.getMin(), 350ul);
+    EXPECT_EQ(updatables.getMax(), 350ul + sendCost);
+    EXPECT_EQ(updatables.getMean(), (298 * 350ul + 2 * 380ul) / 300);
+    EXPECT_EQ(updatables.getBin(AH::TimingStats::getBinIndex(350)), 300);
+
+    for (LoopStage stage : {LoopStage::BufferedInputs, LoopStage::MIDIInput,
+                            LoopStage::Displays, LoopStage::MIDIFlush}) {
+        EXPECT_EQ(profiler.getStageStats(stage).getCount(), 300ul);
+        EXPECT_EQ(profiler.getStageStats(stage).getMax(), 0ul);
+    }
+
+    auto button = profiler.getUpdatableStats(this->button);
+    ASSERT_NE(button, nullptr);
+    EXPECT_EQ(button->getCount(), 300ul);
+    EXPECT_EQ(button->getMin(), 0ul);
+    EXPECT_EQ(button->getMax(), sendCost);
+    auto slow2 = profiler.getUpdatableStats(this->slow2);
+    ASSERT_NE(slow2, nullptr);
+    EXPECT_EQ(slow2->getMin(), 250ul);
+    EXPECT_EQ(slow2->getMax(), 250ul);
+
+    // Press and release
+    EXPECT_EQ(profiler.getLatencyStats().getCount(), 2ul);
+    EXPECT_EQ(profiler.getLatencyStats().getMin(), sendCost);
+    EXPECT_EQ(profiler.getLatencyStats().getMax(), sendCost);
+}
+
+/// Button edges that don't cause any MIDI output are not matched with the
+/// output caused by a later button edge.
+TEST_F(LoopProfilerTest, unmatchedInputs) {
+    loop(100);
+    silentPressed = true;
+    loop(100);
+    notePressed = true;
+    loop(100);
+
+    const LoopProfiler &profiler = Control_Surface.getProfiler();
+    EXPECT_EQ(profiler.getLatencyStats().getCount(), 1ul);
+    EXPECT_EQ(profiler.getLatencyStats().getMax(), sendCost);
+}
+
+TEST_F(LoopProfilerTest, restart) {
+    notePressed = true;
+    loop(10);
+    LoopProfiler &profiler = Control_Surface.getProfiler();
+    profiler.start();
+    loop(5);
+    EXPECT_EQ(profiler.getLoopStats().getCount(), 5ul);
+    EXPECT_EQ(profiler.getLatencyStats().getCount(), 0ul);
+    EXPECT_EQ(profiler.getUpdatableStats(slow1)->getCount(), 5ul);
+    profiler.stop();
+    loop(5);
+    EXPECT_EQ(profiler.getLoopStats().getCount(), 5ul);
+}
+
+TEST_F(LoopProfilerTest, print) {
+    loop(10);
+    notePressed = true;
+    loop(1);
+    StringPrint s;
+    s << Control_Surface.getProfiler();
+    EXPECT_EQ(s.str, "Loop: n=11 min=350 mean=352 max=380 us | "
+                     "256..511:11\r\n"
+                     "BufferedInputs: n=11 min=0 mean=0 max=0 us | 0:11\r\n"
+                     "Updatables: n=11 min=350 mean=352 max=380 us | "
+                     "256..511:11\r\n"
+                     "Potentiometers: n=11 min=0 mean=0 max=0 us | 0:11\r\n"
+                     "MIDIInput: n=11 min=0 mean=0 max=0 us | 0:11\r\n"
+                     "InputElements: n=11 min=0 mean=0 max=0 us | 0:11\r\n"
+                     "BufferedOutputs: n=11 min=0 mean=0 max=0 us | 0:11\r\n"
+                     "MIDIFlush: n=11 min=0 mean=0 max=0 us | 0:11\r\n"
+                     "Displays: n=11 min=0 mean=0 max=0 us | 0:11\r\n"
+                     "  Updatable 0: n=11 min=0 mean=2 max=30 us | "
+                     "0:10 16..31:1\r\n"
+                     "  Updatable 1: n=11 min=100 mean=100 max=100 us | "
+                     "64..127:11\r\n"
+                     "  Updatable 2: n=11 min=0 mean=0 max=0 us | 0:11\r\n"
+                     "  Updatable 3: n=11 min=250 mean=250 max=250 us | "
+                     "128..255:11\r\n"
+                     "Latency: n=1 min=30 mean=30 max=30 us | 16..31:1\r\n");
+}
+
+#endif // AH_PROFILING
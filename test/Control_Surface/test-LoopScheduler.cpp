@@ -0,0 +1,310 @@
+#include <Banks/Bank.hpp>
+#include <Control_Surface/Control_Surface_Class.hpp>
+#include <Display/DisplayElement.hpp>
+#include <MIDI_Outputs/NoteButton.hpp>
+#include <MockMIDI_Interface.hpp>
+#include <gmock-wrapper.h>
+
+#include <algorithm>
+#include <climits>
+#include <memory>
+#include <vector>
+
+using namespace ::testing;
+USING_CS_NAMESPACE;
+
+TEST(LoopScheduler, defaultOrder) {
+    LoopScheduler scheduler;
+    std::vector<LoopStage> order(scheduler.begin(), scheduler.end());
+    std::vector<LoopStage> expected = {
+        LoopStage::BufferedInputs, LoopStage::Updatables,
+        LoopStage::Potentiometers, LoopStage::MIDIInput,
+        LoopStage::InputElements,  LoopStage::BufferedOutputs,
+        LoopStage::MIDIFlush,      LoopStage::Displays,
+    };
+    EXPECT_EQ(order, expected);
+}
+
+TEST(LoopScheduler, priorities) {
+    LoopScheduler scheduler;
+    scheduler.setPriority(LoopStage::MIDIFlush, 0);
+    scheduler.setPriority(LoopStage::MIDIInput, 0);
+    scheduler.setPriority(LoopStage::BufferedInputs, 255);
+    std::vector<LoopStage> order(scheduler.begin(), scheduler.end());
+    // Ties are resolved by the default order
+    std::vector<LoopStage> expected = {
+        LoopStage::MIDIInput,       LoopStage::MIDIFlush,
+        LoopStage::Updatables,      LoopStage::Potentiometers,
+        LoopStage::InputElements,   LoopStage::BufferedOutputs,
+        LoopStage::Displays,        LoopStage::BufferedInputs,
+    };
+    EXPECT_EQ(order, expected);
+}
+
+// -------------------------------------------------------------------------- //
+
+/// Display that takes a long time to write a frame to.
+struct SlowDisplay : DisplayInterface {
+    SlowDisplay(unsigned long &now) : now(now) {}
+
+    void clear() override {}
+    void display() override {
+        EXPECT_EQ(drawsSinceFrame, numElements) << "Incomplete frame";
+        drawsSinceFrame = 0;
+        now += 4000;
+        ++frames;
+    }
+    void drawPixel(int16_t, int16_t, uint16_t) override {}
+    void setTextColor(uint16_t) override {}
+    void setTextSize(uint8_t) override {}
+    void setCursor(int16_t, int16_t) override {}
+    size_t write(uint8_t) override { return 1; }
+    void drawLine(int16_t, int16_t, int16_t, int16_t, uint16_t) override {}
+    void drawFastVLine(int16_t, int16_t, int16_t, uint16_t) override {}
+    void drawFastHLine(int16_t, int16_t, int16_t, uint16_t) override {}
+    void drawXBitmap(int16_t, int16_t, const uint8_t[], int16_t, int16_t,
+                     uint16_t) override {}
+
+    unsigned long &now;
+    unsigned numElements = 0;
+    unsigned drawsSinceFrame = 0;
+    unsigned frames = 0;
+};
+
+/// Display element that takes a long time to draw, and that is always dirty.
+struct SlowDisplayElement : DisplayElement {
+    SlowDisplayElement(SlowDisplay &slow) : DisplayElement(slow), slow(slow) {
+        ++slow.numElements;
+    }
+    void draw() override {
+        slow.now += 500;
+        ++slow.drawsSinceFrame;
+    }
+    SlowDisplay &slow;
+};
+
+std::vector<std::unique_ptr<SlowDisplayElement>>
+makeElements(SlowDisplay &display, unsigned count) {
+    std::vector<std::unique_ptr<SlowDisplayElement>> elements;
+    for (unsigned i = 0; i < count; ++i)
+        elements.emplace_back(new SlowDisplayElement(display));
+    return elements;
+}
+
+/// Bankable input element that takes a long time to refresh after a bank
+/// change, e.g. because it updates many LEDs.
+struct SlowBankable : BankableMIDIInput<4> {
+    /// The time it takes to refresh the element.
+    constexpr static unsigned long refreshCost = 100;
+
+    SlowBankable(Bank<4> &bank, unsigned long &now, unsigned &refreshes)
+        : BankableMIDIInput<4>(bank, CHANGE_ADDRESS), now(now),
+          refreshes(refreshes) {}
+    void onBankSettingChange() override {
+        now += refreshCost;
+        ++refreshes;
+    }
+    unsigned long &now;
+    unsigned &refreshes;
+};
+
+constexpr unsigned long SlowBankable::refreshCost;
+
+std::vector<std::unique_ptr<SlowBankable>>
+makeBankables(Bank<4> &bank, unsigned count, unsigned long &now,
+              unsigned &refreshes) {
+    std::vector<std::unique_ptr<SlowBankable>> bankables;
+    for (unsigned i = 0; i < count; ++i)
+        bankables.emplace_back(new SlowBankable(bank, now, refreshes));
+    return bankables;
+}
+
+/// Runs the main loop on a simulated clock: the time only advances when MIDI
+/// messages are handled, when the display is updated, and by a small fixed
+/// amount per loop.
+class LoopSchedulerLatency : public ::testing::Test {
+  protected:
+    /// The time it takes to handle one incoming MIDI message.
+    constexpr static unsigned long messageCost = 50;
+    /// The time all other stages of the loop take.
+    constexpr static unsigned long loopOverhead = 10;
+
+    void SetUp() override {
+        auto &mock = ArduinoMock::getInstance();
+        EXPECT_CALL(mock, micros()).WillRepeatedly(Invoke([this] {
+            return now;
+        }));
+        EXPECT_CALL(mock, millis()).WillRepeatedly(Invoke([this] {
+            return now / 1000;
+        }));
+        EXPECT_CALL(mock, pinMode(2, INPUT_PULLUP));
+        EXPECT_CALL(mock, digitalRead(2)).WillRepeatedly(Invoke([this] {
+            return now >= pressTime && now < releaseTime ? LOW : HIGH;
+        }));
+        EXPECT_CALL(midi, read()).WillRepeatedly(Invoke([this] {
+            if (floodRemaining == 0)
+                return MIDIReadEvent::NO_MESSAGE;
+            --floodRemaining;
+            now += messageCost;
+            return MIDIReadEvent::CHANNEL_MESSAGE;
+        }));
+        EXPECT_CALL(midi, sendImpl(0x90, 0x3C, 0x7F, 0x0))
+            .WillRepeatedly(InvokeWithoutArgs([this] { noteOnTime = now; }));
+        EXPECT_CALL(midi, sendImpl(0x80, 0x3C, 0x7F, 0x0))
+            .WillRepeatedly(InvokeWithoutArgs([this] { noteOffTime = now; }));
+        Control_Surface.connectDefaultMIDI_Interface();
+        button.begin();
+    }
+
+    void TearDown() override {
+        // Finish the interrupted frame, and restore the default schedule
+        Control_Surface.updateDisplays();
+        LoopScheduler &scheduler = Control_Surface.getScheduler();
+        scheduler.getMIDIInputBudget() = {MIDI_INPUT_MAX_MESSAGES_PER_LOOP,
+                                          MIDI_INPUT_MAX_MICROS_PER_LOOP};
+        scheduler.getDisplayBudget() = {DISPLAY_MAX_ITEMS_PER_LOOP,
+                                        DISPLAY_MAX_MICROS_PER_LOOP};
+        scheduler.getBankRefreshBudget() = {BANK_REFRESH_MAX_ITEMS_PER_LOOP,
+                                            BANK_REFRESH_MAX_MICROS_PER_LOOP};
+        Control_Surface.disconnectMIDI_Interfaces();
+        Mock::VerifyAndClear(&ArduinoMock::getInstance());
+    }
+
+    /// Run the main loop until the given time stamp is set.
+    void loopUntil(const unsigned long &event) {
+        unsigned long start = now;
+        while (event == 0 && now - start < 10000000) {
+            Control_Surface.loop();
+            now += loopOverhead;
+        }
+        ASSERT_NE(event, 0) << "Timeout";
+    }
+
+    /// Press the button after the given delay, run the main loop until the
+    /// Note On message was sent, and return the latency. Then release the
+    /// button, and wait for the debounce time to expire.
+    unsigned long pressAndRelease(unsigned long delay) {
+        noteOnTime = noteOffTime = 0;
+        pressTime = now + delay;
+        releaseTime = ULONG_MAX;
+        loopUntil(noteOnTime);
+        unsigned long latency = noteOnTime - pressTime;
+        releaseTime = now;
+        loopUntil(noteOffTime);
+        unsigned long released = now;
+        while (now - released <= 2000 * AH::BUTTON_DEBOUNCE_TIME) {
+            Control_Surface.loop();
+            now += loopOverhead;
+        }
+        return latency;
+    }
+
+    /// The worst-case latency of many button presses at different times.
+    unsigned long worstCaseLatency() {
+        unsigned long worst = 0;
+        for (unsigned long delay = 1000; delay < 20000; delay += 997)
+            worst = std::max(worst, pressAndRelease(delay));
+        return worst;
+    }
+
+    unsigned long now = 1000000;
+    unsigned long pressTime = ULONG_MAX;
+    unsigned long releaseTime = ULONG_MAX;
+    unsigned long noteOnTime = 0;
+    unsigned long noteOffTime = 0;
+    unsigned long floodRemaining = 0;
+    MockMIDI_Interface midi;
+    NoteButton button = {2, {0x3C, CHANNEL_1}};
+};
+
+TEST_F(LoopSchedulerLatency, unlimitedMIDIInputStarvesButtons) {
+    Control_Surface.getScheduler().getMIDIInputBudget() = {};
+    constexpr unsigned long floodLength = 2000;
+    floodRemaining = floodLength;
+    unsigned long latency = pressAndRelease(1000);
+    EXPECT_GE(latency, floodLength * messageCost - 1000);
+}
+
+TEST_F(LoopSchedulerLatency, midiFlood) {
+    Control_Surface.getScheduler().getMIDIInputBudget() = {0, 1000};
+    floodRemaining = ULONG_MAX;
+    // The button press is detected in the loop after the one in which it
+    // happened. The remainder of that loop is at most one MIDI input stage.
+    EXPECT_LE(worstCaseLatency(), 1000 + messageCost + 2 * loopOverhead);
+}
+
+TEST_F(LoopSchedulerLatency, midiFloodMessageLimit) {
+    Control_Surface.getScheduler().getMIDIInputBudget() = {8, 0};
+    floodRemaining = ULONG_MAX;
+    EXPECT_LE(worstCaseLatency(), 8 * messageCost + 2 * loopOverhead);
+}
+
+TEST_F(LoopSchedulerLatency, slowDisplayUnlimited) {
+    SlowDisplay display{now};
+    auto elements = makeElements(display, 20);
+    Control_Surface.getScheduler().getDisplayBudget() = {};
+    // One full frame: 20 elements of 500 µs and 4000 µs to write the frame
+    EXPECT_GE(worstCaseLatency(), 14000 - 997);
+}
+
+TEST_F(LoopSchedulerLatency, slowDisplayInterrupted) {
+    SlowDisplay display{now};
+    auto elements = makeElements(display, 20);
+    Control_Surface.getScheduler().getDisplayBudget() = {0, 2000};
+    // Drawing is interrupted between elements, but writing a frame to the
+    // display (4000 µs) can't be interrupted.
+    EXPECT_LE(worstCaseLatency(), 2000 + 4000 + 2 * loopOverhead);
+    // All frames are complete (checked by the display), and there are still
+    // frames being drawn
+    EXPECT_GT(display.frames, 50u);
+}
+
+TEST_F(LoopSchedulerLatency, midiFloodAndSlowDisplay) {
+    SlowDisplay display{now};
+    auto elements = makeElements(display, 20);
+    floodRemaining = ULONG_MAX;
+    // Default budgets
+    EXPECT_LE(worstCaseLatency(), MIDI_INPUT_MAX_MICROS_PER_LOOP + messageCost +
+                                      DISPLAY_MAX_MICROS_PER_LOOP + 4000 +
+                                      2 * loopOverhead);
+    EXPECT_GT(display.frames, 10u);
+}
+
+TEST_F(LoopSchedulerLatency, bankChangeUnlimited) {
+    Bank<4> bank;
+    unsigned refreshes = 0;
+    auto bankables = makeBankables(bank, 200, now, refreshes);
+    Control_Surface.getScheduler().getBankRefreshBudget() = {};
+    bank.select(1);
+    // All elements are refreshed in a single loop
+    EXPECT_GE(pressAndRelease(100), 200 * SlowBankable::refreshCost - 100);
+    EXPECT_EQ(refreshes, 200u);
+}
+
+TEST_F(LoopSchedulerLatency, bankChangeAmortized) {
+    Bank<4> bank;
+    unsigned refreshes = 0;
+    auto bankables = makeBankables(bank, 200, now, refreshes);
+
+    // Default budget
+    bank.select(1);
+    unsigned loops = 0, maxPerLoop = 0;
+    while (InputBankRefresher::isAnyRefreshPending()) {
+        unsigned before = refreshes;
+        Control_Surface.loop();
+        now += loopOverhead;
+        maxPerLoop = std::max(maxPerLoop, refreshes - before);
+        ++loops;
+    }
+    EXPECT_EQ(refreshes, 200u);
+    EXPECT_EQ(maxPerLoop, BANK_REFRESH_MAX_ITEMS_PER_LOOP);
+    EXPECT_EQ(loops, (200 + BANK_REFRESH_MAX_ITEMS_PER_LOOP - 1) /
+                         BANK_REFRESH_MAX_ITEMS_PER_LOOP);
+
+    // The button press is detected in the loop after the one in which it
+    // happened. The remainder of that loop is at most one refresh stage.
+    bank.select(2);
+    EXPECT_LE(pressAndRelease(100),
+              BANK_REFRESH_MAX_ITEMS_PER_LOOP * SlowBankable::refreshCost +
+                  2 * loopOverhead);
+}
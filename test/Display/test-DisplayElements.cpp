@@ -0,0 +1,282 @@
+#include <MockPagedDisplay.hpp>
+#include <gtest-wrapper.h>
+
+#include <Control_Surface/Control_Surface_Class.hpp>
+#include <Display/MCU/VUDisplay.hpp>
+#include <Display/NoteBitmapDisplay.hpp>
+
+#include <memory>
+
+USING_CS_NAMESPACE;
+using ::testing::Mock;
+using ::testing::Return;
+
+/// Element that fills its bounds when it's on.
+struct MockElement : DisplayElement {
+    MockElement(DisplayInterface &display, PixelRegion bounds)
+        : DisplayElement(display), bounds(bounds) {}
+
+    void draw() override {
+        ++draws;
+        drawnState = state;
+        if (state)
+            display.fillRect(bounds.x, bounds.y, bounds.w, bounds.h, 1);
+    }
+    bool getDirty() override { return state != drawnState; }
+    PixelRegion getBounds() const override { return bounds; }
+
+    PixelRegion bounds;
+    bool state = true;
+    bool drawnState = false;
+    unsigned draws = 0;
+};
+
+/// Element that doesn't implement getDirty and getBounds.
+struct LegacyElement : DisplayElement {
+    LegacyElement(DisplayInterface &display) : DisplayElement(display) {}
+    void draw() override { ++draws; }
+    unsigned draws = 0;
+};
+
+TEST(DisplayElements, skipUnchangedElements) {
+    MockPagedDisplay display;
+    MockElement a = {display, {0, 0, 16, 8}};   // page 0
+    MockElement b = {display, {64, 20, 16, 16}}; // pages 2-4
+
+    Control_Surface.updateDisplays();
+    EXPECT_EQ(a.draws, 1);
+    EXPECT_EQ(b.draws, 1);
+    EXPECT_EQ(display.clears, 0);
+    // Clear and draw both elements
+    EXPECT_EQ(display.pixelWrites, 2 * (16 * 8) + 2 * (16 * 16));
+    EXPECT_EQ(display.bytesTransferred, 5 * 128); // pages 0-4
+    EXPECT_TRUE(display.getPixel(0, 0));
+    EXPECT_TRUE(display.getPixel(79, 35));
+
+    // Nothing changed
+    display.resetCounters();
+    Control_Surface.updateDisplays();
+    EXPECT_EQ(a.draws, 1);
+    EXPECT_EQ(b.draws, 1);
+    EXPECT_EQ(display.pixelWrites, 0);
+    EXPECT_EQ(display.transfers, 0);
+
+    // Only b changed
+    display.resetCounters();
+    b.state = false;
+    Control_Surface.updateDisplays();
+    EXPECT_EQ(a.draws, 1);
+    EXPECT_EQ(b.draws, 2);
+    EXPECT_EQ(display.pixelWrites, 16 * 16); // clear the region of b
+    EXPECT_EQ(display.bytesTransferred, 3 * 128); // pages 2-4
+    EXPECT_TRUE(display.getPixel(0, 0));
+    EXPECT_FALSE(display.getPixel(79, 35));
+}
+
+TEST(DisplayElements, redrawOverlappingElements) {
+    MockPagedDisplay display;
+    MockElement a = {display, {0, 0, 16, 16}};
+    MockElement b = {display, {8, 8, 16, 16}};
+    MockElement c = {display, {64, 48, 8, 8}};
+    Control_Surface.updateDisplays();
+
+    // Clearing a also clears part of b, so b has to be redrawn as well
+    display.resetCounters();
+    a.state = false;
+    Control_Surface.updateDisplays();
+    EXPECT_EQ(a.draws, 2);
+    EXPECT_EQ(b.draws, 2);
+    EXPECT_EQ(c.draws, 1);
+    EXPECT_EQ(display.bytesTransferred, 2 * 128); // pages 0-1
+    EXPECT_FALSE(display.getPixel(0, 0));
+    EXPECT_TRUE(display.getPixel(8, 8));
+    EXPECT_TRUE(display.getPixel(64, 48));
+}
+
+/// Element that becomes dirty right after its flag was first checked, like
+/// an element whose state depends on millis().
+struct FlakyElement : MockElement {
+    using MockElement::MockElement;
+    bool getDirty() override { return ++dirtyChecks > 1; }
+    unsigned dirtyChecks = 0;
+};
+
+/// An element must never be cleared without being redrawn in the same frame.
+TEST(DisplayElements, dirtyFlagCheckedOncePerFrame) {
+    MockPagedDisplay display;
+    MockElement a = {display, {0, 0, 16, 8}};
+    FlakyElement b = {display, {64, 48, 8, 8}};
+    b.draw();
+
+    Control_Surface.updateDisplays();
+    EXPECT_EQ(b.dirtyChecks, 1);
+    EXPECT_EQ(b.draws, 1);
+    EXPECT_TRUE(display.getPixel(0, 0));
+    EXPECT_TRUE(display.getPixel(64, 48));
+}
+
+TEST(DisplayElements, legacyElementRedrawsEverything) {
+    MockPagedDisplay display;
+    MockElement a = {display, {0, 0, 16, 8}};
+    LegacyElement b = {display};
+
+    for (unsigned i = 1; i <= 3; ++i) {
+        display.resetCounters();
+        Control_Surface.updateDisplays();
+        EXPECT_EQ(display.clears, 1);
+        EXPECT_EQ(display.bytesTransferred, 8 * 128);
+        EXPECT_EQ(a.draws, i);
+        EXPECT_EQ(b.draws, i);
+    }
+}
+
+TEST(DisplayElements, multipleDisplays) {
+    MockPagedDisplay display1, display2;
+    MockElement a = {display1, {0, 0, 8, 8}};
+    MockElement b = {display2, {0, 56, 8, 8}};
+    Control_Surface.updateDisplays();
+
+    display1.resetCounters();
+    display2.resetCounters();
+    b.state = false;
+    Control_Surface.updateDisplays();
+    EXPECT_EQ(display1.transfers, 0);
+    EXPECT_EQ(display2.transfers, 1);
+    EXPECT_EQ(display2.bytesTransferred, 128);
+}
+
+/// When elements are added while the drawing of a display is interrupted,
+/// that display is redrawn entirely.
+TEST(DisplayElements, elementAddedWhileInterrupted) {
+    MockPagedDisplay display;
+    MockElement a = {display, {0, 0, 16, 8}};
+    MockElement b = {display, {64, 20, 16, 16}};
+
+    AH::WorkBudget budget = 1;
+    EXPECT_FALSE(Control_Surface.updateDisplays(budget));
+    EXPECT_EQ(a.draws + b.draws, 1);
+    EXPECT_EQ(display.transfers, 0);
+
+    MockElement c = {display, {32, 40, 16, 8}};
+    AH::WorkBudget unlimited;
+    EXPECT_TRUE(Control_Surface.updateDisplays(unlimited));
+    EXPECT_EQ(display.clears, 1);
+    EXPECT_EQ(a.draws + b.draws, 3);
+    EXPECT_EQ(c.draws, 1);
+    EXPECT_EQ(display.bytesTransferred, 8 * 128);
+    EXPECT_TRUE(display.getPixel(0, 0));
+    EXPECT_TRUE(display.getPixel(79, 35));
+    EXPECT_TRUE(display.getPixel(32, 40));
+}
+
+/// When an element is removed while the drawing of a display is interrupted,
+/// its pixels are cleared and the remaining elements are still drawn.
+TEST(DisplayElements, elementRemovedWhileInterrupted) {
+    MockPagedDisplay display;
+    MockElement a = {display, {0, 0, 16, 8}};
+    MockElement b = {display, {64, 20, 16, 16}};
+    auto c =
+        std::make_unique<MockElement>(display, PixelRegion{32, 40, 16, 8});
+
+    AH::WorkBudget budget = 2;
+    EXPECT_FALSE(Control_Surface.updateDisplays(budget));
+    EXPECT_EQ(a.draws + b.draws + c->draws, 2);
+
+    c.reset();
+    AH::WorkBudget unlimited;
+    EXPECT_TRUE(Control_Surface.updateDisplays(unlimited));
+    EXPECT_EQ(display.bytesTransferred, 8 * 128);
+    EXPECT_TRUE(display.getPixel(0, 0));
+    EXPECT_TRUE(display.getPixel(79, 35));
+    EXPECT_FALSE(display.getPixel(32, 40));
+    EXPECT_FALSE(a.getDirty());
+    EXPECT_FALSE(b.getDirty());
+}
+
+TEST(DisplayElements, noteBitmapDisplay) {
+    MockPagedDisplay display;
+    NoteValue note = {{0x3C, CHANNEL_1}};
+    NoteBitmapDisplay bitmap = {display, note, XBM::mute_7, {16, 16}, 1};
+
+    Control_Surface.updateDisplays();
+    EXPECT_EQ(display.transfers, 1);
+    EXPECT_EQ(display.bytesTransferred, 128); // rows 16-22 = page 2
+    EXPECT_FALSE(bitmap.getDirty());
+
+    display.resetCounters();
+    MIDIInputElementNote::updateAllWith(
+        {MIDIMessageType::NOTE_ON, CHANNEL_1, 0x3C, 0x7F});
+    EXPECT_TRUE(bitmap.getDirty());
+    Control_Surface.updateDisplays();
+    EXPECT_EQ(display.transfers, 1);
+    EXPECT_GT(display.pixelWrites, 0);
+    EXPECT_FALSE(bitmap.getDirty());
+
+    // Different velocity, same bitmap
+    display.resetCounters();
+    MIDIInputElementNote::updateAllWith(
+        {MIDIMessageType::NOTE_ON, CHANNEL_1, 0x3C, 0x10});
+    Control_Surface.updateDisplays();
+    EXPECT_EQ(display.transfers, 0);
+}
+
+struct FixedVU : IVU {
+    FixedVU() : IVU(12) {}
+    uint8_t getValue() override { return value; }
+    bool getOverload() override { return false; }
+    uint8_t value = 0;
+};
+
+static void setMillis(unsigned long time) {
+    EXPECT_CALL(ArduinoMock::getInstance(), millis())
+        .WillRepeatedly(Return(time));
+}
+
+TEST(DisplayElements, vuDisplayPeakDecaysOncePerFrame) {
+    MockPagedDisplay display;
+    FixedVU vu;
+    // Blocks of 3 px with 1 px spacing, the peak bar of value v is drawn at
+    // y = 63 - 4 v, decaying 1 px per VU_PEAK_DECAY_TIME / 4 ms
+    MCU::VUDisplay vuDisplay = {display, vu, {0, 63}, 8, 3, 1, 1};
+    constexpr unsigned long step = VU_PEAK_DECAY_TIME / 4;
+
+    setMillis(0);
+    vu.value = 4;
+    EXPECT_TRUE(vuDisplay.getDirty());
+    vuDisplay.draw();
+    EXPECT_TRUE(display.getPixel(0, 63 - 16));
+    EXPECT_FALSE(vuDisplay.getDirty());
+
+    // The peak is held while the value drops
+    vu.value = 0;
+    setMillis(VU_PEAK_HOLD_TIME);
+    EXPECT_TRUE(vuDisplay.getDirty());
+    vuDisplay.draw();
+    EXPECT_FALSE(vuDisplay.getDirty());
+
+    // Asking whether the element is dirty doesn't advance the decay
+    setMillis(2 * VU_PEAK_HOLD_TIME + step);
+    for (int i = 0; i < 10; ++i)
+        EXPECT_TRUE(vuDisplay.getDirty());
+    display.clear();
+    vuDisplay.draw();
+    EXPECT_TRUE(display.getPixel(0, 63 - 15));
+    EXPECT_FALSE(display.getPixel(0, 63 - 14));
+    EXPECT_FALSE(vuDisplay.getDirty());
+
+    setMillis(2 * VU_PEAK_HOLD_TIME + 2 * step);
+    EXPECT_TRUE(vuDisplay.getDirty());
+    display.clear();
+    vuDisplay.draw();
+    EXPECT_TRUE(display.getPixel(0, 63 - 14));
+    EXPECT_FALSE(display.getPixel(0, 63 - 13));
+
+    // The peak bar is gone after decaying all the way
+    setMillis(2 * VU_PEAK_HOLD_TIME + 16 * step);
+    EXPECT_TRUE(vuDisplay.getDirty());
+    vuDisplay.draw();
+    setMillis(2 * VU_PEAK_HOLD_TIME + 100 * step);
+    EXPECT_FALSE(vuDisplay.getDirty());
+
+    Mock::VerifyAndClear(&ArduinoMock::getInstance());
+}
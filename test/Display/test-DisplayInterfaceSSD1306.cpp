@@ -0,0 +1,140 @@
+#include <gmock-wrapper.h>
+#include <gtest-wrapper.h>
+
+#include <Display/DisplayInterfaces/DisplayInterfaceSSD1306.hpp>
+
+#include <vector>
+
+USING_CS_NAMESPACE;
+using namespace ::testing;
+
+/// I²C interface that records all transmissions.
+struct FakeWire {
+    void beginTransmission(uint8_t address) {
+        transmissions.push_back({address, {}});
+    }
+    size_t write(uint8_t data) { return write(&data, 1); }
+    size_t write(const uint8_t *data, size_t length) {
+        auto &bytes = transmissions.back().bytes;
+        bytes.insert(bytes.end(), data, data + length);
+        return length;
+    }
+    uint8_t endTransmission() { return 0; }
+
+    struct Transmission {
+        uint8_t address;
+        std::vector<uint8_t> bytes;
+    };
+    std::vector<Transmission> transmissions;
+};
+
+struct TestI2CDisplay : SSD1306_I2C_DisplayInterface<FakeWire> {
+    TestI2CDisplay(Adafruit_SSD1306 &display, FakeWire &wire)
+        : SSD1306_I2C_DisplayInterface(display, wire, 0x3D) {}
+    void drawBackground() override {}
+};
+
+struct TestSPIDisplay : SSD1306_SPI_DisplayInterface {
+    TestSPIDisplay(Adafruit_SSD1306 &display)
+        : SSD1306_SPI_DisplayInterface(display, SPI, 9, 10) {}
+    void drawBackground() override {}
+};
+
+const std::vector<uint8_t> pageAddresses(uint8_t first, uint8_t last) {
+    return {SSD1306_PAGEADDR, first, last, SSD1306_COLUMNADDR, 0, 127};
+}
+
+TEST(SSD1306_DisplayInterface, i2cWritesOnlyDirtyPages) {
+    Adafruit_SSD1306 oled;
+    FakeWire wire;
+    TestI2CDisplay display = {oled, wire};
+    display.drawPixel(0, 9, WHITE);   // page 1
+    display.drawPixel(127, 23, WHITE); // page 2
+
+    display.displayRegion({0, 8, 16, 16}); // pages 1-2
+    EXPECT_EQ(oled.displays, 0);
+    EXPECT_EQ(oled.commands, pageAddresses(1, 2));
+
+    // 256 bytes of data, in transmissions of at most 1 + 31 bytes
+    std::vector<uint8_t> data;
+    for (auto &transmission : wire.transmissions) {
+        EXPECT_EQ(transmission.address, 0x3D);
+        ASSERT_GE(transmission.bytes.size(), 2u);
+        EXPECT_LE(transmission.bytes.size(), 32u);
+        EXPECT_EQ(transmission.bytes[0], 0x40);
+        data.insert(data.end(), transmission.bytes.begin() + 1,
+                    transmission.bytes.end());
+    }
+    EXPECT_EQ(wire.transmissions.size(), 9u);
+    ASSERT_EQ(data.size(), 2u * 128);
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), oled.getBuffer() + 128));
+    EXPECT_EQ(data[0], 0x02);
+    EXPECT_EQ(data[255], 0x80);
+}
+
+TEST(SSD1306_DisplayInterface, i2cClampsRegionToDisplay) {
+    Adafruit_SSD1306 oled;
+    FakeWire wire;
+    TestI2CDisplay display = {oled, wire};
+
+    display.displayRegion({0, 60, 8, 16}); // page 7 and beyond
+    EXPECT_EQ(oled.commands, pageAddresses(7, 7));
+
+    oled.commands.clear();
+    wire.transmissions.clear();
+    display.displayRegion({0, 64, 8, 8}); // below the display
+    EXPECT_TRUE(oled.commands.empty());
+    EXPECT_TRUE(wire.transmissions.empty());
+}
+
+TEST(SSD1306_DisplayInterface, spiWritesOnlyDirtyPages) {
+    Adafruit_SSD1306 oled;
+    TestSPIDisplay display = oled;
+    display.drawPixel(5, 63, WHITE); // page 7
+    std::vector<uint8_t> data;
+
+    InSequence seq;
+    EXPECT_CALL(ArduinoMock::getSPI(),
+                beginTransaction(SPISettings{8000000, MSBFIRST, SPI_MODE0}));
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(9, HIGH));
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(10, LOW));
+    EXPECT_CALL(ArduinoMock::getSPI(), transfer(An<uint8_t>()))
+        .Times(128)
+        .WillRepeatedly(Invoke([&](uint8_t byte) {
+            data.push_back(byte);
+            return 0xFF;
+        }));
+    EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(10, HIGH));
+    EXPECT_CALL(ArduinoMock::getSPI(), endTransaction());
+
+    display.displayRegion({0, 56, 128, 8});
+    EXPECT_EQ(oled.commands, pageAddresses(7, 7));
+    ASSERT_EQ(data.size(), 128u);
+    EXPECT_EQ(data[5], 0x80);
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), oled.getBuffer() + 896));
+
+    Mock::VerifyAndClear(&ArduinoMock::getInstance());
+    Mock::VerifyAndClear(&ArduinoMock::getSPI());
+}
+
+/// The region is given in rotated coordinates, the pages are in the
+/// coordinates of the frame buffer.
+TEST(SSD1306_DisplayInterface, rotatedRegionToPages) {
+    Adafruit_SSD1306 oled;
+    FakeWire wire;
+    TestI2CDisplay display = {oled, wire};
+
+    oled.setRotation(2); // upside down
+    display.displayRegion({0, 0, 8, 8});
+    EXPECT_EQ(oled.commands, pageAddresses(7, 7));
+
+    oled.commands.clear();
+    oled.setRotation(1); // rows of the frame buffer are columns on screen
+    display.displayRegion({10, 0, 20, 64});
+    EXPECT_EQ(oled.commands, pageAddresses(1, 3));
+
+    oled.commands.clear();
+    oled.setRotation(3);
+    display.displayRegion({10, 0, 20, 64});
+    EXPECT_EQ(oled.commands, pageAddresses(4, 6));
+}
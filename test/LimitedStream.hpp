@@ -0,0 +1,90 @@
+#pragma once
+
+#include <AH/Arduino-Wrapper.h> // Stream
+
+#include <deque>
+#include <vector>
+
+/// Stream with a transmit buffer of limited size. Bytes move from the buffer
+/// to the wire when the test calls @ref transmit, or, if the Stream follows a
+/// simulated clock, at the rate of serial MIDI (one byte every 320 µs).
+/// Writing to a full buffer blocks, which is simulated by transmitting the
+/// oldest byte first (advancing the clock until it is done, if there is one).
+class LimitedStream : public Stream {
+  public:
+    constexpr static unsigned long byteTime = 320;
+
+    /// Bytes are only transmitted by @ref transmit.
+    LimitedStream(size_t capacity) : capacity(capacity) {}
+    /// Bytes are transmitted as the given simulated time advances.
+    LimitedStream(unsigned long &now, size_t capacity)
+        : now(&now), capacity(capacity) {}
+
+    size_t write(uint8_t data) override {
+        update();
+        if (buffer.size() == capacity) {
+            ++blockingWrites;
+            if (now) {
+                blockedTime += buffer.front().doneTime - *now;
+                *now = buffer.front().doneTime;
+            }
+            transmit(1);
+        }
+        unsigned long start = 0;
+        if (now)
+            start = buffer.empty() ? *now : buffer.back().doneTime;
+        buffer.push_back({start + byteTime, data});
+        return 1;
+    }
+    int availableForWrite() override {
+        update();
+        return capacity - buffer.size();
+    }
+    int peek() override { return -1; }
+    int read() override { return -1; }
+    int available() override { return 0; }
+
+    /// Move the given number of bytes from the transmit buffer to the wire.
+    void transmit(size_t count) {
+        while (count-- > 0 && !buffer.empty()) {
+            wire.push_back(buffer.front());
+            buffer.pop_front();
+        }
+    }
+    /// Move the bytes that have been transmitted by now to the wire.
+    void update() {
+        while (now && !buffer.empty() && buffer.front().doneTime <= *now)
+            transmit(1);
+    }
+    /// Check whether all bytes have been transmitted by now.
+    bool isIdle() {
+        update();
+        return buffer.empty();
+    }
+
+    /// Get the bytes on the wire.
+    std::vector<uint8_t> getWireData() const {
+        std::vector<uint8_t> data;
+        for (auto &byte : wire)
+            data.push_back(byte.data);
+        return data;
+    }
+    /// Transmit everything, and get the bytes on the wire.
+    std::vector<uint8_t> getWire() {
+        transmit(buffer.size());
+        return getWireData();
+    }
+
+    struct Byte {
+        /// The time at which the byte is completely transmitted (if the
+        /// Stream follows a simulated clock).
+        unsigned long doneTime;
+        uint8_t data;
+    };
+    unsigned long *now = nullptr;
+    size_t capacity;
+    unsigned blockingWrites = 0;
+    unsigned long blockedTime = 0;
+    std::deque<Byte> buffer;
+    std::vector<Byte> wire;
+};
@@ -1,6 +1,8 @@
 #include <gtest-wrapper.h>
 
 #include <MIDI_Inputs/MCU/LCD.hpp>
+#include <MIDI_Parsers/SerialMIDI_Parser.hpp>
+#include <MIDI_Parsers/USBMIDI_Parser.hpp>
 
 USING_CS_NAMESPACE;
 
@@ -93,6 +95,93 @@ TEST(LCD, FillManyBuffersWithOneMIDIMessage) {
     EXPECT_STREQ(lcds[3].getText(), "mnop");
 }
 
+/// Feed the message to a parser with a small buffer and SysEx chunking
+/// enabled, and pass all chunks to the LCDs.
+static void updateAllChunked(const std::vector<uint8_t> &sysex) {
+    uint8_t storage[16];
+    SerialMIDI_Parser parser;
+    parser.setSysExBuffer(storage);
+    parser.setSysExChunking(true);
+    unsigned chunks = 0;
+    for (uint8_t b : sysex) {
+        MIDIReadEvent event = parser.parse(b);
+        if (event == MIDIReadEvent::SYSEX_CHUNK ||
+            event == MIDIReadEvent::SYSEX_MESSAGE) {
+            MIDIInputElementSysEx::updateAllWith(parser.getSysExMessage());
+            ++chunks;
+        }
+    }
+    EXPECT_EQ(chunks, (sysex.size() + 15) / 16);
+}
+
+static std::vector<uint8_t> makeLCDMessage(uint8_t offset, const char *text) {
+    std::vector<uint8_t> sysex = {0xF0, 0x00, 0x00, 0x66, 0x14, 0x12, offset};
+    sysex.insert(sysex.end(), text, text + strlen(text));
+    sysex.push_back(0xF7);
+    return sysex;
+}
+
+TEST(LCD, chunkedFullDisplay) {
+    MCU::LCD<112> lcd;
+    std::string line1, line2;
+    for (char i = '1'; i <= '7'; ++i) {
+        line1 += std::string("Track ") + i + ' ';
+        line2 += "  Pan   ";
+    }
+    ASSERT_EQ(line1.size() + line2.size(), 112u);
+    updateAllChunked(makeLCDMessage(0x00, (line1 + line2).c_str()));
+    EXPECT_EQ(lcd.getText(), line1 + line2);
+
+    updateAllChunked(makeLCDMessage(0x08, "Strings Brass   Drums   Bass    "));
+    line1.replace(8, 32, "Strings Brass   Drums   Bass    ");
+    EXPECT_EQ(lcd.getText(), line1 + line2);
+}
+
+TEST(LCD, chunkedMultipleInstances) {
+    MCU::LCD<7> lcds[] = {0, 7, 14, 56};
+    updateAllChunked(makeLCDMessage(0x00, "Track 1Track 2Track 3Track 4"));
+    EXPECT_STREQ(lcds[0].getText(), "Track 1");
+    EXPECT_STREQ(lcds[1].getText(), "Track 2");
+    EXPECT_STREQ(lcds[2].getText(), "Track 3");
+    EXPECT_STREQ(lcds[3].getText(), "       ");
+}
+
+TEST(LCD, chunkedSmallUSBBuffer) {
+    // The USB parser returns chunks of 6 bytes, the header is split over two
+    MCU::LCD<12> lcd;
+    uint8_t storage[8];
+    USBMIDI_Parser parser;
+    parser.setSysExBuffer(storage);
+    parser.setSysExChunking(true);
+    auto sysex = makeLCDMessage(0x02, "abcdefghijklmnop");
+    size_t i = 0;
+    unsigned chunks = 0;
+    auto handle = [&](MIDIReadEvent event) {
+        if (event == MIDIReadEvent::SYSEX_CHUNK ||
+            event == MIDIReadEvent::SYSEX_MESSAGE) {
+            MIDIInputElementSysEx::updateAllWith(parser.getSysExMessage());
+            ++chunks;
+        }
+    };
+    for (; sysex.size() - i > 3; i += 3) {
+        uint8_t packet[4] = {0x04, sysex[i], sysex[i + 1], sysex[i + 2]};
+        handle(parser.parse(packet));
+    }
+    // 24 = 3 × 7 + 3
+    uint8_t packet[4] = {0x07, sysex[i], sysex[i + 1], sysex[i + 2]};
+    handle(parser.parse(packet));
+    EXPECT_EQ(chunks, 4u);
+    EXPECT_STREQ(lcd.getText(), "  abcdefghij");
+}
+
+TEST(LCD, chunkedIgnoresOtherMessages) {
+    MCU::LCD<8> lcd;
+    auto sysex = makeLCDMessage(0x00, "abcdefghijklmnopqrstuvwxyz");
+    sysex[5] = 0x13; // not an LCD message
+    updateAllChunked(sysex);
+    EXPECT_STREQ(lcd.getText(), "        ");
+}
+
 TEST(length, len) {
     auto range = {0, 1, 2, 3, 4, 5, 6, 7};
     for (int a : range) {
@@ -0,0 +1,242 @@
+#include <Control_Surface/Control_Surface_Class.hpp>
+#include <MIDI_Inputs/LEDs/MIDIClockLED.hpp>
+#include <MIDI_Inputs/MIDITempoTracker.hpp>
+#include <gmock-wrapper.h>
+#include <gtest-wrapper.h>
+
+#include <cstdlib>
+#include <random>
+
+USING_CS_NAMESPACE;
+using namespace ::testing;
+
+const RealTimeMessage Clock = MIDIMessageType::TIMING_CLOCK;
+const RealTimeMessage Start = MIDIMessageType::START;
+const RealTimeMessage Continue = MIDIMessageType::CONTINUE;
+const RealTimeMessage Stop = MIDIMessageType::STOP;
+
+/// Generates the timestamps of a MIDI clock with the given tempo, where every
+/// clock message is delayed by a random amount between 0 and the given jitter.
+struct ClockSource {
+    ClockSource(uint32_t centiBPM, unsigned long jitter = 0)
+        : jitter(jitter) {
+        setTempo(centiBPM);
+    }
+    void setTempo(uint32_t centiBPM) {
+        interval = 250000000.0 / centiBPM; // µs per tick
+    }
+    /// Get the time of the next clock message.
+    unsigned long next() {
+        time += interval;
+        unsigned long delay = jitter ? rng() % (jitter + 1) : 0;
+        return 1000000 + static_cast<unsigned long>(time) + delay;
+    }
+
+    double interval;
+    double time = 0;
+    unsigned long jitter;
+    std::mt19937 rng{1};
+};
+
+TEST(MIDITempoTracker, steadyTempo) {
+    MIDITempoTracker tracker;
+    ClockSource source = 12000;
+    EXPECT_FALSE(tracker.hasTempo());
+    EXPECT_EQ(tracker.getBPM(), 0);
+    tracker.update(Clock, source.next());
+    EXPECT_FALSE(tracker.hasTempo());
+    for (int i = 0; i < 96; ++i)
+        tracker.update(Clock, source.next());
+    EXPECT_TRUE(tracker.hasTempo());
+    EXPECT_NEAR(tracker.getTickInterval(), 20833, 1);
+    EXPECT_NEAR(tracker.getCentiBPM(), 12000, 1);
+    EXPECT_EQ(tracker.getBPM(), 120);
+}
+
+TEST(MIDITempoTracker, jitter) {
+    MIDITempoTracker tracker;
+    ClockSource source = {12800, 2000}; // 2 ms of jitter on a 19.5 ms interval
+    for (int i = 0; i < 48; ++i)
+        tracker.update(Clock, source.next());
+    uint32_t maxError = 0;
+    for (int i = 0; i < 24 * 64; ++i) {
+        tracker.update(Clock, source.next());
+        maxError = std::max<uint32_t>(
+            maxError, std::abs(int32_t(tracker.getCentiBPM()) - 12800));
+    }
+    // Within 0.5%, even though individual intervals vary by 10%
+    EXPECT_LE(maxError, 64u);
+}
+
+TEST(MIDITempoTracker, lostClock) {
+    MIDITempoTracker tracker;
+    ClockSource source = 12000;
+    for (int i = 0; i < 48; ++i)
+        tracker.update(Clock, source.next());
+    source.next(); // lost
+    tracker.update(Clock, source.next());
+    EXPECT_NEAR(tracker.getCentiBPM(), 12000, 1);
+    for (int i = 0; i < 4; ++i)
+        tracker.update(Clock, source.next());
+    EXPECT_NEAR(tracker.getCentiBPM(), 12000, 1);
+}
+
+TEST(MIDITempoTracker, tempoChange) {
+    MIDITempoTracker tracker;
+    ClockSource source = 12000;
+    for (int i = 0; i < 48; ++i)
+        tracker.update(Clock, source.next());
+    source.setTempo(9000);
+    for (int i = 1; i < MIDI_CLOCK_MAX_OUTLIERS; ++i) {
+        tracker.update(Clock, source.next());
+        EXPECT_EQ(tracker.getBPM(), 120);
+    }
+    tracker.update(Clock, source.next());
+    EXPECT_EQ(tracker.getBPM(), 90);
+    // Gradual changes are followed by the filter
+    for (uint32_t centiBPM = 9000; centiBPM <= 10000; centiBPM += 10) {
+        source.setTempo(centiBPM);
+        tracker.update(Clock, source.next());
+    }
+    for (int i = 0; i < 48; ++i)
+        tracker.update(Clock, source.next());
+    EXPECT_EQ(tracker.getBPM(), 100);
+}
+
+TEST(MIDITempoTracker, transport) {
+    MIDITempoTracker tracker;
+    unsigned long t = 0;
+    // Clock without Start: tempo, but no position
+    for (int i = 0; i < 10; ++i)
+        EXPECT_FALSE(tracker.update(Clock, t += 20000));
+    EXPECT_FALSE(tracker.isRunning());
+    EXPECT_EQ(tracker.getTickCount(), 0ul);
+    EXPECT_EQ(tracker.getBPM(), 125);
+
+    tracker.update(Start, t += 100);
+    EXPECT_TRUE(tracker.isRunning());
+    // The first clock after Start is the first tick of the song
+    EXPECT_TRUE(tracker.update(Clock, t += 19900));
+    EXPECT_EQ(tracker.getTickCount(), 0ul);
+    EXPECT_TRUE(tracker.isOnBeat());
+    for (int i = 0; i < 25; ++i)
+        tracker.update(Clock, t += 20000);
+    EXPECT_EQ(tracker.getTickCount(), 25ul);
+    EXPECT_EQ(tracker.getBeatCount(), 1ul);
+    EXPECT_EQ(tracker.getTickInBeat(), 1);
+    EXPECT_FALSE(tracker.isOnBeat());
+
+    tracker.update(Stop, t += 100);
+    EXPECT_FALSE(tracker.isRunning());
+    EXPECT_FALSE(tracker.update(Clock, t += 19900));
+    EXPECT_EQ(tracker.getTickCount(), 25ul);
+
+    tracker.update(Continue, t += 100);
+    EXPECT_TRUE(tracker.update(Clock, t += 19900));
+    EXPECT_EQ(tracker.getTickCount(), 26ul);
+
+    tracker.update(Start, t += 100);
+    tracker.update(Clock, t += 19900);
+    EXPECT_EQ(tracker.getTickCount(), 0ul);
+
+    tracker.update(MIDIMessageType::RESET, t += 100);
+    EXPECT_FALSE(tracker.isRunning());
+    EXPECT_FALSE(tracker.hasTempo());
+}
+
+TEST(MIDITempoTracker, beatPhase) {
+    MIDITempoTracker tracker;
+    unsigned long t = 0;
+    tracker.update(Start, t);
+    tracker.update(Clock, t += 1000);
+    EXPECT_EQ(tracker.getBeatPhase(t + 5000), 0); // No tempo yet
+    tracker.update(Clock, t += 20000);
+    EXPECT_EQ(tracker.getBeatPhase(t), 65536 / 24);
+    EXPECT_EQ(tracker.getBeatPhase(t + 10000), 65536 * 3 / 48);
+    // Doesn't advance past the next tick
+    EXPECT_LT(tracker.getBeatPhase(t + 50000), 65536 * 2 / 24);
+    EXPECT_GT(tracker.getBeatPhase(t + 50000), 65536 * 2 / 24 - 20);
+    for (int i = 0; i < 22; ++i)
+        tracker.update(Clock, t += 20000);
+    EXPECT_EQ(tracker.getTickInBeat(), 23);
+    EXPECT_GT(tracker.getBeatPhase(t + 19999), 65500);
+    tracker.update(Clock, t += 20000);
+    EXPECT_EQ(tracker.getBeatPhase(t), 0);
+}
+
+class TestMIDIClock : public MIDIClock {
+  public:
+    using MIDIClock::MIDIClock;
+    unsigned ticks = 0;
+
+  protected:
+    void onTick() override { ++ticks; }
+};
+
+class MIDIClockTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        EXPECT_CALL(ArduinoMock::getInstance(), micros())
+            .WillRepeatedly(Invoke([this] { return now; }));
+    }
+    void TearDown() override {
+        Mock::VerifyAndClear(&ArduinoMock::getInstance());
+    }
+    unsigned long now = 1000000;
+};
+
+TEST_F(MIDIClockTest, controlSurface) {
+    TestMIDIClock clock;
+    TestMIDIClock clock2 = CABLE_2;
+    TrueMIDI_Source source;
+    MIDI_Pipe pipe;
+    source >> pipe >> Control_Surface;
+
+    source.sourceMIDItoPipe(Start);
+    for (int i = 0; i < 49; ++i) {
+        source.sourceMIDItoPipe(Clock);
+        now += 25000;
+    }
+    EXPECT_TRUE(clock.isRunning());
+    EXPECT_EQ(clock.getBPM(), 100);
+    EXPECT_EQ(clock.getCentiBPM(), 10000ul);
+    EXPECT_EQ(clock.getTickCount(), 48ul);
+    EXPECT_EQ(clock.getBeatCount(), 2ul);
+    EXPECT_EQ(clock.ticks, 49u);
+    now -= 12500;
+    EXPECT_EQ(clock.getBeatPhase(), 65536 / 48);
+    // Messages on other cables are ignored
+    EXPECT_FALSE(clock2.isRunning());
+    EXPECT_EQ(clock2.ticks, 0u);
+
+    MIDIInputElementRealTime::resetAll();
+    EXPECT_FALSE(clock.isRunning());
+    EXPECT_EQ(clock.getBPM(), 0);
+}
+
+TEST_F(MIDIClockTest, led) {
+    MIDIClockLED led = 2;
+    auto &mock = ArduinoMock::getInstance();
+    InSequence seq;
+    EXPECT_CALL(mock, pinMode(2, OUTPUT));
+    EXPECT_CALL(mock, digitalWrite(2, LOW));
+    led.begin();
+    led.update(); // Not running
+
+    MIDIInputElementRealTime::updateAllWith(Start);
+    for (int i = 0; i < 24; ++i) {
+        MIDIInputElementRealTime::updateAllWith(Clock);
+        if (i == 0)
+            EXPECT_CALL(mock, digitalWrite(2, HIGH));
+        else if (i == 6)
+            EXPECT_CALL(mock, digitalWrite(2, LOW));
+        led.update();
+        now += 20000;
+    }
+    EXPECT_CALL(mock, digitalWrite(2, HIGH));
+    MIDIInputElementRealTime::updateAllWith(Clock);
+    led.update();
+    EXPECT_CALL(mock, digitalWrite(2, LOW));
+    MIDIInputElementRealTime::updateAllWith(Stop);
+    led.update();
+}
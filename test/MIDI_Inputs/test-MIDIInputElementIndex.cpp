@@ -0,0 +1,203 @@
+#include <gtest-wrapper.h>
+
+#include <MIDI_Inputs/MIDIInputElementPC.hpp>
+#include <MIDI_Inputs/NoteCCRange.hpp>
+
+using namespace CS;
+
+/// CC element that counts how many times it was matched against a message.
+struct CountingCCValue : MIDIInputElementCC {
+    CountingCCValue(MIDIAddress address) : MIDIInputElementCC(address) {}
+
+    bool updateImpl(const ChannelMessageMatcher &midimsg,
+                    const MIDIAddress &) override {
+        value = midimsg.data2;
+        return true;
+    }
+
+    bool match(const MIDIAddress &target) const override {
+        ++matches;
+        return MIDIAddress::matchSingle(this->address, target);
+    }
+
+    uint8_t value = 0;
+    static unsigned matches;
+};
+
+unsigned CountingCCValue::matches = 0;
+
+static ChannelMessageMatcher cc(uint8_t controller, uint8_t value,
+                                Channel channel = CHANNEL_1, uint8_t CN = 0) {
+    return {MIDIMessageType::CONTROL_CHANGE, channel, controller, value, CN};
+}
+
+TEST(MIDIInputElementIndex, enableDisable) {
+    EXPECT_EQ(MIDIInputElementCC::getDispatchIndex(), nullptr);
+    {
+        MIDIInputElementCC::DispatchIndex<16> index;
+        EXPECT_EQ(MIDIInputElementCC::getDispatchIndex(), &index);
+    }
+    EXPECT_EQ(MIDIInputElementCC::getDispatchIndex(), nullptr);
+}
+
+TEST(MIDIInputElementIndex, cachesLookups) {
+    MIDIInputElementCC::DispatchIndex<16> index;
+    CountingCCValue a = {{0x10, CHANNEL_1}};
+    CountingCCValue b = {{0x11, CHANNEL_1}};
+    CountingCCValue c = {{0x12, CHANNEL_1}};
+    CountingCCValue::matches = 0;
+
+    MIDIInputElementCC::updateAllWith(cc(0x12, 0x42));
+    EXPECT_EQ(c.value, 0x42);
+    unsigned firstLookup = CountingCCValue::matches;
+    EXPECT_GE(firstLookup, 1u);
+
+    // The second message with the same address only has to check the element
+    // that handles it.
+    MIDIInputElementCC::updateAllWith(cc(0x12, 0x43));
+    EXPECT_EQ(c.value, 0x43);
+    EXPECT_EQ(CountingCCValue::matches, firstLookup + 1);
+
+    EXPECT_EQ(a.value, 0x00);
+    EXPECT_EQ(b.value, 0x00);
+}
+
+TEST(MIDIInputElementIndex, cachesMisses) {
+    MIDIInputElementCC::DispatchIndex<16> index;
+    CountingCCValue a = {{0x10, CHANNEL_1}};
+    CountingCCValue b = {{0x11, CHANNEL_1}};
+    CountingCCValue::matches = 0;
+
+    MIDIInputElementCC::updateAllWith(cc(0x10, 0x01, CHANNEL_2));
+    EXPECT_EQ(CountingCCValue::matches, 2u);
+    MIDIInputElementCC::updateAllWith(cc(0x10, 0x02, CHANNEL_2));
+    EXPECT_EQ(CountingCCValue::matches, 2u);
+
+    EXPECT_EQ(a.value, 0x00);
+    EXPECT_EQ(b.value, 0x00);
+}
+
+TEST(MIDIInputElementIndex, invalidatedByNewElements) {
+    MIDIInputElementCC::DispatchIndex<16> index;
+    CountingCCValue a = {{0x10, CHANNEL_1}};
+
+    MIDIInputElementCC::updateAllWith(cc(0x20, 0x01));
+    CountingCCValue b = {{0x20, CHANNEL_1}};
+    MIDIInputElementCC::updateAllWith(cc(0x20, 0x02));
+    EXPECT_EQ(b.value, 0x02);
+    EXPECT_EQ(a.value, 0x00);
+}
+
+TEST(MIDIInputElementIndex, invalidatedByRemovedElements) {
+    MIDIInputElementCC::DispatchIndex<16> index;
+    CountingCCValue a = {{0x10, CHANNEL_1}};
+    {
+        CountingCCValue b = {{0x20, CHANNEL_1}};
+        MIDIInputElementCC::updateAllWith(cc(0x20, 0x01));
+        EXPECT_EQ(b.value, 0x01);
+    }
+    // Must not dispatch to the destroyed element.
+    MIDIInputElementCC::updateAllWith(cc(0x20, 0x02));
+    EXPECT_EQ(a.value, 0x00);
+}
+
+TEST(MIDIInputElementIndex, collisions) {
+    // With only two slots, all of these addresses collide, but every message
+    // must still reach the right element.
+    MIDIInputElementCC::DispatchIndex<2> index;
+    CountingCCValue a = {{0x10, CHANNEL_1}};
+    CountingCCValue b = {{0x10, CHANNEL_3}};
+    CountingCCValue c = {{0x10, CHANNEL_1, CABLE_2}};
+    CountingCCValue d = {{0x12, CHANNEL_1}};
+
+    for (uint8_t i = 1; i < 4; ++i) {
+        MIDIInputElementCC::updateAllWith(cc(0x10, i, CHANNEL_1));
+        MIDIInputElementCC::updateAllWith(cc(0x10, i + 0x10, CHANNEL_3));
+        MIDIInputElementCC::updateAllWith(cc(0x10, i + 0x20, CHANNEL_1, 1));
+        MIDIInputElementCC::updateAllWith(cc(0x12, i + 0x30, CHANNEL_1));
+        EXPECT_EQ(a.value, i);
+        EXPECT_EQ(b.value, i + 0x10);
+        EXPECT_EQ(c.value, i + 0x20);
+        EXPECT_EQ(d.value, i + 0x30);
+    }
+}
+
+TEST(MIDIInputElementIndex, noteRange) {
+    MIDIInputElementNote::DispatchIndex<64> index;
+    NoteRange<4> range = {{0x3C, CHANNEL_5}};
+    NoteValue other = {{0x40, CHANNEL_5}};
+
+    for (uint8_t i = 0; i < 5; ++i)
+        MIDIInputElementNote::updateAllWith(
+            {MIDIMessageType::NOTE_ON, CHANNEL_5, uint8_t(0x3C + i), i});
+    EXPECT_EQ(range.getValue(0), 0);
+    EXPECT_EQ(range.getValue(1), 1);
+    EXPECT_EQ(range.getValue(2), 2);
+    EXPECT_EQ(range.getValue(3), 3);
+    EXPECT_EQ(other.getValue(), 4);
+
+    MIDIInputElementNote::updateAllWith(
+        {MIDIMessageType::NOTE_OFF, CHANNEL_5, 0x3E, 0x7F});
+    EXPECT_EQ(range.getValue(2), 0);
+}
+
+TEST(MIDIInputElementIndex, bankable) {
+    MIDIInputElementCC::DispatchIndex<64> index;
+    Bank<2> bank(4);
+    Bankable::CCValue<2> value = {{bank, BankType::CHANGE_ADDRESS},
+                                  {0x10, CHANNEL_1}};
+
+    MIDIInputElementCC::updateAllWith(cc(0x10, 0x11));
+    MIDIInputElementCC::updateAllWith(cc(0x14, 0x22));
+    EXPECT_EQ(value.getValue(), 0x11);
+    bank.select(1);
+    EXPECT_EQ(value.getValue(), 0x22);
+    MIDIInputElementCC::updateAllWith(cc(0x14, 0x33));
+    EXPECT_EQ(value.getValue(), 0x33);
+    bank.select(0);
+    EXPECT_EQ(value.getValue(), 0x11);
+}
+
+/// Program Change element that counts how many times it was matched against a
+/// message.
+struct CountingPCValue : MIDIInputElementPC {
+    CountingPCValue(MIDIAddress address) : MIDIInputElementPC(address) {}
+
+    bool updateImpl(const ChannelMessageMatcher &midimsg,
+                    const MIDIAddress &) override {
+        program = midimsg.data1;
+        return true;
+    }
+
+    bool match(const MIDIAddress &target) const override {
+        ++matches;
+        return MIDIAddress::matchSingle(this->address, target);
+    }
+
+    uint8_t program = 0;
+    static unsigned matches;
+};
+
+unsigned CountingPCValue::matches = 0;
+
+/// The program number is not part of the address, so a lookup for one
+/// program can be reused for all other programs.
+TEST(MIDIInputElementIndex, programChangeIgnoresProgram) {
+    MIDIInputElementPC::DispatchIndex<16> index;
+    CountingPCValue a = {{0, CHANNEL_1}};
+    CountingPCValue b = {{0, CHANNEL_2}};
+    CountingPCValue::matches = 0;
+
+    for (uint8_t program = 0; program < 8; ++program)
+        MIDIInputElementPC::updateAllWith(
+            {MIDIMessageType::PROGRAM_CHANGE, CHANNEL_3, program, 0});
+    EXPECT_EQ(CountingPCValue::matches, 2u);
+
+    for (uint8_t program = 0; program < 8; ++program)
+        MIDIInputElementPC::updateAllWith(
+            {MIDIMessageType::PROGRAM_CHANGE, CHANNEL_2, program, 0});
+    EXPECT_EQ(b.program, 7);
+    EXPECT_EQ(a.program, 0);
+    // Only the first message is searched for, the others use the index
+    EXPECT_EQ(CountingPCValue::matches, 2u + 2u + 7u);
+}
@@ -152,6 +152,7 @@ TEST(MCUVPotLEDsBankable, displayOnBankChange) {
     EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(10, LOW));
 
     bank.select(1);
+    InputBankRefresher::refreshAll();
 
     EXPECT_EQ(vpot.getPosition(), 0x9);
     EXPECT_EQ(vpot.getMode(), 0x1);
@@ -324,10 +324,12 @@ TEST(MCUVULEDsBankable, displayOnBankChange) {
     EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(0, HIGH));
     EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(1, LOW));
     bank.select(1);
+    InputBankRefresher::refreshAll();
     Mock::VerifyAndClear(&ArduinoMock::getInstance());
     EXPECT_EQ(vu.getValue(), 0x6);
     EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(0, HIGH));
     EXPECT_CALL(ArduinoMock::getInstance(), digitalWrite(1, HIGH));
     bank.select(0);
+    InputBankRefresher::refreshAll();
     Mock::VerifyAndClear(&ArduinoMock::getInstance());
 }
\ No newline at end of file
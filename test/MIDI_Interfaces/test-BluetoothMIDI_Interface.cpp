@@ -1,6 +1,14 @@
 #include <MIDI_Interfaces/BluetoothMIDI_Interface.hpp>
+#include <gmock-wrapper.h>
+#include <gtest-wrapper.h>
+
+#include <atomic>
+#include <thread>
 
 using namespace CS;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
 
 TEST(BluetoothMIDIInterface, initializeBegin) {
     BluetoothMIDI_Interface midi;
@@ -46,6 +54,7 @@ TEST(BluetoothMIDIInterface, receiveChannelMessage) {
 
     uint8_t data[] = {0x80, 0x80, 0x90, 0x3C, 0x7F};
     midi.parse(data, sizeof(data));
+    midi.update();
 
     std::vector<uint8_t> expectedSysExMessages = {};
     EXPECT_EQ(cb.sysExMessages, expectedSysExMessages);
@@ -71,6 +80,7 @@ TEST(BluetoothMIDIInterface, receiveMultipleChannelMessage) {
     uint8_t data[] = {0x80, 0x80, 0x90, 0x3C, 0x7F, 0x80, 0x80,
                       0x3D, 0x7E, 0x80, 0xB1, 0x10, 0x40};
     midi.parse(data, sizeof(data));
+    midi.update();
 
     std::vector<uint8_t> expectedSysExMessages = {};
     EXPECT_EQ(cb.sysExMessages, expectedSysExMessages);
@@ -98,6 +108,7 @@ TEST(BluetoothMIDIInterface, receiveMultipleChannelMessageRunningStatus) {
     uint8_t data[] = {0x80, 0x80, 0x90, 0x3C, 0x7F, 0x3D,
                       0x7E, 0x80, 0xB1, 0x10, 0x40};
     midi.parse(data, sizeof(data));
+    midi.update();
 
     std::vector<uint8_t> expectedSysExMessages = {};
     EXPECT_EQ(cb.sysExMessages, expectedSysExMessages);
@@ -128,6 +139,7 @@ TEST(BluetoothMIDIInterface,
                       0x3D, 0x7E,             // Continuation of note on
                       0x80, 0xB1, 0x10, 0x40};
     midi.parse(data, sizeof(data));
+    midi.update();
 
     std::vector<uint8_t> expectedSysExMessages = {};
     EXPECT_EQ(cb.sysExMessages, expectedSysExMessages);
@@ -155,6 +167,7 @@ TEST(BluetoothMIDIInterface, receiveMultipleTwoByteChannelMessage) {
     uint8_t data[] = {0x80, 0x80, 0xD0, 0x3C, 0x80, 0xC0,
                       0x3D, 0x80, 0xB1, 0x10, 0x40};
     midi.parse(data, sizeof(data));
+    midi.update();
 
     std::vector<uint8_t> expectedSysExMessages = {};
     EXPECT_EQ(cb.sysExMessages, expectedSysExMessages);
@@ -181,6 +194,7 @@ TEST(BluetoothMIDIInterface, receiveSysEx) {
 
     uint8_t data[] = {0x80, 0x80, 0xF0, 0x01, 0x02, 0x03, 0x04, 0x80, 0xF7};
     midi.parse(data, sizeof(data));
+    midi.update();
 
     std::vector<uint8_t> expectedSysExMessages = {0xF0, 0x01, 0x02,
                                                   0x03, 0x04, 0xF7};
@@ -204,6 +218,7 @@ TEST(BluetoothMIDIInterface, receiveSysEx2) {
 
     uint8_t data[] = {0x95, 0xED, 0xF0, 0x1, 0x2, 0x3, 0x4, 0xED, 0xF7};
     midi.parse(data, sizeof(data));
+    midi.update();
 
     std::vector<uint8_t> expectedSysExMessages = {0xF0, 0x01, 0x02,
                                                   0x03, 0x04, 0xF7};
@@ -229,6 +244,7 @@ TEST(BluetoothMIDIInterface, receiveSysExSplitAcrossPackets) {
     uint8_t data2[] = {0x80, 0x03, 0x04, 0x80, 0xF7};
     midi.parse(data1, sizeof(data1));
     midi.parse(data2, sizeof(data2));
+    midi.update();
 
     std::vector<uint8_t> expectedSysExMessages = {0xF0, 0x01, 0x02,
                                                   0x03, 0x04, 0xF7};
@@ -254,6 +270,7 @@ TEST(BluetoothMIDIInterface, receiveSysExAndRealTime) {
                       0x80, 0xF8, 0x80, // this is a system real time message
                       0x03, 0x04, 0x80, 0xF7};
     midi.parse(data, sizeof(data));
+    midi.update();
 
     std::vector<uint8_t> expectedSysExMessages = {0xF0, 0x01, 0x02,
                                                   0x03, 0x04, 0xF7};
@@ -262,4 +279,331 @@ TEST(BluetoothMIDIInterface, receiveSysExAndRealTime) {
 
     std::vector<ChannelMessage> expectedChannelMessages = {};
     EXPECT_EQ(cb.channelMessages, expectedChannelMessages);
-}
\ No newline at end of file
+}
+
+TEST(BluetoothMIDIInterface, receiveOnlyInUpdate) {
+    MockMIDI_Callbacks cb;
+    BluetoothMIDI_Interface midi;
+    midi.setCallbacks(&cb);
+
+    uint8_t data[] = {0x80, 0x80, 0x90, 0x3C, 0x7F};
+    midi.parse(data, sizeof(data));
+    // Nothing is dispatched from the BLE callback itself
+    EXPECT_TRUE(cb.channelMessages.empty());
+    midi.update();
+    std::vector<ChannelMessage> expectedChannelMessages = {
+        {0x90, 0x3C, 0x7F, 0x00},
+    };
+    EXPECT_EQ(cb.channelMessages, expectedChannelMessages);
+}
+
+TEST(BluetoothMIDIInterface, receiveQueueOverflow) {
+    MockMIDI_Callbacks cb;
+    BluetoothMIDI_Interface midi;
+    midi.setCallbacks(&cb);
+
+    // 5 bytes per packet, 3 bytes of MIDI data per packet, the queue can
+    // hold 512 bytes, and a packet is only accepted if there's room for 4
+    // bytes.
+    uint8_t data[] = {0x80, 0x80, 0x90, 0x3C, 0x7F};
+    for (unsigned i = 0; i < 200; ++i) {
+        data[3] = i & 0x7F;
+        midi.parse(data, sizeof(data));
+    }
+    const unsigned accepted = (512 - 4) / 3 + 1;
+    EXPECT_EQ(midi.getOverflowCount(), 200 - accepted);
+
+    midi.update();
+    ASSERT_EQ(cb.channelMessages.size(), accepted);
+    for (unsigned i = 0; i < accepted; ++i)
+        EXPECT_EQ(cb.channelMessages[i].data1, i & 0x7F);
+
+    // There's room again after the queue has been drained
+    midi.parse(data, sizeof(data));
+    midi.update();
+    EXPECT_EQ(cb.channelMessages.size(), accepted + 1);
+    EXPECT_EQ(midi.getOverflowCount(), 200 - accepted);
+}
+
+TEST(BluetoothMIDIInterface, receiveFromOtherThread) {
+    MockMIDI_Callbacks cb;
+    BluetoothMIDI_Interface midi;
+    midi.setCallbacks(&cb);
+
+    // The BLE stack calls the callback from a different thread
+    constexpr unsigned numPackets = 1u << 14;
+    std::atomic<bool> done{false};
+    std::thread bleThread([&] {
+        for (unsigned i = 0; i < numPackets; ++i) {
+            // Two note on messages per packet, running status for the second
+            uint8_t data[] = {
+                0x80,
+                0x80,
+                0x90,
+                uint8_t(i & 0x7F),
+                uint8_t(i >> 7),
+                uint8_t(i & 0x7F),
+                0x01,
+            };
+            midi.parse(data, sizeof(data));
+        }
+        done = true;
+    });
+
+    // Main loop
+    while (!done)
+        midi.update();
+    midi.update();
+    bleThread.join();
+
+    const unsigned long dropped = midi.getOverflowCount();
+    EXPECT_EQ(cb.channelMessages.size(), 2 * (numPackets - dropped));
+    // Packets may have been dropped, but the messages that were received must
+    // be complete and in order
+    unsigned previous = 0;
+    for (size_t i = 0; i + 1 < cb.channelMessages.size(); i += 2) {
+        const ChannelMessage &first = cb.channelMessages[i];
+        const ChannelMessage &second = cb.channelMessages[i + 1];
+        unsigned packet = first.data1 | first.data2 << 7;
+        EXPECT_EQ(first.header, 0x90);
+        EXPECT_EQ(second.header, 0x90);
+        EXPECT_EQ(second.data1, first.data1);
+        EXPECT_EQ(second.data2, 0x01);
+        if (i > 0) {
+            EXPECT_GT(packet, previous) << i;
+        }
+        previous = packet;
+    }
+}
+
+// -------------------------------------------------------------------------- //
+
+using Packets = std::vector<std::vector<uint8_t>>;
+
+/// Simulates a client connecting with the given MTU, and records all
+/// notifications and the current time.
+struct BluetoothMIDIInterfaceSend : ::testing::Test {
+    BluetoothMIDI_Interface midi;
+    Packets packets;
+    unsigned long now = 0;
+
+    void connect(uint16_t mtu) {
+        BLEMIDI &ble = midi.getBLEMIDI();
+        EXPECT_CALL(ble, getMTU()).WillOnce(Return(mtu));
+        static_cast<BLEServerCallbacks &>(midi).onConnect(nullptr);
+        midi.update();
+    }
+
+    void SetUp() override {
+        EXPECT_CALL(ArduinoMock::getInstance(), micros())
+            .WillRepeatedly(Invoke([this] { return now; }));
+        EXPECT_CALL(midi.getBLEMIDI(), notifyValue(_, _))
+            .WillRepeatedly(Invoke([this](uint8_t *data, size_t len) {
+                packets.emplace_back(data, data + len);
+            }));
+    }
+
+    void TearDown() override {
+        ::testing::Mock::VerifyAndClear(&ArduinoMock::getInstance());
+    }
+};
+
+TEST_F(BluetoothMIDIInterfaceSend, timestampsAndRunningStatus) {
+    connect(23);
+    now = 1234000; // 1234 ms = 0b1001'1010010
+    midi.sendNoteOn({0x3C, CHANNEL_1}, 0x7F);
+    midi.sendNoteOn({0x3D, CHANNEL_1}, 0x7F);
+    now = 1235000;
+    midi.sendNoteOn({0x3E, CHANNEL_1}, 0x7F);
+    midi.sendCC({0x07, CHANNEL_1}, 0x64);
+    midi.update();
+    EXPECT_TRUE(packets.empty());
+    now = 1244000; // one connection interval after the first message
+    midi.update();
+
+    Packets expected = {{
+        0x89, 0xD2, 0x90, 0x3C, 0x7F, // header, timestamp, note on
+        0x3D, 0x7F,                   // same time, running status
+        0xD3, 0x3E, 0x7F,             // new time, running status
+        0xD3, 0xB0, 0x07, 0x64,       // same time, new status
+    }};
+    EXPECT_EQ(packets, expected);
+}
+
+TEST_F(BluetoothMIDIInterfaceSend, burstSmallMTU) {
+    connect(23); // 20 bytes per packet
+    now = 5000;
+    for (uint8_t i = 0; i < 30; ++i)
+        midi.sendNoteOn({i, CHANNEL_2}, 0x40);
+    // Full packets are sent immediately: 8 messages per packet (19 bytes)
+    EXPECT_EQ(packets.size(), 3);
+    now = 15000;
+    midi.update();
+    ASSERT_EQ(packets.size(), 4);
+    for (size_t i = 0; i < 3; ++i)
+        EXPECT_EQ(packets[i].size(), 19);
+    EXPECT_EQ(packets[3].size(), 5 + 5 * 2);
+    std::vector<uint8_t> expected = {0x80, 0x85, 0x91, 0x00, 0x40, 0x01, 0x40};
+    packets[0].resize(expected.size());
+    EXPECT_EQ(packets[0], expected);
+    expected = {0x80, 0x85, 0x91, 0x18, 0x40, 0x19, 0x40};
+    packets[3].resize(expected.size());
+    EXPECT_EQ(packets[3], expected);
+}
+
+TEST_F(BluetoothMIDIInterfaceSend, burstLargeMTU) {
+    connect(103); // 100 bytes per packet
+    EXPECT_EQ(midi.getPacketSize(), 100);
+    now = 5000;
+    for (uint8_t i = 0; i < 30; ++i)
+        midi.sendNoteOn({i, CHANNEL_2}, 0x40);
+    EXPECT_TRUE(packets.empty());
+    now = 14999;
+    midi.update();
+    EXPECT_TRUE(packets.empty());
+    now = 15000;
+    midi.update();
+    ASSERT_EQ(packets.size(), 1);
+    EXPECT_EQ(packets[0].size(), 5 + 29 * 2);
+}
+
+TEST_F(BluetoothMIDIInterfaceSend, mtuExchangeAfterConnecting) {
+    connect(23);
+    now = 5000;
+    midi.sendNoteOn({0x10, CHANNEL_1}, 0x40);
+    // The callback of the Bluetooth stack doesn't touch the current packet
+    static_cast<BLEServerCallbacks &>(midi).onMtuChanged(nullptr, nullptr);
+    EXPECT_EQ(midi.getPacketSize(), 20);
+    // The new MTU is applied by the main loop
+    EXPECT_CALL(midi.getBLEMIDI(), getMTU()).WillOnce(Return(103));
+    midi.update();
+    EXPECT_EQ(midi.getPacketSize(), 100);
+    EXPECT_TRUE(packets.empty());
+    for (uint8_t i = 0x11; i < 0x20; ++i)
+        midi.sendNoteOn({i, CHANNEL_1}, 0x40);
+    EXPECT_TRUE(packets.empty());
+    now = 15000;
+    midi.update();
+    ASSERT_EQ(packets.size(), 1);
+    EXPECT_EQ(packets[0].size(), 5 + 15 * 2);
+    // No more MTU queries until the next exchange
+    midi.update();
+}
+
+TEST_F(BluetoothMIDIInterfaceSend, connectionInterval) {
+    connect(103);
+    midi.setConnectionInterval(7500);
+    now = 1000;
+    midi.sendCC({0x10, CHANNEL_1}, 0x01);
+    now = 8499;
+    midi.update();
+    EXPECT_TRUE(packets.empty());
+    now = 8500;
+    midi.update();
+    Packets expected = {{0x80, 0x81, 0xB0, 0x10, 0x01}};
+    EXPECT_EQ(packets, expected);
+}
+
+TEST_F(BluetoothMIDIInterfaceSend, timestampHeaderChange) {
+    connect(103);
+    now = 127000;
+    midi.sendNoteOn({0x3C, CHANNEL_1}, 0x7F);
+    now = 128000;
+    midi.sendNoteOn({0x3D, CHANNEL_1}, 0x7F);
+    Packets expected = {{0x80, 0xFF, 0x90, 0x3C, 0x7F}};
+    EXPECT_EQ(packets, expected);
+    now = 200000;
+    midi.update();
+    expected.push_back({0x81, 0x80, 0x90, 0x3D, 0x7F});
+    EXPECT_EQ(packets, expected);
+}
+
+TEST_F(BluetoothMIDIInterfaceSend, realTimeKeepsRunningStatus) {
+    connect(103);
+    now = 2000;
+    midi.sendNoteOn({0x3C, CHANNEL_1}, 0x7F);
+    midi.send(MIDIMessageType::TIMING_CLOCK);
+    midi.sendNoteOn({0x3D, CHANNEL_1}, 0x7F);
+    midi.sendPC({CHANNEL_3}, 0x05);
+    now = 12000;
+    midi.update();
+    Packets expected = {{
+        0x80, 0x82, 0x90, 0x3C, 0x7F, //
+        0x82, 0xF8,                   //
+        0x82, 0x3D, 0x7F,             //
+        0x82, 0xC2, 0x05,             //
+    }};
+    EXPECT_EQ(packets, expected);
+}
+
+TEST_F(BluetoothMIDIInterfaceSend, sysExAcrossPackets) {
+    connect(23);
+    now = 3000;
+    std::vector<uint8_t> sysex(30);
+    sysex.front() = 0xF0;
+    for (uint8_t i = 1; i < 29; ++i)
+        sysex[i] = i;
+    sysex.back() = 0xF7;
+    midi.send(SysExMessage(sysex));
+    now = 13000;
+    midi.update();
+
+    std::vector<uint8_t> first = {0x80, 0x83, 0xF0};
+    first.insert(first.end(), sysex.begin() + 1, sysex.begin() + 18);
+    std::vector<uint8_t> second = {0x80};
+    second.insert(second.end(), sysex.begin() + 18, sysex.begin() + 29);
+    second.insert(second.end(), {0x83, 0xF7});
+    Packets expected = {first, second};
+    EXPECT_EQ(packets, expected);
+
+    // The receiver reassembles the message
+    MockMIDI_Callbacks cb;
+    BluetoothMIDI_Interface receiver;
+    receiver.setCallbacks(&cb);
+    for (auto &packet : packets)
+        receiver.parse(packet.data(), packet.size());
+    receiver.update();
+    EXPECT_EQ(cb.sysExMessages, sysex);
+}
+
+TEST_F(BluetoothMIDIInterfaceSend, roundTrip) {
+    connect(43);
+    for (uint8_t i = 0; i < 50; ++i) {
+        now = 1000 * i / 4;
+        midi.sendNoteOn({uint8_t(i / 3), CHANNEL_1}, i);
+        if (i % 7 == 0)
+            midi.sendCC({0x01, CHANNEL_1}, i);
+        if (i % 10 == 0)
+            midi.send(MIDIMessageType::TIMING_CLOCK);
+    }
+    now = 1000000;
+    midi.update();
+
+    MockMIDI_Callbacks cb;
+    BluetoothMIDI_Interface receiver;
+    receiver.setCallbacks(&cb);
+    for (auto &packet : packets)
+        receiver.parse(packet.data(), packet.size());
+    receiver.update();
+
+    std::vector<ChannelMessage> expected;
+    for (uint8_t i = 0; i < 50; ++i) {
+        expected.push_back({0x90, uint8_t(i / 3), i, 0x00});
+        if (i % 7 == 0)
+            expected.push_back({0xB0, 0x01, i, 0x00});
+    }
+    EXPECT_EQ(cb.channelMessages, expected);
+    EXPECT_EQ(cb.realtimeMessages.size(), 5);
+}
+
+TEST_F(BluetoothMIDIInterfaceSend, notConnected) {
+    now = 1000;
+    midi.sendNoteOn({0x3C, CHANNEL_1}, 0x7F);
+    now = 11000;
+    midi.update();
+    EXPECT_TRUE(packets.empty());
+    // The discarded messages are not sent when a client connects later
+    connect(23);
+    midi.update();
+    EXPECT_TRUE(packets.empty());
+}
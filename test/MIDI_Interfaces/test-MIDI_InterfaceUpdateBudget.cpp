@@ -0,0 +1,248 @@
+#include <MIDI_Interfaces/SerialMIDI_Interface.hpp>
+#include <gmock-wrapper.h>
+#include <gtest-wrapper.h>
+
+#include <queue>
+
+USING_CS_NAMESPACE;
+using namespace ::testing;
+
+class InputStream : public Stream {
+  public:
+    size_t write(uint8_t data) override {
+        (void)data;
+        return 1;
+    }
+    int peek() override { return toRead.empty() ? -1 : toRead.front(); }
+    int read() override {
+        int retval = peek();
+        if (!toRead.empty())
+            toRead.pop();
+        return retval;
+    }
+    int available() override { return toRead.size(); }
+
+    void pushCC(uint8_t controller, uint8_t value) {
+        toRead.push(0xB0);
+        toRead.push(controller);
+        toRead.push(value);
+    }
+
+    std::queue<uint8_t> toRead;
+};
+
+/// Records the incoming messages, and the time at which they were handled.
+/// Handling a message takes 50 µs of simulated time.
+class RecordingCallbacks : public MIDI_Callbacks {
+  public:
+    constexpr static unsigned long messageTime = 50;
+
+    RecordingCallbacks(unsigned long &now) : now(now) {}
+
+    void onChannelMessage(Parsing_MIDI_Interface &midi) override {
+        now += messageTime;
+        auto msg = midi.getChannelMessage();
+        received.push_back({&midi, msg.data1, msg.data2, now});
+    }
+
+    struct Message {
+        Parsing_MIDI_Interface *midi;
+        uint8_t data1;
+        uint8_t data2;
+        unsigned long time;
+    };
+    unsigned long &now;
+    std::vector<Message> received;
+
+    /// Get the messages that were received on the given interface.
+    std::vector<Message> from(const Parsing_MIDI_Interface &midi) const {
+        std::vector<Message> result;
+        for (auto &message : received)
+            if (message.midi == &midi)
+                result.push_back(message);
+        return result;
+    }
+};
+
+constexpr unsigned long RecordingCallbacks::messageTime;
+
+class MIDI_InterfaceUpdateBudget : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        EXPECT_CALL(ArduinoMock::getInstance(), micros())
+            .WillRepeatedly(Invoke([this] { return now; }));
+    }
+    void TearDown() override {
+        Mock::VerifyAndClear(&ArduinoMock::getInstance());
+    }
+    unsigned long now = 1000000;
+};
+
+/// One interface is flooded with messages, while two other interfaces
+/// receive a few notes at the same time. The interfaces share a budget of
+/// 1 ms per loop.
+TEST_F(MIDI_InterfaceUpdateBudget, roundRobinBoundedLatencyNoLoss) {
+    RecordingCallbacks callbacks = now;
+    InputStream floodStream, streamB, streamC;
+    StreamMIDI_Interface flood = floodStream, midiB = streamB, midiC = streamC;
+    for (auto *midi : {&flood, &midiB, &midiC})
+        midi->setCallbacks(callbacks);
+
+    const unsigned numFlood = 300;
+    for (unsigned i = 0; i < numFlood; ++i)
+        floodStream.pushCC(i % 128, i / 128);
+    for (uint8_t i = 0; i < 3; ++i) {
+        streamB.pushCC(0x10, i);
+        streamC.pushCC(0x20, i);
+    }
+
+    AH::WorkBudget budget = {0, 1000};
+    unsigned loops = 0;
+    unsigned long firstLoopEnd = 0;
+    while (callbacks.received.size() < numFlood + 6) {
+        unsigned long start = now;
+        MIDI_Interface::updateAllWithBudget(budget);
+        // Never more than one message over the budget
+        EXPECT_LE(now - start, 1000 + RecordingCallbacks::messageTime);
+        if (loops++ == 0)
+            firstLoopEnd = now;
+        ASSERT_LT(loops, 100u);
+        now += 500; // rest of the main loop
+    }
+    // The flood doesn't delay the messages on the other interfaces
+    for (auto *midi : {&midiB, &midiC}) {
+        auto messages = callbacks.from(*midi);
+        ASSERT_EQ(messages.size(), 3u);
+        for (uint8_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(messages[i].data2, i);
+            EXPECT_LE(messages[i].time, firstLoopEnd);
+        }
+    }
+    // All messages of the flood arrive, in order
+    auto messages = callbacks.from(flood);
+    ASSERT_EQ(messages.size(), numFlood);
+    for (unsigned i = 0; i < numFlood; ++i) {
+        EXPECT_EQ(messages[i].data1, i % 128);
+        EXPECT_EQ(messages[i].data2, i / 128);
+    }
+    EXPECT_GT(loops, numFlood / (1000 / RecordingCallbacks::messageTime));
+    EXPECT_TRUE(floodStream.toRead.empty());
+
+    // Nothing left to do
+    callbacks.received.clear();
+    MIDI_Interface::updateAllWithBudget(budget);
+    EXPECT_TRUE(callbacks.received.empty());
+}
+
+/// When the budget runs out, the next interface goes first in the next loop.
+TEST_F(MIDI_InterfaceUpdateBudget, roundRobinRotation) {
+    RecordingCallbacks callbacks = now;
+    InputStream streamA, streamB;
+    StreamMIDI_Interface midiA = streamA, midiB = streamB;
+    midiA.setCallbacks(callbacks);
+    midiB.setCallbacks(callbacks);
+    for (uint8_t i = 0; i < 10; ++i) {
+        streamA.pushCC(0x01, i);
+        streamB.pushCC(0x02, i);
+    }
+
+    AH::WorkBudget budget = 3;
+    for (int i = 0; i < 4; ++i)
+        MIDI_Interface::updateAllWithBudget(budget);
+    ASSERT_EQ(callbacks.received.size(), 12u);
+    EXPECT_EQ(callbacks.from(midiA).size(), 6u);
+    EXPECT_EQ(callbacks.from(midiB).size(), 6u);
+    for (size_t i = 1; i < callbacks.received.size(); ++i)
+        EXPECT_NE(callbacks.received[i].midi, callbacks.received[i - 1].midi);
+}
+
+TEST_F(MIDI_InterfaceUpdateBudget, maxMessagesPerUpdate) {
+    RecordingCallbacks callbacks = now;
+    InputStream stream;
+    StreamMIDI_Interface midi = stream;
+    midi.setCallbacks(callbacks);
+    midi.setUpdateLimits(5, 0);
+    EXPECT_EQ(midi.getMaxMessagesPerUpdate(), 5);
+    EXPECT_EQ(midi.getMaxMicrosPerUpdate(), 0ul);
+    for (uint8_t i = 0; i < 12; ++i)
+        stream.pushCC(0x01, i);
+
+    for (size_t expected : {5u, 10u, 12u, 12u}) {
+        midi.update();
+        EXPECT_EQ(callbacks.received.size(), expected);
+    }
+    for (uint8_t i = 0; i < 12; ++i)
+        EXPECT_EQ(callbacks.received[i].data2, i);
+}
+
+TEST_F(MIDI_InterfaceUpdateBudget, maxMicrosPerUpdate) {
+    RecordingCallbacks callbacks = now;
+    InputStream stream;
+    StreamMIDI_Interface midi = stream;
+    midi.setCallbacks(callbacks);
+    midi.setUpdateLimits(0, 200);
+    for (uint8_t i = 0; i < 10; ++i)
+        stream.pushCC(0x01, i);
+
+    for (size_t expected : {4u, 8u, 10u}) {
+        midi.update();
+        EXPECT_EQ(callbacks.received.size(), expected);
+    }
+}
+
+/// The limits of an interface also apply when all interfaces are updated.
+TEST_F(MIDI_InterfaceUpdateBudget, perInterfaceLimitsInUpdateAll) {
+    RecordingCallbacks callbacks = now;
+    InputStream streamA, streamB;
+    StreamMIDI_Interface midiA = streamA, midiB = streamB;
+    midiA.setCallbacks(callbacks);
+    midiB.setCallbacks(callbacks);
+    midiA.setUpdateLimits(2, 0);
+    for (uint8_t i = 0; i < 6; ++i) {
+        streamA.pushCC(0x01, i);
+        streamB.pushCC(0x02, i);
+    }
+
+    AH::WorkBudget unlimited;
+    MIDI_Interface::updateAllWithBudget(unlimited);
+    EXPECT_EQ(callbacks.from(midiA).size(), 2u);
+    EXPECT_EQ(callbacks.from(midiB).size(), 6u);
+    MIDI_Interface::updateAllWithBudget(unlimited);
+    EXPECT_EQ(callbacks.from(midiA).size(), 4u);
+}
+
+/// Counts the number of times its housekeeping is done.
+class HousekeepingMIDI_Interface : public StreamMIDI_Interface {
+  public:
+    using StreamMIDI_Interface::StreamMIDI_Interface;
+    unsigned housekeeping = 0;
+
+  protected:
+    void updateHousekeeping() override {
+        ++housekeeping;
+        StreamMIDI_Interface::updateHousekeeping();
+    }
+};
+
+/// The housekeeping is done once per interface per loop, not once for every
+/// message that is read.
+TEST_F(MIDI_InterfaceUpdateBudget, housekeepingOncePerLoop) {
+    RecordingCallbacks callbacks = now;
+    InputStream streamA, streamB;
+    HousekeepingMIDI_Interface midiA = streamA, midiB = streamB;
+    midiA.setCallbacks(callbacks);
+    midiB.setCallbacks(callbacks);
+    for (uint8_t i = 0; i < 5; ++i)
+        streamA.pushCC(0x01, i);
+
+    AH::WorkBudget unlimited;
+    MIDI_Interface::updateAllWithBudget(unlimited);
+    EXPECT_EQ(callbacks.from(midiA).size(), 5u);
+    EXPECT_EQ(midiA.housekeeping, 1u);
+    EXPECT_EQ(midiB.housekeeping, 1u);
+    MIDI_Interface::updateAllWithBudget(unlimited);
+    EXPECT_EQ(midiA.housekeeping, 2u);
+    EXPECT_EQ(midiB.housekeeping, 2u);
+    midiA.update();
+    EXPECT_EQ(midiA.housekeeping, 3u);
+}
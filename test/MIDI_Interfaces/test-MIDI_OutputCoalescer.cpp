@@ -0,0 +1,306 @@
+#include <LimitedStream.hpp>
+#include <MIDI_Interfaces/MIDI_OutputCoalescer.hpp>
+#include <MIDI_Interfaces/SerialMIDI_Interface.hpp>
+#include <gmock-wrapper.h>
+#include <gtest-wrapper.h>
+
+#include <algorithm>
+
+USING_CS_NAMESPACE;
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+/// Stream that doesn't implement availableForWrite.
+class UnknownStream : public Stream {
+  public:
+    size_t write(uint8_t data) override {
+        sent.push_back(data);
+        return 1;
+    }
+    int peek() override { return -1; }
+    int read() override { return -1; }
+    int available() override { return 0; }
+    std::vector<uint8_t> sent;
+};
+
+/// A fader that moves from 0 to 127 in 25.4 ms. The main loop takes 100 µs,
+/// and sends the position of the fader whenever it changed, to a serial MIDI
+/// interface with a transmit buffer of 64 bytes.
+struct FaderScenario {
+    constexpr static unsigned long loopTime = 100;
+    constexpr static unsigned long stepTime = 200;
+    constexpr static unsigned long endOfMovement = 127 * stepTime;
+
+    FaderScenario(MIDI_OutputCoalescerBase *coalescer)
+        : stream(now, 64), midi(stream) {
+        midi.setOutputCoalescer(coalescer);
+        uint8_t previous = 0xFF;
+        while (true) {
+            unsigned long start = now;
+            uint8_t position = std::min(now / stepTime, 127ul);
+            if (position != previous)
+                midi.sendCC({0x07, CHANNEL_1}, position);
+            previous = position;
+            MIDI_Interface::flushAll();
+            maxLoopTime = std::max(maxLoopTime, now - start);
+            now += loopTime;
+            if (position == 127 && (!coalescer || coalescer->isEmpty()) &&
+                stream.isIdle())
+                break;
+        }
+    }
+
+    /// The values of the messages on the wire.
+    std::vector<uint8_t> getValues() const {
+        std::vector<uint8_t> values;
+        auto data = stream.getWireData();
+        for (size_t i = 0; i < data.size(); i += 3) {
+            EXPECT_EQ(data[i], 0xB0);
+            EXPECT_EQ(data[i + 1], 0x07);
+            values.push_back(data[i + 2]);
+        }
+        return values;
+    }
+    /// The time between the moment the fader reached its final position and
+    /// the moment that position arrived at the receiver.
+    unsigned long getFinalLatency() const {
+        return stream.wire.back().doneTime - endOfMovement;
+    }
+
+    unsigned long now = 0;
+    unsigned long maxLoopTime = 0;
+    LimitedStream stream;
+    StreamMIDI_Interface midi;
+};
+
+constexpr unsigned long FaderScenario::endOfMovement;
+
+TEST(MIDI_OutputCoalescer, faderWithoutCoalescing) {
+    FaderScenario fader{nullptr};
+    auto values = fader.getValues();
+    EXPECT_EQ(values.back(), 127);
+    // Once the transmit buffer is full, the main loop is blocked by every
+    // message, and the receiver gets the position of 20 ms ago.
+    EXPECT_GE(fader.maxLoopTime, 2 * LimitedStream::byteTime);
+    EXPECT_GT(fader.stream.blockedTime, 15000ul);
+    EXPECT_GT(fader.getFinalLatency(), 20000ul);
+}
+
+TEST(MIDI_OutputCoalescer, faderWithCoalescing) {
+    MIDI_OutputCoalescer<4> coalescer;
+    FaderScenario fader{&coalescer};
+    auto values = fader.getValues();
+    // The values on the wire are always increasing, and the final value is
+    // sent as soon as the transmit buffer has room for it.
+    EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+    EXPECT_EQ(values.back(), 127);
+    EXPECT_LE(fader.getFinalLatency(), (64 + 3) * LimitedStream::byteTime);
+    // The main loop is never blocked
+    EXPECT_EQ(fader.stream.blockedTime, 0ul);
+    EXPECT_EQ(fader.maxLoopTime, 0ul);
+    EXPECT_EQ(coalescer.getCoalescedCount(), 128 - values.size());
+    EXPECT_LT(values.size(), 128u);
+}
+
+TEST(MIDI_OutputCoalescer, order) {
+    unsigned long now = 0;
+    LimitedStream stream{now, 3};
+    StreamMIDI_Interface midi = stream;
+    MIDI_OutputCoalescer<8> coalescer;
+    midi.setOutputCoalescer(coalescer);
+
+    midi.sendCC({0x07, CHANNEL_1}, 0x01); // sent immediately, buffer full
+    midi.sendCC({0x07, CHANNEL_2}, 0x02); // queued
+    midi.sendPB(CHANNEL_1, 0x1234);       // queued
+    midi.sendCC({0x07, CHANNEL_1}, 0x03); // queued
+    midi.sendCC({0x07, CHANNEL_2}, 0x04); // replaces 0x02
+    midi.sendPB(CHANNEL_1, 0x0567);       // replaces 0x1234
+    EXPECT_EQ(stream.blockedTime, 0ul);
+    // Other messages send the pending ones first, so they don't overtake them
+    midi.sendNoteOn({0x3C, CHANNEL_1}, 0x7F);
+    EXPECT_TRUE(coalescer.isEmpty());
+    midi.sendCC({0x06, CHANNEL_1}, 0x09); // Data Entry, never delayed
+    EXPECT_EQ(stream.blockedTime, 5 * 960ul);
+    midi.sendCP(CHANNEL_3, 0x10);               // queued
+    midi.sendCP(CHANNEL_3, 0x20);               // replaces 0x10
+    midi.sendKP({0x3C, CHANNEL_1}, 0x01);       // queued
+    midi.sendKP({0x3D, CHANNEL_1}, 0x02);       // different note, queued
+    midi.sendCC({0x07, CHANNEL_1, CABLE_2}, 5); // different cable, queued
+
+    EXPECT_EQ(coalescer.getNumberOfPending(), 4);
+    EXPECT_EQ(coalescer.getCoalescedCount(), 3ul);
+
+    while (!coalescer.isEmpty()) {
+        now += 100;
+        midi.sendCoalescedOutput();
+    }
+    EXPECT_EQ(stream.blockedTime, 5 * 960ul);
+    while (!stream.isIdle())
+        now += 100;
+    EXPECT_THAT(stream.getWireData(), ElementsAreArray({
+                                          0xB0, 0x07, 0x01, //
+                                          0xB1, 0x07, 0x04, //
+                                          0xE0, 0x67, 0x0A, //
+                                          0xB0, 0x07, 0x03, //
+                                          0x90, 0x3C, 0x7F, //
+                                          0xB0, 0x06, 0x09, //
+                                          0xD2, 0x20,       //
+                                          0xA0, 0x3C, 0x01, //
+                                          0xA0, 0x3D, 0x02, //
+                                          0xB0, 0x07, 0x05, //
+                                      }));
+}
+
+/// A note that is played while the sustain pedal is down must arrive after
+/// the pedal message, even if controllers are pending.
+TEST(MIDI_OutputCoalescer, sustainPedal) {
+    unsigned long now = 0;
+    LimitedStream stream{now, 3};
+    StreamMIDI_Interface midi = stream;
+    MIDI_OutputCoalescer<8> coalescer;
+    midi.setOutputCoalescer(coalescer);
+
+    midi.sendCC({0x07, CHANNEL_1}, 0x01); // sent immediately, buffer full
+    midi.sendCC({0x07, CHANNEL_1}, 0x02); // queued
+    midi.sendCC({0x40, CHANNEL_1}, 0x7F); // sustain on, never queued
+    midi.sendNoteOn({0x3C, CHANNEL_1}, 0x7F);
+    midi.sendNoteOff({0x3C, CHANNEL_1}, 0x7F);
+    midi.sendCC({0x40, CHANNEL_1}, 0x00); // sustain off
+    EXPECT_EQ(coalescer.getCoalescedCount(), 0ul);
+    EXPECT_THAT(stream.getWire(), ElementsAreArray({
+                                      0xB0, 0x07, 0x01, //
+                                      0xB0, 0x07, 0x02, //
+                                      0xB0, 0x40, 0x7F, //
+                                      0x90, 0x3C, 0x7F, //
+                                      0x80, 0x3C, 0x7F, //
+                                      0xB0, 0x40, 0x00, //
+                                  }));
+}
+
+/// Every step of a relative encoder has to be sent, so its controller can be
+/// excluded from coalescing.
+TEST(MIDI_OutputCoalescer, excludedRelativeController) {
+    unsigned long now = 0;
+    LimitedStream stream{now, 3};
+    StreamMIDI_Interface midi = stream;
+    MIDI_OutputCoalescer<8> coalescer;
+    coalescer.excludeControllers(0x10, 0x17);
+    midi.setOutputCoalescer(coalescer);
+
+    midi.sendCC({0x07, CHANNEL_1}, 0x01); // sent immediately, buffer full
+    midi.sendCC({0x08, CHANNEL_1}, 0x01); // queued
+    midi.sendCC({0x10, CHANNEL_1}, 0x01); // +1, sends the pending CC first
+    midi.sendCC({0x10, CHANNEL_1}, 0x01); // +1
+    midi.sendCC({0x17, CHANNEL_1}, 0x41); // -1
+    midi.sendCC({0x17, CHANNEL_1}, 0x41); // -1
+    EXPECT_EQ(coalescer.getCoalescedCount(), 0ul);
+    EXPECT_THAT(stream.getWire(), ElementsAreArray({
+                                      0xB0, 0x07, 0x01, //
+                                      0xB0, 0x08, 0x01, //
+                                      0xB0, 0x10, 0x01, //
+                                      0xB0, 0x10, 0x01, //
+                                      0xB0, 0x17, 0x41, //
+                                      0xB0, 0x17, 0x41, //
+                                  }));
+}
+
+/// System Exclusive messages don't overtake the pending messages, Real-Time
+/// messages do.
+TEST(MIDI_OutputCoalescer, sysExAndRealTime) {
+    unsigned long now = 0;
+    LimitedStream stream{now, 3};
+    StreamMIDI_Interface midi = stream;
+    MIDI_OutputCoalescer<8> coalescer;
+    midi.setOutputCoalescer(coalescer);
+
+    midi.sendCC({0x07, CHANNEL_1}, 0x01); // sent immediately, buffer full
+    midi.sendCC({0x07, CHANNEL_1}, 0x02); // queued
+    midi.send(MIDIMessageType::TIMING_CLOCK);
+    EXPECT_EQ(coalescer.getNumberOfPending(), 1);
+    const uint8_t sysex[] = {0xF0, 0x12, 0xF7};
+    midi.send(sysex);
+    EXPECT_TRUE(coalescer.isEmpty());
+    EXPECT_THAT(stream.getWire(), ElementsAreArray({
+                                      0xB0, 0x07, 0x01, //
+                                      0xF8,             //
+                                      0xB0, 0x07, 0x02, //
+                                      0xF0, 0x12, 0xF7, //
+                                  }));
+}
+
+TEST(MIDI_OutputCoalescer, full) {
+    unsigned long now = 0;
+    LimitedStream stream{now, 3};
+    StreamMIDI_Interface midi = stream;
+    MIDI_OutputCoalescer<2> coalescer;
+    midi.setOutputCoalescer(coalescer);
+
+    midi.sendCC({0x01, CHANNEL_1}, 0x01); // sent immediately
+    midi.sendCC({0x02, CHANNEL_1}, 0x02); // queued
+    midi.sendCC({0x03, CHANNEL_1}, 0x03); // queued
+    midi.sendCC({0x04, CHANNEL_1}, 0x04); // queue full, sent immediately
+    EXPECT_EQ(stream.blockedTime, 960ul);
+    midi.sendCC({0x02, CHANNEL_1}, 0x12); // replaces 0x02
+
+    midi.setOutputCoalescer(nullptr); // sends the pending messages
+    EXPECT_EQ(coalescer.getNumberOfPending(), 0);
+    midi.sendCC({0x02, CHANNEL_1}, 0x22); // sent immediately
+    while (!stream.isIdle())
+        now += 100;
+    EXPECT_THAT(stream.getWireData(), ElementsAreArray({
+                                          0xB0, 0x01, 0x01, //
+                                          0xB0, 0x04, 0x04, //
+                                          0xB0, 0x02, 0x12, //
+                                          0xB0, 0x03, 0x03, //
+                                          0xB0, 0x02, 0x22, //
+                                      }));
+}
+
+/// If the stream doesn't implement availableForWrite, messages are never
+/// delayed.
+TEST(MIDI_OutputCoalescer, unknownAvailableForWrite) {
+    UnknownStream stream;
+    StreamMIDI_Interface midi = stream;
+    MIDI_OutputCoalescer<4> coalescer;
+    midi.setOutputCoalescer(coalescer);
+
+    midi.sendCC({0x07, CHANNEL_1}, 0x01);
+    midi.sendCC({0x07, CHANNEL_1}, 0x02);
+    EXPECT_THAT(stream.sent, ElementsAre(0xB0, 0x07, 0x01, 0xB0, 0x07, 0x02));
+    EXPECT_TRUE(coalescer.isEmpty());
+}
+
+TEST(MIDI_OutputCoalescer, isCoalescable) {
+    EXPECT_TRUE(MIDI_OutputCoalescerBase::isCoalescable(
+        {MIDIMessageType::CONTROL_CHANGE, CHANNEL_1, 0x07, 0x00}));
+    EXPECT_TRUE(MIDI_OutputCoalescerBase::isCoalescable(
+        {MIDIMessageType::PITCH_BEND, CHANNEL_1, 0x00, 0x40}));
+    EXPECT_TRUE(MIDI_OutputCoalescerBase::isCoalescable(
+        {MIDIMessageType::CHANNEL_PRESSURE, CHANNEL_1, 0x00}));
+    EXPECT_TRUE(MIDI_OutputCoalescerBase::isCoalescable(
+        {MIDIMessageType::KEY_PRESSURE, CHANNEL_1, 0x3C, 0x00}));
+    for (uint8_t cc : {0x00, 0x06, 0x20, 0x26, 0x40, 0x42, 0x45, 0x60, 0x63,
+                       0x65, 0x78, 0x7B})
+        EXPECT_FALSE(MIDI_OutputCoalescerBase::isCoalescable(
+            {MIDIMessageType::CONTROL_CHANGE, CHANNEL_1, cc, 0x00}))
+            << +cc;
+    EXPECT_FALSE(MIDI_OutputCoalescerBase::isCoalescable(
+        {MIDIMessageType::NOTE_ON, CHANNEL_1, 0x3C, 0x7F}));
+    EXPECT_FALSE(MIDI_OutputCoalescerBase::isCoalescable(
+        {MIDIMessageType::PROGRAM_CHANGE, CHANNEL_1, 0x01}));
+}
+
+TEST(MIDI_OutputCoalescer, shouldCoalesce) {
+    MIDI_OutputCoalescer<1> coalescer;
+    coalescer.excludeController(0x10);
+    EXPECT_FALSE(coalescer.shouldCoalesce(
+        {MIDIMessageType::CONTROL_CHANGE, CHANNEL_1, 0x10, 0x01}));
+    EXPECT_TRUE(coalescer.shouldCoalesce(
+        {MIDIMessageType::CONTROL_CHANGE, CHANNEL_1, 0x11, 0x01}));
+    // Only the controllers of Control Change messages are excluded
+    EXPECT_TRUE(coalescer.shouldCoalesce(
+        {MIDIMessageType::KEY_PRESSURE, CHANNEL_1, 0x10, 0x01}));
+    coalescer.includeController(0x10);
+    EXPECT_TRUE(coalescer.shouldCoalesce(
+        {MIDIMessageType::CONTROL_CHANGE, CHANNEL_1, 0x10, 0x01}));
+}
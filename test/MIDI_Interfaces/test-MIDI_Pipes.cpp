@@ -1283,6 +1283,7 @@ TEST(MIDI_Pipes, USBInterfaceLoopBack) {
         .WillOnce(Return(Packet_t{}));
 
     EXPECT_CALL(midi, writeUSBPacket(0x9, 0x9, 0x95, 0x55, 0x66));
+    EXPECT_CALL(midi, flushUSB());
     midi.update();
 }
 
@@ -1614,4 +1615,204 @@ TEST(MIDI_Pipes, disconnectSinkFromSource) {
         ASSERT_EQ(pipes[2].getInitialSource(), //
                   nullptr);
     }
-}
\ No newline at end of file
+}
+// -------------------------------------------------------------------------- //
+
+TEST(MIDI_RoutingTable, sourceX2PipeSinkX2) {
+    StrictMock<MockMIDI_Sink> sink1, sink2;
+    MIDI_Pipe pipe1, pipe3, pipe4;
+    TrueMIDI_Source source1, source2;
+
+    struct CustomPipe : MIDI_Pipe {
+        void mapForwardMIDI(ChannelMessage msg) override {
+            msg.setChannel(CHANNEL_8);
+            sourceMIDItoSink(msg);
+        }
+    } pipe2;
+
+    source1 >> pipe1 >> sink1;
+    source1 >> pipe2 >> sink2;
+    source2 >> pipe3 >> sink1;
+    source2 >> pipe4 >> sink2;
+
+    MIDI_RoutingTable<2, 4> routes;
+    EXPECT_TRUE(routes.freeze(source1, source2));
+    EXPECT_TRUE(source1.isFrozen());
+    EXPECT_TRUE(source2.isFrozen());
+    EXPECT_EQ(routes.getNumberOfSources(), 2);
+    EXPECT_EQ(routes.getNumberOfPipes(), 4);
+
+    ChannelMessage msg{0x93, 0x10, 0x7F, 5};
+    ChannelMessage mapped{0x97, 0x10, 0x7F, 5};
+    {
+        ::testing::InSequence seq;
+        EXPECT_CALL(sink2, sinkMIDIfromPipe(mapped));
+        EXPECT_CALL(sink1, sinkMIDIfromPipe(msg));
+    }
+    source1.sourceMIDItoPipe(msg);
+    ::testing::Mock::VerifyAndClear(&sink1);
+    ::testing::Mock::VerifyAndClear(&sink2);
+
+    {
+        ::testing::InSequence seq;
+        EXPECT_CALL(sink2, sinkMIDIfromPipe(msg));
+        EXPECT_CALL(sink1, sinkMIDIfromPipe(msg));
+    }
+    source2.sourceMIDItoPipe(msg);
+    ::testing::Mock::VerifyAndClear(&sink1);
+    ::testing::Mock::VerifyAndClear(&sink2);
+}
+
+TEST(MIDI_RoutingTable, exclusive) {
+    StrictMock<MockMIDI_Sink> sinks[2];
+    MIDI_PipeFactory<6> pipes;
+    TrueMIDI_Source sources[4];
+
+    sources[1] >> pipes >> sinks[1];
+    sources[1] >> pipes >> sinks[0];
+    sources[0] >> pipes >> sinks[0];
+    sources[2] >> pipes >> sinks[1];
+    sources[3] >> pipes >> sinks[1];
+
+    MIDI_RoutingTable<4, 5> routes;
+    routes.freeze(sources[0], sources[1], sources[2], sources[3]);
+
+    using A = std::vector<bool>;
+    auto canWrite = [&](cn_t cn) {
+        A result;
+        for (auto &source : sources)
+            result.push_back(source.canWrite(cn));
+        return result;
+    };
+
+    EXPECT_EQ(canWrite(0xC), (A{true, true, true, true}));
+    sources[3].exclusive(0xC);
+    EXPECT_EQ(canWrite(0xC), (A{true, false, false, true}));
+    EXPECT_EQ(canWrite(0xB), (A{true, true, true, true}));
+    sources[3].exclusive(0xC, false);
+    EXPECT_EQ(canWrite(0xC), (A{true, true, true, true}));
+    sources[0].exclusive(0xC);
+    EXPECT_EQ(canWrite(0xC), (A{true, false, true, true}));
+    sources[0].exclusive(0xC, false);
+    EXPECT_EQ(canWrite(0xC), (A{true, true, true, true}));
+    EXPECT_TRUE(sources[0].isFrozen());
+}
+
+TEST(MIDI_RoutingTable, thawOnConnect) {
+    StrictMock<MockMIDI_Sink> sink1, sink2;
+    MIDI_Pipe pipe1, pipe2;
+    TrueMIDI_Source source;
+
+    source >> pipe1 >> sink1;
+    MIDI_RoutingTable<1, 2> routes;
+    routes.freeze(source);
+    EXPECT_TRUE(source.isFrozen());
+
+    source >> pipe2 >> sink2;
+    EXPECT_FALSE(source.isFrozen());
+    EXPECT_EQ(routes.getNumberOfSources(), 0);
+
+    RealTimeMessage msg = {0xFF, 3};
+    EXPECT_CALL(sink1, sinkMIDIfromPipe(msg));
+    EXPECT_CALL(sink2, sinkMIDIfromPipe(msg));
+    source.sourceMIDItoPipe(msg);
+    ::testing::Mock::VerifyAndClear(&sink1);
+    ::testing::Mock::VerifyAndClear(&sink2);
+
+    routes.freeze(source);
+    pipe1.disconnect();
+    EXPECT_FALSE(source.isFrozen());
+    EXPECT_CALL(sink2, sinkMIDIfromPipe(msg));
+    source.sourceMIDItoPipe(msg);
+}
+
+TEST(MIDI_RoutingTable, thawOnDestruction) {
+    MIDI_RoutingTable<2, 2> routes;
+    TrueMIDI_Source source1;
+    {
+        TrueMIDI_Source source2;
+        routes.freeze(source1, source2);
+        EXPECT_EQ(routes.getNumberOfSources(), 2);
+    }
+    EXPECT_EQ(routes.getNumberOfSources(), 0);
+    EXPECT_FALSE(source1.isFrozen());
+
+    {
+        MIDI_RoutingTable<1, 1> routes2;
+        routes2.freeze(source1);
+        EXPECT_TRUE(source1.isFrozen());
+    }
+    EXPECT_FALSE(source1.isFrozen());
+}
+
+TEST(MIDI_RoutingTable, errors) {
+    DummyMIDI_Sink sink;
+    MIDI_Pipe pipe1, pipe2;
+    TrueMIDI_Source source1, source2, source3;
+    source1 >> pipe1 >> sink;
+    source1 >> pipe2 >> sink;
+
+    MIDI_RoutingTable<2, 1> routes;
+    try {
+        routes.freeze(source1);
+        FAIL();
+    } catch (AH::ErrorException &e) {
+        EXPECT_EQ(e.getErrorCode(), 0x914A);
+    }
+    EXPECT_FALSE(source1.isFrozen());
+    EXPECT_EQ(routes.getNumberOfPipes(), 0);
+
+    routes.freeze(source2, source3);
+    try {
+        routes.freeze(source1);
+        FAIL();
+    } catch (AH::ErrorException &e) {
+        EXPECT_EQ(e.getErrorCode(), 0x9149);
+    }
+    try {
+        routes.freeze(source2);
+        FAIL();
+    } catch (AH::ErrorException &e) {
+        EXPECT_EQ(e.getErrorCode(), 0x9148);
+    }
+}
+
+/// Sink+source that counts the number of messages it receives.
+struct CountingMIDI_SinkSource : TrueMIDI_SinkSource {
+    void sinkMIDIfromPipe(ChannelMessage) override { ++count; }
+    void sinkMIDIfromPipe(SysExMessage) override { ++count; }
+    void sinkMIDIfromPipe(RealTimeMessage) override { ++count; }
+    unsigned long count = 0;
+};
+
+/// Every message sent by one of the interfaces of a full mesh arrives at each
+/// of the three others, both through the pipes and through a frozen routing
+/// table. (The timing of this workload is in bench-MIDI_Pipes.cpp.)
+TEST(MIDI_RoutingTable, fullMesh) {
+    CountingMIDI_SinkSource interfaces[4];
+    BidirectionalMIDI_PipeFactory<6> pipes;
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = i + 1; j < 4; ++j)
+            interfaces[i] | pipes | interfaces[j];
+
+    constexpr unsigned long N = 10;
+    auto run = [&] {
+        for (unsigned long n = 0; n < N; ++n) {
+            for (auto &interface : interfaces) {
+                ChannelMessage msg{0x90, uint8_t(n & 0x7F), 0x7F, 0};
+                if (interface.canWrite(msg.CN))
+                    interface.sourceMIDItoPipe(msg);
+            }
+        }
+    };
+
+    run();
+    for (auto &interface : interfaces)
+        EXPECT_EQ(interface.count, 3 * N);
+
+    MIDI_RoutingTable<4, 12> routes;
+    routes.freeze(interfaces[0], interfaces[1], interfaces[2], interfaces[3]);
+    run();
+    for (auto &interface : interfaces)
+        EXPECT_EQ(interface.count, 2 * 3 * N);
+}
@@ -0,0 +1,305 @@
+#include <LimitedStream.hpp>
+#include <MIDI_Interfaces/SerialMIDI_Interface.hpp>
+#include <gmock-wrapper.h>
+#include <gtest-wrapper.h>
+
+USING_CS_NAMESPACE;
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+TEST(MIDI_TransmitQueue, messageLength) {
+    EXPECT_EQ(MIDI_TransmitQueueBase::getMessageLength(0x90), 3);
+    EXPECT_EQ(MIDI_TransmitQueueBase::getMessageLength(0xB5), 3);
+    EXPECT_EQ(MIDI_TransmitQueueBase::getMessageLength(0xC0), 2);
+    EXPECT_EQ(MIDI_TransmitQueueBase::getMessageLength(0xDF), 2);
+    EXPECT_EQ(MIDI_TransmitQueueBase::getMessageLength(0xEF), 3);
+    EXPECT_EQ(MIDI_TransmitQueueBase::getMessageLength(0xF1), 2);
+    EXPECT_EQ(MIDI_TransmitQueueBase::getMessageLength(0xF2), 3);
+    EXPECT_EQ(MIDI_TransmitQueueBase::getMessageLength(0xF6), 1);
+    EXPECT_EQ(MIDI_TransmitQueueBase::getMessageLength(0xF8), 1);
+}
+
+TEST(MIDI_TransmitQueue, wrapAround) {
+    MIDI_TransmitQueue<7> queue;
+    const uint8_t cc[] = {0xB0, 0x07, 0x01};
+    const uint8_t pc[] = {0xC0, 0x05};
+    const uint8_t rt[] = {0xF8};
+    EXPECT_TRUE(queue.push(cc, 3));
+    EXPECT_TRUE(queue.push(pc, 2));
+    EXPECT_TRUE(queue.push(rt, 1));
+    EXPECT_FALSE(queue.push(pc, 2));
+    EXPECT_EQ(queue.getNumberOfBytes(), 6);
+    queue.pop();
+    EXPECT_TRUE(queue.push(cc, 3)); // wraps around
+    uint8_t message[3];
+    EXPECT_EQ(queue.copyFront(message), 2);
+    EXPECT_THAT(message, testing::ElementsAre(0xC0, 0x05, testing::_));
+    queue.pop();
+    EXPECT_EQ(queue.copyFront(message), 1);
+    EXPECT_EQ(message[0], 0xF8);
+    queue.pop();
+    EXPECT_TRUE(queue.replace({0xB0, 0x07, 0x7F, 0}));
+    EXPECT_EQ(queue.copyFront(message), 3);
+    EXPECT_THAT(message, ElementsAre(0xB0, 0x07, 0x7F));
+    queue.pop();
+    EXPECT_TRUE(queue.isEmpty());
+}
+
+/// Sending a burst of messages doesn't block, the queue is written to the
+/// Stream as its buffer empties, when the interface is updated.
+TEST(MIDI_TransmitQueue, nonBlocking) {
+    LimitedStream stream = 6;
+    StreamMIDI_Interface midi = stream;
+    MIDI_TransmitQueue<32> queue;
+    midi.setTransmitQueue(queue);
+
+    std::vector<uint8_t> expected;
+    for (uint8_t i = 0; i < 10; ++i) {
+        midi.sendCC({i, CHANNEL_1}, i);
+        expected.insert(expected.end(), {0xB0, i, i});
+    }
+    EXPECT_EQ(stream.blockingWrites, 0u);
+    EXPECT_EQ(stream.buffer.size(), 6u);
+    EXPECT_EQ(queue.getNumberOfBytes(), 24);
+    EXPECT_TRUE(midi.canSendWithoutBlocking(8));  // fits in the queue
+    EXPECT_FALSE(midi.canSendWithoutBlocking(9)); // doesn't
+
+    stream.transmit(4);
+    midi.update(); // only one message fits
+    EXPECT_EQ(stream.buffer.size(), 5u);
+    while (!queue.isEmpty()) {
+        stream.transmit(3);
+        midi.update();
+    }
+    EXPECT_EQ(stream.blockingWrites, 0u);
+    EXPECT_THAT(stream.getWire(), ElementsAreArray(expected));
+    EXPECT_TRUE(midi.canSendWithoutBlocking(6));
+    EXPECT_FALSE(midi.canSendWithoutBlocking(7));
+}
+
+TEST(MIDI_TransmitQueue, flush) {
+    LimitedStream stream = 3;
+    StreamMIDI_Interface midi = stream;
+    MIDI_TransmitQueue<32> queue;
+    midi.setTransmitQueue(queue);
+    midi.sendNoteOn({0x3C, CHANNEL_1}, 0x7F);
+    midi.sendNoteOn({0x3D, CHANNEL_1}, 0x7F);
+    stream.transmit(3);
+    MIDI_Interface::flushAll();
+    EXPECT_TRUE(queue.isEmpty());
+    EXPECT_THAT(stream.getWire(),
+                ElementsAre(0x90, 0x3C, 0x7F, 0x90, 0x3D, 0x7F));
+}
+
+TEST(MIDI_TransmitQueue, overflowBlock) {
+    LimitedStream stream = 3;
+    StreamMIDI_Interface midi = stream;
+    MIDI_TransmitQueue<6> queue{TransmitOverflowPolicy::Block};
+    midi.setTransmitQueue(queue);
+    midi.sendCC({0x01, CHANNEL_1}, 0x01); // written to the Stream
+    midi.sendCC({0x02, CHANNEL_1}, 0x02); // queued
+    midi.sendCC({0x03, CHANNEL_1}, 0x03); // queued
+    EXPECT_EQ(stream.blockingWrites, 0u);
+    midi.sendCC({0x04, CHANNEL_1}, 0x04); // blocks
+    EXPECT_EQ(stream.blockingWrites, 3u);
+    EXPECT_EQ(queue.getDroppedCount(), 0ul);
+    EXPECT_THAT(stream.getWire(), ElementsAre(0xB0, 0x01, 0x01, //
+                                              0xB0, 0x02, 0x02));
+    midi.flush(); // only one message fits in the Stream
+    EXPECT_EQ(queue.getNumberOfBytes(), 3);
+    stream.transmit(3);
+    midi.flush();
+    EXPECT_THAT(stream.getWire(), ElementsAre(0xB0, 0x01, 0x01, //
+                                              0xB0, 0x02, 0x02, //
+                                              0xB0, 0x03, 0x03, //
+                                              0xB0, 0x04, 0x04));
+}
+
+TEST(MIDI_TransmitQueue, overflowDropOldest) {
+    LimitedStream stream = 3;
+    StreamMIDI_Interface midi = stream;
+    MIDI_TransmitQueue<6> queue{TransmitOverflowPolicy::DropOldest};
+    midi.setTransmitQueue(queue);
+    midi.sendCC({0x01, CHANNEL_1}, 0x01); // written to the Stream
+    midi.sendCC({0x02, CHANNEL_1}, 0x02); // queued
+    midi.sendCC({0x03, CHANNEL_1}, 0x03); // queued
+    midi.sendCC({0x04, CHANNEL_1}, 0x04); // replaces 0x02
+    EXPECT_EQ(stream.blockingWrites, 0u);
+    EXPECT_EQ(queue.getDroppedCount(), 1ul);
+    midi.setTransmitQueue(nullptr); // writes the queued messages
+    EXPECT_THAT(stream.getWire(), ElementsAre(0xB0, 0x01, 0x01, //
+                                              0xB0, 0x03, 0x03, //
+                                              0xB0, 0x04, 0x04));
+}
+
+/// A dropped value never reaches the wire, so it must not suppress the next
+/// message with the same value.
+TEST(MIDI_TransmitQueue, overflowDropOldestDuplicateFilter) {
+    LimitedStream stream = 3;
+    StreamMIDI_Interface midi = stream;
+    MIDI_TransmitQueue<6> queue{TransmitOverflowPolicy::DropOldest};
+    MIDI_DuplicateFilter<4> filter;
+    midi.setTransmitQueue(queue);
+    midi.setDuplicateFilter(filter);
+    midi.sendCC({0x01, CHANNEL_1}, 0x01); // written to the Stream
+    midi.sendCC({0x02, CHANNEL_1}, 0x02); // queued
+    midi.sendCC({0x03, CHANNEL_1}, 0x03); // queued
+    midi.sendCC({0x04, CHANNEL_1}, 0x04); // drops 0x02
+    EXPECT_EQ(queue.getDroppedCount(), 1ul);
+    stream.transmit(3);
+    midi.flush();
+    midi.sendCC({0x02, CHANNEL_1}, 0x02); // not a duplicate
+    midi.sendCC({0x03, CHANNEL_1}, 0x03); // duplicate
+    EXPECT_EQ(filter.getSuppressedCount(), 1ul);
+    midi.setTransmitQueue(nullptr);
+    EXPECT_THAT(stream.getWire(), ElementsAre(0xB0, 0x01, 0x01, //
+                                              0xB0, 0x03, 0x03, //
+                                              0xB0, 0x04, 0x04, //
+                                              0xB0, 0x02, 0x02));
+}
+
+TEST(MIDI_TransmitQueue, overflowCoalesce) {
+    LimitedStream stream = 3;
+    StreamMIDI_Interface midi = stream;
+    MIDI_TransmitQueue<5> queue{TransmitOverflowPolicy::Coalesce};
+    midi.setTransmitQueue(queue);
+    midi.sendCC({0x07, CHANNEL_1}, 0x01); // written to the Stream
+    midi.sendCC({0x07, CHANNEL_1}, 0x02); // queued
+    midi.sendCP(CHANNEL_2, 0x10);         // queued
+    midi.sendCC({0x07, CHANNEL_1}, 0x03); // replaces 0x02
+    midi.sendCP(CHANNEL_2, 0x20);         // replaces 0x10
+    EXPECT_EQ(stream.blockingWrites, 0u);
+    EXPECT_EQ(queue.getCoalescedCount(), 2ul);
+    midi.sendNoteOn({0x3C, CHANNEL_1}, 0x7F); // can't be coalesced, blocks
+    EXPECT_GT(stream.blockingWrites, 0u);
+    midi.setTransmitQueue(nullptr);
+    EXPECT_THAT(stream.getWire(), ElementsAre(0xB0, 0x07, 0x01, //
+                                              0xB0, 0x07, 0x03, //
+                                              0xD1, 0x20,       //
+                                              0x90, 0x3C, 0x7F));
+}
+
+/// A new value must not overtake a queued message that can't be coalesced.
+TEST(MIDI_TransmitQueue, overflowCoalesceOrder) {
+    LimitedStream stream = 3;
+    StreamMIDI_Interface midi = stream;
+    MIDI_TransmitQueue<9> queue{TransmitOverflowPolicy::Coalesce};
+    midi.setTransmitQueue(queue);
+    midi.sendCC({0x07, CHANNEL_1}, 0x01);  // written to the Stream
+    midi.sendCC({0x07, CHANNEL_1}, 0x02);  // queued
+    midi.sendCC({0x40, CHANNEL_1}, 0x7F);  // sustain on, queued
+    midi.sendNoteOn({0x3C, CHANNEL_1}, 1); // queued
+    midi.sendCC({0x07, CHANNEL_1}, 0x03);  // full, can't replace 0x02, blocks
+    EXPECT_EQ(queue.getCoalescedCount(), 0ul);
+    EXPECT_GT(stream.blockingWrites, 0u);
+    midi.setTransmitQueue(nullptr);
+    EXPECT_THAT(stream.getWire(), ElementsAre(0xB0, 0x07, 0x01, //
+                                              0xB0, 0x07, 0x02, //
+                                              0xB0, 0x40, 0x7F, //
+                                              0x90, 0x3C, 0x01, //
+                                              0xB0, 0x07, 0x03));
+}
+
+/// The steps of a relative encoder are never replaced.
+TEST(MIDI_TransmitQueue, overflowCoalesceExcluded) {
+    LimitedStream stream = 3;
+    StreamMIDI_Interface midi = stream;
+    MIDI_TransmitQueue<3> queue{TransmitOverflowPolicy::Coalesce};
+    queue.excludeController(0x10);
+    midi.setTransmitQueue(queue);
+    midi.sendCC({0x10, CHANNEL_1}, 0x01); // written to the Stream
+    midi.sendCC({0x10, CHANNEL_1}, 0x01); // queued
+    midi.sendCC({0x10, CHANNEL_1}, 0x01); // full, blocks
+    EXPECT_EQ(queue.getCoalescedCount(), 0ul);
+    midi.setTransmitQueue(nullptr);
+    EXPECT_THAT(stream.getWire(), ElementsAre(0xB0, 0x10, 0x01, //
+                                              0xB0, 0x10, 0x01, //
+                                              0xB0, 0x10, 0x01));
+}
+
+/// Real-Time messages don't wait for the queued messages.
+TEST(MIDI_TransmitQueue, realTimeOvertakes) {
+    LimitedStream stream = 4;
+    StreamMIDI_Interface midi = stream;
+    MIDI_TransmitQueue<16> queue;
+    midi.setTransmitQueue(queue);
+    midi.sendCC({0x01, CHANNEL_1}, 0x01);
+    midi.sendCC({0x02, CHANNEL_1}, 0x02); // queued
+    midi.send(MIDIMessageType::TIMING_CLOCK);
+    midi.setTransmitQueue(nullptr);
+    EXPECT_THAT(stream.getWire(), ElementsAre(0xB0, 0x01, 0x01, 0xF8, //
+                                              0xB0, 0x02, 0x02));
+}
+
+/// System Exclusive messages are never queued, and don't overtake the queued
+/// messages.
+TEST(MIDI_TransmitQueue, sysExNotQueued) {
+    LimitedStream stream = 3;
+    StreamMIDI_Interface midi = stream;
+    MIDI_TransmitQueue<16> queue;
+    midi.setTransmitQueue(queue);
+    midi.sendCC({0x01, CHANNEL_1}, 0x01);
+    midi.sendCC({0x02, CHANNEL_1}, 0x02); // queued
+    const uint8_t sysex[] = {0xF0, 0x11, 0x22, 0xF7};
+    midi.send(sysex);
+    EXPECT_TRUE(queue.isEmpty());
+    EXPECT_THAT(stream.getWire(), ElementsAre(0xB0, 0x01, 0x01, //
+                                              0xB0, 0x02, 0x02, //
+                                              0xF0, 0x11, 0x22, 0xF7));
+}
+
+TEST(MIDI_TransmitQueue, runningStatus) {
+    LimitedStream stream = 64;
+    StreamMIDI_Interface midi = stream;
+    midi.setRunningStatus(true, 0);
+    EXPECT_TRUE(midi.getRunningStatus());
+    midi.sendCC({0x07, CHANNEL_1}, 0x01);
+    midi.sendCC({0x07, CHANNEL_1}, 0x02);
+    midi.sendCC({0x08, CHANNEL_1}, 0x03);
+    midi.send(MIDIMessageType::TIMING_CLOCK); // doesn't cancel it
+    midi.sendCC({0x07, CHANNEL_1}, 0x04);
+    midi.sendCC({0x07, CHANNEL_2}, 0x05);
+    midi.sendPC(CHANNEL_2, 0x06);
+    midi.sendPC(CHANNEL_2, 0x07);
+    const uint8_t sysex[] = {0xF0, 0x11, 0xF7};
+    midi.send(sysex); // cancels it
+    midi.sendPC(CHANNEL_2, 0x08);
+    EXPECT_THAT(stream.getWire(), ElementsAreArray({
+                                      0xB0, 0x07, 0x01, //
+                                      0x07, 0x02,       //
+                                      0x08, 0x03,       //
+                                      0xF8,             //
+                                      0x07, 0x04,       //
+                                      0xB1, 0x07, 0x05, //
+                                      0xC1, 0x06,       //
+                                      0x07,             //
+                                      0xF0, 0x11, 0xF7, //
+                                      0xC1, 0x08,       //
+                                  }));
+}
+
+/// Running status is also used for the queued messages, and saves room in the
+/// transmit buffer of the Stream.
+TEST(MIDI_TransmitQueue, runningStatusQueued) {
+    LimitedStream stream = 3;
+    StreamMIDI_Interface midi = stream;
+    MIDI_TransmitQueue<32> queue;
+    midi.setTransmitQueue(queue);
+    midi.setRunningStatus(true, 0);
+    for (uint8_t i = 0; i < 4; ++i)
+        midi.sendCC({0x07, CHANNEL_1}, i);
+    EXPECT_EQ(queue.getNumberOfBytes(), 9);
+    stream.transmit(2);
+    midi.update();
+    EXPECT_EQ(queue.getNumberOfBytes(), 6);
+    EXPECT_EQ(stream.buffer.size(), 3u);
+    while (!queue.isEmpty()) {
+        stream.transmit(2);
+        midi.update();
+    }
+    EXPECT_EQ(stream.blockingWrites, 0u);
+    EXPECT_THAT(stream.getWire(), ElementsAre(0xB0, 0x07, 0x00, //
+                                              0x07, 0x01,       //
+                                              0x07, 0x02,       //
+                                              0x07, 0x03));
+}
@@ -0,0 +1,268 @@
+#include <MIDI_Interfaces/ReplayMIDI_Interface.hpp>
+#include <gmock-wrapper.h>
+#include <gtest-wrapper.h>
+
+#include <sstream>
+
+USING_CS_NAMESPACE;
+using namespace ::testing;
+
+/// Collects all incoming messages, and optionally answers every channel
+/// message with a Note Off message after a fixed processing time.
+struct ReplayCallbacks : MIDI_Callbacks {
+    ReplayCallbacks(unsigned long &now) : now(now) {}
+
+    void onChannelMessage(Parsing_MIDI_Interface &midi) override {
+        auto msg = midi.getChannelMessage();
+        channel.push_back({msg.header, msg.data1, msg.data2, msg.CN});
+        if (respond) {
+            now += processingTime;
+            static_cast<ReplayMIDI_Interface &>(midi).sendNoteOff(
+                {msg.data1, CHANNEL_1}, 0x40);
+        }
+    }
+    void onSysExMessage(Parsing_MIDI_Interface &midi) override {
+        auto msg = midi.getSysExMessage();
+        sysex.emplace_back(msg.data, msg.data + msg.length);
+    }
+    void onRealTimeMessage(Parsing_MIDI_Interface &midi) override {
+        realtime.push_back(midi.getRealTimeMessage().message);
+    }
+
+    unsigned long &now;
+    bool respond = false;
+    unsigned long processingTime = 0;
+    std::vector<std::vector<uint8_t>> channel;
+    std::vector<std::vector<uint8_t>> sysex;
+    std::vector<uint8_t> realtime;
+};
+
+class ReplayMIDI_InterfaceTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        EXPECT_CALL(ArduinoMock::getInstance(), micros())
+            .WillRepeatedly(Invoke([this] { return now; }));
+    }
+    void TearDown() override {
+        Mock::VerifyAndClear(&ArduinoMock::getInstance());
+    }
+
+    unsigned long now = 5000;
+    ReplayCallbacks callbacks = now;
+};
+
+TEST_F(ReplayMIDI_InterfaceTest, replaySerial) {
+    const MIDICaptureEvent capture[] = {
+        {0, {0x90, 0x3C, 0x7F}, 3},
+        {0, {0x3D, 0x7E}, 2}, // running status
+        {1000, {0xF0, 0x01, 0x02, 0x03}, 4},
+        {1000, {0xF8}, 1},
+        {1500, {0x04, 0xF7, 0xB1, 0x07}, 4},
+        {1500, {0x10}, 1},
+    };
+    ReplayMIDI_Interface midi = capture;
+    midi.setCallbacks(callbacks);
+    midi.begin();
+
+    midi.update();
+    EXPECT_EQ(callbacks.channel, (std::vector<std::vector<uint8_t>>{
+                                     {0x90, 0x3C, 0x7F, 0},
+                                     {0x90, 0x3D, 0x7E, 0},
+                                 }));
+    now += 999;
+    midi.update();
+    EXPECT_EQ(callbacks.channel.size(), 2u);
+    EXPECT_TRUE(callbacks.realtime.empty());
+    now += 1;
+    midi.update();
+    EXPECT_EQ(callbacks.realtime, std::vector<uint8_t>{0xF8});
+    EXPECT_TRUE(callbacks.sysex.empty());
+    EXPECT_FALSE(midi.isFinished());
+    now += 600;
+    midi.update();
+    EXPECT_EQ(callbacks.sysex, (std::vector<std::vector<uint8_t>>{
+                                   {0xF0, 0x01, 0x02, 0x03, 0x04, 0xF7},
+                               }));
+    EXPECT_EQ(callbacks.channel.back(),
+              (std::vector<uint8_t>{0xB1, 0x07, 0x10, 0}));
+    EXPECT_TRUE(midi.isFinished());
+
+    EXPECT_EQ(midi.getReceivedCount(), 5ul);
+    auto &lag = midi.getInputLagStats();
+    EXPECT_EQ(lag.getCount(), 5ul);
+    EXPECT_EQ(lag.getMin(), 0ul);
+    EXPECT_EQ(lag.getMax(), 100ul); // 1600 - 1500
+}
+
+TEST_F(ReplayMIDI_InterfaceTest, replayUSB) {
+    const MIDICaptureEvent capture[] = {
+        {0, {0x29, 0x91, 0x3C, 0x7F}, 4},
+        {10, {0x04, 0xF0, 0x01, 0x02}, 4},
+        {20, {0x0F, 0xFA, 0x00, 0x00}, 4},
+        {30, {0x06, 0x03, 0xF7, 0x00}, 4},
+    };
+    ReplayMIDI_Interface midi = {capture, MIDICaptureFormat::USB};
+    midi.setCallbacks(callbacks);
+    midi.begin();
+
+    now += 30;
+    midi.update();
+    EXPECT_EQ(callbacks.channel, (std::vector<std::vector<uint8_t>>{
+                                     {0x91, 0x3C, 0x7F, 2},
+                                 }));
+    EXPECT_EQ(callbacks.realtime, std::vector<uint8_t>{0xFA});
+    EXPECT_EQ(callbacks.sysex, (std::vector<std::vector<uint8_t>>{
+                                   {0xF0, 0x01, 0x02, 0x03, 0xF7},
+                               }));
+    EXPECT_TRUE(midi.isFinished());
+    EXPECT_EQ(midi.getInputLagStats().getMax(), 30ul);
+    EXPECT_EQ(midi.getInputLagStats().getMin(), 0ul);
+}
+
+TEST_F(ReplayMIDI_InterfaceTest, recordSerial) {
+    ReplayMIDI_Interface midi = {nullptr, 0};
+    MIDICaptureEvent recording[4];
+    midi.setRecordBuffer(recording);
+    midi.begin();
+
+    now += 10;
+    midi.sendCC({0x07, CHANNEL_2}, 0x55);
+    now += 10;
+    midi.sendPC({CHANNEL_3}, 0x05);
+    midi.send(MIDIMessageType::TIMING_CLOCK);
+    now += 10;
+    const uint8_t sysex[] = {0xF0, 0x01, 0x02, 0x03, 0x04, 0xF7};
+    midi.send(sysex); // Needs two events, but only one is left
+    midi.send(MIDIMessageType::STOP);
+
+    ASSERT_EQ(midi.getRecordingLength(), 4u);
+    EXPECT_EQ(recording[0].timestamp, 10ul);
+    EXPECT_EQ(recording[0].length, 3);
+    EXPECT_THAT(recording[0].data, ElementsAre(0xB1, 0x07, 0x55, 0x00));
+    EXPECT_EQ(recording[1].timestamp, 20ul);
+    EXPECT_EQ(recording[1].length, 2);
+    EXPECT_THAT(recording[1].data, ElementsAre(0xC2, 0x05, 0x00, 0x00));
+    EXPECT_EQ(recording[2].length, 1);
+    EXPECT_EQ(recording[2].data[0], 0xF8);
+    EXPECT_EQ(recording[3].timestamp, 30ul);
+    EXPECT_EQ(recording[3].data[0], 0xFC);
+    EXPECT_EQ(midi.getSentCount(), 5ul);
+    EXPECT_EQ(midi.getDroppedCount(), 1ul);
+}
+
+TEST_F(ReplayMIDI_InterfaceTest, recordUSB) {
+    ReplayMIDI_Interface midi = {nullptr, 0, MIDICaptureFormat::USB};
+    MIDICaptureEvent recording[8];
+    midi.setRecordBuffer(recording);
+    midi.begin();
+
+    midi.sendNoteOn({0x3C, CHANNEL_1, CABLE_3}, 0x7F);
+    const uint8_t sysex[] = {0xF0, 0x01, 0x02, 0x03, 0x04, 0xF7};
+    midi.send(sysex);
+    midi.send(MIDIMessageType::START, CABLE_2);
+
+    ASSERT_EQ(midi.getRecordingLength(), 4u);
+    EXPECT_THAT(recording[0].data, ElementsAre(0x29, 0x90, 0x3C, 0x7F));
+    EXPECT_THAT(recording[1].data, ElementsAre(0x04, 0xF0, 0x01, 0x02));
+    EXPECT_THAT(recording[2].data, ElementsAre(0x07, 0x03, 0x04, 0xF7));
+    EXPECT_THAT(recording[3].data, ElementsAre(0x1F, 0xFA, 0x00, 0x00));
+    EXPECT_EQ(midi.getDroppedCount(), 0ul);
+}
+
+/// Chunks of a long SysEx message don't have to be multiples of three bytes,
+/// the packets are only ended by the last chunk.
+TEST_F(ReplayMIDI_InterfaceTest, recordUSBChunked) {
+    ReplayMIDI_Interface midi = {nullptr, 0, MIDICaptureFormat::USB};
+    MIDICaptureEvent recording[8];
+    midi.setRecordBuffer(recording);
+    midi.begin();
+
+    const uint8_t chunk1[] = {0xF0, 0x01, 0x02, 0x03, 0x04};
+    const uint8_t chunk2[] = {0x05, 0x06};
+    const uint8_t chunk3[] = {0x07, 0xF7};
+    midi.send(SysExMessage{chunk1, 5, CABLE_2, true});
+    midi.send(SysExMessage{chunk2, 2, CABLE_2, true});
+    midi.send(SysExMessage{chunk3, 2, CABLE_2, true});
+    // A message that is never terminated is ended by the next one
+    const uint8_t chunk4[] = {0xF0, 0x11};
+    midi.send(SysExMessage{chunk4, 2, CABLE_2, true});
+    const uint8_t sysex[] = {0xF0, 0x21, 0x22, 0x23};
+    midi.send(sysex); // doesn't end in F7, but it's a complete message
+
+    ASSERT_EQ(midi.getRecordingLength(), 6u);
+    EXPECT_THAT(recording[0].data, ElementsAre(0x14, 0xF0, 0x01, 0x02));
+    EXPECT_THAT(recording[1].data, ElementsAre(0x14, 0x03, 0x04, 0x05));
+    EXPECT_THAT(recording[2].data, ElementsAre(0x17, 0x06, 0x07, 0xF7));
+    EXPECT_THAT(recording[3].data, ElementsAre(0x16, 0xF0, 0x11, 0x00));
+    EXPECT_THAT(recording[4].data, ElementsAre(0x04, 0xF0, 0x21, 0x22));
+    EXPECT_THAT(recording[5].data, ElementsAre(0x05, 0x23, 0x00, 0x00));
+    EXPECT_EQ(midi.getDroppedCount(), 0ul);
+}
+
+/// Replay a burst of notes that arrive faster than they can be answered, and
+/// check the latency of the responses.
+TEST_F(ReplayMIDI_InterfaceTest, responseLatency) {
+    std::vector<MIDICaptureEvent> capture;
+    for (uint8_t i = 0; i < 10; ++i)
+        capture.push_back({i * 100ul, {0x90, i, 0x7F}, 3});
+    ReplayMIDI_Interface midi = {capture.data(), capture.size()};
+    MIDICaptureEvent recording[16];
+    midi.setRecordBuffer(recording);
+    midi.setCallbacks(callbacks);
+    callbacks.respond = true;
+    callbacks.processingTime = 150;
+    midi.begin();
+
+    while (!midi.isFinished())
+        midi.update();
+
+    EXPECT_EQ(midi.getReceivedCount(), 10ul);
+    EXPECT_EQ(midi.getSentCount(), 10ul);
+    ASSERT_EQ(midi.getRecordingLength(), 10u);
+    // Every message takes 150 µs, but they arrive every 100 µs, so the
+    // latency grows by 50 µs per message.
+    EXPECT_EQ(recording[0].timestamp, 150ul);
+    EXPECT_EQ(recording[9].timestamp, 1500ul);
+    EXPECT_THAT(recording[9].data, ElementsAre(0x80, 0x09, 0x40, 0x00));
+    auto &latency = midi.getResponseLatencyStats();
+    EXPECT_EQ(latency.getCount(), 10ul);
+    EXPECT_EQ(latency.getMin(), 150ul);
+    EXPECT_EQ(latency.getMax(), 600ul);
+    EXPECT_EQ(midi.getInputLagStats().getMax(), 450ul);
+}
+
+TEST(MIDICapture, readWrite) {
+    std::istringstream is("# Comment\n"
+                          "0 90 3c 7F\n"
+                          "\n"
+                          "  20833 F8\r\n"
+                          "41666 F0 01 02 03 04 05 F7\n");
+    auto events = readMIDICapture(is);
+    ASSERT_EQ(events.size(), 4u);
+    EXPECT_EQ(events[0].timestamp, 0ul);
+    EXPECT_EQ(events[0].length, 3);
+    EXPECT_THAT(events[0].data, ElementsAre(0x90, 0x3C, 0x7F, 0x00));
+    EXPECT_EQ(events[1].timestamp, 20833ul);
+    EXPECT_EQ(events[1].length, 1);
+    EXPECT_EQ(events[2].timestamp, 41666ul);
+    EXPECT_EQ(events[2].length, 4);
+    EXPECT_EQ(events[3].timestamp, 41666ul);
+    EXPECT_EQ(events[3].length, 3);
+    EXPECT_THAT(events[3].data, ElementsAre(0x04, 0x05, 0xF7, 0x00));
+
+    std::ostringstream os;
+    writeMIDICapture(os, events.data(), events.size());
+    EXPECT_EQ(os.str(), "0 90 3C 7F\n"
+                        "20833 F8\n"
+                        "41666 F0 01 02 03\n"
+                        "41666 04 05 F7\n");
+}
+
+TEST(MIDICapture, readInvalid) {
+    std::istringstream timestamp("0 90 3C 7F\nabc 90\n");
+    EXPECT_THROW(readMIDICapture(timestamp), AH::ErrorException);
+    std::istringstream byte("0 90 3C 7F\n10 90 3C 100\n");
+    EXPECT_THROW(readMIDICapture(byte), AH::ErrorException);
+    std::istringstream garbage("0 90 3C zz\n");
+    EXPECT_THROW(readMIDICapture(garbage), AH::ErrorException);
+}
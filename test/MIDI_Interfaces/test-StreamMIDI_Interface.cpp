@@ -165,4 +165,163 @@ TEST(StreamMIDI_Interface, readSysExUpdate) {
     };
     EXPECT_EQ(result, expected);
     EXPECT_EQ(sysex.CN, 0);
-}
\ No newline at end of file
+}
+
+TEST(StreamMIDI_Interface, readMultipleMessagesBuffered) {
+    TestStream stream;
+    StreamMIDI_Interface midi = stream;
+    // More bytes than fit in the read buffer at once
+    std::vector<ChannelMessage> expected;
+    stream.toRead.push(0xB2);
+    for (uint8_t i = 0; i < STREAM_MIDI_READ_BUFFER_SIZE; ++i) {
+        stream.toRead.push(i);
+        stream.toRead.push(0x7F - i);
+        expected.push_back({0xB2, i, uint8_t(0x7F - i), 0x00});
+    }
+    stream.toRead.push(0xF8);
+    for (auto &msg : expected) {
+        EXPECT_EQ(midi.read(), MIDIReadEvent::CHANNEL_MESSAGE);
+        EXPECT_EQ(midi.getChannelMessage(), msg);
+    }
+    EXPECT_EQ(midi.read(), MIDIReadEvent::REALTIME_MESSAGE);
+    EXPECT_EQ(midi.read(), MIDIReadEvent::NO_MESSAGE);
+    EXPECT_TRUE(stream.toRead.empty());
+}
+
+TEST(StreamMIDI_Interface, readMessageSplitAcrossReads) {
+    TestStream stream;
+    StreamMIDI_Interface midi = stream;
+    stream.toRead.push(0x93);
+    stream.toRead.push(0x3C);
+    EXPECT_EQ(midi.read(), MIDIReadEvent::NO_MESSAGE);
+    stream.toRead.push(0x60);
+    EXPECT_EQ(midi.read(), MIDIReadEvent::CHANNEL_MESSAGE);
+    ChannelMessage expectedMsg = {0x93, 0x3C, 0x60, 0x00};
+    EXPECT_EQ(midi.getChannelMessage(), expectedMsg);
+}
+
+TEST(StreamMIDI_Interface, runningStatusRefresh) {
+    unsigned long now = 1000;
+    EXPECT_CALL(ArduinoMock::getInstance(), millis())
+        .WillRepeatedly(testing::Invoke([&] { return now; }));
+    TestStream stream;
+    StreamMIDI_Interface midi = stream;
+    midi.setRunningStatus(true, 100);
+    EXPECT_EQ(midi.getRunningStatusRefresh(), 100ul);
+    midi.sendCC({0x07, CHANNEL_1}, 0x01);
+    now += 99;
+    midi.sendCC({0x07, CHANNEL_1}, 0x02);
+    now += 1; // 100 ms after the status byte was sent
+    midi.sendCC({0x07, CHANNEL_1}, 0x03);
+    now += 50;
+    midi.sendCC({0x07, CHANNEL_1}, 0x04);
+    midi.sendCC({0x07, CHANNEL_2}, 0x05);
+    now += 99;
+    midi.sendCC({0x07, CHANNEL_2}, 0x06);
+    u8vec expected = {
+        0xB0, 0x07, 0x01, //
+        0x07, 0x02,       //
+        0xB0, 0x07, 0x03, //
+        0x07, 0x04,       //
+        0xB1, 0x07, 0x05, //
+        0x07, 0x06,       //
+    };
+    EXPECT_EQ(stream.sent, expected);
+
+    stream.sent.clear();
+    midi.setRunningStatus(false);
+    midi.sendCC({0x07, CHANNEL_2}, 0x07);
+    midi.sendCC({0x07, CHANNEL_2}, 0x08);
+    expected = {0xB1, 0x07, 0x07, 0xB1, 0x07, 0x08};
+    EXPECT_EQ(stream.sent, expected);
+    testing::Mock::VerifyAndClear(&ArduinoMock::getInstance());
+}
+
+TEST(StreamMIDI_Interface, duplicateFilter) {
+    TestStream stream;
+    StreamMIDI_Interface midi = stream;
+    MIDI_DuplicateFilter<4> filter;
+    midi.setDuplicateFilter(filter);
+    midi.sendCC({0x07, CHANNEL_1}, 0x01);
+    midi.sendCC({0x07, CHANNEL_1}, 0x01); // suppressed
+    midi.sendCC({0x07, CHANNEL_2}, 0x01); // different channel
+    midi.sendCC({0x08, CHANNEL_1}, 0x01); // different controller
+    midi.sendCC({0x07, CHANNEL_1}, 0x02);
+    midi.sendCC({0x07, CHANNEL_1}, 0x02); // suppressed
+    midi.sendPB(CHANNEL_1, 0x1234);
+    midi.sendPB(CHANNEL_1, 0x1234); // suppressed
+    midi.sendPB(CHANNEL_1, 0x1235);
+    midi.sendCP(CHANNEL_1, 0x10);
+    midi.sendCP(CHANNEL_1, 0x10);             // suppressed
+    midi.sendNoteOn({0x3C, CHANNEL_1}, 0x7F); // notes are never suppressed
+    midi.sendNoteOn({0x3C, CHANNEL_1}, 0x7F);
+    midi.sendCC({0x06, CHANNEL_1}, 0x01); // neither is Data Entry
+    midi.sendCC({0x06, CHANNEL_1}, 0x01);
+    EXPECT_EQ(filter.getSuppressedCount(), 4ul);
+    EXPECT_EQ(filter.getNumberOfEntries(), 4);
+    u8vec expected = {
+        0xB0, 0x07, 0x01, //
+        0xB1, 0x07, 0x01, //
+        0xB0, 0x08, 0x01, //
+        0xB0, 0x07, 0x02, //
+        0xE0, 0x34, 0x24, //
+        0xE0, 0x35, 0x24, //
+        0xD0, 0x10,       //
+        0x90, 0x3C, 0x7F, //
+        0x90, 0x3C, 0x7F, //
+        0xB0, 0x06, 0x01, //
+        0xB0, 0x06, 0x01, //
+    };
+    EXPECT_EQ(stream.sent, expected);
+
+    // The filter is full, the oldest controller (CC 7 on channel 1) was
+    // forgotten to make room for Channel Pressure
+    stream.sent.clear();
+    midi.sendCC({0x07, CHANNEL_1}, 0x02);
+    midi.sendCC({0x07, CHANNEL_1}, 0x02);
+    EXPECT_EQ(stream.sent, (u8vec{0xB0, 0x07, 0x02}));
+    filter.clear();
+    midi.sendCC({0x07, CHANNEL_1}, 0x02);
+    EXPECT_EQ(stream.sent, (u8vec{0xB0, 0x07, 0x02, 0xB0, 0x07, 0x02}));
+}
+
+/// Relative encoders send the same value for every step, so their steps are
+/// never suppressed once their controller is excluded.
+TEST(StreamMIDI_Interface, duplicateFilterRelative) {
+    TestStream stream;
+    StreamMIDI_Interface midi = stream;
+    MIDI_DuplicateFilter<4> filter;
+    filter.excludeControllers(0x10, 0x17);
+    midi.setDuplicateFilter(filter);
+    for (uint8_t i = 0; i < 3; ++i)
+        midi.sendCC({0x10, CHANNEL_1}, 0x01); // +1
+    for (uint8_t i = 0; i < 2; ++i)
+        midi.sendCC({0x17, CHANNEL_1}, 0x41); // -1
+    midi.sendCC({0x18, CHANNEL_1}, 0x01);
+    midi.sendCC({0x18, CHANNEL_1}, 0x01); // suppressed
+    EXPECT_EQ(filter.getSuppressedCount(), 1ul);
+    u8vec expected = {
+        0xB0, 0x10, 0x01, //
+        0xB0, 0x10, 0x01, //
+        0xB0, 0x10, 0x01, //
+        0xB0, 0x17, 0x41, //
+        0xB0, 0x17, 0x41, //
+        0xB0, 0x18, 0x01, //
+    };
+    EXPECT_EQ(stream.sent, expected);
+}
+
+/// Running status and duplicate suppression combined on a stream of fader
+/// values, where the fader is noisy and sends some values twice.
+TEST(StreamMIDI_Interface, runningStatusAndDuplicateFilter) {
+    TestStream stream;
+    StreamMIDI_Interface midi = stream;
+    MIDI_DuplicateFilter<4> filter;
+    midi.setDuplicateFilter(filter);
+    midi.setRunningStatus(true, 0);
+    for (uint8_t value : {0x10, 0x11, 0x11, 0x12, 0x12, 0x12, 0x13})
+        midi.sendCC({0x07, CHANNEL_1}, value);
+    // 9 bytes instead of 21
+    u8vec expected = {0xB0, 0x07, 0x10, 0x07, 0x11, 0x07, 0x12, 0x07, 0x13};
+    EXPECT_EQ(stream.sent, expected);
+}
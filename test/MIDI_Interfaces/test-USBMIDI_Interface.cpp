@@ -12,12 +12,14 @@ using AH::ErrorException;
 TEST(USBMIDI_Interface, send3B) {
     StrictMock<USBMIDI_Interface> midi;
     EXPECT_CALL(midi, writeUSBPacket(8, 0x9, 0x93, 0x55, 0x66));
+    EXPECT_CALL(midi, flushUSB());
     midi.sendNoteOn({0x55, CHANNEL_4, CABLE_9}, 0x66);
 }
 
 TEST(USBMIDI_Interface, send2B) {
     StrictMock<USBMIDI_Interface> midi;
     EXPECT_CALL(midi, writeUSBPacket(8, 0xC, 0xC3, 0x66, 0x00));
+    EXPECT_CALL(midi, flushUSB());
     midi.sendPC({CHANNEL_4, CABLE_9}, 0x66);
 }
 
@@ -25,6 +27,7 @@ TEST(USBMIDI_Interface, RealTime) {
     StrictMock<USBMIDI_Interface> midi;
     Sequence seq;
     EXPECT_CALL(midi, writeUSBPacket(8, 0xF, 0xF8, 0x00, 0x00)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
     midi.sendOnCable(MIDIMessageType::TIMING_CLOCK, CABLE_9);
 }
 
@@ -32,6 +35,7 @@ TEST(USBMIDI_Interface, SysExSend3B) {
     StrictMock<USBMIDI_Interface> midi;
     Sequence seq;
     EXPECT_CALL(midi, writeUSBPacket(8, 0x7, 0xF0, 0x55, 0xF7)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
     uint8_t sysex[] = {0xF0, 0x55, 0xF7};
     midi.send(sysex, CABLE_9);
 }
@@ -41,6 +45,7 @@ TEST(USBMIDI_Interface, SysExSend4B) {
     Sequence seq;
     EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0xF0, 0x55, 0x66)).InSequence(seq);
     EXPECT_CALL(midi, writeUSBPacket(9, 0x5, 0xF7, 0x00, 0x00)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
     uint8_t sysex[] = {0xF0, 0x55, 0x66, 0xF7};
     midi.send(sysex, CABLE_10);
 }
@@ -50,6 +55,7 @@ TEST(USBMIDI_Interface, SysExSend5B) {
     Sequence seq;
     EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0xF0, 0x55, 0x66)).InSequence(seq);
     EXPECT_CALL(midi, writeUSBPacket(9, 0x6, 0x77, 0xF7, 0x00)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
     uint8_t sysex[] = {0xF0, 0x55, 0x66, 0x77, 0xF7};
     midi.send(sysex, CABLE_10);
 }
@@ -59,6 +65,7 @@ TEST(USBMIDI_Interface, SysExSend6B) {
     Sequence seq;
     EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0xF0, 0x55, 0x66)).InSequence(seq);
     EXPECT_CALL(midi, writeUSBPacket(9, 0x7, 0x77, 0x11, 0xF7)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
     uint8_t sysex[] = {0xF0, 0x55, 0x66, 0x77, 0x11, 0xF7};
     midi.send(sysex, CABLE_10);
 }
@@ -69,6 +76,7 @@ TEST(USBMIDI_Interface, SysExSend7B) {
     EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0xF0, 0x55, 0x66)).InSequence(seq);
     EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0x77, 0x11, 0x22)).InSequence(seq);
     EXPECT_CALL(midi, writeUSBPacket(9, 0x5, 0xF7, 0x00, 0x00)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
     uint8_t sysex[] = {0xF0, 0x55, 0x66, 0x77, 0x11, 0x22, 0xF7};
     midi.send(sysex, CABLE_10);
 }
@@ -79,6 +87,7 @@ TEST(USBMIDI_Interface, SysExSend8B) {
     EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0xF0, 0x55, 0x66)).InSequence(seq);
     EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0x77, 0x11, 0x22)).InSequence(seq);
     EXPECT_CALL(midi, writeUSBPacket(9, 0x6, 0x33, 0xF7, 0x00)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
     uint8_t sysex[] = {0xF0, 0x55, 0x66, 0x77, 0x11, 0x22, 0x33, 0xF7};
     midi.send(sysex, CABLE_10);
 }
@@ -89,6 +98,7 @@ TEST(USBMIDI_Interface, SysExSend9B) {
     EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0xF0, 0x55, 0x66)).InSequence(seq);
     EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0x77, 0x11, 0x22)).InSequence(seq);
     EXPECT_CALL(midi, writeUSBPacket(9, 0x7, 0x33, 0x44, 0xF7)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
     uint8_t sysex[] = {0xF0, 0x55, 0x66, 0x77, 0x11, 0x22, 0x33, 0x44, 0xF7};
     midi.send(sysex, CABLE_10);
 }
@@ -102,6 +112,7 @@ TEST(USBMIDI_Interface, SysExSend2B) {
     StrictMock<USBMIDI_Interface> midi;
     Sequence seq;
     EXPECT_CALL(midi, writeUSBPacket(9, 0x6, 0xF0, 0xF7, 0x00)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
     uint8_t sysex[] = {0xF0, 0xF7};
     midi.send(sysex, CABLE_10);
 }
@@ -117,10 +128,80 @@ TEST(USBMIDI_Interface, SysExSend1B) {
     }
 }
 
+TEST(USBMIDI_Interface, SysExSend300B) {
+    StrictMock<USBMIDI_Interface> midi;
+    std::vector<uint8_t> sysex(300, 0x55);
+    sysex.front() = 0xF0;
+    sysex.back() = 0xF7;
+    // 300 bytes = 100 packets, sent in transfers of 16 packets
+    EXPECT_CALL(midi, writeUSBPacket(0, 0x4, ::testing::_, 0x55, 0x55))
+        .Times(99);
+    EXPECT_CALL(midi, writeUSBPacket(0, 0x7, 0x55, 0x55, 0xF7));
+    EXPECT_CALL(midi, flushUSB()).Times(7);
+    midi.send(SysExMessage{sysex});
+}
+
+TEST(USBMIDI_Interface, SysExSendChunks) {
+    StrictMock<USBMIDI_Interface> midi;
+    Sequence seq;
+    EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0xF0, 0x01, 0x02)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
+    EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0x03, 0x04, 0x05)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
+    EXPECT_CALL(midi, writeUSBPacket(9, 0x7, 0x06, 0x07, 0xF7)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
+    EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0xF0, 0x11, 0x12)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
+    EXPECT_CALL(midi, writeUSBPacket(9, 0x5, 0xF7, 0x00, 0x00)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
+    uint8_t chunk1[] = {0xF0, 0x01, 0x02, 0x03, 0x04};
+    uint8_t chunk2[] = {0x05, 0x06};
+    uint8_t chunk3[] = {0x07, 0xF7};
+    midi.send(SysExMessage{chunk1, 5, CABLE_10, true});
+    midi.send(SysExMessage{chunk2, 2, CABLE_10, true});
+    midi.send(SysExMessage{chunk3, 2, CABLE_10, true});
+    uint8_t chunk4[] = {0xF0, 0x11, 0x12};
+    uint8_t chunk5[] = {0xF7};
+    midi.send(SysExMessage{chunk4, 3, CABLE_10, true});
+    midi.send(SysExMessage{chunk5, 1, CABLE_10, true});
+}
+
+TEST(USBMIDI_Interface, SysExSendUnterminatedChunk) {
+    StrictMock<USBMIDI_Interface> midi;
+    Sequence seq;
+    EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0xF0, 0x01, 0x02)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
+    // A new message starts: the remaining bytes of the previous one are sent
+    EXPECT_CALL(midi, writeUSBPacket(9, 0x5, 0x03, 0x00, 0x00)).InSequence(seq);
+    EXPECT_CALL(midi, writeUSBPacket(9, 0x7, 0xF0, 0x11, 0xF7)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
+    uint8_t chunk1[] = {0xF0, 0x01, 0x02, 0x03};
+    uint8_t message[] = {0xF0, 0x11, 0xF7};
+    midi.send(SysExMessage{chunk1, 4, CABLE_10, true});
+    midi.send(message, CABLE_10);
+}
+
+/// Messages that are not chunks are sent right away, even if they were
+/// truncated and don't end with 0xF7.
+TEST(USBMIDI_Interface, SysExSendTruncated) {
+    StrictMock<USBMIDI_Interface> midi;
+    Sequence seq;
+    EXPECT_CALL(midi, writeUSBPacket(9, 0x4, 0xF0, 0x01, 0x02)).InSequence(seq);
+    EXPECT_CALL(midi, writeUSBPacket(9, 0x6, 0x03, 0x04, 0x00)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
+    EXPECT_CALL(midi, writeUSBPacket(9, 0x7, 0xF0, 0x11, 0xF7)).InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
+    uint8_t truncated[] = {0xF0, 0x01, 0x02, 0x03, 0x04};
+    uint8_t message[] = {0xF0, 0x11, 0xF7};
+    midi.send(truncated, CABLE_10);
+    midi.send(message, CABLE_10);
+}
+
 TEST(USBMIDI_Interface, readRealTime) {
     StrictMock<USBMIDI_Interface> midi;
     EXPECT_CALL(midi, readUSBPacket())
-        .WillOnce(Return(USBMIDI_Interface::MIDIUSBPacket_t{0x3F, 0xF8, 0, 0}));
+        .WillOnce(Return(USBMIDI_Interface::MIDIUSBPacket_t{0x3F, 0xF8, 0, 0}))
+        .WillOnce(Return(USBMIDI_Interface::MIDIUSBPacket_t{}));
     RealTimeMessage expectedMsg = {MIDIMessageType::TIMING_CLOCK, 0x3};
     EXPECT_EQ(midi.read(), MIDIReadEvent::REALTIME_MESSAGE);
     EXPECT_EQ(midi.getRealTimeMessage(), expectedMsg);
@@ -130,7 +211,8 @@ TEST(USBMIDI_Interface, readNoteOn) {
     StrictMock<USBMIDI_Interface> midi;
     EXPECT_CALL(midi, readUSBPacket())
         .WillOnce(
-            Return(USBMIDI_Interface::MIDIUSBPacket_t{0x59, 0x93, 0x3C, 0x60}));
+            Return(USBMIDI_Interface::MIDIUSBPacket_t{0x59, 0x93, 0x3C, 0x60}))
+        .WillOnce(Return(USBMIDI_Interface::MIDIUSBPacket_t{}));
     EXPECT_EQ(midi.read(), MIDIReadEvent::CHANNEL_MESSAGE);
     ChannelMessage expectedMsg = {0x93, 0x3C, 0x60, 0x05};
     EXPECT_EQ(midi.getChannelMessage(), expectedMsg);
@@ -144,7 +226,8 @@ TEST(USBMIDI_Interface, readSysEx) {
     EXPECT_CALL(midi, readUSBPacket())
         .WillOnce(Return(Packet_t{{0x54, 0xF0, 0x55, 0x66}}))
         .WillOnce(Return(Packet_t{{0x54, 0x77, 0x11, 0x22}}))
-        .WillOnce(Return(Packet_t{{0x56, 0x33, 0xF7, 0x00}}));
+        .WillOnce(Return(Packet_t{{0x56, 0x33, 0xF7, 0x00}}))
+        .WillOnce(Return(Packet_t{}));
     EXPECT_EQ(midi.read(), MIDIReadEvent::SYSEX_MESSAGE);
     SysExMessage sysex = midi.getSysExMessage();
     const SysExVector result = {
@@ -156,4 +239,193 @@ TEST(USBMIDI_Interface, readSysEx) {
     };
     EXPECT_EQ(result, expected);
     EXPECT_EQ(sysex.CN, 5);
-}
\ No newline at end of file
+}
+/// All available packets are read at once, and the host isn't polled again
+/// A SysEx message that fills a custom buffer larger than the default one is
+/// received by a single call to read.
+TEST(USBMIDI_Interface, readSysExCustomBuffer) {
+    StrictMock<USBMIDI_Interface> midi;
+    static uint8_t storage[600];
+    midi.setSysExBuffer(storage);
+    using Packet_t = USBMIDI_Interface::MIDIUSBPacket_t;
+    std::vector<Packet_t> packets;
+    packets.push_back({{0x04, 0xF0, 0x00, 0x01}});
+    for (uint8_t i = 0; i < 198; ++i)
+        packets.push_back({{0x04, i, 0x02, 0x03}});
+    packets.push_back({{0x07, 0x04, 0x05, 0xF7}});
+    packets.push_back({});
+    size_t index = 0;
+    EXPECT_CALL(midi, readUSBPacket())
+        .Times(packets.size())
+        .WillRepeatedly(testing::Invoke([&] { return packets[index++]; }));
+    EXPECT_EQ(midi.read(), MIDIReadEvent::SYSEX_MESSAGE);
+    EXPECT_EQ(midi.getSysExMessage().length, 600);
+    EXPECT_EQ(midi.getSysExMessage().data[599], 0xF7);
+    EXPECT_EQ(midi.read(), MIDIReadEvent::NO_MESSAGE);
+}
+
+/// until they have been handled.
+TEST(USBMIDI_Interface, readMultiplePacketsBuffered) {
+    StrictMock<USBMIDI_Interface> midi;
+    using Packet_t = USBMIDI_Interface::MIDIUSBPacket_t;
+    Sequence seq;
+    EXPECT_CALL(midi, readUSBPacket())
+        .InSequence(seq)
+        .WillOnce(Return(Packet_t{{0x09, 0x90, 0x3C, 0x7F}}))
+        .WillOnce(Return(Packet_t{{0x1F, 0xF8, 0x00, 0x00}}))
+        .WillOnce(Return(Packet_t{{0x14, 0xF0, 0x01, 0x02}}))
+        .WillOnce(Return(Packet_t{{0x15, 0xF7, 0x00, 0x00}}))
+        .WillOnce(Return(Packet_t{{0x0B, 0xB0, 0x07, 0x10}}))
+        .WillOnce(Return(Packet_t{}));
+    EXPECT_EQ(midi.read(), MIDIReadEvent::CHANNEL_MESSAGE);
+    EXPECT_EQ(midi.getChannelMessage(), (ChannelMessage{0x90, 0x3C, 0x7F, 0}));
+    EXPECT_EQ(midi.read(), MIDIReadEvent::REALTIME_MESSAGE);
+    EXPECT_EQ(midi.getRealTimeMessage(),
+              (RealTimeMessage{MIDIMessageType::TIMING_CLOCK, 1}));
+    EXPECT_EQ(midi.read(), MIDIReadEvent::SYSEX_MESSAGE);
+    EXPECT_EQ(midi.getSysExMessage().length, 4);
+    EXPECT_EQ(midi.read(), MIDIReadEvent::CHANNEL_MESSAGE);
+    EXPECT_EQ(midi.getChannelMessage(), (ChannelMessage{0xB0, 0x07, 0x10, 0}));
+    // The host had no more packets, so it isn't polled again
+    EXPECT_EQ(midi.read(), MIDIReadEvent::NO_MESSAGE);
+    ::testing::Mock::VerifyAndClear(&midi);
+
+    // The next read polls the host again
+    EXPECT_CALL(midi, readUSBPacket()).WillOnce(Return(Packet_t{}));
+    EXPECT_EQ(midi.read(), MIDIReadEvent::NO_MESSAGE);
+}
+
+/// More packets than fit in the read buffer are read in multiple parts,
+/// without losing any.
+TEST(USBMIDI_Interface, readMorePacketsThanBuffer) {
+    StrictMock<USBMIDI_Interface> midi;
+    using Packet_t = USBMIDI_Interface::MIDIUSBPacket_t;
+    const uint8_t numPackets = USB_MIDI_READ_BUFFER_SIZE * 2 + 3;
+    uint8_t sent = 0;
+    EXPECT_CALL(midi, readUSBPacket())
+        .Times(numPackets + 1)
+        .WillRepeatedly(testing::Invoke([&] {
+            if (sent == numPackets)
+                return Packet_t{};
+            uint8_t i = sent++;
+            return Packet_t{{0x0B, 0xB0, i, 0x40}};
+        }));
+    for (uint8_t i = 0; i < numPackets; ++i) {
+        ASSERT_EQ(midi.read(), MIDIReadEvent::CHANNEL_MESSAGE);
+        EXPECT_EQ(midi.getChannelMessage(), (ChannelMessage{0xB0, i, 0x40, 0}));
+    }
+    EXPECT_EQ(midi.read(), MIDIReadEvent::NO_MESSAGE);
+}
+
+// -------------------------------------------------------------------------- //
+
+using ::testing::_;
+
+TEST(USBMIDI_Interface, writeCombiningFlushOncePerLoop) {
+    StrictMock<USBMIDI_Interface> midi;
+    midi.setWriteCombining(true);
+    EXPECT_CALL(ArduinoMock::getInstance(), micros())
+        .WillRepeatedly(Return(0));
+
+    for (unsigned loop = 0; loop < 3; ++loop) {
+        // A bank of 8 faders that all change during the same loop iteration
+        EXPECT_CALL(midi, writeUSBPacket(0, 0xB, 0xB0, _, 0x40)).Times(8);
+        for (uint8_t i = 0; i < 8; ++i)
+            midi.sendCC({i, CHANNEL_1}, 0x40);
+        ::testing::Mock::VerifyAndClear(&midi);
+
+        // End of Control_Surface_::loop
+        EXPECT_CALL(midi, flushUSB()).Times(1);
+        MIDI_Interface::flushAll();
+        ::testing::Mock::VerifyAndClear(&midi);
+    }
+
+    // Nothing to send, so no empty transfers
+    MIDI_Interface::flushAll();
+    ::testing::Mock::VerifyAndClear(&ArduinoMock::getInstance());
+}
+
+TEST(USBMIDI_Interface, writeCombiningFlushWhenFull) {
+    StrictMock<USBMIDI_Interface> midi;
+    midi.setWriteCombining(true);
+    EXPECT_CALL(ArduinoMock::getInstance(), micros())
+        .WillRepeatedly(Return(0));
+
+    Sequence seq;
+    EXPECT_CALL(midi, writeUSBPacket(0, 0x9, 0x90, _, 0x7F))
+        .Times(USB_MIDI_PACKETS_PER_TRANSFER)
+        .InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
+    EXPECT_CALL(midi, writeUSBPacket(0, 0x9, 0x90, _, 0x7F))
+        .Times(4)
+        .InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
+
+    for (uint8_t i = 0; i < USB_MIDI_PACKETS_PER_TRANSFER + 4; ++i)
+        midi.sendNoteOn({i, CHANNEL_1}, 0x7F);
+    MIDI_Interface::flushAll();
+    ::testing::Mock::VerifyAndClear(&ArduinoMock::getInstance());
+}
+
+TEST(USBMIDI_Interface, writeCombiningLatencyDeadline) {
+    StrictMock<USBMIDI_Interface> midi;
+    midi.setWriteCombining(true);
+    midi.setMaxLatency(500);
+    EXPECT_EQ(midi.getMaxLatency(), 500u);
+
+    // first packet: start time + deadline check after the message
+    EXPECT_CALL(ArduinoMock::getInstance(), micros())
+        .Times(2)
+        .WillRepeatedly(Return(1000));
+    EXPECT_CALL(midi, writeUSBPacket(0, 0xB, 0xB0, 0x10, 0x01));
+    midi.sendCC({0x10, CHANNEL_1}, 0x01);
+    ::testing::Mock::VerifyAndClear(&midi);
+    ::testing::Mock::VerifyAndClear(&ArduinoMock::getInstance());
+
+    // deadline not yet expired
+    EXPECT_CALL(ArduinoMock::getInstance(), micros()).WillOnce(Return(1499));
+    EXPECT_CALL(midi, readUSBPacket())
+        .WillOnce(Return(USBMIDI_Interface::MIDIUSBPacket_t{}));
+    midi.update();
+    ::testing::Mock::VerifyAndClear(&midi);
+    ::testing::Mock::VerifyAndClear(&ArduinoMock::getInstance());
+
+    // deadline expired
+    EXPECT_CALL(ArduinoMock::getInstance(), micros()).WillOnce(Return(1500));
+    EXPECT_CALL(midi, flushUSB());
+    EXPECT_CALL(midi, readUSBPacket())
+        .WillOnce(Return(USBMIDI_Interface::MIDIUSBPacket_t{}));
+    midi.update();
+    ::testing::Mock::VerifyAndClear(&midi);
+    ::testing::Mock::VerifyAndClear(&ArduinoMock::getInstance());
+
+    // nothing buffered, so the clock isn't checked
+    EXPECT_CALL(midi, readUSBPacket())
+        .WillOnce(Return(USBMIDI_Interface::MIDIUSBPacket_t{}));
+    midi.update();
+}
+
+TEST(USBMIDI_Interface, writeCombiningDisable) {
+    StrictMock<USBMIDI_Interface> midi;
+    midi.setWriteCombining(true);
+    EXPECT_TRUE(midi.getWriteCombining());
+    EXPECT_CALL(ArduinoMock::getInstance(), micros())
+        .WillRepeatedly(Return(0));
+    EXPECT_CALL(midi, writeUSBPacket(0, 0xB, 0xB0, 0x10, 0x01));
+    midi.sendCC({0x10, CHANNEL_1}, 0x01);
+    ::testing::Mock::VerifyAndClear(&midi);
+
+    // Disabling write combining sends the buffered packets
+    EXPECT_CALL(midi, flushUSB());
+    midi.setWriteCombining(false);
+    EXPECT_FALSE(midi.getWriteCombining());
+    ::testing::Mock::VerifyAndClear(&midi);
+    ::testing::Mock::VerifyAndClear(&ArduinoMock::getInstance());
+
+    // Back to one transfer per message
+    Sequence seq;
+    EXPECT_CALL(midi, writeUSBPacket(0, 0xB, 0xB0, 0x11, 0x02))
+        .InSequence(seq);
+    EXPECT_CALL(midi, flushUSB()).InSequence(seq);
+    midi.sendCC({0x11, CHANNEL_1}, 0x02);
+}
@@ -1,5 +1,6 @@
 #include <MIDI_Outputs/Bankable/CCPotentiometer.hpp>
 #include <MIDI_Outputs/CCPotentiometer.hpp>
+#include <MIDI_Outputs/CCPotentiometers.hpp>
 #include <MockMIDI_Interface.hpp>
 #include <gmock-wrapper.h>
 
@@ -72,4 +73,38 @@ TEST(CCPotentiometer, invert) {
     pot.update();
 
     Mock::VerifyAndClear(&ArduinoMock::getInstance());
-}
\ No newline at end of file
+}
+
+TEST(CCPotentiometers, simple) {
+    MockMIDI_Interface midi;
+    Control_Surface.connectDefaultMIDI_Interface();
+
+    CCPotentiometers<2> pots = {{2, 3}, {0x3C, CHANNEL_7, CABLE_13}, {2}};
+    EXPECT_CALL(ArduinoMock::getInstance(), analogRead(2)).WillOnce(Return(0));
+    EXPECT_CALL(ArduinoMock::getInstance(), analogRead(3)).WillOnce(Return(0));
+    pots.begin();
+
+    EXPECT_CALL(ArduinoMock::getInstance(), analogRead(2))
+        .Times(3)
+        .WillRepeatedly(Return(512));
+    EXPECT_CALL(ArduinoMock::getInstance(), analogRead(3))
+        .Times(3)
+        .WillRepeatedly(Return(0));
+    InSequence s;
+    EXPECT_CALL(midi, sendImpl(0xB6, 0x3C, 16, 0xC));
+    pots.update();
+    EXPECT_CALL(midi, sendImpl(0xB6, 0x3C, 28, 0xC));
+    pots.update();
+    EXPECT_CALL(midi, sendImpl(0xB6, 0x3C, 37, 0xC));
+    pots.update();
+
+    EXPECT_CALL(ArduinoMock::getInstance(), analogRead(2))
+        .WillOnce(Return(512));
+    EXPECT_CALL(ArduinoMock::getInstance(), analogRead(3))
+        .WillOnce(Return(1023));
+    EXPECT_CALL(midi, sendImpl(0xB6, 0x3C, 43, 0xC));
+    EXPECT_CALL(midi, sendImpl(0xB6, 0x3E, 32, 0xC));
+    pots.update();
+
+    Mock::VerifyAndClear(&ArduinoMock::getInstance());
+}
@@ -166,6 +166,147 @@ TEST(USBMIDIParser, sysExEndsWithoutStarting3Bytes) {
     EXPECT_EQ(uparser.parse(packet), MIDIReadEvent::NO_MESSAGE);
 }
 
+/// A SysEx message of the given length, with some recognizable data.
+static SysExVector makeLargeSysEx(size_t length) {
+    SysExVector sysex(length);
+    for (size_t i = 0; i < length; ++i)
+        sysex[i] = (i * 7 + i / 128) & 0x7F;
+    sysex.front() = 0xF0;
+    sysex.back() = 0xF7;
+    return sysex;
+}
+
+TEST(USBMIDIParser, sysEx4KiB) {
+    static uint8_t storage[4096];
+    USBMIDI_Parser uparser;
+    uparser.setSysExBuffer(storage, CABLE_3);
+    const SysExVector sysex = makeLargeSysEx(4096);
+
+    MIDIReadEvent event = MIDIReadEvent::NO_MESSAGE;
+    size_t i = 0;
+    for (; sysex.size() - i > 3; i += 3) {
+        uint8_t packet[4] = {0x24, sysex[i], sysex[i + 1], sysex[i + 2]};
+        EXPECT_EQ(uparser.parse(packet), MIDIReadEvent::NO_MESSAGE);
+    }
+    // 4096 = 3 × 1365 + 1
+    ASSERT_EQ(sysex.size() - i, 1u);
+    uint8_t packet[4] = {0x25, sysex[i], 0x00, 0x00};
+    event = uparser.parse(packet);
+
+    ASSERT_EQ(event, MIDIReadEvent::SYSEX_MESSAGE);
+    SysExMessage msg = uparser.getSysExMessage();
+    EXPECT_EQ(msg.length, 4096);
+    EXPECT_EQ(msg.CN, 2);
+    EXPECT_EQ(SysExVector(msg.data, msg.data + msg.length), sysex);
+}
+
+TEST(USBMIDIParser, sysExLargerThanCustomBuffer) {
+    uint8_t storage[300];
+    USBMIDI_Parser uparser;
+    uparser.setSysExBuffer(storage);
+    const SysExVector sysex = makeLargeSysEx(301);
+
+    size_t i = 0;
+    for (; sysex.size() - i > 3; i += 3) {
+        uint8_t packet[4] = {0x04, sysex[i], sysex[i + 1], sysex[i + 2]};
+        EXPECT_EQ(uparser.parse(packet), MIDIReadEvent::NO_MESSAGE);
+    }
+    ASSERT_EQ(sysex.size() - i, 1u);
+    uint8_t packet[4] = {0x05, sysex[i], 0x00, 0x00};
+    // Buffer full, message is dropped
+    EXPECT_EQ(uparser.parse(packet), MIDIReadEvent::NO_MESSAGE);
+}
+
+TEST(USBMIDIParser, maxSysExCapacity) {
+    USBMIDI_Parser uparser;
+    EXPECT_EQ(uparser.getMaxSysExCapacity(), SYSEX_BUFFER_SIZE);
+    static uint8_t storage[600];
+    uparser.setSysExBuffer(storage);
+    EXPECT_EQ(uparser.getMaxSysExCapacity(), 600);
+    uint8_t small[4];
+    uparser.setSysExBuffer(small);
+    EXPECT_EQ(uparser.getMaxSysExCapacity(), SYSEX_BUFFER_SIZE);
+}
+
+TEST(SysExMessage, lengthIsClamped) {
+    std::vector<uint8_t> data(0x10001);
+    EXPECT_EQ(SysExMessage(data).length, 0xFFFF);
+    EXPECT_EQ((SysExMessage{data.data(), 0x10000, 0}).length, 0xFFFF);
+    EXPECT_EQ((SysExMessage{data.data(), 0x1234, 0}).length, 0x1234);
+}
+
+TEST(USBMIDIParser, sysExChunks) {
+    uint8_t storage[8];
+    USBMIDI_Parser uparser;
+    uparser.setSysExBuffer(storage, CABLE_2);
+    uparser.setSysExChunking(true);
+    const SysExVector sysex = makeLargeSysEx(20);
+
+    SysExVector received;
+    std::vector<MIDIReadEvent> events;
+    auto handle = [&](MIDIReadEvent event) {
+        if (event == MIDIReadEvent::NO_MESSAGE)
+            return;
+        events.push_back(event);
+        SysExMessage msg = uparser.getSysExMessage();
+        EXPECT_EQ(msg.CN, 1);
+        received.insert(received.end(), msg.data, msg.data + msg.length);
+    };
+    size_t i = 0;
+    for (; sysex.size() - i > 3; i += 3) {
+        uint8_t packet[4] = {0x14, sysex[i], sysex[i + 1], sysex[i + 2]};
+        handle(uparser.parse(packet));
+    }
+    // 20 = 3 × 6 + 2
+    uint8_t packet[4] = {0x16, sysex[i], sysex[i + 1], 0x00};
+    handle(uparser.parse(packet));
+
+    // The buffer is returned after every two packets (less than 3 bytes left)
+    const std::vector<MIDIReadEvent> expected = {
+        MIDIReadEvent::SYSEX_CHUNK,
+        MIDIReadEvent::SYSEX_CHUNK,
+        MIDIReadEvent::SYSEX_CHUNK,
+        MIDIReadEvent::SYSEX_MESSAGE,
+    };
+    EXPECT_EQ(events, expected);
+    EXPECT_EQ(received, sysex);
+    EXPECT_TRUE(uparser.getSysExMessage().chunked);
+}
+
+TEST(USBMIDIParser, sysExChunkedFlag) {
+    uint8_t storage[4];
+    USBMIDI_Parser uparser;
+    uparser.setSysExBuffer(storage);
+    uint8_t packet1[4] = {0x04, 0xF0, 0x10, 0x11};
+    uint8_t packet2[4] = {0x04, 0x12, 0x13, 0x14};
+    uint8_t packet3[4] = {0x05, 0xF7, 0x00, 0x00};
+    uint8_t packet4[4] = {0x07, 0xF0, 0x20, 0xF7};
+    EXPECT_EQ(uparser.parse(packet1), MIDIReadEvent::NO_MESSAGE);
+    EXPECT_EQ(uparser.parse(packet2), MIDIReadEvent::NO_MESSAGE);
+    EXPECT_EQ(uparser.parse(packet3), MIDIReadEvent::NO_MESSAGE);
+    EXPECT_EQ(uparser.parse(packet4), MIDIReadEvent::SYSEX_MESSAGE);
+    EXPECT_FALSE(uparser.getSysExMessage().chunked);
+    // With chunking enabled, the same message is chunked
+    uparser.setSysExChunking(true);
+    EXPECT_EQ(uparser.parse(packet1), MIDIReadEvent::SYSEX_CHUNK);
+    EXPECT_TRUE(uparser.getSysExMessage().chunked);
+    EXPECT_EQ(uparser.parse(packet2), MIDIReadEvent::SYSEX_CHUNK);
+    EXPECT_EQ(uparser.parse(packet3), MIDIReadEvent::SYSEX_MESSAGE);
+    EXPECT_TRUE(uparser.getSysExMessage().chunked);
+    EXPECT_EQ(uparser.parse(packet4), MIDIReadEvent::SYSEX_MESSAGE);
+    EXPECT_FALSE(uparser.getSysExMessage().chunked);
+}
+
+TEST(USBMIDIParser, sysExChunkingShortMessage) {
+    USBMIDI_Parser uparser;
+    uparser.setSysExChunking(true);
+    uint8_t packet1[4] = {0x04, 0xF0, 0x10, 0x11};
+    uint8_t packet2[4] = {0x06, 0x12, 0xF7, 0x00};
+    EXPECT_EQ(uparser.parse(packet1), MIDIReadEvent::NO_MESSAGE);
+    EXPECT_EQ(uparser.parse(packet2), MIDIReadEvent::SYSEX_MESSAGE);
+    EXPECT_TRUE(uparser.getSysExMessage().isCompleteMessage());
+}
+
 // -------------------------- SERIAL PARSER TESTS --------------------------- //
 
 TEST(SerialMIDIParser, noteOff) {
@@ -582,4 +723,300 @@ TEST(SerialMIDIParser, realSysEx) {
         0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0xF7,
     };
     EXPECT_EQ(result, expected);
-}
\ No newline at end of file
+}
+
+// ----------------------- SERIAL PARSER BUFFER TESTS ----------------------- //
+
+/// Parsed event with its message, for comparing parser outputs.
+struct ParsedEvent {
+    MIDIReadEvent event;
+    ChannelMessage channelMessage;
+    RealTimeMessage realTimeMessage;
+    SysExVector sysex;
+
+    ParsedEvent(MIDIReadEvent event, const SerialMIDI_Parser &parser)
+        : event(event), channelMessage{0, 0, 0, 0}, realTimeMessage{0, 0} {
+        SerialMIDI_Parser &p = const_cast<SerialMIDI_Parser &>(parser);
+        switch (event) {
+            case MIDIReadEvent::CHANNEL_MESSAGE:
+                channelMessage = p.getChannelMessage();
+                break;
+            case MIDIReadEvent::REALTIME_MESSAGE:
+                realTimeMessage = p.getRealTimeMessage();
+                break;
+            case MIDIReadEvent::SYSEX_MESSAGE:
+            case MIDIReadEvent::SYSEX_CHUNK:
+                sysex = {p.getSysExBuffer(),
+                         p.getSysExBuffer() + p.getSysExLength()};
+                break;
+            case MIDIReadEvent::NO_MESSAGE: break;
+            default: break;
+        }
+    }
+
+    bool operator==(const ParsedEvent &o) const {
+        return event == o.event && channelMessage == o.channelMessage &&
+               realTimeMessage == o.realTimeMessage && sysex == o.sysex;
+    }
+};
+
+static std::vector<ParsedEvent> parseBytewise(const SysExVector &data) {
+    SerialMIDI_Parser sparser;
+    std::vector<ParsedEvent> events;
+    for (uint8_t b : data) {
+        MIDIReadEvent event = sparser.parse(b);
+        if (event != MIDIReadEvent::NO_MESSAGE)
+            events.emplace_back(event, sparser);
+    }
+    return events;
+}
+
+static std::vector<ParsedEvent> parseBuffered(const SysExVector &data,
+                                              size_t chunkSize) {
+    SerialMIDI_Parser sparser;
+    std::vector<ParsedEvent> events;
+    for (size_t start = 0; start < data.size(); start += chunkSize) {
+        size_t end = std::min(start + chunkSize, data.size());
+        size_t i = start;
+        while (i < end) {
+            size_t consumed;
+            MIDIReadEvent event =
+                sparser.parse(data.data() + i, end - i, consumed);
+            EXPECT_GT(consumed, 0u);
+            i += consumed;
+            if (event != MIDIReadEvent::NO_MESSAGE)
+                events.emplace_back(event, sparser);
+        }
+        EXPECT_EQ(i, end);
+    }
+    return events;
+}
+
+TEST(SerialMIDIParser, bufferMultipleMessages) {
+    SerialMIDI_Parser sparser;
+    const uint8_t data[] = {0x93, 0x10, 0x20, 0x11, 0x21, 0xF8, 0xC2, 0x05};
+    size_t consumed;
+
+    EXPECT_EQ(sparser.parse(data, sizeof(data), consumed),
+              MIDIReadEvent::CHANNEL_MESSAGE);
+    EXPECT_EQ(consumed, 3u);
+    EXPECT_EQ(sparser.getChannelMessage(),
+              (ChannelMessage{0x93, 0x10, 0x20, 0}));
+
+    EXPECT_EQ(sparser.parse(data + 3, sizeof(data) - 3, consumed),
+              MIDIReadEvent::CHANNEL_MESSAGE);
+    EXPECT_EQ(consumed, 2u);
+    EXPECT_EQ(sparser.getChannelMessage(),
+              (ChannelMessage{0x93, 0x11, 0x21, 0}));
+
+    EXPECT_EQ(sparser.parse(data + 5, sizeof(data) - 5, consumed),
+              MIDIReadEvent::REALTIME_MESSAGE);
+    EXPECT_EQ(consumed, 1u);
+
+    EXPECT_EQ(sparser.parse(data + 6, sizeof(data) - 6, consumed),
+              MIDIReadEvent::CHANNEL_MESSAGE);
+    EXPECT_EQ(consumed, 2u);
+    EXPECT_EQ(sparser.getChannelMessage().header, 0xC2);
+    EXPECT_EQ(sparser.getChannelMessage().data1, 0x05);
+
+    EXPECT_EQ(sparser.parse(data + 8, 0, consumed), MIDIReadEvent::NO_MESSAGE);
+    EXPECT_EQ(consumed, 0u);
+}
+
+TEST(SerialMIDIParser, bufferIncompleteMessage) {
+    SerialMIDI_Parser sparser;
+    const uint8_t data[] = {0xF0, 0x01, 0x02, 0x03, 0x04};
+    size_t consumed;
+    EXPECT_EQ(sparser.parse(data, sizeof(data), consumed),
+              MIDIReadEvent::NO_MESSAGE);
+    EXPECT_EQ(consumed, sizeof(data));
+    EXPECT_EQ(sparser.parse(0xF7), MIDIReadEvent::SYSEX_MESSAGE);
+    const SysExVector result(sparser.getSysExBuffer(),
+                             sparser.getSysExBuffer() +
+                                 sparser.getSysExLength());
+    const SysExVector expected = {0xF0, 0x01, 0x02, 0x03, 0x04, 0xF7};
+    EXPECT_EQ(result, expected);
+}
+
+TEST(SerialMIDIParser, bufferSameAsBytewise) {
+    const SysExVector data = {
+        0x12, 0x13,                   // data without header
+        0x90, 0x3C, 0x7F,             // note on
+        0x3D, 0x7E,                   // running status
+        0x3E, 0xF8, 0x7D,             // real-time in between data bytes
+        0xB1, 0x07, 0x64, 0x08, 0x10, // control change + running status
+        0xF0, 0x41, 0x42, 0xF8, 0x43, 0x44, 0xF7, // SysEx with real-time
+        0x45, 0x46,                               // data after SysEx end
+        0xF0, 0x01, 0x02, 0x03,       // SysEx terminated by status byte
+        0xF0, 0x04, 0x05, 0xF7,       // SysEx terminated by SysEx start
+        0xE0, 0x00, 0x40,             // pitch bend
+        0xF0, 0xF7,                   // empty SysEx
+        0xD5, 0x11, 0x12, 0xFE, 0x13, // channel pressure, running status
+        0xF6,                         // tune request
+        0x14,                         // data byte after tune request
+        0xFF,                         // reset
+    };
+    auto expected = parseBytewise(data);
+    EXPECT_EQ(expected.size(), 17u);
+    for (size_t chunkSize : {1, 2, 3, 5, 7, 16, 64})
+        EXPECT_EQ(parseBuffered(data, chunkSize), expected) << chunkSize;
+}
+
+TEST(SerialMIDIParser, bufferSysExOverflow) {
+    SysExVector data(SYSEX_BUFFER_SIZE + 10, 0x55);
+    data.front() = 0xF0;
+    data.back() = 0xF7;
+    auto expected = parseBytewise(data);
+    ASSERT_EQ(expected.size(), 1u);
+    EXPECT_EQ(expected[0].sysex.size(), SYSEX_BUFFER_SIZE);
+    for (size_t chunkSize : {1, 7, 1000})
+        EXPECT_EQ(parseBuffered(data, chunkSize), expected) << chunkSize;
+}
+
+TEST(SerialMIDIParser, sysEx4KiB) {
+    static uint8_t storage[4096];
+    const SysExVector sysex = makeLargeSysEx(4096);
+    SysExVector data = {0x90, 0x3C, 0x7F}; // note on before
+    data.insert(data.end(), sysex.begin(), sysex.end());
+    data.insert(data.end(), {0xF8, 0x80, 0x3C, 0x7F}); // RT + note off after
+
+    for (size_t chunkSize : {1, 16, 1000, 5000}) {
+        SerialMIDI_Parser sparser;
+        sparser.setSysExBuffer(storage);
+        std::vector<MIDIReadEvent> events;
+        for (size_t i = 0; i < data.size();) {
+            size_t length = std::min(chunkSize, data.size() - i);
+            size_t consumed;
+            MIDIReadEvent event = sparser.parse(&data[i], length, consumed);
+            i += consumed;
+            if (event == MIDIReadEvent::NO_MESSAGE)
+                continue;
+            events.push_back(event);
+            if (event == MIDIReadEvent::SYSEX_MESSAGE) {
+                SysExMessage msg = sparser.getSysExMessage();
+                EXPECT_EQ(msg.length, 4096) << chunkSize;
+                EXPECT_EQ(SysExVector(msg.data, msg.data + msg.length), sysex)
+                    << chunkSize;
+            }
+        }
+        const std::vector<MIDIReadEvent> expected = {
+            MIDIReadEvent::CHANNEL_MESSAGE,
+            MIDIReadEvent::SYSEX_MESSAGE,
+            MIDIReadEvent::REALTIME_MESSAGE,
+            MIDIReadEvent::CHANNEL_MESSAGE,
+        };
+        EXPECT_EQ(events, expected) << chunkSize;
+    }
+}
+
+TEST(SerialMIDIParser, sysExCustomBufferBytewise) {
+    uint8_t storage[600];
+    SerialMIDI_Parser sparser;
+    sparser.setSysExBuffer(storage);
+    const SysExVector sysex = makeLargeSysEx(600);
+    for (size_t i = 0; i < sysex.size() - 1; ++i)
+        EXPECT_EQ(sparser.parse(sysex[i]), MIDIReadEvent::NO_MESSAGE);
+    EXPECT_EQ(sparser.parse(sysex.back()), MIDIReadEvent::SYSEX_MESSAGE);
+    EXPECT_EQ(sparser.getSysExLength(), 600u);
+    EXPECT_EQ(SysExVector(sparser.getSysExBuffer(),
+                          sparser.getSysExBuffer() + 600),
+              sysex);
+}
+
+static std::vector<ParsedEvent> parseChunks(const SysExVector &data,
+                                            size_t chunkSize,
+                                            SysExVector &received) {
+    uint8_t storage[10];
+    SerialMIDI_Parser sparser;
+    sparser.setSysExBuffer(storage);
+    sparser.setSysExChunking(true);
+    std::vector<ParsedEvent> events;
+    auto handle = [&](MIDIReadEvent event) {
+        if (event == MIDIReadEvent::NO_MESSAGE)
+            return;
+        events.emplace_back(event, sparser);
+        if (event == MIDIReadEvent::SYSEX_CHUNK ||
+            event == MIDIReadEvent::SYSEX_MESSAGE)
+            received.insert(received.end(), sparser.getSysExBuffer(),
+                            sparser.getSysExBuffer() +
+                                sparser.getSysExLength());
+    };
+    for (size_t i = 0; i < data.size();) {
+        if (chunkSize == 0) { // bytewise
+            handle(sparser.parse(data[i++]));
+        } else {
+            size_t consumed;
+            size_t length = std::min(chunkSize, data.size() - i);
+            handle(sparser.parse(&data[i], length, consumed));
+            i += consumed;
+        }
+    }
+    return events;
+}
+
+TEST(SerialMIDIParser, sysExChunks) {
+    SysExVector data = makeLargeSysEx(35);
+    data.insert(data.begin() + 12, 0xF8); // real-time in the middle
+    data.insert(data.end(), {0x90, 0x10, 0x20});
+
+    for (size_t chunkSize : {0, 1, 3, 7, 100}) {
+        SysExVector received;
+        auto events = parseChunks(data, chunkSize, received);
+        // 35 bytes in a buffer of 10 bytes
+        std::vector<MIDIReadEvent> types;
+        for (auto &e : events)
+            types.push_back(e.event);
+        const std::vector<MIDIReadEvent> expected = {
+            MIDIReadEvent::SYSEX_CHUNK,     MIDIReadEvent::REALTIME_MESSAGE,
+            MIDIReadEvent::SYSEX_CHUNK,     MIDIReadEvent::SYSEX_CHUNK,
+            MIDIReadEvent::SYSEX_MESSAGE,   MIDIReadEvent::CHANNEL_MESSAGE,
+        };
+        EXPECT_EQ(types, expected) << chunkSize;
+        EXPECT_EQ(received, makeLargeSysEx(35)) << chunkSize;
+    }
+}
+
+TEST(SerialMIDIParser, sysExChunksExactMultiple) {
+    // The last data byte fills the buffer, the end byte is a chunk on its own
+    SysExVector data = makeLargeSysEx(11);
+    for (size_t chunkSize : {0, 4, 100}) {
+        SysExVector received;
+        auto events = parseChunks(data, chunkSize, received);
+        ASSERT_EQ(events.size(), 2u) << chunkSize;
+        EXPECT_EQ(events[0].event, MIDIReadEvent::SYSEX_CHUNK);
+        EXPECT_EQ(events[1].event, MIDIReadEvent::SYSEX_MESSAGE);
+        EXPECT_EQ(events[1].sysex, SysExVector{0xF7});
+        EXPECT_EQ(received, data) << chunkSize;
+    }
+}
+
+TEST(SerialMIDIParser, sysExChunksUnterminated) {
+    // A SysEx message that is terminated by another status byte
+    SysExVector data = makeLargeSysEx(15);
+    data.back() = 0x90;
+    data.insert(data.end(), {0x10, 0x20});
+    SysExVector received;
+    auto events = parseChunks(data, 0, received);
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].event, MIDIReadEvent::SYSEX_CHUNK);
+    EXPECT_EQ(events[1].event, MIDIReadEvent::SYSEX_MESSAGE);
+    EXPECT_EQ(events[2].event, MIDIReadEvent::CHANNEL_MESSAGE);
+    SysExVector expected = makeLargeSysEx(15);
+    EXPECT_EQ(received, expected);
+}
+
+TEST(SerialMIDIParser, sysExTruncatedIsNotChunked) {
+    // Without chunking, messages that don't fit are truncated
+    uint8_t storage[4];
+    SerialMIDI_Parser sparser;
+    sparser.setSysExBuffer(storage);
+    SysExVector data = {0xF0, 0x01, 0x02, 0x03, 0x04, 0x05, 0x90};
+    for (size_t i = 0; i < data.size() - 1; ++i)
+        EXPECT_EQ(sparser.parse(data[i]), MIDIReadEvent::NO_MESSAGE);
+    EXPECT_EQ(sparser.parse(data.back()), MIDIReadEvent::SYSEX_MESSAGE);
+    SysExMessage msg = sparser.getSysExMessage();
+    EXPECT_EQ(SysExVector(msg.data, msg.data + msg.length),
+              (SysExVector{0xF0, 0x01, 0x02, 0x03}));
+    EXPECT_FALSE(msg.chunked);
+    EXPECT_TRUE(msg.isCompleteMessage());
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Display/DisplayInterface.hpp>
+
+/// 128×64 monochrome display with a frame buffer that consists of 8 pages of
+/// 8 rows, like the SSD1306. Counts the number of pixels that are drawn and
+/// the number of bytes that are written to the display.
+struct MockPagedDisplay : CS::DisplayInterface {
+    constexpr static int16_t width = 128, height = 64;
+
+    void clear() override {
+        ++clears;
+        for (auto &byte : buffer)
+            byte = 0;
+    }
+    void display() override { displayPages(0, height / 8 - 1); }
+    void displayRegion(const CS::PixelRegion &region) override {
+        int16_t top = region.y > 0 ? region.y : 0;
+        int16_t bottom = region.y + region.h;
+        if (bottom > height)
+            bottom = height;
+        if (top < bottom)
+            displayPages(top / 8, (bottom - 1) / 8);
+    }
+    void displayPages(uint8_t first, uint8_t last) {
+        ++transfers;
+        bytesTransferred += (last - first + 1) * width;
+    }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+        ++pixelWrites;
+        if (x < 0 || x >= width || y < 0 || y >= height)
+            return;
+        uint8_t &byte = buffer[x + (y / 8) * width];
+        uint8_t mask = 1 << (y % 8);
+        byte = color ? byte | mask : byte & ~mask;
+    }
+    bool getPixel(int16_t x, int16_t y) const {
+        return buffer[x + (y / 8) * width] & (1 << (y % 8));
+    }
+
+    void setTextColor(uint16_t) override {}
+    void setTextSize(uint8_t) override {}
+    void setCursor(int16_t, int16_t) override {}
+    size_t write(uint8_t) override { return 1; }
+    void drawLine(int16_t, int16_t, int16_t, int16_t, uint16_t) override {}
+    void drawFastVLine(int16_t x, int16_t y, int16_t h,
+                       uint16_t color) override {
+        for (int16_t i = 0; i < h; ++i)
+            drawPixel(x, y + i, color);
+    }
+    void drawFastHLine(int16_t x, int16_t y, int16_t w,
+                       uint16_t color) override {
+        for (int16_t i = 0; i < w; ++i)
+            drawPixel(x + i, y, color);
+    }
+    void drawXBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w,
+                     int16_t h, uint16_t color) override {
+        int16_t byteWidth = (w + 7) / 8;
+        for (int16_t j = 0; j < h; ++j)
+            for (int16_t i = 0; i < w; ++i)
+                if (bitmap[j * byteWidth + i / 8] & (1 << (i % 8)))
+                    drawPixel(x + i, y + j, color);
+    }
+
+    void resetCounters() {
+        clears = pixelWrites = transfers = 0;
+        bytesTransferred = 0;
+    }
+
+    uint8_t buffer[width * height / 8] = {};
+    unsigned clears = 0;
+    unsigned pixelWrites = 0;
+    unsigned transfers = 0;
+    unsigned long bytesTransferred = 0;
+};